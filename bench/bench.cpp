@@ -0,0 +1,475 @@
+// tcp_kit_bench: 在回环地址上压测服务端, 输出吞吐、延迟分位数与每个请求的 CPU 时间
+//
+// tcp_kit_bench [--mode=closed|open] [--connections=4] [--depth=8] [--rate=10000] [--payload=64]
+//               [--mix=echo:1] [--spin-us=50] [--duration=10] [--warmup=2]
+//               [--server=inproc|fork|host:port] [--ev-handlers=0] [--handlers=0]
+//               [--expected-interval-us=0] [--format=json|csv] [--output=path]
+// tcp_kit_bench --serve [--ev-handlers=0] [--handlers=0]
+//
+// closed: 每个连接保持 depth 个待回复的请求, 收到回复后立即发出下一个. 协调遗漏修正以 expected-interval-us
+//         (为 0 时取延迟的中位数)作为请求的期望间隔
+// open:   以 rate(请求/秒)的固定速率发出请求, 与回复是否到达无关, 延迟从计划发出的时间算起, 因此已包含
+//         排队造成的延迟. 待回复的请求达到 connections * depth 时推迟发出, 推迟的时间同样计入延迟
+//
+// mix 为逗号分隔的 api:权重, 可选的 api 为 echo(回显 payload 字节的字符串)、add(两个 int32 相加)与
+// spin(服务端忙等 spin-us 微秒). 服务端使用 json 协议: 二进制的 protobuf 帧中可能出现换行符, 不适用于按行分帧.
+// 结果写到 output(默认为标准输出, 其中会混有日志)
+
+#include <network/server.h>
+#include <network/json.h>
+#include <network/client.h>
+#include <util/histogram.h>
+#include <util/system_util.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <future>
+
+#ifndef BENCH_PORT
+#define BENCH_PORT 3300
+#endif
+
+namespace tcp_kit {
+
+    namespace bench {
+
+        using steady = std::chrono::steady_clock;
+
+        struct options {
+            bool        closed          = true;
+            uint32_t    connections     = 4;
+            uint32_t    depth           = 8;
+            uint32_t    rate            = 10000;
+            uint32_t    payload         = 64;
+            std::string mix             = "echo:1";
+            uint32_t    spin_us         = 50;
+            double      duration        = 10;
+            double      warmup          = 2;
+            std::string server          = "inproc";
+            uint16_t    ev_handlers     = 0;
+            uint16_t    handlers        = 0;
+            uint64_t    expected_interval_us = 0;
+            bool        csv             = false;
+            std::string output;
+            bool        serve           = false;
+        };
+
+        struct weighted_api {
+            std::string name;
+            uint32_t    weight;
+        };
+
+        uint64_t now_ns() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(steady::now().time_since_epoch()).count();
+        }
+
+        void sleep_until_ns(uint64_t t) {
+            uint64_t now = now_ns();
+            if(t > now)
+                std::this_thread::sleep_for(std::chrono::nanoseconds(t - now));
+        }
+
+        bool parse(int argc, char **argv, options &opts) {
+            for(int i = 1; i < argc; ++i) {
+                std::string arg = argv[i];
+                if(arg == "--serve") {
+                    opts.serve = true;
+                    continue;
+                }
+                size_t eq = arg.find('=');
+                if(arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+                    fprintf(stderr, "Unrecognized argument [%s]\n", arg.c_str());
+                    return false;
+                }
+                std::string key = arg.substr(2, eq - 2), value = arg.substr(eq + 1);
+                if(key == "mode" && (value == "closed" || value == "open"))   opts.closed = value == "closed";
+                else if(key == "connections")           opts.connections = std::stoul(value);
+                else if(key == "depth")                 opts.depth = std::stoul(value);
+                else if(key == "rate")                  opts.rate = std::stoul(value);
+                else if(key == "payload")               opts.payload = std::stoul(value);
+                else if(key == "mix")                   opts.mix = value;
+                else if(key == "spin-us")               opts.spin_us = std::stoul(value);
+                else if(key == "duration")              opts.duration = std::stod(value);
+                else if(key == "warmup")                opts.warmup = std::stod(value);
+                else if(key == "server")                opts.server = value;
+                else if(key == "ev-handlers")           opts.ev_handlers = uint16_t(std::stoul(value));
+                else if(key == "handlers")              opts.handlers = uint16_t(std::stoul(value));
+                else if(key == "expected-interval-us")  opts.expected_interval_us = std::stoull(value);
+                else if(key == "format" && (value == "json" || value == "csv")) opts.csv = value == "csv";
+                else if(key == "output")                opts.output = value;
+                else {
+                    fprintf(stderr, "Unrecognized argument [%s]\n", arg.c_str());
+                    return false;
+                }
+            }
+            if(!opts.connections || !opts.depth || !opts.rate || opts.duration <= 0 || opts.warmup < 0) {
+                fprintf(stderr, "connections, depth, rate and duration must be positive\n");
+                return false;
+            }
+            return true;
+        }
+
+        bool parse_mix(const std::string &mix, std::vector<weighted_api> &apis) {
+            size_t begin = 0;
+            while(begin < mix.size()) {
+                size_t end = mix.find(',', begin);
+                if(end == std::string::npos)
+                    end = mix.size();
+                std::string item = mix.substr(begin, end - begin);
+                size_t colon = item.find(':');
+                weighted_api api{item.substr(0, colon), colon == std::string::npos ? 1 : uint32_t(std::stoul(item.substr(colon + 1)))};
+                if(api.name != "echo" && api.name != "add" && api.name != "spin") {
+                    fprintf(stderr, "Unknown api [%s] in mix, expected echo / add / spin\n", api.name.c_str());
+                    return false;
+                }
+                if(api.weight)
+                    apis.push_back(api);
+                begin = end + 1;
+            }
+            if(apis.empty())
+                fprintf(stderr, "Empty api mix\n");
+            return !apis.empty();
+        }
+
+        // 压测用的服务端, 阻塞直到进程退出
+        void serve(const options &opts) {
+            server<json, BENCH_PORT> svr(opts.ev_handlers, opts.handlers);
+            svr.api("echo", [](std::string payload) {
+                return payload;
+            });
+            svr.api("add", [](int32_t a, int32_t b) {
+                return a + b;
+            });
+            svr.api("spin", [](uint32_t us) {
+                auto until = steady::now() + std::chrono::microseconds(us);
+                while(steady::now() < until);
+                return us;
+            });
+            svr.api("bench_cpu", [] {
+                return uint64_t(process_cpu_time_us());
+            });
+            svr.start();
+        }
+
+        // 发出请求并记录回复. 回复的回调都在客户端的事件循环线程中执行, 直方图只在该线程中写入,
+        // 由 _in_flight 的 release / acquire 保证 drain 返回后主线程可以读取
+        class load {
+
+        public:
+            load(const options &opts, const std::string &address, std::vector<weighted_api> apis):
+                    _opts(opts), _client(address, opts.connections), _apis(std::move(apis)),
+                    _total_weight(0), _payload(opts.payload, 'x'), _in_flight(0), _stopped(false),
+                    _measure_begin(0), _measure_end(0), _n_errors(0), _n_overloaded(0) {
+                for(const weighted_api &api: _apis)
+                    _total_weight += api.weight;
+            }
+
+            // 发送一个请求, 返回服务端是否可达与是否提供 bench_cpu
+            bool probe(bool &has_cpu_api) {
+                std::promise<GenericReply::Code> code;
+                std::future<GenericReply::Code> res = code.get_future();
+                GenericMsg msg;
+                msg.set_api("bench_cpu");
+                _client.send(msg, [&code](std::unique_ptr<GenericReply> reply) {
+                    code.set_value(reply->code());
+                });
+                GenericReply::Code c = res.get();
+                has_cpu_api = c == GenericReply::SUCCESS;
+                return c != GenericReply::UNKNOWN_ERR;
+            }
+
+            int64_t server_cpu_us() {
+                auto res = _client.call<uint64_t>("bench_cpu");
+                try {
+                    return int64_t(res.get());
+                } catch (...) {
+                    return -1;
+                }
+            }
+
+            void run(uint64_t begin, uint64_t measure_begin, uint64_t measure_end) {
+                _measure_begin = measure_begin;
+                _measure_end = measure_end;
+                if(_opts.closed) {
+                    for(uint32_t i = 0; i < _opts.connections * _opts.depth; ++i)
+                        issue(now_ns());
+                } else {
+                    _pacer = std::thread([this, begin] { pace(begin); });
+                }
+            }
+
+            // 停止发出请求并等待所有待回复的请求完成
+            void drain() {
+                _stopped.store(true, std::memory_order_relaxed);
+                if(_pacer.joinable())
+                    _pacer.join();
+                while(_in_flight.load(std::memory_order_acquire))
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            const histogram& service() const  { return _service; }
+            const histogram& response() const { return _response; }
+            uint64_t n_errors() const         { return _n_errors; }
+            uint64_t n_overloaded() const     { return _n_overloaded; }
+
+        private:
+            const options                &_opts;
+            client<json>                  _client;
+            std::vector<weighted_api>     _apis;
+            uint32_t                      _total_weight;
+            std::string                   _payload;
+            std::atomic<uint32_t>         _in_flight;
+            std::atomic<bool>             _stopped;
+            std::thread                   _pacer;
+            uint64_t                      _measure_begin;
+            uint64_t                      _measure_end;
+            histogram                     _service;   // 从实际发出算起的延迟(微秒)
+            histogram                     _response;  // 从计划发出算起的延迟(微秒), closed 模式下与 _service 相同
+            uint64_t                      _n_errors;
+            uint64_t                      _n_overloaded;
+
+            // 开环: 第 i 个请求计划在 begin + i / rate 发出
+            void pace(uint64_t begin) {
+                const uint64_t cap = uint64_t(_opts.connections) * _opts.depth;
+                const double interval_ns = 1e9 / _opts.rate;
+                for(uint64_t i = 0; !_stopped.load(std::memory_order_relaxed); ++i) {
+                    uint64_t intended = begin + uint64_t(i * interval_ns);
+                    sleep_until_ns(intended);
+                    while(_in_flight.load(std::memory_order_relaxed) >= cap && !_stopped.load(std::memory_order_relaxed))
+                        std::this_thread::yield();
+                    issue(intended);
+                }
+            }
+
+            // 开环模式下在 pacer 线程中调用, 闭环模式下在主线程(首批)与事件循环线程中调用
+            void issue(uint64_t intended) {
+                GenericMsg msg;
+                const weighted_api &api = pick();
+                msg.set_api(api.name);
+                if(api.name == "echo") {
+                    msg.add_params()->set_str(_payload);
+                } else if(api.name == "add") {
+                    msg.add_params()->set_s32(1);
+                    msg.add_params()->set_s32(2);
+                } else {
+                    msg.add_params()->set_u32(_opts.spin_us);
+                }
+                _in_flight.fetch_add(1, std::memory_order_relaxed);
+                uint64_t sent = now_ns();
+                _client.send(msg, [this, intended, sent](std::unique_ptr<GenericReply> reply) {
+                    on_reply(intended, sent, *reply);
+                });
+            }
+
+            const weighted_api& pick() {
+                static thread_local uint64_t rand = 0x9e3779b97f4a7c15ull;
+                if(_apis.size() == 1)
+                    return _apis[0];
+                rand ^= rand << 13;
+                rand ^= rand >> 7;
+                rand ^= rand << 17;
+                uint32_t r = uint32_t(rand % _total_weight);
+                for(const weighted_api &api: _apis) {
+                    if(r < api.weight)
+                        return api;
+                    r -= api.weight;
+                }
+                return _apis.back();
+            }
+
+            void on_reply(uint64_t intended, uint64_t sent, const GenericReply &reply) {
+                uint64_t now = now_ns();
+                if(now >= _measure_begin && now < _measure_end) {
+                    if(reply.code() == GenericReply::SUCCESS) {
+                        _service.record((now - sent) / 1000);
+                        _response.record((now - intended) / 1000);
+                    } else if(reply.code() == GenericReply::OVERLOADED) {
+                        ++_n_overloaded;
+                    } else {
+                        ++_n_errors;
+                    }
+                }
+                if(_opts.closed && !_stopped.load(std::memory_order_relaxed))
+                    issue(now);
+                _in_flight.fetch_sub(1, std::memory_order_release);
+            }
+
+        };
+
+        // 结果按顺序输出为一个扁平的 json 对象或一行 csv(带表头), 便于跨版本比较
+        class report {
+
+        public:
+            void add(const std::string &key, const std::string &value, bool quoted = false) {
+                _fields.emplace_back(key, quoted ? "\"" + value + "\"" : value);
+            }
+
+            void add(const std::string &key, double value) {
+                char buf[64];
+                snprintf(buf, sizeof(buf), "%.3f", value);
+                add(key, std::string(buf));
+            }
+
+            void add(const std::string &key, uint64_t value) {
+                add(key, std::to_string(value));
+            }
+
+            void add_latency(const std::string &prefix, const histogram &h) {
+                add(prefix + "_mean_us", h.mean());
+                add(prefix + "_p50_us", h.percentile(50));
+                add(prefix + "_p90_us", h.percentile(90));
+                add(prefix + "_p99_us", h.percentile(99));
+                add(prefix + "_p999_us", h.percentile(99.9));
+                add(prefix + "_max_us", h.max());
+            }
+
+            bool print(bool csv, const std::string &path) const {
+                std::string out;
+                if(csv) {
+                    for(size_t i = 0; i < _fields.size(); ++i)
+                        out += (i ? "," : "") + _fields[i].first;
+                    out += "\n";
+                    for(size_t i = 0; i < _fields.size(); ++i)
+                        out += (i ? "," : "") + _fields[i].second;
+                } else {
+                    out += "{";
+                    for(size_t i = 0; i < _fields.size(); ++i)
+                        out += (i ? ", \"" : "\"") + _fields[i].first + "\": " + _fields[i].second;
+                    out += "}";
+                }
+                FILE *file = path.empty() ? stdout : fopen(path.c_str(), "w");
+                if(!file) {
+                    perror(path.c_str());
+                    return false;
+                }
+                fprintf(file, "%s\n", out.c_str());
+                if(file == stdout)
+                    fflush(file);
+                else
+                    fclose(file);
+                return true;
+            }
+
+        private:
+            std::vector<std::pair<std::string, std::string>> _fields;
+
+        };
+
+        int run(const options &opts) {
+            std::vector<weighted_api> apis;
+            if(!parse_mix(opts.mix, apis))
+                return 2;
+
+            // fork 必须在创建任何线程之前
+            pid_t child = 0;
+            std::string address = "127.0.0.1:" + std::to_string(BENCH_PORT);
+            if(opts.server == "fork") {
+                child = fork();
+                if(child < 0) {
+                    perror("fork");
+                    return 1;
+                }
+                if(child == 0) {
+                    serve(opts);
+                    _exit(0);
+                }
+            } else if(opts.server == "inproc") {
+                std::thread([&opts] { serve(opts); }).detach();
+            } else {
+                address = opts.server;
+            }
+
+            int code = 0;
+            {
+                load ld(opts, address, apis);
+                bool has_cpu_api = false, reachable = false;
+                for(uint32_t attempt = 0; attempt < 50 && !reachable; ++attempt) {
+                    if(attempt)
+                        std::this_thread::sleep_for(std::chrono::milliseconds(CLIENT_RECONNECT_MS));
+                    reachable = ld.probe(has_cpu_api);
+                }
+                if(!reachable) {
+                    fprintf(stderr, "Unable to reach the server at [%s]\n", address.c_str());
+                    code = 1;
+                } else {
+                    const uint64_t begin = now_ns();
+                    const uint64_t measure_begin = begin + uint64_t(opts.warmup * 1e9);
+                    const uint64_t measure_end = measure_begin + uint64_t(opts.duration * 1e9);
+                    ld.run(begin, measure_begin, measure_end);
+
+                    sleep_until_ns(measure_begin);
+                    int64_t cpu_begin = process_cpu_time_us();
+                    int64_t server_cpu_begin = opts.server != "inproc" && has_cpu_api ? ld.server_cpu_us() : -1;
+                    sleep_until_ns(measure_end);
+                    int64_t cpu_end = process_cpu_time_us();
+                    int64_t server_cpu_end = server_cpu_begin >= 0 ? ld.server_cpu_us() : -1;
+                    ld.drain();
+
+                    uint64_t n = ld.service().count();
+                    histogram corrected;
+                    if(opts.closed)
+                        ld.service().corrected(opts.expected_interval_us ? opts.expected_interval_us : ld.service().percentile(50), corrected);
+
+                    report r;
+                    r.add("mode", opts.closed ? "closed" : "open", true);
+                    r.add("server", opts.server, true);
+                    r.add("connections", uint64_t(opts.connections));
+                    r.add("depth", uint64_t(opts.depth));
+                    r.add("rate", opts.closed ? uint64_t(0) : uint64_t(opts.rate));
+                    r.add("payload", uint64_t(opts.payload));
+                    r.add("mix", opts.mix, true);
+                    r.add("duration_s", opts.duration);
+                    r.add("requests", n);
+                    r.add("errors", ld.n_errors());
+                    r.add("overloaded", ld.n_overloaded());
+                    r.add("throughput_rps", n / opts.duration);
+                    r.add_latency("latency", ld.service());
+                    r.add_latency("corrected_latency", opts.closed ? corrected : ld.response());
+                    // inproc 时进程的 CPU 时间包含服务端, fork / 外部服务端时只是客户端
+                    r.add("process_cpu_us_per_req", n ? double(cpu_end - cpu_begin) / n : 0.0);
+                    if(server_cpu_begin >= 0 && server_cpu_end >= 0)
+                        r.add("server_cpu_us_per_req", n ? double(server_cpu_end - server_cpu_begin) / n : 0.0);
+                    else
+                        r.add("server_cpu_us_per_req", "null");
+                    if(!r.print(opts.csv, opts.output))
+                        code = 1;
+                }
+            }
+
+            if(child > 0) {
+                kill(child, SIGTERM);
+                waitpid(child, nullptr, 0);
+            }
+            return code;
+        }
+
+    }
+
+}
+
+int main(int argc, char **argv) {
+    tcp_kit::bench::options opts;
+    try {
+        if(!tcp_kit::bench::parse(argc, argv, opts))
+            return 2;
+    } catch (const std::exception &e) {
+        fprintf(stderr, "Invalid argument: %s\n", e.what());
+        return 2;
+    }
+    if(opts.serve) {
+        tcp_kit::bench::serve(opts);
+        return 0;
+    }
+    // inproc 的服务端线程不会停止, 不执行静态对象的析构
+    int code = tcp_kit::bench::run(opts);
+    fflush(stdout);
+    _exit(code);
+}
@@ -0,0 +1,553 @@
+// tcp_kit_microbench: 数据通路上各组件的微基准(Google Benchmark), 作为调优前后比较的基线
+//
+// tcp_kit_microbench [--benchmark_filter=<regex>] [--benchmark_format=json] [--benchmark_out=<path>]
+
+#include <benchmark/benchmark.h>
+#include <concurrent/lock_free_queue.h>
+#include <concurrent/lock_free_queue_nb.h>
+#include <concurrent/lock_free_spsc_queue.h>
+#include <concurrent/blocking_fifo.h>
+#include <concurrent/lock_free_stack.h>
+#include <thread/thread_pool.h>
+#include <network/server.h>
+#include <network/generic.h>
+#include <network/json.h>
+#include <logger/access_log.h>
+#include <filter/ssl.h>
+#include <filter/compress.h>
+#include <event2/event.h>
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <openssl/ssl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MICROBENCH_PORT
+#define MICROBENCH_PORT 0
+#endif
+
+namespace tcp_kit {
+
+    namespace microbench {
+
+        // 各个队列的入队/出队接口不一致, 以 queue_ops 统一. take 总是等到取得元素为止,
+        // 非阻塞的队列(lock_free_queue_nb / lock_free_stack)以自旋代替阻塞
+        template<typename Q>
+        struct queue_ops {
+            static Q& instance() { static Q q; return q; }
+            static void put(Q &q, uint64_t v) { q.push(v); }
+            static void take(Q &q) { while(!q.pop()); }
+        };
+
+        template<>
+        struct queue_ops<blocking_fifo<uint64_t>> {
+            static blocking_fifo<uint64_t>& instance() { static blocking_fifo<uint64_t> q(1024); return q; }
+            static void put(blocking_fifo<uint64_t> &q, uint64_t v) { q.push(v); }
+            static void take(blocking_fifo<uint64_t> &q) { benchmark::DoNotOptimize(q.pop()); }
+        };
+
+        // 每个线程先入队再出队, 队列中的元素不超过线程数, 阻塞队列的出队不会永久等待
+        template<typename Q>
+        void queue_push_pop(benchmark::State &state) {
+            Q &q = queue_ops<Q>::instance();
+            uint64_t v = 0;
+            for(auto _: state) {
+                queue_ops<Q>::put(q, ++v);
+                queue_ops<Q>::take(q);
+            }
+            state.SetItemsProcessed(state.iterations());
+        }
+
+        BENCHMARK_TEMPLATE(queue_push_pop, lock_free_queue<uint64_t>)->ThreadRange(1, 8)->UseRealTime();
+        BENCHMARK_TEMPLATE(queue_push_pop, lock_free_queue_nb<uint64_t>)->ThreadRange(1, 8)->UseRealTime();
+        BENCHMARK_TEMPLATE(queue_push_pop, blocking_fifo<uint64_t>)->ThreadRange(1, 8)->UseRealTime();
+        BENCHMARK_TEMPLATE(queue_push_pop, lock_free_stack<uint64_t>)->ThreadRange(1, 8)->UseRealTime();
+        BENCHMARK_TEMPLATE(queue_push_pop, lock_free_spsc_queue<uint64_t>)->Threads(1)->UseRealTime();
+
+        // 一个生产者与一个消费者(每个线程的迭代次数相同), 元素经过队列在线程间传递
+        template<typename Q>
+        void queue_handoff(benchmark::State &state) {
+            Q &q = queue_ops<Q>::instance();
+            bool producer = state.thread_index() == 0;
+            uint64_t v = 0;
+            for(auto _: state) {
+                if(producer)
+                    queue_ops<Q>::put(q, ++v);
+                else
+                    queue_ops<Q>::take(q);
+            }
+            state.SetItemsProcessed(state.iterations());
+        }
+
+        BENCHMARK_TEMPLATE(queue_handoff, lock_free_queue<uint64_t>)->Threads(2)->UseRealTime();
+        BENCHMARK_TEMPLATE(queue_handoff, lock_free_queue_nb<uint64_t>)->Threads(2)->UseRealTime();
+        BENCHMARK_TEMPLATE(queue_handoff, lock_free_spsc_queue<uint64_t>)->Threads(2)->UseRealTime();
+        BENCHMARK_TEMPLATE(queue_handoff, blocking_fifo<uint64_t>)->Threads(2)->UseRealTime();
+
+        // 线程池满时 execute 会丢弃任务(reject 为空实现), 因此限制未完成的任务数小于工作队列的容量
+        void thread_pool_execute(benchmark::State &state) {
+            const uint32_t n_threads = uint32_t(state.range(0));
+            const uint64_t window = 1024;
+            thread_pool pool(n_threads, n_threads, 1000, std::make_unique<blocking_fifo<runnable>>(window * 2));
+            std::atomic<uint64_t> completed(0);
+            uint64_t submitted = 0;
+            for(auto _: state) {
+                while(submitted - completed.load(std::memory_order_relaxed) >= window)
+                    std::this_thread::yield();
+                pool.execute([&completed] {
+                    completed.fetch_add(1, std::memory_order_relaxed);
+                });
+                ++submitted;
+            }
+            while(completed.load(std::memory_order_relaxed) != submitted)
+                std::this_thread::yield();
+            state.SetItemsProcessed(state.iterations());
+            pool.shutdown();
+            pool.await_termination();
+        }
+
+        BENCHMARK(thread_pool_execute)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+        GenericMsg make_msg(size_t payload) {
+            GenericMsg msg;
+            msg.set_api("echo");
+            msg.set_seq(1);
+            msg.add_params()->set_str(std::string(payload, 'x'));
+            return msg;
+        }
+
+        std::unique_ptr<GenericReply> make_reply(size_t payload) {
+            std::unique_ptr<GenericReply> reply(new GenericReply);
+            reply->set_code(GenericReply::SUCCESS);
+            reply->mutable_result()->set_str(std::string(payload, 'x'));
+            return reply;
+        }
+
+        // 与 ev_handler 一样把帧(不含 CRLF)拷贝到以 '\0' 结尾的缓冲区中
+        msg_buffer make_input(const std::string &frame) {
+            msg_buffer input(frame.size() + 1);
+            memcpy(input.ptr, frame.data(), frame.size());
+            input.ptr[frame.size()] = '\0';
+            input.size = frame.size();
+            return input;
+        }
+
+        template<typename Deserializer>
+        void deserialize(benchmark::State &state, const std::string &frame) {
+            msg_context ctx{};
+            for(auto _: state) {
+                msg_buffer input = make_input(frame);
+                benchmark::DoNotOptimize(Deserializer::process(&ctx, input));
+                free(input.ptr);
+            }
+            state.SetBytesProcessed(state.iterations() * frame.size());
+        }
+
+        template<typename Serializer>
+        void serialize(benchmark::State &state) {
+            msg_context ctx{};
+            ctx.seq = 1;
+            std::unique_ptr<GenericReply> prototype = make_reply(state.range(0));
+            size_t bytes = 0;
+            for(auto _: state) {
+                msg_buffer output = Serializer::process(&ctx, std::unique_ptr<GenericReply>(new GenericReply(*prototype)));
+                bytes += output.size;
+                free(output.ptr);
+            }
+            state.SetBytesProcessed(bytes);
+        }
+
+        void protobuf_deserializer(benchmark::State &state) {
+            std::string frame;
+            make_msg(state.range(0)).SerializeToString(&frame);
+            deserialize<generic::protobuf_deserializer>(state, frame);
+        }
+
+        void json_deserializer(benchmark::State &state) {
+            std::string frame = json::json_codec::encode(make_msg(state.range(0)));
+            frame.resize(frame.size() - 2);
+            deserialize<json::json_deserializer>(state, frame);
+        }
+
+        void protobuf_serializer(benchmark::State &state) {
+            serialize<generic::protobuf_serializer>(state);
+        }
+
+        void json_serializer(benchmark::State &state) {
+            serialize<json::json_serializer>(state);
+        }
+
+        BENCHMARK(protobuf_deserializer)->Arg(16)->Arg(256)->Arg(4096)->Arg(65536);
+        BENCHMARK(protobuf_serializer)->Arg(16)->Arg(256)->Arg(4096)->Arg(65536);
+        BENCHMARK(json_deserializer)->Arg(16)->Arg(256)->Arg(4096)->Arg(65536);
+        BENCHMARK(json_serializer)->Arg(16)->Arg(256)->Arg(4096)->Arg(65536);
+
+        using dispatcher = generic::api_dispatcher<MICROBENCH_PORT>;
+
+        // 注册 range(0) 个 api(包括 add), 每次迭代分发一个请求, 包含请求的拷贝(真实通路中由反序列化产生)
+        void register_apis(size_t n) {
+            dispatcher::api("add", [](int32_t a, int32_t b) {
+                return a + b;
+            });
+            for(size_t i = 1; i < n; ++i) {
+                dispatcher::api("api_" + std::to_string(i), [](int32_t a) {
+                    return a;
+                });
+            }
+        }
+
+        void api_dispatch(benchmark::State &state, const char *api) {
+            register_apis(size_t(state.range(0)));
+            GenericMsg prototype;
+            prototype.set_api(api);
+            prototype.set_seq(1);
+            prototype.add_params()->set_s32(1);
+            prototype.add_params()->set_s32(2);
+            msg_context ctx{};
+            for(auto _: state) {
+                ctx.reject_code = 0;
+                benchmark::DoNotOptimize(dispatcher::process(&ctx, std::unique_ptr<GenericMsg>(new GenericMsg(prototype))));
+            }
+            state.SetItemsProcessed(state.iterations());
+        }
+
+        void api_dispatcher_hit(benchmark::State &state) {
+            api_dispatch(state, "add");
+        }
+
+        void api_dispatcher_miss(benchmark::State &state) {
+            api_dispatch(state, "no_such_api");
+        }
+
+        BENCHMARK(api_dispatcher_hit)->Arg(1)->Arg(64)->Arg(1024);
+        BENCHMARK(api_dispatcher_miss)->Arg(1)->Arg(64)->Arg(1024);
+
+        // 4 个阶段的过滤器链(解析 -> 路由 -> 处理 -> 编码), 每个阶段只做很少的工作, 以比较调用链本身的开销:
+        // boxed 的各阶段以 unique_ptr 传递中间结果并经 filter_chain 中的函数指针调用, typed 的各阶段以值传递并经
+        // process_pipeline 直接调用
+        struct frame_header { uint64_t api; uint64_t seq; };
+        struct frame_request { uint64_t api; uint64_t seq; uint64_t arg; };
+        struct frame_reply { uint64_t seq; uint64_t result; };
+
+        uint64_t read_u64(const char *p) {
+            uint64_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        struct typed_parse {
+            static frame_header process(msg_context *ctx, msg_buffer input) {
+                return {read_u64(input.ptr), read_u64(input.ptr + 8)};
+            }
+        };
+
+        struct typed_route {
+            static frame_request process(msg_context *ctx, frame_header header) {
+                return {header.api, header.seq, header.api ^ header.seq};
+            }
+        };
+
+        struct typed_handle {
+            static frame_reply process(msg_context *ctx, frame_request request) {
+                return {request.seq, request.arg * 31 + 7};
+            }
+        };
+
+        struct typed_encode {
+            static msg_buffer process(msg_context *ctx, frame_reply reply) {
+                msg_buffer output(sizeof(reply));
+                memcpy(output.ptr, &reply, sizeof(reply));
+                return output;
+            }
+        };
+
+        struct boxed_parse {
+            static std::unique_ptr<frame_header> process(msg_context *ctx, std::unique_ptr<msg_buffer> input) {
+                return std::unique_ptr<frame_header>(new frame_header(typed_parse::process(ctx, *input)));
+            }
+        };
+
+        struct boxed_route {
+            static std::unique_ptr<frame_request> process(msg_context *ctx, std::unique_ptr<frame_header> header) {
+                return std::unique_ptr<frame_request>(new frame_request(typed_route::process(ctx, *header)));
+            }
+        };
+
+        struct boxed_handle {
+            static std::unique_ptr<frame_reply> process(msg_context *ctx, std::unique_ptr<frame_request> request) {
+                return std::unique_ptr<frame_reply>(new frame_reply(typed_handle::process(ctx, *request)));
+            }
+        };
+
+        struct boxed_encode {
+            static std::unique_ptr<msg_buffer> process(msg_context *ctx, std::unique_ptr<frame_reply> reply) {
+                return std::unique_ptr<msg_buffer>(new msg_buffer(typed_encode::process(ctx, *reply)));
+            }
+        };
+
+        void process_chain_boxed(benchmark::State &state) {
+            process_chain chain = make_process_chain(type_list<boxed_parse, boxed_route, boxed_handle, boxed_encode>{});
+            msg_buffer input = make_input(std::string(16, 'x'));
+            msg_context ctx{};
+            for(auto _: state) {
+                // 与 handler 原来的做法一样, 为输入分配一个 msg_buffer
+                std::unique_ptr<msg_buffer> output = chain(&ctx, buffer_arg<std::unique_ptr<msg_buffer>>::from(input));
+                benchmark::DoNotOptimize(output->ptr);
+                free(output->ptr);
+            }
+            free(input.ptr);
+            state.SetItemsProcessed(state.iterations());
+        }
+
+        void process_chain_typed(benchmark::State &state) {
+            using pipeline = process_pipeline<type_list<typed_parse, typed_route, typed_handle, typed_encode>>;
+            msg_buffer input = make_input(std::string(16, 'x'));
+            msg_context ctx{};
+            for(auto _: state) {
+                msg_buffer output = pipeline::call(&ctx, input);
+                benchmark::DoNotOptimize(output.ptr);
+                free(output.ptr);
+            }
+            free(input.ptr);
+            state.SetItemsProcessed(state.iterations());
+        }
+
+        BENCHMARK(process_chain_boxed);
+        BENCHMARK(process_chain_typed);
+
+        // 原样移动数据的读写过滤器
+        struct pass_through {
+            static bufferevent_filter_result read(evbuffer *src, evbuffer *dst, ev_ssize_t, bufferevent_flush_mode, ev_context*) {
+                evbuffer_add_buffer(dst, src);
+                return BEV_OK;
+            }
+            static bufferevent_filter_result write(evbuffer *src, evbuffer *dst, ev_ssize_t, bufferevent_flush_mode, ev_context*) {
+                evbuffer_add_buffer(dst, src);
+                return BEV_OK;
+            }
+        };
+
+        // 原来的做法: 每个过滤器嵌套一层 bufferevent_filter
+        bufferevent* nest_filters(bufferevent *bev, const std::vector<bufferevent_filter_cb> &reads,
+                                  const std::vector<bufferevent_filter_cb> &writes) {
+            for(size_t i = 0; i < reads.size(); ++i)
+                bev = bufferevent_filter_new(bev, reads[i], writes[i], BEV_OPT_CLOSE_ON_FREE, nullptr, nullptr);
+            return bev;
+        }
+
+        // 在一对 bufferevent 上经过 N 个过滤器读入并写出 64 字节
+        template<bool Nested>
+        void rw_filters(benchmark::State &state) {
+            size_t n = size_t(state.range(0));
+            std::vector<bufferevent_filter_cb> reads(n, &catchable_read<pass_through>);
+            std::vector<bufferevent_filter_cb> writes(n, &catchable_write<pass_through>);
+            event_base *base = event_base_new();
+            bufferevent *pair[2];
+            bufferevent_pair_new(base, BEV_OPT_CLOSE_ON_FREE, pair);
+            bufferevent *bev = Nested ? nest_filters(pair[0], reads, writes) : rw_pipeline::attach(pair[0], reads, writes, nullptr);
+            bufferevent_enable(bev, EV_READ | EV_WRITE);
+            bufferevent_enable(pair[1], EV_READ | EV_WRITE);
+            char payload[64] = {0}, out[64];
+            for(auto _: state) {
+                bufferevent_write(pair[1], payload, sizeof(payload));
+                bufferevent_write(bev, payload, sizeof(payload));
+                event_base_loop(base, EVLOOP_NONBLOCK);
+                if(bufferevent_read(bev, out, sizeof(out)) != sizeof(out) ||
+                   bufferevent_read(pair[1], out, sizeof(out)) != sizeof(out)) {
+                    state.SkipWithError("The payload did not pass through the filters");
+                    break;
+                }
+            }
+            bufferevent_free(bev);
+            bufferevent_free(pair[1]);
+            event_base_free(base);
+            state.SetItemsProcessed(state.iterations());
+        }
+
+        BENCHMARK_TEMPLATE(rw_filters, true)->Name("rw_filters_nested")->Arg(0)->Arg(1)->Arg(3)->Arg(5);
+        BENCHMARK_TEMPLATE(rw_filters, false)->Name("rw_filters_pipeline")->Arg(0)->Arg(1)->Arg(3)->Arg(5);
+
+        // 访问日志的一次记录, 包括成批写入 mmap 映射的段与段写满后换用新段的开销. 时间由调用方给出, 不计读时钟
+        void access_log_append(benchmark::State &state) {
+            char dir[] = "/tmp/tcp_kit_microbench_XXXXXX";
+            if(!mkdtemp(dir)) {
+                state.SkipWithError("Cannot create the directory of the access log");
+                return;
+            }
+            access_log::enable(dir, 16 * 1024 * 1024);
+            std::string api = "echo";
+            uint64_t seq = 0;
+            auto now = std::chrono::steady_clock::now();
+            for(auto _: state)
+                access_log::log_request(now, 1, &api, ++seq, 1000, 64, 64, GenericReply::SUCCESS);
+            access_log::disable();
+            access_log::flush();
+            state.SetItemsProcessed(state.iterations());
+            system((std::string("rm -rf ") + dir).c_str());
+        }
+
+        BENCHMARK(access_log_append);
+
+        // 以自签名证书配置服务端的 SSL_CTX, 返回与之握手的客户端 SSL_CTX
+        SSL_CTX* tls_client_ctx() {
+            static SSL_CTX *client = [] {
+                filters::tls_options opts;
+                opts.cert_file = "/tmp/tcp_kit_microbench_cert.pem";
+                opts.key_file = "/tmp/tcp_kit_microbench_key.pem";
+                filters::write_self_signed(opts.cert_file, opts.key_file);
+                filters::tls_context::configure(opts);
+                SSL_CTX *c = SSL_CTX_new(TLS_client_method());
+                SSL_CTX_set_session_cache_mode(c, SSL_SESS_CACHE_CLIENT);
+                return c;
+            }();
+            return client;
+        }
+
+        // 客户端与服务端以一对内存 BIO 相连, 不经过 socket
+        struct tls_pair {
+            SSL *client;
+            SSL *server;
+
+            tls_pair(SSL_SESSION *session): client(SSL_new(tls_client_ctx())), server(SSL_new(filters::tls_context::get())) {
+                BIO *c, *s;
+                BIO_new_bio_pair(&c, 64 * 1024, &s, 64 * 1024);
+                SSL_set_bio(client, c, c);
+                SSL_set_bio(server, s, s);
+                SSL_set_connect_state(client);
+                SSL_set_accept_state(server);
+                if(session)
+                    SSL_set_session(client, session);
+            }
+
+            // 未经 close_notify 就释放的连接, 客户端会把它的会话标记为不可恢复
+            ~tls_pair() {
+                SSL_shutdown(client);
+                SSL_shutdown(server);
+                SSL_free(client);
+                SSL_free(server);
+            }
+
+            bool handshake() {
+                for(int i = 0; i < 16; ++i) {
+                    int c = SSL_do_handshake(client);
+                    int s = SSL_do_handshake(server);
+                    if(c == 1 && s == 1) {
+                        // 让客户端处理服务端在握手后发送的会话票据
+                        char b;
+                        SSL_read(client, &b, 1);
+                        return true;
+                    }
+                }
+                return false;
+            }
+        };
+
+        // 一次完整的 TLS 1.3 握手(ECDHE + 证书签名), 或以会话票据恢复的握手
+        template<bool Resume>
+        void tls_handshake(benchmark::State &state) {
+            tls_client_ctx();
+            SSL_SESSION *session = nullptr;
+            if(Resume) {
+                tls_pair first(nullptr);
+                if(!first.handshake()) {
+                    state.SkipWithError("The TLS handshake failed");
+                    return;
+                }
+                session = SSL_get1_session(first.client);
+            }
+            for(auto _: state) {
+                tls_pair p(session);
+                if(!p.handshake() || bool(SSL_session_reused(p.client)) != Resume) {
+                    state.SkipWithError("The TLS handshake failed");
+                    break;
+                }
+                // TLS 1.3 的客户端每张票据只使用一次, 换用这次连接收到的票据
+                if(Resume) {
+                    SSL_SESSION_free(session);
+                    session = SSL_get1_session(p.client);
+                }
+            }
+            if(session)
+                SSL_SESSION_free(session);
+            state.SetItemsProcessed(state.iterations());
+        }
+
+        BENCHMARK_TEMPLATE(tls_handshake, false)->Name("tls_handshake_full");
+        BENCHMARK_TEMPLATE(tls_handshake, true)->Name("tls_handshake_resumed");
+
+        // 已建立的连接上加密写出并解密读入一条 N 字节的消息, 即内核 TLS 不可用时 OpenSSL 在用户态的记录层开销
+        void tls_throughput(benchmark::State &state) {
+            tls_client_ctx();
+            tls_pair p(nullptr);
+            if(!p.handshake()) {
+                state.SkipWithError("The TLS handshake failed");
+                return;
+            }
+            std::vector<char> payload(size_t(state.range(0)), 'x'), out(payload.size());
+            for(auto _: state) {
+                size_t n = 0;
+                if(SSL_write(p.server, payload.data(), int(payload.size())) != int(payload.size())) {
+                    state.SkipWithError("SSL_write failed");
+                    break;
+                }
+                int r;
+                while(n < out.size() && (r = SSL_read(p.client, out.data() + n, int(out.size() - n))) > 0)
+                    n += size_t(r);
+                if(n != out.size()) {
+                    state.SkipWithError("SSL_read failed");
+                    break;
+                }
+            }
+            state.SetBytesProcessed(state.iterations() * state.range(0));
+        }
+
+        BENCHMARK(tls_throughput)->Arg(64)->Arg(1024)->Arg(16 * 1024);
+
+        // 压缩过滤器在一个连接上编码并解码 N 字节的 JSON 回复(字段相同、值各不相同), wire_ratio 为编码后与明文的字节数之比
+        void compress_stream(benchmark::State &state) {
+            uint8_t codec = uint8_t(state.range(0));
+            if(codec && !(filters::supported_codecs() & codec)) {
+                state.SkipWithError("The codec is not compiled in");
+                return;
+            }
+            filters::block_encoder encoder(codec);
+            filters::block_decoder decoder;
+            std::vector<std::string> payloads(256);
+            for(size_t k = 0; k < payloads.size(); ++k) {
+                std::string &p = payloads[k];
+                p = "[";
+                for(uint32_t i = 0; p.size() < size_t(state.range(1)); ++i)
+                    p += "{\"id\":" + std::to_string((k * 7919 + i) * 104729 % 1000003) + ",\"name\":\"user" +
+                         std::to_string(i * 31 + k) + "\",\"status\":\"" + (i % 3 ? "active" : "idle") + "\"},";
+                p.resize(size_t(state.range(1)));
+            }
+            evbuffer *plain = evbuffer_new(), *encoded = evbuffer_new(), *decoded = evbuffer_new();
+            size_t wire = 0, k = 0;
+            for(auto _: state) {
+                const std::string &payload = payloads[k++ % payloads.size()];
+                evbuffer_add(plain, payload.data(), payload.size());
+                encoder.encode(plain, encoded);
+                wire += evbuffer_get_length(encoded);
+                decoder.decode(encoded, decoded);
+                evbuffer_drain(decoded, evbuffer_get_length(decoded));
+            }
+            evbuffer_free(plain);
+            evbuffer_free(encoded);
+            evbuffer_free(decoded);
+            state.SetBytesProcessed(state.iterations() * state.range(1));
+            state.counters["wire_ratio"] = double(wire) / double(state.iterations() * state.range(1));
+        }
+
+        BENCHMARK(compress_stream)->ArgNames({"codec", "bytes"})
+            ->ArgsProduct({{filters::CODEC_RAW, filters::CODEC_LZ4, filters::CODEC_ZSTD}, {64, 1024, 16 * 1024}});
+
+    }
+
+}
+
+BENCHMARK_MAIN();
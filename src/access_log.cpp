@@ -0,0 +1,193 @@
+#include <logger/access_log.h>
+#include <logger/logger.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+namespace tcp_kit {
+
+    namespace access_log {
+
+        std::atomic<bool> _enabled {false};
+
+        namespace {
+
+            std::mutex             config_mutex;    // 保护 config_dir 与 config_size
+            std::string            config_dir;
+            size_t                 config_size = ACCESS_LOG_SEGMENT_SIZE;
+            std::atomic<uint32_t>  generation {0};  // 每次启用或停止时递增, 各线程据此换用新的段
+            std::atomic<uint32_t>  next_writer {0};
+            std::atomic<int64_t>   wall_offset {0}; // 墙上时钟减去单调时钟(纳秒), 启用时取得
+
+            uint64_t wall_ns() {
+                timespec ts;
+                clock_gettime(CLOCK_REALTIME, &ts);
+                return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+            }
+
+            // 预先以写方式映射即将写入的页, 避免逐页的缺页中断
+            void populate(char *addr, size_t len) {
+#ifdef MADV_POPULATE_WRITE
+                uintptr_t page = uintptr_t(sysconf(_SC_PAGESIZE));
+                uintptr_t begin = uintptr_t(addr) & ~(page - 1);
+                madvise(reinterpret_cast<void*>(begin), uintptr_t(addr) + len - begin, MADV_POPULATE_WRITE);
+#endif
+            }
+
+            struct segment_writer {
+                int      fd         = -1;
+                char    *base       = nullptr;
+                size_t   size       = 0;
+                size_t   offset     = 0;
+                uint32_t generation = 0;
+                uint32_t writer     = UINT32_MAX;
+                uint32_t index      = 0;
+                bool     failed     = false;    // 该代的段无法打开, 丢弃记录而不再尝试
+                uint32_t buffered   = 0;
+                record   buffer[ACCESS_LOG_BUFFER_RECORDS];
+
+                ~segment_writer() {
+                    spill();
+                    close();
+                }
+
+                bool open() {
+                    std::string dir;
+                    {
+                        std::lock_guard<std::mutex> lock(config_mutex);
+                        dir = config_dir;
+                        size = std::max(config_size, sizeof(segment_header) + sizeof(record));
+                    }
+                    if(writer == UINT32_MAX)
+                        writer = next_writer.fetch_add(1, std::memory_order_relaxed);
+                    std::string path = dir + "/access-" + std::to_string(getpid()) + "-" + std::to_string(writer)
+                                       + "-" + std::to_string(index++) + ".seg";
+                    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                    bool allocated = fd >= 0 &&
+#ifdef __linux__
+                                     posix_fallocate(fd, 0, off_t(size)) == 0;
+#else
+                                     ftruncate(fd, off_t(size)) == 0;
+#endif
+                    void *p = allocated ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+                    if(p == MAP_FAILED) {
+                        log_error("Cannot open the access log segment %s", path.c_str());
+                        if(fd >= 0) ::close(fd);
+                        fd = -1;
+                        return false;
+                    }
+                    base = static_cast<char*>(p);
+                    segment_header header{};
+                    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+                    header.version = VERSION;
+                    header.record_size = sizeof(record);
+                    header.created_ns = wall_ns();
+                    header.pid = uint32_t(getpid());
+                    header.writer = writer;
+                    header.index = index - 1;
+                    memcpy(base, &header, sizeof(header));
+                    offset = sizeof(header);
+                    return true;
+                }
+
+                // 截去预分配而未写入的部分
+                void close() {
+                    if(!base)
+                        return;
+                    munmap(base, size);
+                    if(ftruncate(fd, off_t(offset)) != 0)
+                        log_warn("Cannot truncate the access log segment");
+                    ::close(fd);
+                    base = nullptr;
+                    fd = -1;
+                }
+
+                // 将缓冲的记录写入段, 段写满时换用新的段
+                void spill() {
+                    uint32_t done = 0;
+                    while(done < buffered && !failed) {
+                        if(!base || offset + sizeof(record) > size) {
+                            close();
+                            failed = !open();
+                            continue;
+                        }
+                        size_t n = std::min<size_t>(buffered - done, (size - offset) / sizeof(record));
+                        populate(base + offset, n * sizeof(record));
+                        memcpy(base + offset, buffer + done, n * sizeof(record));
+                        offset += n * sizeof(record);
+                        done += uint32_t(n);
+                    }
+                    buffered = 0;
+                }
+
+                // 启用或停止之后, 此前缓冲的记录写入原来的段, 再关闭它
+                void sync(uint32_t gen) {
+                    if(generation == gen)
+                        return;
+                    spill();
+                    close();
+                    generation = gen;
+                    failed = false;
+                }
+            };
+
+            // 只在记录过的线程中分配
+            thread_local std::unique_ptr<segment_writer> local;
+
+        }
+
+        void enable(const std::string &dir, size_t segment_size) {
+            {
+                std::lock_guard<std::mutex> lock(config_mutex);
+                config_dir = dir;
+                config_size = segment_size;
+            }
+            wall_offset.store(int64_t(wall_ns()) - std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+            generation.fetch_add(1, std::memory_order_release);
+            _enabled.store(true, std::memory_order_release);
+        }
+
+        void disable() {
+            _enabled.store(false, std::memory_order_release);
+            generation.fetch_add(1, std::memory_order_release);
+        }
+
+        void flush() {
+            if(!local)
+                return;
+            local->sync(generation.load(std::memory_order_acquire));
+            local->spill();
+        }
+
+        void append(std::chrono::steady_clock::time_point at, uint64_t conn_id, const std::string *api, uint64_t seq,
+                    uint64_t latency_ns, uint32_t bytes_in, uint32_t bytes_out, uint16_t code) {
+            if(!local)
+                local.reset(new segment_writer);
+            segment_writer &w = *local;
+            w.sync(generation.load(std::memory_order_acquire));
+            if(w.failed)
+                return;
+            record &r = w.buffer[w.buffered];
+            r.time_ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(at.time_since_epoch()).count()
+                                 + wall_offset.load(std::memory_order_relaxed));
+            r.conn_id = conn_id;
+            r.latency_ns = latency_ns;
+            r.seq = seq;
+            r.bytes_in = bytes_in;
+            r.bytes_out = bytes_out;
+            r.code = code;
+            size_t n = api ? std::min(api->size(), sizeof(r.api)) : 0;
+            memcpy(r.api, api ? api->data() : "", n);
+            memset(r.api + n, 0, sizeof(r.api) - n);
+            if(++w.buffered == ACCESS_LOG_BUFFER_RECORDS)
+                w.spill();
+        }
+
+    }
+
+}
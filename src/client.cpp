@@ -0,0 +1,176 @@
+#include <network/client.h>
+#include <logger/logger.h>
+#include <event2/buffer.h>
+#include <event2/thread.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace tcp_kit {
+
+    client_base::client_base(const std::string &address, uint32_t n_conns, decoder_t decode):
+            _addr_len(sizeof(_addr)), _decode(decode), _seq(0), _n_pending(0) {
+        memset(&_addr, 0, sizeof(_addr));
+        if(evutil_parse_sockaddr_port(address.c_str(), reinterpret_cast<sockaddr *>(&_addr), &_addr_len) != 0)
+            throw generic_error<ILLEGALITY_ARGS>("Invalid server address [%s]", address.c_str());
+        evthread_use_pthreads();
+        _ev_base = event_base_new();
+        _submit_ev = event_new(_ev_base, -1, 0, submit_callback, this);
+        if(!_ev_base || !_submit_ev)
+            throw generic_error<CONS_EVENT_FAILED>("Failed to construct the client event loop");
+        for(uint32_t i = 0; i < (n_conns ? n_conns : 1); ++i)
+            _conns.emplace_back(new connection{this, nullptr, {}, {}});
+        _loop = std::thread([this] {
+            event_base_loop(_ev_base, EVLOOP_NO_EXIT_ON_EMPTY);
+        });
+    }
+
+    // 停止事件循环后在当前线程中以失败回调所有未完成的请求
+    client_base::~client_base() {
+        event_base_loopbreak(_ev_base);
+        _loop.join();
+        submission *sub = _submissions.pop_all();
+        while(sub) {
+            submission *next = sub->next;
+            for(request &req: sub->requests)
+                fail(req, "Client closed");
+            delete sub;
+            sub = next;
+        }
+        for(auto &conn: _conns)
+            close(conn.get(), "Client closed");
+        event_free(_submit_ev);
+        event_base_free(_ev_base);
+    }
+
+    void client_base::on_push(reply_callback callback) {
+        _on_push = std::move(callback);
+    }
+
+    size_t client_base::n_pending() const {
+        return _n_pending.load(std::memory_order_relaxed);
+    }
+
+    uint64_t client_base::next_seq() {
+        return _seq.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    void client_base::submit(submission *sub) {
+        if(_submissions.push(sub))
+            event_active(_submit_ev, 0, 0);
+    }
+
+    void client_base::submit_callback(evutil_socket_t, short, void *arg) {
+        auto *client_ = static_cast<client_base *>(arg);
+        submission *sub = client_->_submissions.pop_all();
+        while(sub) {
+            submission *next = sub->next;
+            connection *conn = client_->pick();
+            for(request &req: sub->requests) {
+                if(!conn) {
+                    client_->fail(req, "Unable to connect to the server");
+                    continue;
+                }
+                // 输出缓冲只在本轮事件循环结束后写出, 同一轮提交的请求合并为一次写
+                bufferevent_write(conn->bev, req.frame.data(), req.frame.size());
+                conn->pending.emplace(req.seq, std::move(req.on_reply));
+                client_->_n_pending.fetch_add(1, std::memory_order_relaxed);
+            }
+            delete sub;
+            sub = next;
+        }
+    }
+
+    // 选择待回复请求最少的连接, 断开的连接在重连间隔之后重新建立
+    client_base::connection *client_base::pick() {
+        connection *best = nullptr;
+        auto now = std::chrono::steady_clock::now();
+        for(auto &conn: _conns) {
+            if(!conn->bev && now - conn->closed_at >= std::chrono::milliseconds(CLIENT_RECONNECT_MS))
+                open(conn.get());
+            if(conn->bev && (!best || conn->pending.size() < best->pending.size()))
+                best = conn.get();
+        }
+        return best;
+    }
+
+    bool client_base::open(connection *conn) {
+        conn->bev = bufferevent_socket_new(_ev_base, -1, BEV_OPT_CLOSE_ON_FREE);
+        if(!conn->bev)
+            return false;
+        bufferevent_setcb(conn->bev, read_callback, nullptr, event_callback, conn);
+        bufferevent_enable(conn->bev, EV_READ | EV_WRITE);
+        if(bufferevent_socket_connect(conn->bev, reinterpret_cast<sockaddr *>(&_addr), _addr_len) != 0) {
+            bufferevent_free(conn->bev);
+            conn->bev = nullptr;
+            conn->closed_at = std::chrono::steady_clock::now();
+            return false;
+        }
+        return true;
+    }
+
+    void client_base::close(connection *conn, const std::string &reason) {
+        if(conn->bev) {
+            bufferevent_free(conn->bev);
+            conn->bev = nullptr;
+        }
+        conn->closed_at = std::chrono::steady_clock::now();
+        std::map<uint64_t, reply_callback> pending;
+        pending.swap(conn->pending);
+        _n_pending.fetch_sub(pending.size(), std::memory_order_relaxed);
+        for(auto &p: pending) {
+            request req{p.first, std::string(), std::move(p.second)};
+            fail(req, reason);
+        }
+    }
+
+    void client_base::fail(request &req, const std::string &reason) {
+        std::unique_ptr<GenericReply> reply(new GenericReply);
+        reply->set_code(GenericReply::UNKNOWN_ERR);
+        reply->set_msg(reason);
+        reply->set_seq(req.seq);
+        req.on_reply(std::move(reply));
+    }
+
+    void client_base::read_callback(bufferevent *bev, void *arg) {
+        auto *conn = static_cast<connection *>(arg);
+        evbuffer *input = bufferevent_get_input(bev);
+        char *line;
+        size_t len;
+        while((line = evbuffer_readln(input, &len, EVBUFFER_EOL_CRLF))) {
+            std::unique_ptr<GenericReply> reply(new GenericReply);
+            bool decoded = conn->owner->_decode(line, len, *reply);
+            free(line);
+            if(!decoded) {
+                log_error("Unable to parse the reply, closing the connection");
+                conn->owner->close(conn, "Malformed reply");
+                return;
+            }
+            conn->owner->dispatch(conn, std::move(reply));
+        }
+    }
+
+    // 没有 seq 的 OVERLOADED 回复来自服务端在没有处理中的请求时的直接拒绝, 此时它对应的一定是最早的待回复请求
+    void client_base::dispatch(connection *conn, std::unique_ptr<GenericReply> reply) {
+        auto it = conn->pending.end();
+        if(reply->seq())
+            it = conn->pending.find(reply->seq());
+        else if(!reply->has_topic() && reply->code() == GenericReply::OVERLOADED)
+            it = conn->pending.begin();
+        if(it == conn->pending.end()) {
+            if(_on_push)
+                _on_push(std::move(reply));
+            return;
+        }
+        reply_callback on_reply = std::move(it->second);
+        conn->pending.erase(it);
+        _n_pending.fetch_sub(1, std::memory_order_relaxed);
+        on_reply(std::move(reply));
+    }
+
+    void client_base::event_callback(bufferevent *bev, short what, void *arg) {
+        auto *conn = static_cast<connection *>(arg);
+        if(what & (BEV_EVENT_EOF | BEV_EVENT_ERROR))
+            conn->owner->close(conn, what & BEV_EVENT_EOF ? "Connection closed by the server" : "Connection error");
+    }
+
+}
@@ -0,0 +1,447 @@
+#include <filter/compress.h>
+#include <error/errors.h>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#if TCP_KIT_LZ4
+#include <lz4frame.h>
+#endif
+#if TCP_KIT_ZSTD
+#include <zstd.h>
+#endif
+
+namespace tcp_kit {
+
+    namespace filters {
+
+        static_assert(COMPRESS_BLOCK_SIZE > 0 && COMPRESS_BLOCK_SIZE <= (1 << 22),
+                      "The length of a block must fit in its 3-byte header");
+
+        namespace {
+
+            const size_t HEADER_SIZE = 4;
+
+            // 压缩后的块比明文略大的上限, 超过的块视为非法
+            const size_t MAX_BLOCK = COMPRESS_BLOCK_SIZE * 2;
+
+            void put_header(unsigned char *header, uint8_t codec, size_t len) {
+                header[0] = codec;
+                header[1] = uint8_t(len);
+                header[2] = uint8_t(len >> 8);
+                header[3] = uint8_t(len >> 16);
+            }
+
+            // 各种上下文的创建、重置与释放
+            template<typename Ctx>
+            struct ctx_ops;
+
+#if TCP_KIT_LZ4
+            // 以链接的块(块可以引用前 64KB 的数据)组成一个贯穿整个连接的帧, 每次写出都立即刷新
+            const LZ4F_preferences_t lz4_prefs = {
+                {LZ4F_max64KB, LZ4F_blockLinked, LZ4F_noContentChecksum, LZ4F_frame, 0, 0, LZ4F_noBlockChecksum},
+                0, 1, 0, {0, 0, 0}
+            };
+
+            template<>
+            struct ctx_ops<LZ4F_cctx> {
+                static LZ4F_cctx* create() {
+                    LZ4F_cctx *c = nullptr;
+                    return LZ4F_isError(LZ4F_createCompressionContext(&c, LZ4F_VERSION)) ? nullptr : c;
+                }
+                // 复用时以 LZ4F_compressBegin 开始新的帧, 不需要重置
+                static void reset(LZ4F_cctx *c) { }
+                static void destroy(LZ4F_cctx *c) { LZ4F_freeCompressionContext(c); }
+            };
+
+            template<>
+            struct ctx_ops<LZ4F_dctx> {
+                static LZ4F_dctx* create() {
+                    LZ4F_dctx *d = nullptr;
+                    return LZ4F_isError(LZ4F_createDecompressionContext(&d, LZ4F_VERSION)) ? nullptr : d;
+                }
+                static void reset(LZ4F_dctx *d) { LZ4F_resetDecompressionContext(d); }
+                static void destroy(LZ4F_dctx *d) { LZ4F_freeDecompressionContext(d); }
+            };
+#endif
+
+#if TCP_KIT_ZSTD
+            template<>
+            struct ctx_ops<ZSTD_CCtx> {
+                static ZSTD_CCtx* create() {
+                    ZSTD_CCtx *c = ZSTD_createCCtx();
+                    if(c && (ZSTD_isError(ZSTD_CCtx_setParameter(c, ZSTD_c_compressionLevel, COMPRESS_ZSTD_LEVEL)) ||
+                             ZSTD_isError(ZSTD_CCtx_setParameter(c, ZSTD_c_windowLog, COMPRESS_ZSTD_WINDOW_LOG)))) {
+                        ZSTD_freeCCtx(c);
+                        return nullptr;
+                    }
+                    return c;
+                }
+                // 只重置会话, 保留参数
+                static void reset(ZSTD_CCtx *c) { ZSTD_CCtx_reset(c, ZSTD_reset_session_only); }
+                static void destroy(ZSTD_CCtx *c) { ZSTD_freeCCtx(c); }
+            };
+
+            template<>
+            struct ctx_ops<ZSTD_DCtx> {
+                static ZSTD_DCtx* create() {
+                    ZSTD_DCtx *d = ZSTD_createDCtx();
+                    if(d && ZSTD_isError(ZSTD_DCtx_setParameter(d, ZSTD_d_windowLogMax, COMPRESS_ZSTD_WINDOW_LOG_MAX))) {
+                        ZSTD_freeDCtx(d);
+                        return nullptr;
+                    }
+                    return d;
+                }
+                static void reset(ZSTD_DCtx *d) { ZSTD_DCtx_reset(d, ZSTD_reset_session_only); }
+                static void destroy(ZSTD_DCtx *d) { ZSTD_freeDCtx(d); }
+            };
+#endif
+
+            // 一个线程的空闲上下文. 上下文(尤其是 zstd 的窗口)占用数百 KB, 连接频繁建立与关闭时不再反复分配
+            template<typename Ctx>
+            struct ctx_pool {
+                std::vector<Ctx*> idle;
+
+                Ctx* acquire() {
+                    if(!idle.empty()) {
+                        Ctx *c = idle.back();
+                        idle.pop_back();
+                        return c;
+                    }
+                    Ctx *c = ctx_ops<Ctx>::create();
+                    if(!c)
+                        throw generic_error<COMPRESS_FAILED>("Failed to create the compression context");
+                    return c;
+                }
+
+                void release(Ctx *c) {
+                    if(idle.size() < COMPRESS_POOL_SIZE) {
+                        ctx_ops<Ctx>::reset(c);
+                        idle.push_back(c);
+                    } else {
+                        ctx_ops<Ctx>::destroy(c);
+                    }
+                }
+
+                ~ctx_pool() {
+                    for(Ctx *c : idle)
+                        ctx_ops<Ctx>::destroy(c);
+                }
+            };
+
+            struct thread_state {
+#if TCP_KIT_LZ4
+                ctx_pool<LZ4F_cctx> lz4_c;
+                ctx_pool<LZ4F_dctx> lz4_d;
+#endif
+#if TCP_KIT_ZSTD
+                ctx_pool<ZSTD_CCtx> zstd_c;
+                ctx_pool<ZSTD_DCtx> zstd_d;
+#endif
+                // 声明在池之后, 先于池析构, 其中的上下文得以回到池中
+                std::unordered_map<uint64_t, std::unique_ptr<compress_session>> sessions;
+            };
+
+            thread_state& local() {
+                static thread_local thread_state state;
+                return state;
+            }
+
+            template<typename Ctx>
+            ctx_pool<Ctx>& pool_of();
+
+#if TCP_KIT_LZ4
+            template<> ctx_pool<LZ4F_cctx>& pool_of() { return local().lz4_c; }
+            template<> ctx_pool<LZ4F_dctx>& pool_of() { return local().lz4_d; }
+#endif
+#if TCP_KIT_ZSTD
+            template<> ctx_pool<ZSTD_CCtx>& pool_of() { return local().zstd_c; }
+            template<> ctx_pool<ZSTD_DCtx>& pool_of() { return local().zstd_d; }
+#endif
+
+        }
+
+        uint8_t supported_codecs() {
+            uint8_t codecs = 0;
+#if TCP_KIT_LZ4
+            codecs |= CODEC_LZ4;
+#endif
+#if TCP_KIT_ZSTD
+            codecs |= CODEC_ZSTD;
+#endif
+            return codecs;
+        }
+
+        uint8_t choose_codec(uint8_t peer_codecs) {
+            uint8_t common = peer_codecs & supported_codecs();
+            if(common & COMPRESS_PREFERRED)
+                return COMPRESS_PREFERRED;
+            if(common & CODEC_ZSTD)
+                return CODEC_ZSTD;
+            if(common & CODEC_LZ4)
+                return CODEC_LZ4;
+            return CODEC_RAW;
+        }
+
+        // -------------------------------------------------------------------------------------------------------------
+
+        block_encoder::block_encoder(uint8_t codec): _codec(CODEC_RAW), _cctx(nullptr), _begun(false) {
+            use(codec);
+        }
+
+        block_encoder::~block_encoder() {
+#if TCP_KIT_LZ4
+            if(_codec == CODEC_LZ4)
+                pool_of<LZ4F_cctx>().release(static_cast<LZ4F_cctx *>(_cctx));
+#endif
+#if TCP_KIT_ZSTD
+            if(_codec == CODEC_ZSTD)
+                pool_of<ZSTD_CCtx>().release(static_cast<ZSTD_CCtx *>(_cctx));
+#endif
+        }
+
+        void block_encoder::use(uint8_t codec) {
+            if(codec == _codec)
+                return;
+            if(_codec != CODEC_RAW || !(codec & supported_codecs()))
+                throw generic_error<COMPRESS_FAILED>("Cannot switch the encoder from codec %d to %d", _codec, codec);
+#if TCP_KIT_LZ4
+            if(codec == CODEC_LZ4)
+                _cctx = pool_of<LZ4F_cctx>().acquire();
+#endif
+#if TCP_KIT_ZSTD
+            if(codec == CODEC_ZSTD)
+                _cctx = pool_of<ZSTD_CCtx>().acquire();
+#endif
+            _codec = codec;
+        }
+
+        uint8_t block_encoder::codec() const {
+            return _codec;
+        }
+
+        void block_encoder::encode(evbuffer *src, evbuffer *dst) {
+            size_t len = evbuffer_get_length(src);
+            bool raw = _codec == CODEC_RAW || len < COMPRESS_MIN_SIZE;
+            while(len > 0) {
+                size_t n = std::min(len, size_t(COMPRESS_BLOCK_SIZE));
+                if(raw) {
+                    unsigned char header[HEADER_SIZE];
+                    put_header(header, CODEC_RAW, n);
+                    evbuffer_add(dst, header, HEADER_SIZE);
+                    evbuffer_remove_buffer(src, dst, n);
+                } else {
+                    compress(src, n, dst);
+                }
+                len -= n;
+            }
+        }
+
+        // 将 src 的前 n 字节压缩为一个块并刷新, 对端收到这个块即可解压出全部 n 字节
+        void block_encoder::compress(evbuffer *src, size_t n, evbuffer *dst) {
+            size_t bound = 0;
+#if TCP_KIT_LZ4
+            if(_codec == CODEC_LZ4)
+                bound = LZ4F_HEADER_SIZE_MAX + LZ4F_compressBound(n, &lz4_prefs);
+#endif
+#if TCP_KIT_ZSTD
+            if(_codec == CODEC_ZSTD)
+                bound = ZSTD_compressBound(n) + 64;
+#endif
+            // 消息通常只占一个 chain, 此时 pullup 不拷贝
+            const unsigned char *in = evbuffer_pullup(src, ev_ssize_t(n));
+            evbuffer_iovec out;
+            if(!in || evbuffer_reserve_space(dst, ev_ssize_t(HEADER_SIZE + bound), &out, 1) < 1)
+                throw generic_error<COMPRESS_FAILED>("Failed to reserve %zu bytes for the compressed block", bound);
+            auto *header = static_cast<unsigned char *>(out.iov_base);
+#if TCP_KIT_LZ4 || TCP_KIT_ZSTD
+            unsigned char *p = header + HEADER_SIZE;
+#endif
+            size_t size = 0;
+#if TCP_KIT_LZ4
+            if(_codec == CODEC_LZ4) {
+                auto *c = static_cast<LZ4F_cctx *>(_cctx);
+                size_t res;
+                if(!_begun) {
+                    res = LZ4F_compressBegin(c, p, bound, &lz4_prefs);
+                    if(LZ4F_isError(res))
+                        throw generic_error<COMPRESS_FAILED>("LZ4F_compressBegin: %s", LZ4F_getErrorName(res));
+                    size = res;
+                    _begun = true;
+                }
+                res = LZ4F_compressUpdate(c, p + size, bound - size, in, n, nullptr);
+                if(LZ4F_isError(res))
+                    throw generic_error<COMPRESS_FAILED>("LZ4F_compressUpdate: %s", LZ4F_getErrorName(res));
+                size += res;
+            }
+#endif
+#if TCP_KIT_ZSTD
+            if(_codec == CODEC_ZSTD) {
+                ZSTD_inBuffer input{in, n, 0};
+                ZSTD_outBuffer output{p, bound, 0};
+                size_t res = ZSTD_compressStream2(static_cast<ZSTD_CCtx *>(_cctx), &output, &input, ZSTD_e_flush);
+                if(ZSTD_isError(res))
+                    throw generic_error<COMPRESS_FAILED>("ZSTD_compressStream2: %s", ZSTD_getErrorName(res));
+                if(res != 0)
+                    throw generic_error<COMPRESS_FAILED>("The compressed block exceeds its bound");
+                size = output.pos;
+            }
+#endif
+            put_header(header, _codec, size);
+            out.iov_len = HEADER_SIZE + size;
+            evbuffer_commit_space(dst, &out, 1);
+            evbuffer_drain(src, n);
+        }
+
+        // -------------------------------------------------------------------------------------------------------------
+
+        block_decoder::block_decoder(): _lz4(nullptr), _zstd(nullptr) { }
+
+        block_decoder::~block_decoder() {
+#if TCP_KIT_LZ4
+            if(_lz4)
+                pool_of<LZ4F_dctx>().release(static_cast<LZ4F_dctx *>(_lz4));
+#endif
+#if TCP_KIT_ZSTD
+            if(_zstd)
+                pool_of<ZSTD_DCtx>().release(static_cast<ZSTD_DCtx *>(_zstd));
+#endif
+        }
+
+        bool block_decoder::decode(evbuffer *src, evbuffer *dst) {
+            bool decoded = false;
+            unsigned char header[HEADER_SIZE];
+            while(evbuffer_copyout(src, header, HEADER_SIZE) == HEADER_SIZE) {
+                size_t n = size_t(header[1]) | size_t(header[2]) << 8 | size_t(header[3]) << 16;
+                if(n > (header[0] == CODEC_RAW ? size_t(COMPRESS_BLOCK_SIZE) : MAX_BLOCK))
+                    throw generic_error<COMPRESS_FAILED>("The block of %zu bytes is too large", n);
+                if(evbuffer_get_length(src) < HEADER_SIZE + n)
+                    break;
+                evbuffer_drain(src, HEADER_SIZE);
+                if(header[0] == CODEC_RAW)
+                    evbuffer_remove_buffer(src, dst, n);
+                else
+                    decompress(header[0], src, n, dst);
+                decoded = true;
+            }
+            return decoded;
+        }
+
+        // 解压 src 的前 n 字节(一个完整的块), 一个块解压后不超过 COMPRESS_BLOCK_SIZE 字节
+        void block_decoder::decompress(uint8_t codec, evbuffer *src, size_t n, evbuffer *dst) {
+            if(!(codec & supported_codecs()) || (codec != CODEC_LZ4 && codec != CODEC_ZSTD))
+                throw generic_error<COMPRESS_FAILED>("Unsupported codec %d", codec);
+            const unsigned char *in = evbuffer_pullup(src, ev_ssize_t(n));
+            evbuffer_iovec out;
+            // 多留 1 字节, 以识别超出块长度的数据
+            const size_t cap = COMPRESS_BLOCK_SIZE + 1;
+            if(!in || evbuffer_reserve_space(dst, cap, &out, 1) < 1)
+                throw generic_error<COMPRESS_FAILED>("Failed to reserve the space for the decompressed block");
+#if TCP_KIT_LZ4 || TCP_KIT_ZSTD
+            auto *p = static_cast<unsigned char *>(out.iov_base);
+#endif
+            size_t size = 0;
+#if TCP_KIT_LZ4
+            if(codec == CODEC_LZ4) {
+                if(!_lz4)
+                    _lz4 = pool_of<LZ4F_dctx>().acquire();
+                size_t consumed = 0;
+                while(consumed < n) {
+                    size_t out_len = cap - size, in_len = n - consumed;
+                    size_t res = LZ4F_decompress(static_cast<LZ4F_dctx *>(_lz4), p + size, &out_len,
+                                                 in + consumed, &in_len, nullptr);
+                    if(LZ4F_isError(res))
+                        throw generic_error<COMPRESS_FAILED>("LZ4F_decompress: %s", LZ4F_getErrorName(res));
+                    size += out_len;
+                    consumed += in_len;
+                    if(size == cap || (out_len == 0 && in_len == 0))
+                        break;
+                }
+                if(consumed < n)
+                    size = cap;
+            }
+#endif
+#if TCP_KIT_ZSTD
+            if(codec == CODEC_ZSTD) {
+                if(!_zstd)
+                    _zstd = pool_of<ZSTD_DCtx>().acquire();
+                ZSTD_inBuffer input{in, n, 0};
+                ZSTD_outBuffer output{p, cap, 0};
+                while(input.pos < input.size && output.pos < output.size) {
+                    size_t res = ZSTD_decompressStream(static_cast<ZSTD_DCtx *>(_zstd), &output, &input);
+                    if(ZSTD_isError(res))
+                        throw generic_error<COMPRESS_FAILED>("ZSTD_decompressStream: %s", ZSTD_getErrorName(res));
+                }
+                size = input.pos < input.size ? cap : output.pos;
+            }
+#endif
+            if(size > COMPRESS_BLOCK_SIZE)
+                throw generic_error<COMPRESS_FAILED>("The decompressed block exceeds %d bytes", COMPRESS_BLOCK_SIZE);
+            out.iov_len = size;
+            evbuffer_commit_space(dst, &out, 1);
+            evbuffer_drain(src, n);
+        }
+
+        // -------------------------------------------------------------------------------------------------------------
+
+        compress_session::compress_session(): _hello_sent(false), _peer_known(false) { }
+
+        void compress_session::encode(evbuffer *src, evbuffer *dst) {
+            if(evbuffer_get_length(src) == 0)
+                return;
+            if(!_hello_sent) {
+                uint8_t hello = supported_codecs();
+                evbuffer_add(dst, &hello, 1);
+                _hello_sent = true;
+            }
+            _encoder.encode(src, dst);
+        }
+
+        bool compress_session::decode(evbuffer *src, evbuffer *dst) {
+            bool consumed = false;
+            if(!_peer_known) {
+                uint8_t peer;
+                if(evbuffer_remove(src, &peer, 1) != 1)
+                    return false;
+                _encoder.use(choose_codec(peer));
+                _peer_known = true;
+                consumed = true;
+            }
+            return _decoder.decode(src, dst) || consumed;
+        }
+
+        uint8_t compress_session::codec() const {
+            return _encoder.codec();
+        }
+
+        // -------------------------------------------------------------------------------------------------------------
+
+        namespace {
+
+            compress_session& session_of(ev_context *ctx) {
+                std::unique_ptr<compress_session> &session = local().sessions[ctx->conn_id];
+                if(!session)
+                    session.reset(new compress_session());
+                return *session;
+            }
+
+        }
+
+        bufferevent_filter_result compress_filter::read(evbuffer *src, evbuffer *dst, ev_ssize_t dst_limit,
+                                                        bufferevent_flush_mode mode, ev_context *ctx) {
+            return session_of(ctx).decode(src, dst) ? BEV_OK : BEV_NEED_MORE;
+        }
+
+        bufferevent_filter_result compress_filter::write(evbuffer *src, evbuffer *dst, ev_ssize_t dst_limit,
+                                                         bufferevent_flush_mode mode, ev_context *ctx) {
+            session_of(ctx).encode(src, dst);
+            return BEV_OK;
+        }
+
+        void compress_filter::close(ev_context *ctx) {
+            local().sessions.erase(ctx->conn_id);
+        }
+
+    }
+
+}
@@ -0,0 +1,69 @@
+#include <network/concurrency_limiter.h>
+#include <algorithm>
+
+namespace tcp_kit {
+
+    static const double priority_share[] = {1.0, 0.9, 0.5};
+
+    concurrency_limiter::concurrency_limiter(): _limit_f(LIMITER_INITIAL_LIMIT), _limit(LIMITER_INITIAL_LIMIT),
+                                                _in_flight(0), _admitted(0), _rejected(0) { }
+
+    bool concurrency_limiter::try_acquire() {
+        if(!LIMITER_INITIAL_LIMIT)
+            return true;
+        if(_in_flight.load(std::memory_order_relaxed) >= _limit.load(std::memory_order_relaxed)) {
+            _rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _in_flight.fetch_add(1, std::memory_order_relaxed);
+        _admitted.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void concurrency_limiter::release(std::chrono::steady_clock::duration latency, bool sample) {
+        if(!LIMITER_INITIAL_LIMIT)
+            return;
+        uint32_t in_flight = _in_flight.fetch_sub(1, std::memory_order_relaxed);
+        if(!sample)
+            return;
+        bool over = latency > std::chrono::milliseconds(LIMITER_LATENCY_TARGET_MS);
+        double limit = _limit_f.load(std::memory_order_relaxed), next;
+        do {
+            if(over)
+                next = std::max(limit * LIMITER_BACKOFF, double(LIMITER_MIN_LIMIT));
+            else if(in_flight * 2 >= limit)
+                next = std::min(limit + 1.0 / limit, double(LIMITER_MAX_LIMIT));
+            else
+                return;
+        } while(!_limit_f.compare_exchange_weak(limit, next, std::memory_order_relaxed));
+        _limit.store(uint32_t(next), std::memory_order_relaxed);
+    }
+
+    bool concurrency_limiter::admit(uint8_t priority) {
+        if(!LIMITER_INITIAL_LIMIT || priority == CRITICAL)
+            return true;
+        if(_in_flight.load(std::memory_order_relaxed) <= _limit.load(std::memory_order_relaxed) * priority_share[priority])
+            return true;
+        // 该请求已由 try_acquire 计入接受数, 改记为拒绝
+        _admitted.fetch_sub(1, std::memory_order_relaxed);
+        _rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint32_t concurrency_limiter::limit() const {
+        return _limit.load(std::memory_order_relaxed);
+    }
+
+    uint32_t concurrency_limiter::in_flight() const {
+        return _in_flight.load(std::memory_order_relaxed);
+    }
+
+    uint64_t concurrency_limiter::n_admitted() const {
+        return _admitted.load(std::memory_order_relaxed);
+    }
+
+    uint64_t concurrency_limiter::n_rejected() const {
+        return _rejected.load(std::memory_order_relaxed);
+    }
+
+}
@@ -0,0 +1,93 @@
+#include <network/conn_table.h>
+#include <network/ev_context.h>
+
+namespace tcp_kit {
+
+    static_assert(CONN_TABLE_CAPACITY % CONN_CHUNK_SIZE == 0 && CONN_TABLE_CAPACITY <= (uint64_t(1) << CONN_SLOT_BITS),
+                  "CONN_TABLE_CAPACITY must be a multiple of CONN_CHUNK_SIZE and fit in the slot bits");
+    static_assert(CONN_SLOT_BITS + CONN_EV_HANDLER_BITS + CONN_GEN_BITS == 64, "conn_id must be 64 bits");
+
+    struct conn_table::chunk {
+        struct slot {
+            std::atomic<uint32_t> gen;
+            alignas(ev_context) unsigned char storage[sizeof(ev_context)];
+        };
+        slot slots[CONN_CHUNK_SIZE];
+    };
+
+    conn_table::conn_table(): _index(0), _chunks(new std::atomic<chunk*>[CONN_TABLE_CAPACITY / CONN_CHUNK_SIZE]),
+                              _n_slots(0), _n_used(0) {
+        for(uint32_t i = 0; i < CONN_TABLE_CAPACITY / CONN_CHUNK_SIZE; ++i)
+            _chunks[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    conn_table::~conn_table() {
+        for(uint32_t i = 0; i < CONN_TABLE_CAPACITY / CONN_CHUNK_SIZE; ++i)
+            delete _chunks[i].load(std::memory_order_relaxed);
+    }
+
+    void conn_table::init(uint16_t ev_handler_index) {
+        _index = ev_handler_index;
+    }
+
+    void *conn_table::acquire(uint64_t &conn_id) {
+        uint32_t slot;
+        if(!_free.empty()) {
+            slot = _free.back();
+            _free.pop_back();
+        } else if(_n_slots < CONN_TABLE_CAPACITY) {
+            slot = _n_slots;
+            if(!(slot & (CONN_CHUNK_SIZE - 1)))
+                _chunks[slot >> CONN_CHUNK_BITS].store(new chunk(), std::memory_order_release);
+            ++_n_slots;
+        } else {
+            return nullptr;
+        }
+        chunk::slot &s = _chunks[slot >> CONN_CHUNK_BITS].load(std::memory_order_relaxed)->slots[slot & (CONN_CHUNK_SIZE - 1)];
+        uint32_t gen = s.gen.fetch_add(1, std::memory_order_release) + 1;
+        conn_id = ((gen & CONN_GEN_MASK) << (CONN_SLOT_BITS + CONN_EV_HANDLER_BITS)) |
+                  (uint64_t(_index) << CONN_SLOT_BITS) | slot;
+        ++_n_used;
+        return s.storage;
+    }
+
+    void conn_table::release(ev_context *ctx) {
+        uint32_t slot = ctx->conn_id & CONN_SLOT_MASK;
+        chunk::slot &s = _chunks[slot >> CONN_CHUNK_BITS].load(std::memory_order_relaxed)->slots[slot & (CONN_CHUNK_SIZE - 1)];
+        ctx->~ev_context();
+        s.gen.fetch_add(1, std::memory_order_release);
+        _free.push_back(slot);
+        --_n_used;
+    }
+
+    ev_context *conn_table::find(uint64_t conn_id) const {
+        uint64_t slot = conn_id & CONN_SLOT_MASK;
+        if(ev_handler_of(conn_id) != _index || slot >= CONN_TABLE_CAPACITY)
+            return nullptr;
+        chunk *c = _chunks[slot >> CONN_CHUNK_BITS].load(std::memory_order_acquire);
+        if(!c)
+            return nullptr;
+        chunk::slot &s = c->slots[slot & (CONN_CHUNK_SIZE - 1)];
+        uint32_t gen = s.gen.load(std::memory_order_acquire);
+        if(!(gen & 1) || (gen & CONN_GEN_MASK) != (conn_id >> (CONN_SLOT_BITS + CONN_EV_HANDLER_BITS)))
+            return nullptr;
+        return reinterpret_cast<ev_context *>(s.storage);
+    }
+
+    uint32_t conn_table::size() const {
+        return _n_used;
+    }
+
+    void conn_table::for_each(const std::function<void(ev_context *)> &fn) const {
+        for(uint32_t slot = 0; slot < _n_slots; ++slot) {
+            chunk::slot &s = _chunks[slot >> CONN_CHUNK_BITS].load(std::memory_order_relaxed)->slots[slot & (CONN_CHUNK_SIZE - 1)];
+            if(s.gen.load(std::memory_order_relaxed) & 1)
+                fn(reinterpret_cast<ev_context *>(s.storage));
+        }
+    }
+
+    uint16_t conn_table::ev_handler_of(uint64_t conn_id) {
+        return (conn_id >> CONN_SLOT_BITS) & CONN_EV_HANDLER_MASK;
+    }
+
+}
@@ -1,17 +1,25 @@
 #include <error/errors.h>
 #include <string>
+#include <memory>
+#include <stdarg.h>
+#include <stdio.h>
 
 namespace tcp_kit {
 
     std::string format_msg(const char* fmt, ...) {
-        va_list args;
+        va_list args, args_copy;
         va_start(args, fmt);
-        int msg_len = snprintf(nullptr, 0, fmt, args);
-        auto msg = std::make_unique<char[]>(msg_len + 1);
-        vsprintf(msg.get(), fmt, args);
+        va_copy(args_copy, args);
+        int msg_len = vsnprintf(nullptr, 0, fmt, args);
         va_end(args);
-        msg[msg_len] = '\0';
-        return std::string(msg.get());
+        if(msg_len < 0) {
+            va_end(args_copy);
+            return std::string(fmt);
+        }
+        auto msg = std::make_unique<char[]>(msg_len + 1);
+        vsnprintf(msg.get(), msg_len + 1, fmt, args_copy);
+        va_end(args_copy);
+        return std::string(msg.get(), msg_len);
     }
 
 
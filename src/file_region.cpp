@@ -0,0 +1,37 @@
+#include <network/file_region.h>
+#include <error/errors.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace tcp_kit {
+
+    file_region file_region::of(const std::string& path, int64_t offset, int64_t length) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+            throw generic_error<OPEN_FILE_FAILED>("Failed to open the file [%s]", path.c_str());
+        struct stat st;
+        if(fstat(fd, &st) != 0 || offset < 0 || offset > st.st_size) {
+            close(fd);
+            throw generic_error<OPEN_FILE_FAILED>("Illegal region of the file [%s]", path.c_str());
+        }
+        if(length < 0 || offset + length > st.st_size)
+            length = st.st_size - offset;
+        return {fd, offset, length};
+    }
+
+    file_sink file_sink::of(const std::string& path, int64_t length, int64_t offset) {
+        if(length < 0 || offset < 0)
+            throw generic_error<ILLEGALITY_ARGS>("Illegal length or offset of the file [%s]", path.c_str());
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+        if(fd < 0)
+            throw generic_error<OPEN_FILE_FAILED>("Failed to open the file [%s]", path.c_str());
+        // 写入后文件恰好结束于 offset + length, 覆盖较大的旧文件时不残留其尾部, 续传时保留 offset 之前的内容
+        if(ftruncate(fd, offset + length) != 0 || lseek(fd, offset, SEEK_SET) < 0) {
+            close(fd);
+            throw generic_error<OPEN_FILE_FAILED>("Failed to seek the file [%s]", path.c_str());
+        }
+        return {fd, offset, length};
+    }
+
+}
@@ -1,4 +1,6 @@
 #include <network/filter_chain.h>
+#include <network/ev_context.h>
+#include <event2/buffer.h>
 
 namespace tcp_kit {
 
@@ -8,6 +10,13 @@ namespace tcp_kit {
 
     }
 
+    bool suspend_connects(ev_context* ctx, void (*rest)(ev_context*)) {
+        if(!ctx->resume_connects)
+            return false;
+        ctx->resume_connects = rest;
+        return true;
+    }
+
     void empty_close_chain(ev_context* ctx) {
 
     }
@@ -16,8 +25,82 @@ namespace tcp_kit {
         return in;
     }
 
+    std::unique_ptr<msg_buffer> empty_reply_chain(msg_context* ctx, uint32_t code) {
+        return nullptr;
+    }
+
+    std::unique_ptr<msg_buffer> empty_encode_chain(msg_context* ctx, void* reply) {
+        return nullptr;
+    }
+
     msg_buffer::msg_buffer(size_t size_): ptr((char*)malloc(size_)), size(size_) {}
 
     msg_buffer::msg_buffer(char *ptr_, size_t size_): ptr(ptr_), size(size_) {}
 
+    bufferevent* rw_pipeline::attach(bufferevent *underlying, const std::vector<bufferevent_filter_cb> &reads,
+                                     const std::vector<bufferevent_filter_cb> &writes, ev_context *ctx) {
+        if(reads.empty() && writes.empty())
+            return underlying;
+        rw_pipeline *pipeline = new rw_pipeline(reads, writes, ctx);
+        // 只有一个方向有过滤器时, 另一个方向由 bufferevent_filter 直接移动数据
+        bufferevent *bev = bufferevent_filter_new(underlying, reads.empty() ? nullptr : read,
+                                                  writes.empty() ? nullptr : write,
+                                                  BEV_OPT_CLOSE_ON_FREE, free, pipeline);
+        if(!bev)
+            delete pipeline;
+        return bev;
+    }
+
+    rw_pipeline::rw_pipeline(const std::vector<bufferevent_filter_cb> &reads,
+                             const std::vector<bufferevent_filter_cb> &writes, ev_context *ctx):
+                             _ctx(ctx), _reads{&reads, {}, false}, _writes{&writes, {}, true} {
+        for(direction *d: {&_reads, &_writes}) {
+            for(size_t i = 1; i < d->stages->size(); ++i)
+                d->between.push_back(evbuffer_new());
+        }
+    }
+
+    rw_pipeline::~rw_pipeline() {
+        for(direction *d: {&_reads, &_writes}) {
+            for(evbuffer *buf: d->between)
+                if(buf) evbuffer_free(buf);
+        }
+    }
+
+    // 依次执行各个过滤器, 前一个的输出是后一个的输入. 之前未被消费的数据留在过滤器之间的缓冲中, 因此即使 src 没有新的
+    // 数据也执行每个过滤器. src 被消费或 dst 有新的数据时返回 BEV_OK, bufferevent_filter 在 src 仍有数据时会再次调用
+    bufferevent_filter_result rw_pipeline::direction::run(evbuffer *src, evbuffer *dst, ev_ssize_t dst_limit,
+                                                          bufferevent_flush_mode mode, ev_context *ctx) {
+        size_t src_len = evbuffer_get_length(src), dst_len = evbuffer_get_length(dst);
+        size_t n = stages->size();
+        evbuffer *in = src;
+        for(size_t i = 0; i < n; ++i) {
+            bool last = i + 1 == n;
+            evbuffer *out = last ? dst : between[i];
+            if(!out)
+                return BEV_ERROR;
+            bufferevent_filter_cb stage = (*stages)[reverse ? n - 1 - i : i];
+            if(stage(in, out, last ? dst_limit : -1, mode, ctx) == BEV_ERROR)
+                return BEV_ERROR;
+            in = out;
+        }
+        return evbuffer_get_length(src) != src_len || evbuffer_get_length(dst) != dst_len ? BEV_OK : BEV_NEED_MORE;
+    }
+
+    bufferevent_filter_result rw_pipeline::read(evbuffer *src, evbuffer *dst, ev_ssize_t dst_limit,
+                                                bufferevent_flush_mode mode, void *arg) {
+        auto *pipeline = static_cast<rw_pipeline*>(arg);
+        return pipeline->_reads.run(src, dst, dst_limit, mode, pipeline->_ctx);
+    }
+
+    bufferevent_filter_result rw_pipeline::write(evbuffer *src, evbuffer *dst, ev_ssize_t dst_limit,
+                                                 bufferevent_flush_mode mode, void *arg) {
+        auto *pipeline = static_cast<rw_pipeline*>(arg);
+        return pipeline->_writes.run(src, dst, dst_limit, mode, pipeline->_ctx);
+    }
+
+    void rw_pipeline::free(void *arg) {
+        delete static_cast<rw_pipeline*>(arg);
+    }
+
 }
@@ -0,0 +1,63 @@
+#include <coroutine/task.h>
+
+#if TCP_KIT_COROUTINES
+
+#include <new>
+
+namespace tcp_kit {
+
+    static_assert(FRAME_POOL_MAX_FRAME % FRAME_POOL_GRANULARITY == 0,
+                  "FRAME_POOL_MAX_FRAME must be a multiple of FRAME_POOL_GRANULARITY");
+
+    struct free_frame {
+        free_frame *next;
+    };
+
+    struct frame_lists {
+        free_frame *heads[FRAME_POOL_MAX_FRAME / FRAME_POOL_GRANULARITY] = {};
+        uint32_t    sizes[FRAME_POOL_MAX_FRAME / FRAME_POOL_GRANULARITY] = {};
+
+        ~frame_lists() {
+            for(free_frame *head: heads) {
+                while(head) {
+                    free_frame *next = head->next;
+                    ::operator delete(head);
+                    head = next;
+                }
+            }
+        }
+    };
+
+    static thread_local frame_lists _lists;
+
+    void *frame_pool::allocate(size_t size) {
+        if(size > FRAME_POOL_MAX_FRAME)
+            return ::operator new(size);
+        size_t level = (size - 1) / FRAME_POOL_GRANULARITY;
+        free_frame *frame = _lists.heads[level];
+        if(!frame)
+            return ::operator new((level + 1) * FRAME_POOL_GRANULARITY);
+        _lists.heads[level] = frame->next;
+        --_lists.sizes[level];
+        return frame;
+    }
+
+    void frame_pool::deallocate(void *frame, size_t size) {
+        if(size > FRAME_POOL_MAX_FRAME) {
+            ::operator delete(frame);
+            return;
+        }
+        size_t level = (size - 1) / FRAME_POOL_GRANULARITY;
+        if(_lists.sizes[level] >= FRAME_POOL_MAX_CACHED) {
+            ::operator delete(frame);
+            return;
+        }
+        auto *f = static_cast<free_frame *>(frame);
+        f->next = _lists.heads[level];
+        _lists.heads[level] = f;
+        ++_lists.sizes[level];
+    }
+
+}
+
+#endif
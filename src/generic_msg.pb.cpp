@@ -22,8 +22,10 @@ namespace _pbi = _pb::internal;
 
 namespace tcp_kit {
 PROTOBUF_CONSTEXPR BasicType::BasicType(
-    ::_pbi::ConstantInitialized)
-  : _oneof_case_{}{}
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_.value_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}
+  , /*decltype(_impl_._oneof_case_)*/{}} {}
 struct BasicTypeDefaultTypeInternal {
   PROTOBUF_CONSTEXPR BasicTypeDefaultTypeInternal()
       : _instance(::_pbi::ConstantInitialized{}) {}
@@ -34,10 +36,14 @@ struct BasicTypeDefaultTypeInternal {
 };
 PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 BasicTypeDefaultTypeInternal _BasicType_default_instance_;
 PROTOBUF_CONSTEXPR GenericMsg::GenericMsg(
-    ::_pbi::ConstantInitialized)
-  : params_()
-  , api_(&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{})
-  , body_(nullptr){}
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_._has_bits_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}
+  , /*decltype(_impl_.params_)*/{}
+  , /*decltype(_impl_.api_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+  , /*decltype(_impl_.body_)*/nullptr
+  , /*decltype(_impl_.seq_)*/uint64_t{0u}
+  , /*decltype(_impl_.timeout_ms_)*/0u} {}
 struct GenericMsgDefaultTypeInternal {
   PROTOBUF_CONSTEXPR GenericMsgDefaultTypeInternal()
       : _instance(::_pbi::ConstantInitialized{}) {}
@@ -56,7 +62,7 @@ const uint32_t TableStruct_generic_5fmsg_2eproto::offsets[] PROTOBUF_SECTION_VAR
   ~0u,  // no _has_bits_
   PROTOBUF_FIELD_OFFSET(::tcp_kit::BasicType, _internal_metadata_),
   ~0u,  // no _extensions_
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::BasicType, _oneof_case_[0]),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::BasicType, _impl_._oneof_case_[0]),
   ~0u,  // no _weak_field_map_
   ~0u,  // no _inlined_string_donated_
   ::_pbi::kInvalidFieldOffsetTag,
@@ -67,23 +73,27 @@ const uint32_t TableStruct_generic_5fmsg_2eproto::offsets[] PROTOBUF_SECTION_VAR
   ::_pbi::kInvalidFieldOffsetTag,
   ::_pbi::kInvalidFieldOffsetTag,
   ::_pbi::kInvalidFieldOffsetTag,
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::BasicType, value_),
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericMsg, _has_bits_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::BasicType, _impl_.value_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericMsg, _impl_._has_bits_),
   PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericMsg, _internal_metadata_),
   ~0u,  // no _extensions_
   ~0u,  // no _oneof_case_
   ~0u,  // no _weak_field_map_
   ~0u,  // no _inlined_string_donated_
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericMsg, api_),
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericMsg, params_),
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericMsg, body_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericMsg, _impl_.api_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericMsg, _impl_.params_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericMsg, _impl_.body_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericMsg, _impl_.timeout_ms_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericMsg, _impl_.seq_),
   ~0u,
   ~0u,
   0,
+  2,
+  1,
 };
 static const ::_pbi::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
   { 0, -1, -1, sizeof(::tcp_kit::BasicType)},
-  { 15, 24, -1, sizeof(::tcp_kit::GenericMsg)},
+  { 15, 26, -1, sizeof(::tcp_kit::GenericMsg)},
 };
 
 static const ::_pb::Message* const file_default_instances[] = {
@@ -96,17 +106,19 @@ const char descriptor_table_protodef_generic_5fmsg_2eproto[] PROTOBUF_SECTION_VA
   "tobuf/any.proto\"\206\001\n\tBasicType\022\r\n\003u32\030\001 \001"
   "(\rH\000\022\r\n\003s32\030\002 \001(\005H\000\022\r\n\003u64\030\003 \001(\004H\000\022\r\n\003s6"
   "4\030\004 \001(\003H\000\022\013\n\001f\030\005 \001(\002H\000\022\013\n\001d\030\006 \001(\001H\000\022\013\n\001b"
-  "\030\007 \001(\010H\000\022\r\n\003str\030\010 \001(\tH\000B\007\n\005value\"o\n\nGene"
-  "ricMsg\022\013\n\003api\030\001 \001(\t\022\"\n\006params\030\002 \003(\0132\022.tc"
-  "p_kit.BasicType\022\'\n\004body\030\003 \001(\0132\024.google.p"
-  "rotobuf.AnyH\000\210\001\001B\007\n\005_bodyb\006proto3"
+  "\030\007 \001(\010H\000\022\r\n\003str\030\010 \001(\tH\000B\007\n\005value\"\261\001\n\nGen"
+  "ericMsg\022\013\n\003api\030\001 \001(\t\022\"\n\006params\030\002 \003(\0132\022.t"
+  "cp_kit.BasicType\022\'\n\004body\030\003 \001(\0132\024.google."
+  "protobuf.AnyH\000\210\001\001\022\027\n\ntimeout_ms\030\004 \001(\rH\001\210"
+  "\001\001\022\020\n\003seq\030\005 \001(\004H\002\210\001\001B\007\n\005_bodyB\r\n\013_timeou"
+  "t_msB\006\n\004_seqb\006proto3"
   ;
 static const ::_pbi::DescriptorTable* const descriptor_table_generic_5fmsg_2eproto_deps[1] = {
   &::descriptor_table_google_2fprotobuf_2fany_2eproto,
 };
 static ::_pbi::once_flag descriptor_table_generic_5fmsg_2eproto_once;
 const ::_pbi::DescriptorTable descriptor_table_generic_5fmsg_2eproto = {
-    false, false, 313, descriptor_table_protodef_generic_5fmsg_2eproto,
+    false, false, 380, descriptor_table_protodef_generic_5fmsg_2eproto,
     "generic_msg.proto",
     &descriptor_table_generic_5fmsg_2eproto_once, descriptor_table_generic_5fmsg_2eproto_deps, 1, 2,
     schemas, file_default_instances, TableStruct_generic_5fmsg_2eproto::offsets,
@@ -130,44 +142,50 @@ class BasicType::_Internal {
 BasicType::BasicType(::PROTOBUF_NAMESPACE_ID::Arena* arena,
                          bool is_message_owned)
   : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
-  SharedCtor();
+  SharedCtor(arena, is_message_owned);
   // @@protoc_insertion_point(arena_constructor:tcp_kit.BasicType)
 }
 BasicType::BasicType(const BasicType& from)
   : ::PROTOBUF_NAMESPACE_ID::Message() {
+  BasicType* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_.value_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , /*decltype(_impl_._oneof_case_)*/{}};
+
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
   clear_has_value();
   switch (from.value_case()) {
     case kU32: {
-      _internal_set_u32(from._internal_u32());
+      _this->_internal_set_u32(from._internal_u32());
       break;
     }
     case kS32: {
-      _internal_set_s32(from._internal_s32());
+      _this->_internal_set_s32(from._internal_s32());
       break;
     }
     case kU64: {
-      _internal_set_u64(from._internal_u64());
+      _this->_internal_set_u64(from._internal_u64());
       break;
     }
     case kS64: {
-      _internal_set_s64(from._internal_s64());
+      _this->_internal_set_s64(from._internal_s64());
       break;
     }
     case kF: {
-      _internal_set_f(from._internal_f());
+      _this->_internal_set_f(from._internal_f());
       break;
     }
     case kD: {
-      _internal_set_d(from._internal_d());
+      _this->_internal_set_d(from._internal_d());
       break;
     }
     case kB: {
-      _internal_set_b(from._internal_b());
+      _this->_internal_set_b(from._internal_b());
       break;
     }
     case kStr: {
-      _internal_set_str(from._internal_str());
+      _this->_internal_set_str(from._internal_str());
       break;
     }
     case VALUE_NOT_SET: {
@@ -177,8 +195,16 @@ BasicType::BasicType(const BasicType& from)
   // @@protoc_insertion_point(copy_constructor:tcp_kit.BasicType)
 }
 
-inline void BasicType::SharedCtor() {
-clear_has_value();
+inline void BasicType::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_.value_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , /*decltype(_impl_._oneof_case_)*/{}
+  };
+  clear_has_value();
 }
 
 BasicType::~BasicType() {
@@ -198,7 +224,7 @@ inline void BasicType::SharedDtor() {
 }
 
 void BasicType::SetCachedSize(int size) const {
-  _cached_size_.Set(size);
+  _impl_._cached_size_.Set(size);
 }
 
 void BasicType::clear_value() {
@@ -233,14 +259,14 @@ void BasicType::clear_value() {
       break;
     }
     case kStr: {
-      value_.str_.Destroy();
+      _impl_.value_.str_.Destroy();
       break;
     }
     case VALUE_NOT_SET: {
       break;
     }
   }
-  _oneof_case_[0] = VALUE_NOT_SET;
+  _impl_._oneof_case_[0] = VALUE_NOT_SET;
 }
 
 
@@ -470,66 +496,62 @@ size_t BasicType::ByteSizeLong() const {
       break;
     }
   }
-  return MaybeComputeUnknownFieldsSize(total_size, &_cached_size_);
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
 }
 
 const ::PROTOBUF_NAMESPACE_ID::Message::ClassData BasicType::_class_data_ = {
-    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSizeCheck,
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
     BasicType::MergeImpl
 };
 const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*BasicType::GetClassData() const { return &_class_data_; }
 
-void BasicType::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message* to,
-                      const ::PROTOBUF_NAMESPACE_ID::Message& from) {
-  static_cast<BasicType *>(to)->MergeFrom(
-      static_cast<const BasicType &>(from));
-}
-
 
-void BasicType::MergeFrom(const BasicType& from) {
-// @@protoc_insertion_point(class_specific_merge_from_start:tcp_kit.BasicType)
-  GOOGLE_DCHECK_NE(&from, this);
+void BasicType::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<BasicType*>(&to_msg);
+  auto& from = static_cast<const BasicType&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:tcp_kit.BasicType)
+  GOOGLE_DCHECK_NE(&from, _this);
   uint32_t cached_has_bits = 0;
   (void) cached_has_bits;
 
   switch (from.value_case()) {
     case kU32: {
-      _internal_set_u32(from._internal_u32());
+      _this->_internal_set_u32(from._internal_u32());
       break;
     }
     case kS32: {
-      _internal_set_s32(from._internal_s32());
+      _this->_internal_set_s32(from._internal_s32());
       break;
     }
     case kU64: {
-      _internal_set_u64(from._internal_u64());
+      _this->_internal_set_u64(from._internal_u64());
       break;
     }
     case kS64: {
-      _internal_set_s64(from._internal_s64());
+      _this->_internal_set_s64(from._internal_s64());
       break;
     }
     case kF: {
-      _internal_set_f(from._internal_f());
+      _this->_internal_set_f(from._internal_f());
       break;
     }
     case kD: {
-      _internal_set_d(from._internal_d());
+      _this->_internal_set_d(from._internal_d());
       break;
     }
     case kB: {
-      _internal_set_b(from._internal_b());
+      _this->_internal_set_b(from._internal_b());
       break;
     }
     case kStr: {
-      _internal_set_str(from._internal_str());
+      _this->_internal_set_str(from._internal_str());
       break;
     }
     case VALUE_NOT_SET: {
       break;
     }
   }
-  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
 }
 
 void BasicType::CopyFrom(const BasicType& from) {
@@ -546,8 +568,8 @@ bool BasicType::IsInitialized() const {
 void BasicType::InternalSwap(BasicType* other) {
   using std::swap;
   _internal_metadata_.InternalSwap(&other->_internal_metadata_);
-  swap(value_, other->value_);
-  swap(_oneof_case_[0], other->_oneof_case_[0]);
+  swap(_impl_.value_, other->_impl_.value_);
+  swap(_impl_._oneof_case_[0], other->_impl_._oneof_case_[0]);
 }
 
 ::PROTOBUF_NAMESPACE_ID::Metadata BasicType::GetMetadata() const {
@@ -560,55 +582,80 @@ void BasicType::InternalSwap(BasicType* other) {
 
 class GenericMsg::_Internal {
  public:
-  using HasBits = decltype(std::declval<GenericMsg>()._has_bits_);
+  using HasBits = decltype(std::declval<GenericMsg>()._impl_._has_bits_);
   static const ::PROTOBUF_NAMESPACE_ID::Any& body(const GenericMsg* msg);
   static void set_has_body(HasBits* has_bits) {
     (*has_bits)[0] |= 1u;
   }
+  static void set_has_timeout_ms(HasBits* has_bits) {
+    (*has_bits)[0] |= 4u;
+  }
+  static void set_has_seq(HasBits* has_bits) {
+    (*has_bits)[0] |= 2u;
+  }
 };
 
 const ::PROTOBUF_NAMESPACE_ID::Any&
 GenericMsg::_Internal::body(const GenericMsg* msg) {
-  return *msg->body_;
+  return *msg->_impl_.body_;
 }
 void GenericMsg::clear_body() {
-  if (body_ != nullptr) body_->Clear();
-  _has_bits_[0] &= ~0x00000001u;
+  if (_impl_.body_ != nullptr) _impl_.body_->Clear();
+  _impl_._has_bits_[0] &= ~0x00000001u;
 }
 GenericMsg::GenericMsg(::PROTOBUF_NAMESPACE_ID::Arena* arena,
                          bool is_message_owned)
-  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned),
-  params_(arena) {
-  SharedCtor();
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
   // @@protoc_insertion_point(arena_constructor:tcp_kit.GenericMsg)
 }
 GenericMsg::GenericMsg(const GenericMsg& from)
-  : ::PROTOBUF_NAMESPACE_ID::Message(),
-      _has_bits_(from._has_bits_),
-      params_(from.params_) {
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  GenericMsg* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){from._impl_._has_bits_}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.params_){from._impl_.params_}
+    , decltype(_impl_.api_){}
+    , decltype(_impl_.body_){nullptr}
+    , decltype(_impl_.seq_){}
+    , decltype(_impl_.timeout_ms_){}};
+
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
-  api_.InitDefault();
+  _impl_.api_.InitDefault();
   #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
-    api_.Set("", GetArenaForAllocation());
+    _impl_.api_.Set("", GetArenaForAllocation());
   #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
   if (!from._internal_api().empty()) {
-    api_.Set(from._internal_api(), 
-      GetArenaForAllocation());
+    _this->_impl_.api_.Set(from._internal_api(), 
+      _this->GetArenaForAllocation());
   }
   if (from._internal_has_body()) {
-    body_ = new ::PROTOBUF_NAMESPACE_ID::Any(*from.body_);
-  } else {
-    body_ = nullptr;
+    _this->_impl_.body_ = new ::PROTOBUF_NAMESPACE_ID::Any(*from._impl_.body_);
   }
+  ::memcpy(&_impl_.seq_, &from._impl_.seq_,
+    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.timeout_ms_) -
+    reinterpret_cast<char*>(&_impl_.seq_)) + sizeof(_impl_.timeout_ms_));
   // @@protoc_insertion_point(copy_constructor:tcp_kit.GenericMsg)
 }
 
-inline void GenericMsg::SharedCtor() {
-api_.InitDefault();
-#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
-  api_.Set("", GetArenaForAllocation());
-#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
-body_ = nullptr;
+inline void GenericMsg::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.params_){arena}
+    , decltype(_impl_.api_){}
+    , decltype(_impl_.body_){nullptr}
+    , decltype(_impl_.seq_){uint64_t{0u}}
+    , decltype(_impl_.timeout_ms_){0u}
+  };
+  _impl_.api_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.api_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
 }
 
 GenericMsg::~GenericMsg() {
@@ -622,12 +669,13 @@ GenericMsg::~GenericMsg() {
 
 inline void GenericMsg::SharedDtor() {
   GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
-  api_.Destroy();
-  if (this != internal_default_instance()) delete body_;
+  _impl_.params_.~RepeatedPtrField();
+  _impl_.api_.Destroy();
+  if (this != internal_default_instance()) delete _impl_.body_;
 }
 
 void GenericMsg::SetCachedSize(int size) const {
-  _cached_size_.Set(size);
+  _impl_._cached_size_.Set(size);
 }
 
 void GenericMsg::Clear() {
@@ -636,14 +684,19 @@ void GenericMsg::Clear() {
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
-  params_.Clear();
-  api_.ClearToEmpty();
-  cached_has_bits = _has_bits_[0];
+  _impl_.params_.Clear();
+  _impl_.api_.ClearToEmpty();
+  cached_has_bits = _impl_._has_bits_[0];
   if (cached_has_bits & 0x00000001u) {
-    GOOGLE_DCHECK(body_ != nullptr);
-    body_->Clear();
+    GOOGLE_DCHECK(_impl_.body_ != nullptr);
+    _impl_.body_->Clear();
+  }
+  if (cached_has_bits & 0x00000006u) {
+    ::memset(&_impl_.seq_, 0, static_cast<size_t>(
+        reinterpret_cast<char*>(&_impl_.timeout_ms_) -
+        reinterpret_cast<char*>(&_impl_.seq_)) + sizeof(_impl_.timeout_ms_));
   }
-  _has_bits_.Clear();
+  _impl_._has_bits_.Clear();
   _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
@@ -685,6 +738,24 @@ const char* GenericMsg::_InternalParse(const char* ptr, ::_pbi::ParseContext* ct
         } else
           goto handle_unusual;
         continue;
+      // optional uint32 timeout_ms = 4;
+      case 4:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 32)) {
+          _Internal::set_has_timeout_ms(&has_bits);
+          _impl_.timeout_ms_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional uint64 seq = 5;
+      case 5:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 40)) {
+          _Internal::set_has_seq(&has_bits);
+          _impl_.seq_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
       default:
         goto handle_unusual;
     }  // switch
@@ -701,7 +772,7 @@ const char* GenericMsg::_InternalParse(const char* ptr, ::_pbi::ParseContext* ct
     CHK_(ptr != nullptr);
   }  // while
 message_done:
-  _has_bits_.Or(has_bits);
+  _impl_._has_bits_.Or(has_bits);
   return ptr;
 failure:
   ptr = nullptr;
@@ -740,6 +811,18 @@ uint8_t* GenericMsg::_InternalSerialize(
         _Internal::body(this).GetCachedSize(), target, stream);
   }
 
+  // optional uint32 timeout_ms = 4;
+  if (_internal_has_timeout_ms()) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt32ToArray(4, this->_internal_timeout_ms(), target);
+  }
+
+  // optional uint64 seq = 5;
+  if (_internal_has_seq()) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt64ToArray(5, this->_internal_seq(), target);
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
@@ -758,7 +841,7 @@ size_t GenericMsg::ByteSizeLong() const {
 
   // repeated .tcp_kit.BasicType params = 2;
   total_size += 1UL * this->_internal_params_size();
-  for (const auto& msg : this->params_) {
+  for (const auto& msg : this->_impl_.params_) {
     total_size +=
       ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(msg);
   }
@@ -770,44 +853,63 @@ size_t GenericMsg::ByteSizeLong() const {
         this->_internal_api());
   }
 
-  // optional .google.protobuf.Any body = 3;
-  cached_has_bits = _has_bits_[0];
-  if (cached_has_bits & 0x00000001u) {
-    total_size += 1 +
-      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(
-        *body_);
-  }
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000007u) {
+    // optional .google.protobuf.Any body = 3;
+    if (cached_has_bits & 0x00000001u) {
+      total_size += 1 +
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(
+          *_impl_.body_);
+    }
+
+    // optional uint64 seq = 5;
+    if (cached_has_bits & 0x00000002u) {
+      total_size += ::_pbi::WireFormatLite::UInt64SizePlusOne(this->_internal_seq());
+    }
 
-  return MaybeComputeUnknownFieldsSize(total_size, &_cached_size_);
+    // optional uint32 timeout_ms = 4;
+    if (cached_has_bits & 0x00000004u) {
+      total_size += ::_pbi::WireFormatLite::UInt32SizePlusOne(this->_internal_timeout_ms());
+    }
+
+  }
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
 }
 
 const ::PROTOBUF_NAMESPACE_ID::Message::ClassData GenericMsg::_class_data_ = {
-    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSizeCheck,
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
     GenericMsg::MergeImpl
 };
 const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GenericMsg::GetClassData() const { return &_class_data_; }
 
-void GenericMsg::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message* to,
-                      const ::PROTOBUF_NAMESPACE_ID::Message& from) {
-  static_cast<GenericMsg *>(to)->MergeFrom(
-      static_cast<const GenericMsg &>(from));
-}
 
-
-void GenericMsg::MergeFrom(const GenericMsg& from) {
-// @@protoc_insertion_point(class_specific_merge_from_start:tcp_kit.GenericMsg)
-  GOOGLE_DCHECK_NE(&from, this);
+void GenericMsg::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<GenericMsg*>(&to_msg);
+  auto& from = static_cast<const GenericMsg&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:tcp_kit.GenericMsg)
+  GOOGLE_DCHECK_NE(&from, _this);
   uint32_t cached_has_bits = 0;
   (void) cached_has_bits;
 
-  params_.MergeFrom(from.params_);
+  _this->_impl_.params_.MergeFrom(from._impl_.params_);
   if (!from._internal_api().empty()) {
-    _internal_set_api(from._internal_api());
+    _this->_internal_set_api(from._internal_api());
   }
-  if (from._internal_has_body()) {
-    _internal_mutable_body()->::PROTOBUF_NAMESPACE_ID::Any::MergeFrom(from._internal_body());
+  cached_has_bits = from._impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000007u) {
+    if (cached_has_bits & 0x00000001u) {
+      _this->_internal_mutable_body()->::PROTOBUF_NAMESPACE_ID::Any::MergeFrom(
+          from._internal_body());
+    }
+    if (cached_has_bits & 0x00000002u) {
+      _this->_impl_.seq_ = from._impl_.seq_;
+    }
+    if (cached_has_bits & 0x00000004u) {
+      _this->_impl_.timeout_ms_ = from._impl_.timeout_ms_;
+    }
+    _this->_impl_._has_bits_[0] |= cached_has_bits;
   }
-  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
 }
 
 void GenericMsg::CopyFrom(const GenericMsg& from) {
@@ -826,13 +928,18 @@ void GenericMsg::InternalSwap(GenericMsg* other) {
   auto* lhs_arena = GetArenaForAllocation();
   auto* rhs_arena = other->GetArenaForAllocation();
   _internal_metadata_.InternalSwap(&other->_internal_metadata_);
-  swap(_has_bits_[0], other->_has_bits_[0]);
-  params_.InternalSwap(&other->params_);
+  swap(_impl_._has_bits_[0], other->_impl_._has_bits_[0]);
+  _impl_.params_.InternalSwap(&other->_impl_.params_);
   ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
-      &api_, lhs_arena,
-      &other->api_, rhs_arena
+      &_impl_.api_, lhs_arena,
+      &other->_impl_.api_, rhs_arena
   );
-  swap(body_, other->body_);
+  ::PROTOBUF_NAMESPACE_ID::internal::memswap<
+      PROTOBUF_FIELD_OFFSET(GenericMsg, _impl_.timeout_ms_)
+      + sizeof(GenericMsg::_impl_.timeout_ms_)
+      - PROTOBUF_FIELD_OFFSET(GenericMsg, _impl_.body_)>(
+          reinterpret_cast<char*>(&_impl_.body_),
+          reinterpret_cast<char*>(&other->_impl_.body_));
 }
 
 ::PROTOBUF_NAMESPACE_ID::Metadata GenericMsg::GetMetadata() const {
@@ -22,8 +22,10 @@ namespace _pbi = _pb::internal;
 
 namespace tcp_kit {
 PROTOBUF_CONSTEXPR GenericReply_BasicType::GenericReply_BasicType(
-    ::_pbi::ConstantInitialized)
-  : _oneof_case_{}{}
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_.value_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}
+  , /*decltype(_impl_._oneof_case_)*/{}} {}
 struct GenericReply_BasicTypeDefaultTypeInternal {
   PROTOBUF_CONSTEXPR GenericReply_BasicTypeDefaultTypeInternal()
       : _instance(::_pbi::ConstantInitialized{}) {}
@@ -34,12 +36,16 @@ struct GenericReply_BasicTypeDefaultTypeInternal {
 };
 PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 GenericReply_BasicTypeDefaultTypeInternal _GenericReply_BasicType_default_instance_;
 PROTOBUF_CONSTEXPR GenericReply::GenericReply(
-    ::_pbi::ConstantInitialized)
-  : msg_(&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{})
-  , result_(nullptr)
-  , body_(nullptr)
-  , code_(0)
-{}
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_._has_bits_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}
+  , /*decltype(_impl_.msg_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+  , /*decltype(_impl_.topic_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+  , /*decltype(_impl_.result_)*/nullptr
+  , /*decltype(_impl_.body_)*/nullptr
+  , /*decltype(_impl_.stream_len_)*/uint64_t{0u}
+  , /*decltype(_impl_.seq_)*/uint64_t{0u}
+  , /*decltype(_impl_.code_)*/0} {}
 struct GenericReplyDefaultTypeInternal {
   PROTOBUF_CONSTEXPR GenericReplyDefaultTypeInternal()
       : _instance(::_pbi::ConstantInitialized{}) {}
@@ -58,7 +64,7 @@ const uint32_t TableStruct_generic_5freply_2eproto::offsets[] PROTOBUF_SECTION_V
   ~0u,  // no _has_bits_
   PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply_BasicType, _internal_metadata_),
   ~0u,  // no _extensions_
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply_BasicType, _oneof_case_[0]),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply_BasicType, _impl_._oneof_case_[0]),
   ~0u,  // no _weak_field_map_
   ~0u,  // no _inlined_string_donated_
   ::_pbi::kInvalidFieldOffsetTag,
@@ -69,25 +75,31 @@ const uint32_t TableStruct_generic_5freply_2eproto::offsets[] PROTOBUF_SECTION_V
   ::_pbi::kInvalidFieldOffsetTag,
   ::_pbi::kInvalidFieldOffsetTag,
   ::_pbi::kInvalidFieldOffsetTag,
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply_BasicType, value_),
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, _has_bits_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply_BasicType, _impl_.value_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, _impl_._has_bits_),
   PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, _internal_metadata_),
   ~0u,  // no _extensions_
   ~0u,  // no _oneof_case_
   ~0u,  // no _weak_field_map_
   ~0u,  // no _inlined_string_donated_
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, code_),
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, msg_),
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, result_),
-  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, body_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, _impl_.code_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, _impl_.msg_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, _impl_.result_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, _impl_.body_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, _impl_.stream_len_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, _impl_.topic_),
+  PROTOBUF_FIELD_OFFSET(::tcp_kit::GenericReply, _impl_.seq_),
   ~0u,
   0,
-  1,
   2,
+  3,
+  4,
+  1,
+  5,
 };
 static const ::_pbi::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
   { 0, -1, -1, sizeof(::tcp_kit::GenericReply_BasicType)},
-  { 15, 25, -1, sizeof(::tcp_kit::GenericReply)},
+  { 15, 28, -1, sizeof(::tcp_kit::GenericReply)},
 };
 
 static const ::_pb::Message* const file_default_instances[] = {
@@ -97,25 +109,28 @@ static const ::_pb::Message* const file_default_instances[] = {
 
 const char descriptor_table_protodef_generic_5freply_2eproto[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) =
   "\n\023generic_reply.proto\022\007tcp_kit\032\031google/p"
-  "rotobuf/any.proto\"\257\003\n\014GenericReply\022(\n\004co"
+  "rotobuf/any.proto\"\256\004\n\014GenericReply\022(\n\004co"
   "de\030\001 \001(\0162\032.tcp_kit.GenericReply.Code\022\020\n\003"
   "msg\030\002 \001(\tH\000\210\001\001\0224\n\006result\030\003 \001(\0132\037.tcp_kit"
   ".GenericReply.BasicTypeH\001\210\001\001\022\'\n\004body\030\004 \001"
-  "(\0132\024.google.protobuf.AnyH\002\210\001\001\032\206\001\n\tBasicT"
-  "ype\022\r\n\003u32\030\001 \001(\rH\000\022\r\n\003s32\030\002 \001(\005H\000\022\r\n\003u64"
-  "\030\003 \001(\004H\000\022\r\n\003s64\030\004 \001(\003H\000\022\013\n\001f\030\005 \001(\002H\000\022\013\n\001"
-  "d\030\006 \001(\001H\000\022\013\n\001b\030\007 \001(\010H\000\022\r\n\003str\030\010 \001(\tH\000B\007\n"
-  "\005value\"_\n\004Code\022\017\n\013UNKNOWN_ERR\020\000\022\014\n\007SUCCE"
-  "SS\020\310\001\022\022\n\rRES_NOT_FOUND\020\224\003\022\030\n\023INTERNAL_SE"
-  "RVER_ERR\020\364\003\022\n\n\005ERROR\020\371\003B\006\n\004_msgB\t\n\007_resu"
-  "ltB\007\n\005_bodyb\006proto3"
+  "(\0132\024.google.protobuf.AnyH\002\210\001\001\022\027\n\nstream_"
+  "len\030\005 \001(\004H\003\210\001\001\022\022\n\005topic\030\006 \001(\tH\004\210\001\001\022\020\n\003se"
+  "q\030\007 \001(\004H\005\210\001\001\032\206\001\n\tBasicType\022\r\n\003u32\030\001 \001(\rH"
+  "\000\022\r\n\003s32\030\002 \001(\005H\000\022\r\n\003u64\030\003 \001(\004H\000\022\r\n\003s64\030\004"
+  " \001(\003H\000\022\013\n\001f\030\005 \001(\002H\000\022\013\n\001d\030\006 \001(\001H\000\022\013\n\001b\030\007 "
+  "\001(\010H\000\022\r\n\003str\030\010 \001(\tH\000B\007\n\005value\"~\n\004Code\022\017\n"
+  "\013UNKNOWN_ERR\020\000\022\014\n\007SUCCESS\020\310\001\022\022\n\rRES_NOT_"
+  "FOUND\020\224\003\022\014\n\007TIMEOUT\020\230\003\022\030\n\023INTERNAL_SERVE"
+  "R_ERR\020\364\003\022\017\n\nOVERLOADED\020\367\003\022\n\n\005ERROR\020\371\003B\006\n"
+  "\004_msgB\t\n\007_resultB\007\n\005_bodyB\r\n\013_stream_len"
+  "B\010\n\006_topicB\006\n\004_seqb\006proto3"
   ;
 static const ::_pbi::DescriptorTable* const descriptor_table_generic_5freply_2eproto_deps[1] = {
   &::descriptor_table_google_2fprotobuf_2fany_2eproto,
 };
 static ::_pbi::once_flag descriptor_table_generic_5freply_2eproto_once;
 const ::_pbi::DescriptorTable descriptor_table_generic_5freply_2eproto = {
-    false, false, 499, descriptor_table_protodef_generic_5freply_2eproto,
+    false, false, 626, descriptor_table_protodef_generic_5freply_2eproto,
     "generic_reply.proto",
     &descriptor_table_generic_5freply_2eproto_once, descriptor_table_generic_5freply_2eproto_deps, 1, 2,
     schemas, file_default_instances, TableStruct_generic_5freply_2eproto::offsets,
@@ -138,7 +153,9 @@ bool GenericReply_Code_IsValid(int value) {
     case 0:
     case 200:
     case 404:
+    case 408:
     case 500:
+    case 503:
     case 505:
       return true;
     default:
@@ -150,7 +167,9 @@ bool GenericReply_Code_IsValid(int value) {
 constexpr GenericReply_Code GenericReply::UNKNOWN_ERR;
 constexpr GenericReply_Code GenericReply::SUCCESS;
 constexpr GenericReply_Code GenericReply::RES_NOT_FOUND;
+constexpr GenericReply_Code GenericReply::TIMEOUT;
 constexpr GenericReply_Code GenericReply::INTERNAL_SERVER_ERR;
+constexpr GenericReply_Code GenericReply::OVERLOADED;
 constexpr GenericReply_Code GenericReply::ERROR;
 constexpr GenericReply_Code GenericReply::Code_MIN;
 constexpr GenericReply_Code GenericReply::Code_MAX;
@@ -166,44 +185,50 @@ class GenericReply_BasicType::_Internal {
 GenericReply_BasicType::GenericReply_BasicType(::PROTOBUF_NAMESPACE_ID::Arena* arena,
                          bool is_message_owned)
   : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
-  SharedCtor();
+  SharedCtor(arena, is_message_owned);
   // @@protoc_insertion_point(arena_constructor:tcp_kit.GenericReply.BasicType)
 }
 GenericReply_BasicType::GenericReply_BasicType(const GenericReply_BasicType& from)
   : ::PROTOBUF_NAMESPACE_ID::Message() {
+  GenericReply_BasicType* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_.value_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , /*decltype(_impl_._oneof_case_)*/{}};
+
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
   clear_has_value();
   switch (from.value_case()) {
     case kU32: {
-      _internal_set_u32(from._internal_u32());
+      _this->_internal_set_u32(from._internal_u32());
       break;
     }
     case kS32: {
-      _internal_set_s32(from._internal_s32());
+      _this->_internal_set_s32(from._internal_s32());
       break;
     }
     case kU64: {
-      _internal_set_u64(from._internal_u64());
+      _this->_internal_set_u64(from._internal_u64());
       break;
     }
     case kS64: {
-      _internal_set_s64(from._internal_s64());
+      _this->_internal_set_s64(from._internal_s64());
       break;
     }
     case kF: {
-      _internal_set_f(from._internal_f());
+      _this->_internal_set_f(from._internal_f());
       break;
     }
     case kD: {
-      _internal_set_d(from._internal_d());
+      _this->_internal_set_d(from._internal_d());
       break;
     }
     case kB: {
-      _internal_set_b(from._internal_b());
+      _this->_internal_set_b(from._internal_b());
       break;
     }
     case kStr: {
-      _internal_set_str(from._internal_str());
+      _this->_internal_set_str(from._internal_str());
       break;
     }
     case VALUE_NOT_SET: {
@@ -213,8 +238,16 @@ GenericReply_BasicType::GenericReply_BasicType(const GenericReply_BasicType& fro
   // @@protoc_insertion_point(copy_constructor:tcp_kit.GenericReply.BasicType)
 }
 
-inline void GenericReply_BasicType::SharedCtor() {
-clear_has_value();
+inline void GenericReply_BasicType::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_.value_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , /*decltype(_impl_._oneof_case_)*/{}
+  };
+  clear_has_value();
 }
 
 GenericReply_BasicType::~GenericReply_BasicType() {
@@ -234,7 +267,7 @@ inline void GenericReply_BasicType::SharedDtor() {
 }
 
 void GenericReply_BasicType::SetCachedSize(int size) const {
-  _cached_size_.Set(size);
+  _impl_._cached_size_.Set(size);
 }
 
 void GenericReply_BasicType::clear_value() {
@@ -269,14 +302,14 @@ void GenericReply_BasicType::clear_value() {
       break;
     }
     case kStr: {
-      value_.str_.Destroy();
+      _impl_.value_.str_.Destroy();
       break;
     }
     case VALUE_NOT_SET: {
       break;
     }
   }
-  _oneof_case_[0] = VALUE_NOT_SET;
+  _impl_._oneof_case_[0] = VALUE_NOT_SET;
 }
 
 
@@ -506,66 +539,62 @@ size_t GenericReply_BasicType::ByteSizeLong() const {
       break;
     }
   }
-  return MaybeComputeUnknownFieldsSize(total_size, &_cached_size_);
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
 }
 
 const ::PROTOBUF_NAMESPACE_ID::Message::ClassData GenericReply_BasicType::_class_data_ = {
-    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSizeCheck,
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
     GenericReply_BasicType::MergeImpl
 };
 const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GenericReply_BasicType::GetClassData() const { return &_class_data_; }
 
-void GenericReply_BasicType::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message* to,
-                      const ::PROTOBUF_NAMESPACE_ID::Message& from) {
-  static_cast<GenericReply_BasicType *>(to)->MergeFrom(
-      static_cast<const GenericReply_BasicType &>(from));
-}
-
 
-void GenericReply_BasicType::MergeFrom(const GenericReply_BasicType& from) {
-// @@protoc_insertion_point(class_specific_merge_from_start:tcp_kit.GenericReply.BasicType)
-  GOOGLE_DCHECK_NE(&from, this);
+void GenericReply_BasicType::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<GenericReply_BasicType*>(&to_msg);
+  auto& from = static_cast<const GenericReply_BasicType&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:tcp_kit.GenericReply.BasicType)
+  GOOGLE_DCHECK_NE(&from, _this);
   uint32_t cached_has_bits = 0;
   (void) cached_has_bits;
 
   switch (from.value_case()) {
     case kU32: {
-      _internal_set_u32(from._internal_u32());
+      _this->_internal_set_u32(from._internal_u32());
       break;
     }
     case kS32: {
-      _internal_set_s32(from._internal_s32());
+      _this->_internal_set_s32(from._internal_s32());
       break;
     }
     case kU64: {
-      _internal_set_u64(from._internal_u64());
+      _this->_internal_set_u64(from._internal_u64());
       break;
     }
     case kS64: {
-      _internal_set_s64(from._internal_s64());
+      _this->_internal_set_s64(from._internal_s64());
       break;
     }
     case kF: {
-      _internal_set_f(from._internal_f());
+      _this->_internal_set_f(from._internal_f());
       break;
     }
     case kD: {
-      _internal_set_d(from._internal_d());
+      _this->_internal_set_d(from._internal_d());
       break;
     }
     case kB: {
-      _internal_set_b(from._internal_b());
+      _this->_internal_set_b(from._internal_b());
       break;
     }
     case kStr: {
-      _internal_set_str(from._internal_str());
+      _this->_internal_set_str(from._internal_str());
       break;
     }
     case VALUE_NOT_SET: {
       break;
     }
   }
-  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
 }
 
 void GenericReply_BasicType::CopyFrom(const GenericReply_BasicType& from) {
@@ -582,8 +611,8 @@ bool GenericReply_BasicType::IsInitialized() const {
 void GenericReply_BasicType::InternalSwap(GenericReply_BasicType* other) {
   using std::swap;
   _internal_metadata_.InternalSwap(&other->_internal_metadata_);
-  swap(value_, other->value_);
-  swap(_oneof_case_[0], other->_oneof_case_[0]);
+  swap(_impl_.value_, other->_impl_.value_);
+  swap(_impl_._oneof_case_[0], other->_impl_._oneof_case_[0]);
 }
 
 ::PROTOBUF_NAMESPACE_ID::Metadata GenericReply_BasicType::GetMetadata() const {
@@ -596,73 +625,113 @@ void GenericReply_BasicType::InternalSwap(GenericReply_BasicType* other) {
 
 class GenericReply::_Internal {
  public:
-  using HasBits = decltype(std::declval<GenericReply>()._has_bits_);
+  using HasBits = decltype(std::declval<GenericReply>()._impl_._has_bits_);
   static void set_has_msg(HasBits* has_bits) {
     (*has_bits)[0] |= 1u;
   }
   static const ::tcp_kit::GenericReply_BasicType& result(const GenericReply* msg);
   static void set_has_result(HasBits* has_bits) {
-    (*has_bits)[0] |= 2u;
+    (*has_bits)[0] |= 4u;
   }
   static const ::PROTOBUF_NAMESPACE_ID::Any& body(const GenericReply* msg);
   static void set_has_body(HasBits* has_bits) {
-    (*has_bits)[0] |= 4u;
+    (*has_bits)[0] |= 8u;
+  }
+  static void set_has_stream_len(HasBits* has_bits) {
+    (*has_bits)[0] |= 16u;
+  }
+  static void set_has_topic(HasBits* has_bits) {
+    (*has_bits)[0] |= 2u;
+  }
+  static void set_has_seq(HasBits* has_bits) {
+    (*has_bits)[0] |= 32u;
   }
 };
 
 const ::tcp_kit::GenericReply_BasicType&
 GenericReply::_Internal::result(const GenericReply* msg) {
-  return *msg->result_;
+  return *msg->_impl_.result_;
 }
 const ::PROTOBUF_NAMESPACE_ID::Any&
 GenericReply::_Internal::body(const GenericReply* msg) {
-  return *msg->body_;
+  return *msg->_impl_.body_;
 }
 void GenericReply::clear_body() {
-  if (body_ != nullptr) body_->Clear();
-  _has_bits_[0] &= ~0x00000004u;
+  if (_impl_.body_ != nullptr) _impl_.body_->Clear();
+  _impl_._has_bits_[0] &= ~0x00000008u;
 }
 GenericReply::GenericReply(::PROTOBUF_NAMESPACE_ID::Arena* arena,
                          bool is_message_owned)
   : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
-  SharedCtor();
+  SharedCtor(arena, is_message_owned);
   // @@protoc_insertion_point(arena_constructor:tcp_kit.GenericReply)
 }
 GenericReply::GenericReply(const GenericReply& from)
-  : ::PROTOBUF_NAMESPACE_ID::Message(),
-      _has_bits_(from._has_bits_) {
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  GenericReply* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){from._impl_._has_bits_}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.msg_){}
+    , decltype(_impl_.topic_){}
+    , decltype(_impl_.result_){nullptr}
+    , decltype(_impl_.body_){nullptr}
+    , decltype(_impl_.stream_len_){}
+    , decltype(_impl_.seq_){}
+    , decltype(_impl_.code_){}};
+
   _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
-  msg_.InitDefault();
+  _impl_.msg_.InitDefault();
   #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
-    msg_.Set("", GetArenaForAllocation());
+    _impl_.msg_.Set("", GetArenaForAllocation());
   #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
   if (from._internal_has_msg()) {
-    msg_.Set(from._internal_msg(), 
-      GetArenaForAllocation());
+    _this->_impl_.msg_.Set(from._internal_msg(), 
+      _this->GetArenaForAllocation());
+  }
+  _impl_.topic_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.topic_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (from._internal_has_topic()) {
+    _this->_impl_.topic_.Set(from._internal_topic(), 
+      _this->GetArenaForAllocation());
   }
   if (from._internal_has_result()) {
-    result_ = new ::tcp_kit::GenericReply_BasicType(*from.result_);
-  } else {
-    result_ = nullptr;
+    _this->_impl_.result_ = new ::tcp_kit::GenericReply_BasicType(*from._impl_.result_);
   }
   if (from._internal_has_body()) {
-    body_ = new ::PROTOBUF_NAMESPACE_ID::Any(*from.body_);
-  } else {
-    body_ = nullptr;
+    _this->_impl_.body_ = new ::PROTOBUF_NAMESPACE_ID::Any(*from._impl_.body_);
   }
-  code_ = from.code_;
+  ::memcpy(&_impl_.stream_len_, &from._impl_.stream_len_,
+    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.code_) -
+    reinterpret_cast<char*>(&_impl_.stream_len_)) + sizeof(_impl_.code_));
   // @@protoc_insertion_point(copy_constructor:tcp_kit.GenericReply)
 }
 
-inline void GenericReply::SharedCtor() {
-msg_.InitDefault();
-#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
-  msg_.Set("", GetArenaForAllocation());
-#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
-::memset(reinterpret_cast<char*>(this) + static_cast<size_t>(
-    reinterpret_cast<char*>(&result_) - reinterpret_cast<char*>(this)),
-    0, static_cast<size_t>(reinterpret_cast<char*>(&code_) -
-    reinterpret_cast<char*>(&result_)) + sizeof(code_));
+inline void GenericReply::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.msg_){}
+    , decltype(_impl_.topic_){}
+    , decltype(_impl_.result_){nullptr}
+    , decltype(_impl_.body_){nullptr}
+    , decltype(_impl_.stream_len_){uint64_t{0u}}
+    , decltype(_impl_.seq_){uint64_t{0u}}
+    , decltype(_impl_.code_){0}
+  };
+  _impl_.msg_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.msg_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  _impl_.topic_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.topic_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
 }
 
 GenericReply::~GenericReply() {
@@ -676,13 +745,14 @@ GenericReply::~GenericReply() {
 
 inline void GenericReply::SharedDtor() {
   GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
-  msg_.Destroy();
-  if (this != internal_default_instance()) delete result_;
-  if (this != internal_default_instance()) delete body_;
+  _impl_.msg_.Destroy();
+  _impl_.topic_.Destroy();
+  if (this != internal_default_instance()) delete _impl_.result_;
+  if (this != internal_default_instance()) delete _impl_.body_;
 }
 
 void GenericReply::SetCachedSize(int size) const {
-  _cached_size_.Set(size);
+  _impl_._cached_size_.Set(size);
 }
 
 void GenericReply::Clear() {
@@ -691,22 +761,30 @@ void GenericReply::Clear() {
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
-  cached_has_bits = _has_bits_[0];
-  if (cached_has_bits & 0x00000007u) {
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x0000000fu) {
     if (cached_has_bits & 0x00000001u) {
-      msg_.ClearNonDefaultToEmpty();
+      _impl_.msg_.ClearNonDefaultToEmpty();
     }
     if (cached_has_bits & 0x00000002u) {
-      GOOGLE_DCHECK(result_ != nullptr);
-      result_->Clear();
+      _impl_.topic_.ClearNonDefaultToEmpty();
     }
     if (cached_has_bits & 0x00000004u) {
-      GOOGLE_DCHECK(body_ != nullptr);
-      body_->Clear();
+      GOOGLE_DCHECK(_impl_.result_ != nullptr);
+      _impl_.result_->Clear();
+    }
+    if (cached_has_bits & 0x00000008u) {
+      GOOGLE_DCHECK(_impl_.body_ != nullptr);
+      _impl_.body_->Clear();
     }
   }
-  code_ = 0;
-  _has_bits_.Clear();
+  if (cached_has_bits & 0x00000030u) {
+    ::memset(&_impl_.stream_len_, 0, static_cast<size_t>(
+        reinterpret_cast<char*>(&_impl_.seq_) -
+        reinterpret_cast<char*>(&_impl_.stream_len_)) + sizeof(_impl_.seq_));
+  }
+  _impl_.code_ = 0;
+  _impl_._has_bits_.Clear();
   _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
 }
 
@@ -752,6 +830,34 @@ const char* GenericReply::_InternalParse(const char* ptr, ::_pbi::ParseContext*
         } else
           goto handle_unusual;
         continue;
+      // optional uint64 stream_len = 5;
+      case 5:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 40)) {
+          _Internal::set_has_stream_len(&has_bits);
+          _impl_.stream_len_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional string topic = 6;
+      case 6:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 50)) {
+          auto str = _internal_mutable_topic();
+          ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
+          CHK_(ptr);
+          CHK_(::_pbi::VerifyUTF8(str, "tcp_kit.GenericReply.topic"));
+        } else
+          goto handle_unusual;
+        continue;
+      // optional uint64 seq = 7;
+      case 7:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 56)) {
+          _Internal::set_has_seq(&has_bits);
+          _impl_.seq_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
       default:
         goto handle_unusual;
     }  // switch
@@ -768,7 +874,7 @@ const char* GenericReply::_InternalParse(const char* ptr, ::_pbi::ParseContext*
     CHK_(ptr != nullptr);
   }  // while
 message_done:
-  _has_bits_.Or(has_bits);
+  _impl_._has_bits_.Or(has_bits);
   return ptr;
 failure:
   ptr = nullptr;
@@ -813,6 +919,28 @@ uint8_t* GenericReply::_InternalSerialize(
         _Internal::body(this).GetCachedSize(), target, stream);
   }
 
+  // optional uint64 stream_len = 5;
+  if (_internal_has_stream_len()) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt64ToArray(5, this->_internal_stream_len(), target);
+  }
+
+  // optional string topic = 6;
+  if (_internal_has_topic()) {
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::VerifyUtf8String(
+      this->_internal_topic().data(), static_cast<int>(this->_internal_topic().length()),
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::SERIALIZE,
+      "tcp_kit.GenericReply.topic");
+    target = stream->WriteStringMaybeAliased(
+        6, this->_internal_topic(), target);
+  }
+
+  // optional uint64 seq = 7;
+  if (_internal_has_seq()) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteUInt64ToArray(7, this->_internal_seq(), target);
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
         _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
@@ -829,8 +957,8 @@ size_t GenericReply::ByteSizeLong() const {
   // Prevent compiler warnings about cached_has_bits being unused
   (void) cached_has_bits;
 
-  cached_has_bits = _has_bits_[0];
-  if (cached_has_bits & 0x00000007u) {
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x0000003fu) {
     // optional string msg = 2;
     if (cached_has_bits & 0x00000001u) {
       total_size += 1 +
@@ -838,18 +966,35 @@ size_t GenericReply::ByteSizeLong() const {
           this->_internal_msg());
     }
 
-    // optional .tcp_kit.GenericReply.BasicType result = 3;
+    // optional string topic = 6;
     if (cached_has_bits & 0x00000002u) {
+      total_size += 1 +
+        ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
+          this->_internal_topic());
+    }
+
+    // optional .tcp_kit.GenericReply.BasicType result = 3;
+    if (cached_has_bits & 0x00000004u) {
       total_size += 1 +
         ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(
-          *result_);
+          *_impl_.result_);
     }
 
     // optional .google.protobuf.Any body = 4;
-    if (cached_has_bits & 0x00000004u) {
+    if (cached_has_bits & 0x00000008u) {
       total_size += 1 +
         ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(
-          *body_);
+          *_impl_.body_);
+    }
+
+    // optional uint64 stream_len = 5;
+    if (cached_has_bits & 0x00000010u) {
+      total_size += ::_pbi::WireFormatLite::UInt64SizePlusOne(this->_internal_stream_len());
+    }
+
+    // optional uint64 seq = 7;
+    if (cached_has_bits & 0x00000020u) {
+      total_size += ::_pbi::WireFormatLite::UInt64SizePlusOne(this->_internal_seq());
     }
 
   }
@@ -859,44 +1004,52 @@ size_t GenericReply::ByteSizeLong() const {
       ::_pbi::WireFormatLite::EnumSize(this->_internal_code());
   }
 
-  return MaybeComputeUnknownFieldsSize(total_size, &_cached_size_);
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
 }
 
 const ::PROTOBUF_NAMESPACE_ID::Message::ClassData GenericReply::_class_data_ = {
-    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSizeCheck,
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
     GenericReply::MergeImpl
 };
 const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GenericReply::GetClassData() const { return &_class_data_; }
 
-void GenericReply::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message* to,
-                      const ::PROTOBUF_NAMESPACE_ID::Message& from) {
-  static_cast<GenericReply *>(to)->MergeFrom(
-      static_cast<const GenericReply &>(from));
-}
-
 
-void GenericReply::MergeFrom(const GenericReply& from) {
-// @@protoc_insertion_point(class_specific_merge_from_start:tcp_kit.GenericReply)
-  GOOGLE_DCHECK_NE(&from, this);
+void GenericReply::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<GenericReply*>(&to_msg);
+  auto& from = static_cast<const GenericReply&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:tcp_kit.GenericReply)
+  GOOGLE_DCHECK_NE(&from, _this);
   uint32_t cached_has_bits = 0;
   (void) cached_has_bits;
 
-  cached_has_bits = from._has_bits_[0];
-  if (cached_has_bits & 0x00000007u) {
+  cached_has_bits = from._impl_._has_bits_[0];
+  if (cached_has_bits & 0x0000003fu) {
     if (cached_has_bits & 0x00000001u) {
-      _internal_set_msg(from._internal_msg());
+      _this->_internal_set_msg(from._internal_msg());
     }
     if (cached_has_bits & 0x00000002u) {
-      _internal_mutable_result()->::tcp_kit::GenericReply_BasicType::MergeFrom(from._internal_result());
+      _this->_internal_set_topic(from._internal_topic());
     }
     if (cached_has_bits & 0x00000004u) {
-      _internal_mutable_body()->::PROTOBUF_NAMESPACE_ID::Any::MergeFrom(from._internal_body());
+      _this->_internal_mutable_result()->::tcp_kit::GenericReply_BasicType::MergeFrom(
+          from._internal_result());
+    }
+    if (cached_has_bits & 0x00000008u) {
+      _this->_internal_mutable_body()->::PROTOBUF_NAMESPACE_ID::Any::MergeFrom(
+          from._internal_body());
+    }
+    if (cached_has_bits & 0x00000010u) {
+      _this->_impl_.stream_len_ = from._impl_.stream_len_;
     }
+    if (cached_has_bits & 0x00000020u) {
+      _this->_impl_.seq_ = from._impl_.seq_;
+    }
+    _this->_impl_._has_bits_[0] |= cached_has_bits;
   }
   if (from._internal_code() != 0) {
-    _internal_set_code(from._internal_code());
+    _this->_internal_set_code(from._internal_code());
   }
-  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
 }
 
 void GenericReply::CopyFrom(const GenericReply& from) {
@@ -915,17 +1068,21 @@ void GenericReply::InternalSwap(GenericReply* other) {
   auto* lhs_arena = GetArenaForAllocation();
   auto* rhs_arena = other->GetArenaForAllocation();
   _internal_metadata_.InternalSwap(&other->_internal_metadata_);
-  swap(_has_bits_[0], other->_has_bits_[0]);
+  swap(_impl_._has_bits_[0], other->_impl_._has_bits_[0]);
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
+      &_impl_.msg_, lhs_arena,
+      &other->_impl_.msg_, rhs_arena
+  );
   ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
-      &msg_, lhs_arena,
-      &other->msg_, rhs_arena
+      &_impl_.topic_, lhs_arena,
+      &other->_impl_.topic_, rhs_arena
   );
   ::PROTOBUF_NAMESPACE_ID::internal::memswap<
-      PROTOBUF_FIELD_OFFSET(GenericReply, code_)
-      + sizeof(GenericReply::code_)
-      - PROTOBUF_FIELD_OFFSET(GenericReply, result_)>(
-          reinterpret_cast<char*>(&result_),
-          reinterpret_cast<char*>(&other->result_));
+      PROTOBUF_FIELD_OFFSET(GenericReply, _impl_.code_)
+      + sizeof(GenericReply::_impl_.code_)
+      - PROTOBUF_FIELD_OFFSET(GenericReply, _impl_.result_)>(
+          reinterpret_cast<char*>(&_impl_.result_),
+          reinterpret_cast<char*>(&other->_impl_.result_));
 }
 
 ::PROTOBUF_NAMESPACE_ID::Metadata GenericReply::GetMetadata() const {
@@ -11,10 +11,10 @@ namespace tcp_kit {
     class lock_free_queue_nb {
     private:
         struct node;
+        // 不能有填充字节: compare_exchange 按字节比较, 未初始化的填充会导致比较失败
         struct counted_node_ptr {
-            int     external_count;
-            node*   ptr;
-            uint8_t padding[sizeof(void *) - sizeof(int)];
+            intptr_t external_count;
+            node*    ptr;
         };
 
         std::atomic<counted_node_ptr> _head;
@@ -38,7 +38,7 @@ namespace tcp_kit {
             std::atomic<node_counter> count;
             std::atomic<counted_node_ptr> next;
 
-            node(): data({nullptr, false, {0}}), count({0, 2}), next({0, nullptr, {0}}) {}
+            node(): data({nullptr, false, {0}}), count({0, 2}), next({0, nullptr}) {}
 
             void release_ref() {
                 node_counter old_counter = count.load(std::memory_order_relaxed);
@@ -111,17 +111,17 @@ namespace tcp_kit {
         }
 
     public:
-        lock_free_queue_nb(): _count(0), _head({1, new node, {0}}), _tail(_head.load()) {}
+        lock_free_queue_nb(): _count(0), _head({1, new node}), _tail(_head.load()) {}
 
         void push(T new_value) {
             std::unique_ptr<T> new_data(new T(new_value));
-            counted_node_ptr new_next{1, new node, {0}};
+            counted_node_ptr new_next{1, new node};
             counted_node_ptr old_tail = _tail.load();
             for (;;) {
                 increase_external_count(_tail, old_tail);
                 // T *old_data = nullptr;
                 if (/*old_tail.ptr->data.compare_exchange_strong(old_data, new_data.get())*/ old_tail.ptr->set_data(new_data.get())) { // 如果在这里执行之前另一个线程入队又另一个线程出队，又将 data 指针改为 nullptr, 导致 ABA 问题发生
-                    counted_node_ptr old_next{0, nullptr, {0}};
+                    counted_node_ptr old_next{0, nullptr};
                     if (!old_tail.ptr->next.compare_exchange_strong(old_next, new_next)) {
                         delete new_next.ptr;
                         new_next = old_next;
@@ -132,7 +132,7 @@ namespace tcp_kit {
                     new_data.release();
                     break;
                 } else {
-                    counted_node_ptr old_next{0, nullptr, {0}};
+                    counted_node_ptr old_next{0, nullptr};
                     if (old_tail.ptr->next.compare_exchange_strong(old_next, new_next)) {
                         old_next = new_next;
                         new_next.ptr = new node;
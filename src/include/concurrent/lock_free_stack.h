@@ -8,9 +8,10 @@ namespace tcp_kit {
     class lock_free_stack {
     private:
         struct node;
+        // 不能有填充字节: compare_exchange 按字节比较, 未初始化的填充会导致比较失败
         struct counted_node_ptr {
-            int   external_count;
-            node* ptr;
+            intptr_t external_count;
+            node*    ptr;
         };
 
         struct node {
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+
+namespace tcp_kit {
+
+    // 侵入式多生产者单消费者队列, T 需要有成员 T *next
+    // 生产者以 CAS 压入链表头部, 消费者一次取走整个链表并反转为入队顺序, 入队与出队都不会阻塞.
+    // 不实现 queue<T> 接口: 消费者不逐个弹出也不等待, 而是在被通知后(如事件回调中)批量处理
+    template<typename T>
+    class mpsc_queue {
+
+    public:
+        mpsc_queue(): _head(nullptr) {}
+
+        // 返回入队前队列是否为空, 为 true 时由该生产者负责通知消费者
+        bool push(T *node) {
+            T *old = _head.load(std::memory_order_relaxed);
+            do {
+                node->next = old;
+            } while(!_head.compare_exchange_weak(old, node, std::memory_order_release, std::memory_order_relaxed));
+            return old == nullptr;
+        }
+
+        // 取走所有节点, 按入队顺序以链表返回, 队列为空时返回 nullptr
+        T *pop_all() {
+            T *node = _head.exchange(nullptr, std::memory_order_acquire);
+            T *ordered = nullptr;
+            while(node) {
+                T *next = node->next;
+                node->next = ordered;
+                ordered = node;
+                node = next;
+            }
+            return ordered;
+        }
+
+        mpsc_queue(const mpsc_queue&) = delete;
+        mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+    private:
+        std::atomic<T*> _head;
+
+    };
+
+}
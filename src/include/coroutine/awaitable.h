@@ -0,0 +1,142 @@
+#pragma once
+
+#include <coroutine/task.h>
+
+#if TCP_KIT_COROUTINES
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <network/server.h>
+#include <thread/thread_pool.h>
+
+namespace tcp_kit {
+
+    // 以下可等待对象只能在处理请求的协程(api 处理器返回的 task 及其 await 的 task)中使用. 挂起期间 handler 线程
+    // 继续处理其他消息, 恢复总是经由 ev_handler 回到原来的 handler 线程, 不会在其他线程中执行协程
+
+    // 挂起当前请求 duration 后恢复, 精度为时间轮的 tick(TIMING_WHEEL_TICK_MS)
+    struct sleep_awaiter {
+        uint32_t delay_ms;
+
+        bool await_ready() { return false; }
+
+        template<typename P>
+        void await_suspend(std::coroutine_handle<P> h) {
+            msg_context *ctx = h.promise().ctx;
+            suspend_request(h);
+            ctx->ev_handler->resume(ctx, delay_ms);
+        }
+
+        void await_resume() { }
+    };
+
+    template<typename Rep, typename Period>
+    inline sleep_awaiter sleep_for(std::chrono::duration<Rep, Period> duration) {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+        return sleep_awaiter{ms > 0 ? static_cast<uint32_t>(ms) : 0};
+    }
+
+    // 在线程池中执行 fn, 完成后以其返回值恢复, fn 抛出的异常在 co_await 处重新抛出
+    template<typename Fn>
+    class offload_awaiter {
+
+    public:
+        using result_type = std::invoke_result_t<Fn>;
+
+        offload_awaiter(thread_pool &pool, Fn fn): _pool(pool), _fn(std::move(fn)) { }
+
+        bool await_ready() { return false; }
+
+        template<typename P>
+        void await_suspend(std::coroutine_handle<P> h) {
+            msg_context *ctx = h.promise().ctx;
+            suspend_request(h);
+            try {
+                _pool.execute([this, ctx] {
+                    try {
+                        if constexpr (std::is_void<result_type>::value)
+                            _fn();
+                        else
+                            _result.emplace(_fn());
+                    } catch (...) {
+                        _error = std::current_exception();
+                    }
+                    ctx->ev_handler->resume(ctx);
+                });
+            } catch (...) {
+                ctx->resume = nullptr;
+                throw;
+            }
+        }
+
+        result_type await_resume() {
+            if(_error)
+                std::rethrow_exception(_error);
+            if constexpr (!std::is_void<result_type>::value)
+                return std::move(*_result);
+        }
+
+    private:
+        using storage_t = typename std::conditional<std::is_void<result_type>::value, bool, result_type>::type;
+
+        thread_pool               &_pool;
+        Fn                         _fn;
+        std::optional<storage_t>   _result;
+        std::exception_ptr         _error;
+
+    };
+
+    template<typename Fn>
+    inline offload_awaiter<Fn> offload(thread_pool &pool, Fn fn) {
+        return offload_awaiter<Fn>(pool, std::move(fn));
+    }
+
+    // 等待一个以回调给出结果的异步操作(如 tcp_kit 客户端的异步调用、其他库的异步接口). start 被立即调用并收到一个
+    // std::function<void(T)> 回调, 回调可以在任意线程中调用且只能调用一次:
+    //
+    // std::string value = co_await async_call<std::string>([key](std::function<void(std::string)> cb) {
+    //     cache.async_get(key, std::move(cb));
+    // });
+    template<typename T, typename Start>
+    class callback_awaiter {
+
+    public:
+        explicit callback_awaiter(Start start): _start(std::move(start)) { }
+
+        bool await_ready() { return false; }
+
+        template<typename P>
+        void await_suspend(std::coroutine_handle<P> h) {
+            msg_context *ctx = h.promise().ctx;
+            suspend_request(h);
+            try {
+                _start(std::function<void(T)>([this, ctx](T value) {
+                    _value.emplace(std::move(value));
+                    ctx->ev_handler->resume(ctx);
+                }));
+            } catch (...) {
+                ctx->resume = nullptr;
+                throw;
+            }
+        }
+
+        T await_resume() {
+            return std::move(*_value);
+        }
+
+    private:
+        Start             _start;
+        std::optional<T>  _value;
+
+    };
+
+    template<typename T, typename Start>
+    inline callback_awaiter<T, Start> async_call(Start start) {
+        return callback_awaiter<T, Start>(std::move(start));
+    }
+
+}
+
+#endif
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <type_traits>
+
+namespace tcp_kit {
+
+    template<typename T>
+    struct is_task : std::false_type {};
+
+}
+
+// 协程形式的 api 处理器, 需要以 C++20 编译并定义 TCP_KIT_COROUTINES(CMake 选项 -DTCP_KIT_COROUTINES=ON)
+#if TCP_KIT_COROUTINES
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <stddef.h>
+#include <network/msg_context.h>
+
+// 协程帧池按 FRAME_POOL_GRANULARITY 字节分级, 大于 FRAME_POOL_MAX_FRAME 的帧直接从堆上分配
+#ifndef FRAME_POOL_GRANULARITY
+#define FRAME_POOL_GRANULARITY   64
+#endif
+
+#ifndef FRAME_POOL_MAX_FRAME
+#define FRAME_POOL_MAX_FRAME     2048
+#endif
+
+// 每个线程每一级最多缓存的空闲帧数
+#ifndef FRAME_POOL_MAX_CACHED
+#define FRAME_POOL_MAX_CACHED    4096
+#endif
+
+namespace tcp_kit {
+
+    // 协程帧的分配器, 每个线程一个空闲链表. 协程总是在处理它的 handler 线程中创建、恢复和销毁, 因此帧的分配与回收
+    // 都落在同一个线程的池中, 不需要加锁
+    class frame_pool {
+
+    public:
+        static void *allocate(size_t size);
+        static void deallocate(void *frame, size_t size);
+
+    };
+
+    struct promise_base {
+        msg_context             *ctx = nullptr;   // 所属的请求, 由 await 它的协程传递下来
+        std::coroutine_handle<>  continuation;    // 结束后恢复的协程
+        std::exception_ptr       error;
+
+        static void *operator new(size_t size) { return frame_pool::allocate(size); }
+        static void operator delete(void *frame, size_t size) { frame_pool::deallocate(frame, size); }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct final_awaiter {
+            bool await_ready() noexcept { return false; }
+            template<typename P>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+                std::coroutine_handle<> next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept { }
+        };
+
+        final_awaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    // 惰性启动的协程, 被 co_await 时才开始执行, 结束后以对称转移的方式恢复 await 它的协程:
+    //
+    // svr.api("slow", [](std::string key) -> task<std::string> {
+    //     co_await sleep_for(std::chrono::milliseconds(200));
+    //     std::string value = co_await offload(pool, [key] { return load(key); });
+    //     co_return value;
+    // });
+    //
+    // 处理器返回 task<T> 时, handler 线程在协程第一次挂起后立即处理下一条消息, 协程之后在同一个 handler 线程中恢复,
+    // 结束时以 co_return 的值回复, 抛出异常时以 ERROR 回复
+    // 挂起中的请求仍占用并发限制器与连接的额度, 需要同时处理大量慢请求时相应调高 LIMITER_LATENCY_TARGET_MS、
+    // LIMITER_MAX_LIMIT(或将 LIMITER_INITIAL_LIMIT 设为 0)与 MAX_IN_FLIGHT_PER_CONN
+    template<typename T>
+    class task {
+
+    public:
+        using value_type = T;
+
+        struct promise_type: promise_base {
+            std::optional<T> value;
+
+            task get_return_object() { return task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+            template<typename U>
+            void return_value(U &&v) { value.emplace(std::forward<U>(v)); }
+        };
+
+        task(task &&other) noexcept: _handle(other._handle) { other._handle = nullptr; }
+
+        ~task() {
+            if(_handle)
+                _handle.destroy();
+        }
+
+        struct awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() { return false; }
+
+            template<typename P>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<P> parent) {
+                handle.promise().ctx = parent.promise().ctx;
+                handle.promise().continuation = parent;
+                return handle;
+            }
+
+            T await_resume() {
+                if(handle.promise().error)
+                    std::rethrow_exception(handle.promise().error);
+                return std::move(*handle.promise().value);
+            }
+        };
+
+        awaiter operator co_await() && { return awaiter{_handle}; }
+
+        task(const task&) = delete;
+        task& operator=(const task&) = delete;
+
+    private:
+        std::coroutine_handle<promise_type> _handle;
+
+        explicit task(std::coroutine_handle<promise_type> handle): _handle(handle) { }
+
+    };
+
+    template<>
+    class task<void> {
+
+    public:
+        using value_type = void;
+
+        struct promise_type: promise_base {
+            task get_return_object() { return task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            void return_void() { }
+        };
+
+        task(task &&other) noexcept: _handle(other._handle) { other._handle = nullptr; }
+
+        ~task() {
+            if(_handle)
+                _handle.destroy();
+        }
+
+        struct awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() { return false; }
+
+            template<typename P>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<P> parent) {
+                handle.promise().ctx = parent.promise().ctx;
+                handle.promise().continuation = parent;
+                return handle;
+            }
+
+            void await_resume() {
+                if(handle.promise().error)
+                    std::rethrow_exception(handle.promise().error);
+            }
+        };
+
+        awaiter operator co_await() && { return awaiter{_handle}; }
+
+        task(const task&) = delete;
+        task& operator=(const task&) = delete;
+
+    private:
+        std::coroutine_handle<promise_type> _handle;
+
+        explicit task(std::coroutine_handle<promise_type> handle): _handle(handle) { }
+
+    };
+
+    template<typename T>
+    struct is_task<task<T>> : std::true_type {};
+
+    // 立即开始执行且结束后自行销毁的协程, 由 api_dispatcher 用来驱动处理器返回的 task, 不直接使用.
+    // 第一个参数必须是 msg_context *, 它成为被驱动的 task 所属的请求
+    struct detached {
+        struct promise_type: promise_base {
+            template<typename... Args>
+            promise_type(msg_context *ctx_, Args&&...) { ctx = ctx_; }
+
+            detached get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() { }
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    // 挂起当前请求, 之后通过 ev_handler_base::resume 将它交还给 handler 线程, handler 取出带有 resume 的请求时恢复协程
+    template<typename P>
+    inline void suspend_request(std::coroutine_handle<P> h) {
+        h.promise().ctx->resume = h.address();
+    }
+
+    // 在 handler 线程中恢复挂起的请求
+    inline void resume_request(msg_context *ctx) {
+        void *h = ctx->resume;
+        ctx->resume = nullptr;
+        std::coroutine_handle<>::from_address(h).resume();
+    }
+
+}
+
+#endif
@@ -14,7 +14,12 @@ namespace tcp_kit {
             UNSUPPORTED_TYPE,    // 不支持的类型
             RES_NOT_FOUND,       // 资源不存在
             ILLEGALITY_ARGS,     // 非法参数
-            SERIALIZE_MSG_ERROR  // 序列化消息失败
+            SERIALIZE_MSG_ERROR, // 序列化消息失败
+            OPEN_FILE_FAILED,    // 打开文件失败
+            CALL_FAILED,         // 客户端调用失败(连接失败或服务端回复了错误)
+            TLS_FAILED,          // 创建 TLS 上下文或连接时出错
+            CONNECT_FAILED,      // 挂起的连接未能完成建立(如 TLS 握手失败)
+            COMPRESS_FAILED      // 压缩或解压失败(如对端发送了非法的块)
         };
 
         template<error_flags F>
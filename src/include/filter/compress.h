@@ -0,0 +1,143 @@
+#pragma once
+
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <stdint.h>
+#include <network/ev_context.h>
+
+// 编译时以 TCP_KIT_LZ4 / TCP_KIT_ZSTD 启用对应的编码(需要链接 liblz4 / libzstd), 都未启用时只收发原始块
+
+// 块的最大长度(明文字节). 写出的数据被切分为不超过该长度的块, 每个块单独刷新, 对端收到一个完整的块即可解码
+#ifndef COMPRESS_BLOCK_SIZE
+#define COMPRESS_BLOCK_SIZE        (64 * 1024)
+#endif
+
+// 一次写出的数据小于该长度(字节)时不压缩, 以原始块发送
+#ifndef COMPRESS_MIN_SIZE
+#define COMPRESS_MIN_SIZE          256
+#endif
+
+// 双方都支持两种编码时使用的编码: 2 为 zstd(压缩率更高), 1 为 LZ4(更快)
+#ifndef COMPRESS_PREFERRED
+#define COMPRESS_PREFERRED         2
+#endif
+
+#ifndef COMPRESS_ZSTD_LEVEL
+#define COMPRESS_ZSTD_LEVEL        1
+#endif
+
+// zstd 压缩窗口(2 的幂), 决定每个连接的压缩上下文占用的内存. 解码时接受的窗口不超过 COMPRESS_ZSTD_WINDOW_LOG_MAX
+#ifndef COMPRESS_ZSTD_WINDOW_LOG
+#define COMPRESS_ZSTD_WINDOW_LOG   17
+#endif
+
+#ifndef COMPRESS_ZSTD_WINDOW_LOG_MAX
+#define COMPRESS_ZSTD_WINDOW_LOG_MAX 23
+#endif
+
+// 每个线程为每种上下文保留的空闲数, 连接关闭后其上下文重置并回到池中, 供新连接复用
+#ifndef COMPRESS_POOL_SIZE
+#define COMPRESS_POOL_SIZE         64
+#endif
+
+namespace tcp_kit {
+
+    namespace filters {
+
+        // 块的编码, 同时是握手字节中的位
+        static const uint8_t CODEC_RAW  = 0;
+        static const uint8_t CODEC_LZ4  = 1;
+        static const uint8_t CODEC_ZSTD = 2;
+
+        // 本端支持的编码的位掩码
+        uint8_t supported_codecs();
+
+        // 双方支持的编码中选用的编码, 没有共同的编码时为 CODEC_RAW
+        uint8_t choose_codec(uint8_t peer_codecs);
+
+        // 单向的流式编码器. 块为 1 字节编码 + 3 字节(小端)长度 + 数据. 压缩上下文在编码器的生命周期内保留,
+        // 后面的块可以引用之前的数据, 重复的 protobuf/JSON 消息因此能压缩得更小
+        class block_encoder {
+
+        public:
+            explicit block_encoder(uint8_t codec = CODEC_RAW);
+            ~block_encoder();
+
+            // 改用 codec 编码, 只能从 CODEC_RAW 切换
+            void use(uint8_t codec);
+            uint8_t codec() const;
+
+            // 将 src 中的全部数据编码后追加到 dst, 不足 COMPRESS_MIN_SIZE 时以原始块发送
+            void encode(evbuffer *src, evbuffer *dst);
+
+            block_encoder(const block_encoder&) = delete;
+            block_encoder& operator=(const block_encoder&) = delete;
+
+        private:
+            uint8_t  _codec;
+            void    *_cctx;   // 从池中取得的压缩上下文
+            bool     _begun;  // LZ4 的帧头已写出
+
+            void compress(evbuffer *src, size_t n, evbuffer *dst);
+
+        };
+
+        // 单向的流式解码器, 每种编码的解压上下文在第一次遇到该编码的块时从池中取得
+        class block_decoder {
+
+        public:
+            block_decoder();
+            ~block_decoder();
+
+            // 从 src 中取出完整的块解码后追加到 dst, 不完整的块留在 src 中. 块非法时抛出 generic_error<COMPRESS_FAILED>.
+            // 返回是否取出了块
+            bool decode(evbuffer *src, evbuffer *dst);
+
+            block_decoder(const block_decoder&) = delete;
+            block_decoder& operator=(const block_decoder&) = delete;
+
+        private:
+            void *_lz4;
+            void *_zstd;
+
+            void decompress(uint8_t codec, evbuffer *src, size_t n, evbuffer *dst);
+
+        };
+
+        // 一个连接两个方向上的压缩. 每一端写出的第一个字节是本端支持的编码的位掩码(握手字节), 收到对端的握手字节之前以
+        // 原始块写出, 之后改用双方都支持的编码. 因此双方都不需要等待握手, 对端不支持压缩时仍可以通信
+        class compress_session {
+
+        public:
+            compress_session();
+
+            // 将 src 中的全部明文编码后追加到 dst
+            void encode(evbuffer *src, evbuffer *dst);
+
+            // 从 src 中解码完整的块追加到 dst, 返回是否取出了数据
+            bool decode(evbuffer *src, evbuffer *dst);
+
+            // 本端写出时使用的编码
+            uint8_t codec() const;
+
+        private:
+            bool          _hello_sent;
+            bool          _peer_known;
+            block_encoder _encoder;
+            block_decoder _decoder;
+
+        };
+
+        // 压缩过滤器(Read/Write Filter). 每个连接一个 compress_session, 由 ev_handler 线程持有, 连接关闭时释放.
+        // 它应是第一个注册的读写过滤器(最靠近 socket), 与 tls_filter 一起使用时先压缩再加密
+        struct compress_filter {
+            static bufferevent_filter_result read(evbuffer *src, evbuffer *dst, ev_ssize_t dst_limit,
+                                                  bufferevent_flush_mode mode, ev_context *ctx);
+            static bufferevent_filter_result write(evbuffer *src, evbuffer *dst, ev_ssize_t dst_limit,
+                                                   bufferevent_flush_mode mode, ev_context *ctx);
+            static void close(ev_context *ctx);
+        };
+
+    }
+
+}
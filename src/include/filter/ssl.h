@@ -2,44 +2,92 @@
 
 #include <event2/bufferevent_ssl.h>
 #include <openssl/ssl.h>
-#include <openssl/rand.h>
-#include <pthread.h>
-#include "include/network/ev_context.h"
+#include <string>
+#include <network/ev_context.h>
+
+// 证书链与私钥(PEM)的默认路径, 可以在第一个 TLS 连接之前通过 tls_context::configure 修改
+#ifndef TLS_CERT_FILE
+#define TLS_CERT_FILE           "cert.pem"
+#endif
+
+#ifndef TLS_KEY_FILE
+#define TLS_KEY_FILE            "key.pem"
+#endif
+
+// 允许的最低协议版本
+#ifndef TLS_MIN_VERSION
+#define TLS_MIN_VERSION         TLS1_3_VERSION
+#endif
+
+// 所有连接共享的服务端会话缓存的容量, 以及会话(含票据)的有效期(秒)
+#ifndef TLS_SESSION_CACHE_SIZE
+#define TLS_SESSION_CACHE_SIZE  20480
+#endif
+
+#ifndef TLS_SESSION_TIMEOUT_S
+#define TLS_SESSION_TIMEOUT_S   7200
+#endif
+
+// TLS 1.3 握手后发给客户端的会话票据数, 为 0 时不发送票据(仍可以通过 TLS 1.2 的会话缓存恢复)
+#ifndef TLS_TICKETS
+#define TLS_TICKETS             2
+#endif
+
+// 非 0 时在 Linux 上于握手后启用内核 TLS, 记录层的加解密由内核完成. 需要内核提供 tls 模块(modprobe tls)
+// 且 OpenSSL 以 enable-ktls 构建, 不可用时仍由 OpenSSL 在用户态加解密
+#ifndef TLS_ENABLE_KTLS
+#define TLS_ENABLE_KTLS         1
+#endif
+
+// 进行 TLS 握手的 crypto 线程数, 握手(证书签名与密钥交换)在这些线程中进行, 完成后连接交还给接收它的 ev_handler,
+// 握手风暴不会拖慢 ev_handler 上已建立的连接. 为 0 时在 ev_handler 线程中握手
+#ifndef TLS_HANDSHAKE_THREADS
+#define TLS_HANDSHAKE_THREADS   2
+#endif
+
+// 握手的时限(毫秒), 超时的连接以错误关闭
+#ifndef TLS_HANDSHAKE_TIMEOUT_MS
+#define TLS_HANDSHAKE_TIMEOUT_MS 10000
+#endif
 
 namespace tcp_kit {
 
     namespace filters {
 
-        // 依赖于 libevent 提供的 OpenSSL 过滤器实现
+        struct tls_options {
+            std::string cert_file   = TLS_CERT_FILE;
+            std::string key_file    = TLS_KEY_FILE;
+            int         min_version = TLS_MIN_VERSION;
+        };
 
-        class ssl_ctx_guard {
+        // 所有 TLS 连接共享的 SSL_CTX, 会话缓存与票据密钥随之在所有线程的连接间共享. 在第一次使用时按配置创建
+        class tls_context {
 
         public:
-            static ssl_ctx_guard singleton;
-            SSL_CTX* ctx;
-
-            ssl_ctx_guard(const ssl_ctx_guard&) = delete;
-            ssl_ctx_guard(ssl_ctx_guard&&) = delete;
-            ssl_ctx_guard& operator=(const ssl_ctx_guard&) = delete;
-
-        private:
-            static pthread_mutex_t* ssl_locks;
-            static int ssl_num_locks;
+            // 替换配置, 只在 SSL_CTX 创建之前生效, 之后调用返回 false
+            static bool configure(const tls_options &opts);
 
-            ssl_ctx_guard();
-            static void thread_lock_cb(int mode, int which, const char * f, int l);
-            static void init_ssl_locking();
-
-            ~ssl_ctx_guard();
+            // 创建失败(如证书或私钥无法读取)时抛出 generic_error<TLS_FAILED>, 之后每次调用都抛出同样的错误
+            static SSL_CTX* get();
 
         };
 
-        struct openssl_filter {
+        // TLS 连接过滤器(Connect Filter). 以连接的 socket 直接构造 OpenSSL 的 bufferevent 替换原来的 bufferevent,
+        // OpenSSL 直接读写 socket, 而不是在 socket bufferevent 之上再套一层过滤器(多一对缓冲与一次拷贝).
+        // 握手在 crypto 线程中进行(见 TLS_HANDSHAKE_THREADS), 其间连接的建立被挂起, 其后的连接过滤器在握手完成后才被调用.
+        // 之后注册的 Read/Write Filters 处理的是明文. 客户端未发送 close_notify 就断开时视为正常断开
+        struct tls_filter {
             static void connect(ev_context* ctx);
+
+            // 握手完成后在 ev_handler 线程中调用, 以已建立的 ssl 构造 bufferevent
+            static void established(ev_context* ctx, void *ssl);
         };
 
-    }
+        using openssl_filter = tls_filter;
 
-}
+        // 生成自签名的证书(CN=localhost)与 P-256 私钥并写入 PEM 文件, 用于测试与基准. 成功时返回 true
+        bool write_self_signed(const std::string &cert_file, const std::string &key_file);
 
+    }
 
+}
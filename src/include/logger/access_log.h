@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// 每个访问日志段文件的大小(字节), 写满后换用新的段
+#ifndef ACCESS_LOG_SEGMENT_SIZE
+#define ACCESS_LOG_SEGMENT_SIZE    (64 * 1024 * 1024)
+#endif
+
+// 每个写入线程缓冲的记录数, 缓冲满或 flush 时成批写入段文件
+#ifndef ACCESS_LOG_BUFFER_RECORDS
+#define ACCESS_LOG_BUFFER_RECORDS  1024
+#endif
+
+namespace tcp_kit {
+
+    // 每个请求一条的二进制访问日志. 每个写入线程(ev_handler)独占一个缓冲区与一组预分配并以 mmap 映射的段文件,
+    // 记录先写入缓冲区, 再成批拷贝到映射的内存中, 不经过锁与逐条的系统调用. 段文件可以用 tcp_kit_access_log 转换为 csv 或 json
+    namespace access_log {
+
+        const char     MAGIC[8] = {'T', 'K', 'A', 'C', 'C', 'L', 'O', 'G'};
+        const uint32_t VERSION  = 1;
+
+        // 段文件头, 其后是连续的 record. 预分配而未写入的部分全为 0, 以 time_ns 为 0 的记录表示段的结尾
+        struct segment_header {
+            char     magic[8];
+            uint32_t version;
+            uint32_t record_size;
+            uint64_t created_ns;
+            uint32_t pid;
+            uint32_t writer;        // 写入线程的编号
+            uint32_t index;         // 该线程的第几个段
+            char     reserved[28];
+        };
+
+        struct record {
+            uint64_t time_ns;       // 回复写入输出缓冲的时间(unix epoch)
+            uint64_t conn_id;
+            uint64_t latency_ns;    // 入队到回复写入输出缓冲
+            uint64_t seq;           // 请求的关联 id
+            uint32_t bytes_in;
+            uint32_t bytes_out;
+            uint16_t code;          // 回复的状态码(GenericReply::Code)
+            char     api[22];       // api 名称, 过长时截断, 不足时以 '\0' 填充
+        };
+
+        static_assert(sizeof(segment_header) == 64, "segment_header must be 64 bytes");
+        static_assert(sizeof(record) == 64, "record must be 64 bytes");
+
+        extern std::atomic<bool> _enabled;
+
+        // 在已存在的目录 dir 中写访问日志, 段文件名为 access-<pid>-<writer>-<index>.seg
+        void enable(const std::string &dir, size_t segment_size = ACCESS_LOG_SEGMENT_SIZE);
+
+        // 停止记录. 各线程缓冲的记录与当前的段在其下一次 flush 或线程退出时写出并关闭, 关闭时截去未写入的部分
+        void disable();
+
+        // 将调用线程缓冲的记录写入段文件, ev_handler 每个时间轮刻度调用一次
+        void flush();
+
+        inline bool enabled() {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        void append(std::chrono::steady_clock::time_point at, uint64_t conn_id, const std::string *api, uint64_t seq,
+                    uint64_t latency_ns, uint32_t bytes_in, uint32_t bytes_out, uint16_t code);
+
+        // at 为调用方已取得的单调时钟时间, 按启用时两个时钟的差换算为记录的 time_ns, 省去一次读取墙上时钟
+        inline void log_request(std::chrono::steady_clock::time_point at, uint64_t conn_id, const std::string *api,
+                                uint64_t seq, uint64_t latency_ns, uint32_t bytes_in, uint32_t bytes_out, uint16_t code) {
+            if(enabled())
+                append(at, conn_id, api, seq, latency_ns, bytes_in, bytes_out, code);
+        }
+
+        // 读取一个段文件中的全部记录, 文件不是段文件时返回 false. 只依赖本头文件, 供离线工具使用
+        inline bool read_segment(const std::string &path, segment_header &header, std::vector<record> &records) {
+            FILE *f = fopen(path.c_str(), "rb");
+            if(!f)
+                return false;
+            bool valid = fread(&header, sizeof(header), 1, f) == 1 && memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+                         && header.version == VERSION && header.record_size == sizeof(record);
+            record r;
+            while(valid && fread(&r, sizeof(r), 1, f) == 1 && r.time_ns)
+                records.push_back(r);
+            fclose(f);
+            return valid;
+        }
+
+    }
+
+}
@@ -1,18 +1,215 @@
 #pragma once
 
 #include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <util/func_traits.h>
 
 enum levels { LOG_DEBUG, LOG_INFO, LOG_WARN, LOG_ERROR, LOG_FATAL };
 
+// 低于该级别的 log_* 在编译期去除, 参数不会被求值
 #ifndef LOG_LEVEL
 #define LOG_LEVEL LOG_DEBUG
 #endif
 
-#define log_debug(...) log(LOG_DEBUG, __FILE__, __LINE__, __VA_ARGS__)
-#define log_info(...)  log(LOG_INFO,  __FILE__, __LINE__, __VA_ARGS__)
-#define log_warn(...)  log(LOG_WARN,  __FILE__, __LINE__, __VA_ARGS__)
-#define log_error(...) log(LOG_ERROR, __FILE__, __LINE__, __VA_ARGS__)
-#define log_fatal(...) log(LOG_FATAL, __FILE__, __LINE__, __VA_ARGS__)
+// 每个线程的日志环形缓冲区大小(字节, 2 的幂), 写满时丢弃新的日志并计数, 不阻塞调用线程
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE       (64 * 1024)
+#endif
+
+// 单条日志的最大长度(字节), 超出的部分被截断
+#ifndef LOG_LINE_MAX
+#define LOG_LINE_MAX          1024
+#endif
+
+// 后台线程在没有日志时的等待间隔
+#ifndef LOG_FLUSH_INTERVAL_MS
+#define LOG_FLUSH_INTERVAL_MS 10
+#endif
+
+// 每个 log_* 调用点在 LOG_RATE_WINDOW_MS 毫秒内至多写出 LOG_RATE_LIMIT 条, 其余的只计数, 在该调用点下一条写出的日志中注明. 为 0 时不限制
+#ifndef LOG_RATE_LIMIT
+#define LOG_RATE_LIMIT        100
+#endif
+
+#ifndef LOG_RATE_WINDOW_MS
+#define LOG_RATE_WINDOW_MS    1000
+#endif
+
+// fmt 必须是字符串字面量: 记录中只保存它的指针, 由后台线程格式化
+#define TCP_KIT_LOG(level, ...)                                                                     \
+    do {                                                                                            \
+        if((level) >= LOG_LEVEL) {                                                                  \
+            static tcp_kit::logging::rate_limiter tcp_kit_log_limiter_;                             \
+            uint32_t tcp_kit_log_suppressed_;                                                       \
+            if(tcp_kit_log_limiter_.allow(tcp_kit_log_suppressed_))                                 \
+                tcp_kit::logging::log_deferred(level, __FILE__, __LINE__, tcp_kit_log_suppressed_,  \
+                                               "" __VA_ARGS__);                                     \
+        }                                                                                           \
+    } while(0)
+
+#define log_debug(...) TCP_KIT_LOG(LOG_DEBUG, __VA_ARGS__)
+#define log_info(...)  TCP_KIT_LOG(LOG_INFO,  __VA_ARGS__)
+#define log_warn(...)  TCP_KIT_LOG(LOG_WARN,  __VA_ARGS__)
+#define log_error(...) TCP_KIT_LOG(LOG_ERROR, __VA_ARGS__)
+#define log_fatal(...) TCP_KIT_LOG(LOG_FATAL, __VA_ARGS__)
+
+// 在调用线程中格式化后写入该线程的缓冲区, 由后台线程批量写出(ERROR 写到 stderr, 其余写到 stdout). fmt 可以不是字面量
+void log(uint8_t level, const char* file, uint32_t line, const char* fmt, ...);
+
+// 等待调用之前写入的日志全部写出. FATAL 日志与进程正常退出时自动调用
+void log_flush();
+
+// 因缓冲区已满而丢弃的日志数
+uint64_t log_dropped();
+
+namespace tcp_kit {
+
+    namespace logging {
+
+        inline int64_t coarse_now_ms() {
+            timespec ts;
+#ifdef CLOCK_REALTIME_COARSE
+            clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+#else
+            clock_gettime(CLOCK_REALTIME, &ts);
+#endif
+            return int64_t(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+        }
+
+        // 固定窗口的限流, 每个调用点一个(静态对象, 常量初始化)
+        class rate_limiter {
+
+        public:
+            bool allow(uint32_t &suppressed) {
+                if(!LOG_RATE_LIMIT) {
+                    suppressed = 0;
+                    return true;
+                }
+                int64_t window = coarse_now_ms() / LOG_RATE_WINDOW_MS;
+                int64_t current = _window.load(std::memory_order_relaxed);
+                if(window != current && _window.compare_exchange_strong(current, window, std::memory_order_relaxed))
+                    _used.store(0, std::memory_order_relaxed);
+                if(_used.fetch_add(1, std::memory_order_relaxed) < LOG_RATE_LIMIT) {
+                    suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+                    return true;
+                }
+                _suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+        private:
+            std::atomic<int64_t>  _window {0};
+            std::atomic<uint32_t> _used {0};
+            std::atomic<uint32_t> _suppressed {0};
+
+        };
+
+        // 由后台线程调用, 从 args 中解码参数并格式化到 out
+        using formatter_t = int (*)(char *out, size_t size, const char *fmt, const char *args);
+
+        // 延迟格式化的记录, 其后紧跟编码后的参数
+        struct deferred_head {
+            formatter_t  formatter;
+            const char  *file;
+            const char  *fmt;
+            int64_t      time_ms;
+            uint32_t     line;
+            uint32_t     suppressed;
+        };
+
+        // 写入调用线程的缓冲区, 缓冲区已满时丢弃并计数
+        void push_deferred(uint8_t level, const char *record, uint32_t len);
+
+        // 算术类型、枚举与指针按值拷贝
+        template<typename T>
+        struct arg_codec {
+            static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                          "Only arithmetic, enum, pointer and string arguments can be logged");
+            static size_t size(const T&) { return sizeof(T); }
+            static char* encode(char *p, const T &v) { memcpy(p, &v, sizeof(T)); return p + sizeof(T); }
+            static T decode(const char *&p) { T v; memcpy(&v, p, sizeof(T)); p += sizeof(T); return v; }
+            static const T& pass(const T &v) { return v; }
+        };
+
+        // 字符串拷贝内容: [uint32_t 长度][字符]['\0']
+        struct string_codec {
+            static size_t size(const char *s) { return sizeof(uint32_t) + strlen(s ? s : "(null)") + 1; }
+            static char* encode(char *p, const char *s) {
+                s = s ? s : "(null)";
+                uint32_t n = uint32_t(strlen(s));
+                memcpy(p, &n, sizeof(n));
+                memcpy(p + sizeof(n), s, n + 1);
+                return p + sizeof(n) + n + 1;
+            }
+            static const char* decode(const char *&p) {
+                uint32_t n;
+                memcpy(&n, p, sizeof(n));
+                const char *s = p + sizeof(n);
+                p = s + n + 1;
+                return s;
+            }
+            static const char* pass(const char *s) { return s; }
+        };
+
+        template<> struct arg_codec<const char*>: string_codec {};
+        template<> struct arg_codec<char*>: string_codec {};
+
+        template<>
+        struct arg_codec<std::string>: string_codec {
+            static size_t size(const std::string &s) { return sizeof(uint32_t) + s.size() + 1; }
+            static char* encode(char *p, const std::string &s) { return string_codec::encode(p, s.c_str()); }
+            static const char* pass(const std::string &s) { return s.c_str(); }
+        };
+
+        template<typename T>
+        using codec_t = arg_codec<typename std::decay<T>::type>;
+
+        template<typename Tuple, size_t... I>
+        int format_tuple(char *out, size_t size, const char *fmt, const Tuple &args, index_seq<I...>) {
+            return snprintf(out, size, fmt, std::get<I>(args)...);
+        }
+
+        template<typename... Args>
+        int format_args(char *out, size_t size, const char *fmt, const char *args) {
+            // 花括号初始化按从左到右的顺序求值, 与编码的顺序一致
+            std::tuple<decltype(codec_t<Args>::decode(args))...> decoded{codec_t<Args>::decode(args)...};
+            return format_tuple(out, size, fmt, decoded, typename tuple_index_seq<sizeof...(Args)>::seq_t{});
+        }
+
+        inline size_t sum_sizes() { return 0; }
+
+        template<typename T, typename... Rest>
+        size_t sum_sizes(const T &v, const Rest&... rest) { return codec_t<T>::size(v) + sum_sizes(rest...); }
+
+        inline char* encode_args(char *p) { return p; }
+
+        template<typename T, typename... Rest>
+        char* encode_args(char *p, const T &v, const Rest&... rest) { return encode_args(codec_t<T>::encode(p, v), rest...); }
+
+        // 只拷贝格式串指针与参数, 格式化在后台线程进行. 编码后超过 LOG_LINE_MAX 时退回在调用线程格式化
+        template<typename... Args>
+        void log_deferred(uint8_t level, const char *file, uint32_t line, uint32_t suppressed,
+                          const char *fmt, const Args&... args) {
+            size_t len = sizeof(deferred_head) + sum_sizes(args...);
+            if(len <= LOG_LINE_MAX) {
+                char record[LOG_LINE_MAX];
+                deferred_head head{&format_args<Args...>, file, fmt, coarse_now_ms(), line, suppressed};
+                memcpy(record, &head, sizeof(head));
+                encode_args(record + sizeof(head), args...);
+                push_deferred(level, record, uint32_t(len));
+            } else {
+                ::log(level, file, line, fmt, codec_t<Args>::pass(args)...);
+            }
+            if(level == LOG_FATAL)
+                log_flush();
+        }
+
+    }
 
-void log(uint8_t level, const char* file, uint32_t line, const char* fmt, ...);
\ No newline at end of file
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <util/histogram.h>
+
+// 为 0 时不记录任何指标(记录函数为空), __metrics 与 Prometheus 端点仍可用但数据全为 0
+#ifndef METRICS_ENABLED
+#define METRICS_ENABLED          1
+#endif
+
+// 各线程分片中直方图的精度, 相对误差不超过 1 / 2^(METRICS_HISTOGRAM_BITS - 1)
+#ifndef METRICS_HISTOGRAM_BITS
+#define METRICS_HISTOGRAM_BITS   6
+#endif
+
+// server 自动注册的指标 api 名称
+#ifndef METRICS_API
+#define METRICS_API              "__metrics"
+#endif
+
+// 非 0 时 server::start 在该端口上提供 Prometheus 文本格式的指标(GET /metrics)
+#ifndef METRICS_PROMETHEUS_PORT
+#define METRICS_PROMETHEUS_PORT  0
+#endif
+
+namespace tcp_kit {
+
+    namespace metrics {
+
+        enum counter_id: uint32_t {
+            CONN_ACCEPTED,      // accept: 建立的连接
+            CONN_CLOSED,        // 释放的连接
+            CONN_THROTTLED,     // 输出缓冲超过高水位而被限流的连接
+            CONN_UNTHROTTLED,   // 解除限流(包括被限流时关闭)的连接
+            FRAMES_IN,          // frame: 读出的完整消息
+            BYTES_IN,           // 读出的消息字节数(不含分隔符)
+            MSG_ENQUEUED,       // enqueue: 交给 handler 的消息
+            MSG_REJECTED,       // 因过载被拒绝的消息
+            MSG_DEQUEUED,       // dequeue: handler 取出的消息
+            API_CALLS,          // api: 调用的 api
+            API_ERRORS,         // 以非 SUCCESS 回复的 api 调用
+            REPLIES_OUT,        // write: 写入输出缓冲的回复
+            BYTES_OUT,          // 写入输出缓冲的回复字节数
+            HANDLER_BUSY_NS,    // handler 线程处理消息的累计时间
+            TLS_HANDSHAKES,     // 完成的 TLS 握手
+            TLS_RESUMED,        // 其中以会话票据或会话缓存恢复的握手
+            TLS_KTLS,           // 其中发送方向启用了内核 TLS 的连接
+            N_COUNTERS
+        };
+
+        enum histogram_id: uint32_t {
+            FRAME_BYTES,        // 消息大小
+            QUEUE_WAIT_NS,      // 入队到被 handler 取出
+            PROCESS_NS,         // 过滤器链的处理(含反序列化、api 与序列化)
+            API_NS,             // api 的调用
+            SERIALIZE_NS,       // 回复的序列化
+            REQUEST_NS,         // 入队到回复写入输出缓冲
+            N_HISTOGRAMS
+        };
+
+        using shard_histogram_t = basic_histogram<METRICS_HISTOGRAM_BITS>;
+
+        // 单写者的原子直方图, 只由所属线程写入, 其他线程随时可以读取(读到的各桶之间可能相差正在进行的记录)
+        class shard_histogram {
+
+        public:
+            void record(uint64_t value) {
+                bump(_counts[shard_histogram_t::index_of(value)], 1);
+                bump(_sum, value);
+                if(value > _max.load(std::memory_order_relaxed))
+                    _max.store(value, std::memory_order_relaxed);
+                if(value < _min.load(std::memory_order_relaxed))
+                    _min.store(value, std::memory_order_relaxed);
+            }
+
+            void merge_into(shard_histogram_t &out) const;
+
+        private:
+            std::atomic<uint64_t> _counts[shard_histogram_t::N_COUNTS] {};
+            std::atomic<uint64_t> _sum {0};
+            std::atomic<uint64_t> _min {UINT64_MAX};
+            std::atomic<uint64_t> _max {0};
+
+            // 只有一个写者, 不需要原子的读-改-写
+            static void bump(std::atomic<uint64_t> &a, uint64_t n) {
+                a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+
+        };
+
+        // 每个记录过指标的线程持有一个分片, 分片在线程退出后保留, 其计数仍计入汇总
+        struct shard {
+            std::atomic<uint64_t> counters[N_COUNTERS] {};
+            shard_histogram       histograms[N_HISTOGRAMS];
+        };
+
+        shard* register_shard();
+
+        inline shard& local() {
+            static thread_local shard *s = nullptr;
+            if(!s)
+                s = register_shard();
+            return *s;
+        }
+
+        inline void count(counter_id id, uint64_t n = 1) {
+#if METRICS_ENABLED
+            std::atomic<uint64_t> &c = local().counters[id];
+            c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+#endif
+        }
+
+        inline void record(histogram_id id, uint64_t value) {
+#if METRICS_ENABLED
+            local().histograms[id].record(value);
+#endif
+        }
+
+        // 记录 since 到 now 的纳秒数并返回
+        inline uint64_t record_since(histogram_id id, std::chrono::steady_clock::time_point since,
+                                     std::chrono::steady_clock::time_point now) {
+            uint64_t ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now - since).count());
+            record(id, ns);
+            return ns;
+        }
+
+        // 取当前时间, METRICS_ENABLED 为 0 时不读时钟
+        inline std::chrono::steady_clock::time_point now() {
+#if METRICS_ENABLED
+            return std::chrono::steady_clock::now();
+#else
+            return std::chrono::steady_clock::time_point();
+#endif
+        }
+
+        // 作用域内的耗时记录到 id
+        class scoped_timer {
+
+        public:
+            explicit scoped_timer(histogram_id id): _id(id), _start(now()) { }
+            ~scoped_timer() { record_since(_id, _start, now()); }
+
+            scoped_timer(const scoped_timer&) = delete;
+            scoped_timer& operator=(const scoped_timer&) = delete;
+
+        private:
+            histogram_id                           _id;
+            std::chrono::steady_clock::time_point  _start;
+
+        };
+
+        // 所有分片在某一时刻的汇总
+        struct snapshot {
+            uint64_t           counters[N_COUNTERS];
+            shard_histogram_t  histograms[N_HISTOGRAMS];
+
+            // 由计数派生的瞬时值
+            uint64_t connections() const { return counters[CONN_ACCEPTED] - counters[CONN_CLOSED]; }
+            uint64_t queue_depth() const { return counters[MSG_ENQUEUED] - counters[MSG_DEQUEUED]; }
+            uint64_t throttled() const { return counters[CONN_THROTTLED] - counters[CONN_UNTHROTTLED]; }
+        };
+
+        const char* name_of(counter_id id);
+        const char* name_of(histogram_id id);
+
+        void collect(snapshot &out);
+
+        // 汇总并编码为 json, __metrics api 的返回值
+        std::string to_json();
+
+        // 汇总并编码为 Prometheus 文本格式, 直方图以 summary(分位数, 单位换算为秒)输出
+        std::string to_prometheus();
+
+        // 在后台线程中以 HTTP 提供 GET /metrics, 重复调用时只有第一次生效. 监听失败时返回 false
+        bool serve_prometheus(uint16_t port, const std::string &address = "0.0.0.0");
+
+    }
+
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <typeinfo>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// 为 0 时不采样也不记录任何 span, 各个阶段的记录函数为空
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED       1
+#endif
+
+// 每个线程的环形缓冲保留的最近的 span 数, 写满后覆盖最早的
+#ifndef TRACE_RING_SPANS
+#define TRACE_RING_SPANS    4096
+#endif
+
+// 启动时的采样率(0 ~ 1), 运行时可以通过 set_sample_rate 或 TRACE_API(见 TRACE_API_ENABLED)调整
+#ifndef TRACE_SAMPLE_RATE
+#define TRACE_SAMPLE_RATE   0
+#endif
+
+// 为 1 时 server 在它的 PORT(不包括 listen 增加的端口)上注册 TRACE_API. 任何能连接的客户端都可以借此改变采样率,
+// 所以默认不注册
+#ifndef TRACE_API_ENABLED
+#define TRACE_API_ENABLED   0
+#endif
+
+// 调整采样率的 api 名称, 参数为新的采样率, 返回原来的采样率
+#ifndef TRACE_API
+#define TRACE_API           "__trace"
+#endif
+
+namespace tcp_kit {
+
+    // 按采样率追踪请求经过的各个阶段. 被采样的请求在 msg_context 中带有非 0 的 trace_id 与上一个阶段结束时的时间戳,
+    // 每个阶段结束时以 rdtsc 取时间戳, 将 [上一个阶段结束, 现在] 作为一个 span 写入当前线程的环形缓冲.
+    // 未被采样的请求在每个阶段只多一次判断, 采样率为 0 时读取消息也只多读一次采样率
+    namespace trace {
+
+        enum stage: uint8_t {
+            READ,       // ev_handler: 读出完整消息并构造 msg_context
+            ENQUEUE,    // ev_handler: msg_queue->push
+            QUEUE,      // 入队到被 handler 取出
+            FILTER,     // handler: 一个 Process Filter 的处理, 名称为过滤器的类型
+            DONE,       // handler: 最后一个过滤器返回到调用 done()
+            DISPATCH,   // done() 到 ev_handler 执行 process_callback
+            REPLY,      // ev_handler: 回复写入输出缓冲
+            FLUSH,      // 回复写入输出缓冲到输出缓冲被写空
+            N_STAGES
+        };
+
+        struct span {
+            uint64_t    trace_id;
+            uint64_t    begin;      // ticks() 的值
+            uint64_t    end;
+            const char *name;       // FILTER 为过滤器类型 mangle 后的名称, 其他阶段为空
+            uint32_t    thread;     // 记录该 span 的线程 id
+            stage       stage_;
+        };
+
+        // 采样阈值, 每个请求取一个 32 位的随机数, 小于阈值时采样. 2^32 表示全部采样, 0 表示关闭
+        extern std::atomic<uint64_t> _threshold;
+
+        inline bool active() {
+#if TRACE_ENABLED
+            return _threshold.load(std::memory_order_relaxed) != 0;
+#else
+            return false;
+#endif
+        }
+
+        // 时间戳计数器, 导出时按与单调时钟的比例换算为纳秒. 没有可用的计数器时为单调时钟的纳秒数
+        inline uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#elif defined(__aarch64__)
+            uint64_t v;
+            asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+            return v;
+#else
+            return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+        }
+
+        void set_sample_rate(double rate);
+        double sample_rate();
+
+        // 按采样率决定是否追踪一个请求, 采样时返回新的非 0 trace id, 否则返回 0
+        uint64_t sample();
+
+        void record(uint64_t trace_id, stage s, const char *name, uint64_t begin, uint64_t end);
+
+        // 记录 at 到现在的一个阶段, 并将 at 推进到现在. trace_id 为 0(未被采样)时什么都不做
+        inline void mark(uint64_t trace_id, uint64_t &at, stage s, const char *name = nullptr) {
+#if TRACE_ENABLED
+            if(trace_id) {
+                uint64_t now = ticks();
+                record(trace_id, s, name, at, now);
+                at = now;
+            }
+#endif
+        }
+
+        template<typename F>
+        const char* type_name() {
+            return typeid(F).name();
+        }
+
+        const char* name_of(stage s);
+
+        // 取出所有线程环形缓冲中保留的 span(不清空), 按 trace_id 与开始时间排序
+        void collect(std::vector<span> &out);
+
+        // 编码为 Chrome trace event 格式(chrome://tracing 与 Perfetto 可以直接打开), 时间相对于进程启动
+        std::string to_chrome_json();
+
+        // 编码为 OTLP/JSON 的 ExportTraceServiceRequest, 每个请求一个根 span, 各阶段为其子 span
+        std::string to_otlp_json();
+
+        enum format {
+            CHROME,
+            OTLP
+        };
+
+        // 将保留的 span 写入文件, 失败时返回 false
+        bool export_file(const std::string &path, format f = CHROME);
+
+    }
+
+}
@@ -1,21 +1,373 @@
 #pragma once
+
 #include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <future>
+#include <functional>
+#include <type_traits>
+#include <typeinfo>
+#include <chrono>
+#include <event2/event.h>
+#include <event2/bufferevent.h>
+#include <event2/util.h>
+#include <concurrent/mpsc_queue.h>
+#include <error/errors.h>
+#include <network/generic_msg.pb.h>
+#include <network/generic_reply.pb.h>
+
+// 每个客户端(对应一个服务端地址)持有的连接数, 请求被分配给待回复请求最少的连接
+#ifndef CLIENT_POOL_SIZE
+#define CLIENT_POOL_SIZE         4
+#endif
+
+// 连接断开后, 间隔该时间(毫秒)才会在发送请求时重新建立连接
+#ifndef CLIENT_RECONNECT_MS
+#define CLIENT_RECONNECT_MS      100
+#endif
 
 namespace tcp_kit {
 
+    // 回复的回调, 在客户端的事件循环线程中调用. 连接失败或断开时以 code 为 UNKNOWN_ERR 的回复调用
+    using reply_callback = std::function<void(std::unique_ptr<GenericReply>)>;
+
+    // 客户端与协议无关的部分: 一个事件循环线程与到同一服务端的连接池
+    // 请求可以在任意线程中提交, 经由队列交给事件循环线程写出. 同一连接上可以有任意多个待回复的请求(流水线),
+    // 回复按 seq 与请求匹配, 因此服务端乱序完成(如异步 api)的回复也能正确对应
+    class client_base {
+
+    public:
+        using decoder_t = bool (*)(const char *frame, size_t len, GenericReply &reply);
+
+        // address 形如 "127.0.0.1:3000"
+        client_base(const std::string &address, uint32_t n_conns, decoder_t decode);
+        virtual ~client_base();
+
+        // 没有 seq 的推送(如订阅的 topic)的回调, 在发送第一个请求之前设置
+        void on_push(reply_callback callback);
+
+        // 当前所有连接上待回复的请求数
+        size_t n_pending() const;
+
+        client_base(const client_base&) = delete;
+        client_base& operator=(const client_base&) = delete;
+
+    protected:
+        struct request {
+            uint64_t        seq;
+            std::string     frame;
+            reply_callback  on_reply;
+        };
+
+        // 一次提交, 其中的请求写到同一个连接, 在同一轮事件循环中一起写出
+        struct submission {
+            submission         *next;
+            std::vector<request> requests;
+        };
+
+        uint64_t next_seq();
+
+        // 可以在任意线程中调用, 接管 sub 的所有权
+        void submit(submission *sub);
+
+    private:
+        struct connection {
+            client_base                       *owner;
+            bufferevent                       *bev;
+            std::chrono::steady_clock::time_point closed_at;
+            std::map<uint64_t, reply_callback> pending;   // seq -> 回调, seq 递增, 因此 begin() 是最早的请求
+        };
+
+        event_base                          *_ev_base;
+        event                               *_submit_ev;
+        mpsc_queue<submission>               _submissions;
+        std::vector<std::unique_ptr<connection>> _conns;
+        sockaddr_storage                     _addr;
+        int                                  _addr_len;
+        decoder_t                            _decode;
+        reply_callback                       _on_push;
+        std::atomic<uint64_t>                _seq;
+        std::atomic<size_t>                  _n_pending;
+        std::thread                          _loop;
+
+        static void submit_callback(evutil_socket_t, short, void *arg);
+        static void read_callback(bufferevent *bev, void *arg);
+        static void event_callback(bufferevent *bev, short what, void *arg);
+
+        connection *pick();
+        bool open(connection *conn);
+        void close(connection *conn, const std::string &reason);
+        void dispatch(connection *conn, std::unique_ptr<GenericReply> reply);
+        void fail(request &req, const std::string &reason);
+
+    };
+
+    // 以 api_dispatcher::api 相同的规则打包参数与解包结果: 基本类型依次作为 params, protobuf 消息作为 body.
+    // 基本类型需与服务端处理器的参数类型完全一致(如 uint32_t 与 int32_t 不能混用), 字符串字面量按 std::string 打包
+    template<typename T>
+    void pack_param(GenericMsg &msg, const T &value, typename std::enable_if<std::is_base_of<google::protobuf::Message, T>::value>::type* = nullptr) {
+        msg.mutable_body()->PackFrom(value);
+    }
+
+    inline void pack_param(GenericMsg &msg, uint32_t value)           { msg.add_params()->set_u32(value); }
+    inline void pack_param(GenericMsg &msg, int32_t value)            { msg.add_params()->set_s32(value); }
+    inline void pack_param(GenericMsg &msg, uint64_t value)           { msg.add_params()->set_u64(value); }
+    inline void pack_param(GenericMsg &msg, int64_t value)            { msg.add_params()->set_s64(value); }
+    inline void pack_param(GenericMsg &msg, float value)              { msg.add_params()->set_f(value); }
+    inline void pack_param(GenericMsg &msg, double value)             { msg.add_params()->set_d(value); }
+    inline void pack_param(GenericMsg &msg, bool value)               { msg.add_params()->set_b(value); }
+    inline void pack_param(GenericMsg &msg, const std::string &value) { msg.add_params()->set_str(value); }
+    inline void pack_param(GenericMsg &msg, const char *value)        { msg.add_params()->set_str(value); }
+
+    template<typename R>
+    struct reply_unpacker {
+        static R unpack(GenericReply &reply) {
+            static_assert(std::is_base_of<google::protobuf::Message, R>::value, "Unsupported result type");
+            R res;
+            if(!reply.has_body() || !reply.body().UnpackTo(&res))
+                throw generic_error<API_ARGS_MISMATCHED>("The attempt to unpack the reply body into a [%s] type failed.", typeid(R).name());
+            return res;
+        }
+    };
+
+#define TCP_KIT_REPLY_UNPACKER(TYPE, FIELD)                                                                           \
+    template<>                                                                                                         \
+    struct reply_unpacker<TYPE> {                                                                                      \
+        static TYPE unpack(GenericReply &reply) {                                                                      \
+            if(!reply.has_result() || !reply.result().has_##FIELD())                                                   \
+                throw generic_error<API_ARGS_MISMATCHED>("The attempt to unpack the reply result into a [" #TYPE "] type failed."); \
+            return reply.result().FIELD();                                                                             \
+        }                                                                                                              \
+    };
+
+    TCP_KIT_REPLY_UNPACKER(uint32_t, u32)
+    TCP_KIT_REPLY_UNPACKER(int32_t, s32)
+    TCP_KIT_REPLY_UNPACKER(uint64_t, u64)
+    TCP_KIT_REPLY_UNPACKER(int64_t, s64)
+    TCP_KIT_REPLY_UNPACKER(float, f)
+    TCP_KIT_REPLY_UNPACKER(double, d)
+    TCP_KIT_REPLY_UNPACKER(bool, b)
+    TCP_KIT_REPLY_UNPACKER(std::string, str)
+
+#undef TCP_KIT_REPLY_UNPACKER
+
+    template<>
+    struct reply_unpacker<void> {
+        static void unpack(GenericReply &) { }
+    };
+
+    // 服务端以非 SUCCESS 的状态码回复时抛出
+    inline void ensure_success(const GenericReply &reply) {
+        if(reply.code() != GenericReply::SUCCESS)
+            throw generic_error<CALL_FAILED>("Call failed with code [%d]: %s", int(reply.code()), reply.msg().c_str());
+    }
+
+    // 异步客户端, Protocols 与服务端的协议相同(generic / json), 使用其 client_codec 编解码:
+    //
+    // client<generic> cli("127.0.0.1:3000");
+    // std::future<int32_t> sum = cli.call<int32_t>("add", int32_t(1), int32_t(2));
+    // cli.call_async<std::string>("echo", [](std::exception_ptr err, std::string s) { ... }, std::string("hi"));
+    //
+    // auto b = cli.make_batch();
+    // auto f1 = b.call<int32_t>("add", int32_t(1), int32_t(2));
+    // auto f2 = b.call<std::string>("echo", std::string("hi"));
+    // b.submit();
+    //
+    // 回调在客户端的事件循环线程中调用, 不要在其中阻塞. 不支持跟随文件流的 api
     template<typename Protocols>
-    class client {
+    class client: public client_base {
+
+        using codec = typename Protocols::client_codec;
+
     public:
-        explicit client(std::string& address);
+        explicit client(const std::string &address, uint32_t n_conns = CLIENT_POOL_SIZE);
+
+        // 调用 api, 以 future 得到结果, 调用失败时 future 抛出 generic_error<CALL_FAILED>
+        template<typename R, typename... Args>
+        std::future<R> call(const std::string &api, Args&&... args);
+
+        // 调用 api, 以 on_reply(std::exception_ptr, R) 得到结果, 失败时 exception_ptr 非空. R 为 void 时 on_reply(std::exception_ptr)
+        template<typename R, typename Callback, typename... Args>
+        void call_async(const std::string &api, Callback on_reply, Args&&... args);
+
+        // 发送已构造的请求, seq 由客户端填写
+        void send(GenericMsg &msg, reply_callback on_reply);
+
+        // 批量调用: 请求在 submit 时一次提交, 写到同一个连接并一起写出
+        class batch {
+
+        public:
+            template<typename R, typename... Args>
+            std::future<R> call(const std::string &api, Args&&... args);
+
+            void submit();
+
+            batch(batch&&) = default;
+            ~batch();
+
+        private:
+            friend class client;
+
+            client                       *_client;
+            std::unique_ptr<submission>   _sub;
+
+            explicit batch(client *c);
+
+        };
+
+        batch make_batch();
+
         client(client&) = delete;
         client(client&&) = delete;
         client& operator=(client&) = delete;
 
+    private:
+        template<typename R, typename... Args>
+        request make_call(const std::string &api, reply_callback on_reply, Args&&... args);
+
+        template<typename R>
+        static reply_callback to_promise(std::shared_ptr<std::promise<R>> promise);
+
+        template<typename R, typename Callback>
+        static reply_callback to_callback(Callback on_reply, std::false_type);
+
+        template<typename R, typename Callback>
+        static reply_callback to_callback(Callback on_reply, std::true_type);
+
+    };
+
+    template<typename Protocols>
+    client<Protocols>::client(const std::string &address, uint32_t n_conns): client_base(address, n_conns, &codec::decode) { }
+
+    template<typename Protocols>
+    template<typename R, typename... Args>
+    typename client_base::request client<Protocols>::make_call(const std::string &api, reply_callback on_reply, Args&&... args) {
+        GenericMsg msg;
+        msg.set_api(api);
+        uint64_t seq = next_seq();
+        msg.set_seq(seq);
+        int expand[] = {0, (pack_param(msg, std::forward<Args>(args)), 0)...};
+        (void) expand;
+        return request{seq, codec::encode(msg), std::move(on_reply)};
+    }
+
+    // 以回复设置 promise 的结果, R 为 void 时只检查状态码
+    template<typename R>
+    struct promise_setter {
+        static void set(std::promise<R> &promise, GenericReply &reply) {
+            ensure_success(reply);
+            promise.set_value(reply_unpacker<R>::unpack(reply));
+        }
+    };
+
+    template<>
+    struct promise_setter<void> {
+        static void set(std::promise<void> &promise, GenericReply &reply) {
+            ensure_success(reply);
+            promise.set_value();
+        }
     };
 
     template<typename Protocols>
-    client<Protocols>::client(std::string& address) {
+    template<typename R>
+    reply_callback client<Protocols>::to_promise(std::shared_ptr<std::promise<R>> promise) {
+        return [promise](std::unique_ptr<GenericReply> reply) {
+            try {
+                promise_setter<R>::set(*promise, *reply);
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        };
+    }
+
+    template<typename Protocols>
+    template<typename R, typename Callback>
+    reply_callback client<Protocols>::to_callback(Callback on_reply, std::false_type) {
+        return [on_reply](std::unique_ptr<GenericReply> reply) mutable {
+            R res{};
+            std::exception_ptr err;
+            try {
+                ensure_success(*reply);
+                res = reply_unpacker<R>::unpack(*reply);
+            } catch (...) {
+                err = std::current_exception();
+            }
+            on_reply(err, std::move(res));
+        };
+    }
+
+    template<typename Protocols>
+    template<typename R, typename Callback>
+    reply_callback client<Protocols>::to_callback(Callback on_reply, std::true_type) {
+        return [on_reply](std::unique_ptr<GenericReply> reply) mutable {
+            std::exception_ptr err;
+            try {
+                ensure_success(*reply);
+            } catch (...) {
+                err = std::current_exception();
+            }
+            on_reply(err);
+        };
+    }
+
+    template<typename Protocols>
+    template<typename R, typename... Args>
+    std::future<R> client<Protocols>::call(const std::string &api, Args&&... args) {
+        auto promise = std::make_shared<std::promise<R>>();
+        std::future<R> res = promise->get_future();
+        std::unique_ptr<submission> sub(new submission{nullptr});
+        sub->requests.push_back(make_call<R>(api, to_promise<R>(promise), std::forward<Args>(args)...));
+        submit(sub.release());
+        return res;
+    }
+
+    template<typename Protocols>
+    template<typename R, typename Callback, typename... Args>
+    void client<Protocols>::call_async(const std::string &api, Callback on_reply, Args&&... args) {
+        std::unique_ptr<submission> sub(new submission{nullptr});
+        sub->requests.push_back(make_call<R>(api, to_callback<R>(std::move(on_reply), std::is_void<R>{}),
+                                          std::forward<Args>(args)...));
+        submit(sub.release());
+    }
+
+    template<typename Protocols>
+    void client<Protocols>::send(GenericMsg &msg, reply_callback on_reply) {
+        uint64_t seq = next_seq();
+        msg.set_seq(seq);
+        std::unique_ptr<submission> sub(new submission{nullptr});
+        sub->requests.push_back(request{seq, codec::encode(msg), std::move(on_reply)});
+        submit(sub.release());
+    }
+
+    template<typename Protocols>
+    typename client<Protocols>::batch client<Protocols>::make_batch() {
+        return batch(this);
+    }
+
+    template<typename Protocols>
+    client<Protocols>::batch::batch(client *c): _client(c), _sub(new submission{nullptr}) { }
 
+    template<typename Protocols>
+    template<typename R, typename... Args>
+    std::future<R> client<Protocols>::batch::call(const std::string &api, Args&&... args) {
+        auto promise = std::make_shared<std::promise<R>>();
+        std::future<R> res = promise->get_future();
+        _sub->requests.push_back(_client->template make_call<R>(api, to_promise<R>(promise), std::forward<Args>(args)...));
+        return res;
     }
 
-}
\ No newline at end of file
+    template<typename Protocols>
+    void client<Protocols>::batch::submit() {
+        if(_sub && !_sub->requests.empty())
+            _client->submit(_sub.release());
+        _sub.reset(new submission{nullptr});
+    }
+
+    // 未提交的请求随 batch 析构而丢弃, 其 future 得到 broken_promise
+    template<typename Protocols>
+    client<Protocols>::batch::~batch() = default;
+
+}
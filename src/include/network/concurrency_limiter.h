@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+
+// 自适应并发限制(每个 ev_handler 一个), LIMITER_INITIAL_LIMIT 为 0 时不启用
+// LIMITER_INITIAL_LIMIT     | 初始的并发上限
+// LIMITER_MIN_LIMIT         | 并发上限的下界
+// LIMITER_MAX_LIMIT         | 并发上限的上界
+// LIMITER_LATENCY_TARGET_MS | 请求从入队到 handler 处理返回的目标时延, 超过时视为过载
+#ifndef LIMITER_INITIAL_LIMIT
+#define LIMITER_INITIAL_LIMIT     32
+#endif
+
+#ifndef LIMITER_MIN_LIMIT
+#define LIMITER_MIN_LIMIT         4
+#endif
+
+#ifndef LIMITER_MAX_LIMIT
+#define LIMITER_MAX_LIMIT         1024
+#endif
+
+#ifndef LIMITER_LATENCY_TARGET_MS
+#define LIMITER_LATENCY_TARGET_MS 100
+#endif
+
+// 过载时并发上限的乘性减小系数
+#ifndef LIMITER_BACKOFF
+#define LIMITER_BACKOFF           0.9
+#endif
+
+namespace tcp_kit {
+
+    // AIMD 并发限制器
+    // ev_handler 在消息入队前 try_acquire, 失败时以 OVERLOADED 回复; handler 处理返回后以排队与处理的时延 release
+    // (异步 api 在交由完成令牌时 release, 等待完成的时间不计入):
+    //   时延超过目标: limit = limit * LIMITER_BACKOFF
+    //   时延未超过目标且占用超过一半: limit = limit + 1 / limit (约每处理完 limit 个请求加 1)
+    //
+    // 优先级: 各优先级只能占用并发上限的一部分, 为更高优先级的请求留出余量, 由 api_dispatcher 在得知请求的 api 后检查
+    //
+    // try_acquire 只在 ev_handler 线程中调用, release 在各 handler 线程中调用, admit 与各统计值可以在任意线程中读取
+    class concurrency_limiter {
+
+    public:
+        static const uint8_t CRITICAL  = 0; // 可以占用全部并发上限
+        static const uint8_t NORMAL    = 1; // 可以占用 90%
+        static const uint8_t SHEDDABLE = 2; // 可以占用 50%
+
+        concurrency_limiter();
+
+        bool try_acquire();
+
+        // 归还额度, sample 为 false 时不以该请求的时延调整并发上限(如被提前拒绝的请求)
+        void release(std::chrono::steady_clock::duration latency, bool sample);
+
+        // 当前占用是否允许该优先级的请求继续处理, 只对 try_acquire 接受的请求调用. 不允许时将该请求从接受数改记为拒绝数
+        bool admit(uint8_t priority);
+
+        uint32_t limit() const;
+        uint32_t in_flight() const;
+        uint64_t n_admitted() const;
+        uint64_t n_rejected() const;
+
+        concurrency_limiter(const concurrency_limiter&) = delete;
+        concurrency_limiter& operator=(const concurrency_limiter&) = delete;
+
+    private:
+        std::atomic<double>    _limit_f;
+        std::atomic<uint32_t>  _limit;
+        std::atomic<uint32_t>  _in_flight;
+        std::atomic<uint64_t>  _admitted;
+        std::atomic<uint64_t>  _rejected;
+
+    };
+
+    // 注册 api 时的可选项: svr.api("report", prcs, api_options{concurrency_limiter::SHEDDABLE, 8});
+    struct api_options {
+        uint8_t   priority      = concurrency_limiter::NORMAL;
+        uint32_t  max_in_flight = 0; // 该 api 同时处理中的请求数上限, 为 0 时不限制
+    };
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+
+// conn_id 的组成: [24][14][26]: generation | ev_handler 下标 | 槽位
+#define CONN_SLOT_BITS        26
+#define CONN_EV_HANDLER_BITS  14
+#define CONN_GEN_BITS         24
+#define CONN_SLOT_MASK        ((uint64_t(1) << CONN_SLOT_BITS) - 1)
+#define CONN_EV_HANDLER_MASK  ((uint64_t(1) << CONN_EV_HANDLER_BITS) - 1)
+#define CONN_GEN_MASK         ((uint64_t(1) << CONN_GEN_BITS) - 1)
+
+// 每次分配的槽位数
+#define CONN_CHUNK_BITS       8
+#define CONN_CHUNK_SIZE       (1 << CONN_CHUNK_BITS)
+
+// 单个 ev_handler 可同时持有的连接数上限
+#ifndef CONN_TABLE_CAPACITY
+#define CONN_TABLE_CAPACITY   (1 << 20)
+#endif
+
+namespace tcp_kit {
+
+    struct ev_context;
+
+    // ev_context 的分配器与连接表(每个 ev_handler 一个)
+    // ev_context 按块分配在槽位中, 块在 ev_handler 析构前不会释放, 连接断开后槽位回到空闲链表, 接受新连接时不再分配内存.
+    // 槽位每次被占用或释放时其 generation 加 1(奇数表示占用中), conn_id 中记录占用时的 generation, 因此槽位被复用后旧的
+    // conn_id 不会查找到新的连接.
+    //
+    // acquire / release 只在所属 ev_handler 线程中调用. find 可以在任意线程中调用, 它不会返回已释放的内存, 但返回的
+    // ev_context 只能在所属 ev_handler 线程中访问(如通过 event_active 投递到该线程后再次 find)
+    class conn_table {
+
+    public:
+        conn_table();
+        ~conn_table();
+
+        // 设置所属 ev_handler 的下标, 在 ev_handler 线程启动之前调用
+        void init(uint16_t ev_handler_index);
+
+        // 分配一个槽位, 返回未构造的 ev_context 内存, 由调用者在其上构造. 连接数达到上限时返回 nullptr
+        void *acquire(uint64_t &conn_id);
+
+        // 析构 ctx 并归还其槽位, 之后 ctx->conn_id 不再能被查找到
+        void release(ev_context *ctx);
+
+        // 查找 conn_id 对应的存活连接, conn_id 已失效或不属于该 ev_handler 时返回 nullptr
+        ev_context *find(uint64_t conn_id) const;
+
+        uint32_t size() const;
+
+        // 依次访问所有存活的连接, 只在所属 ev_handler 线程中调用. fn 中可以释放正在访问的连接
+        void for_each(const std::function<void(ev_context *)> &fn) const;
+
+        static uint16_t ev_handler_of(uint64_t conn_id);
+
+        conn_table(const conn_table&) = delete;
+        conn_table& operator=(const conn_table&) = delete;
+
+    private:
+        struct chunk;
+
+        uint16_t                           _index;
+        std::unique_ptr<std::atomic<chunk*>[]> _chunks;
+        uint32_t                           _n_slots;  // 已分配的槽位数
+        uint32_t                           _n_used;   // 占用中的槽位数
+        std::vector<uint32_t>              _free;
+
+    };
+
+}
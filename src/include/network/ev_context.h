@@ -4,11 +4,14 @@
 #include <event2/event.h>
 #include <util/tcp_util.h>
 #include <network/server.h>
+#include <network/file_region.h>
+#include <util/timing_wheel.h>
 
 namespace tcp_kit {
 
     class ev_handler_base;
     class handler_base;
+    class filter_chain;
 
     struct ev_context {
         static const uint8_t CONNECTED  = 0; // 连接建立
@@ -18,25 +21,46 @@ namespace tcp_kit {
         static const uint8_t CLOSED     = 4; // 连接已关闭, bev 不再可用
         static const uint8_t TERMINATED = 5; // 终结
 
+        // 暂停读取连接的原因, 任意一个原因存在时都不再从该连接读取消息
+        static const uint8_t PAUSED_BY_IN_FLIGHT = 1; // 连接上未完成的请求数达到上限, 或扣留着过载拒绝的回复
+        static const uint8_t PAUSED_BY_MEMORY    = 2; // 所有连接排队中的消息占用的内存达到高水位
+        static const uint8_t PAUSED_BY_OUTPUT    = 4; // 输出缓冲超过高水位, 对端消费过慢(限流)
+
         struct control {
             unsigned error:   1;
             unsigned state:   3;
             unsigned n_async: 12;
+            unsigned paused:  3;
+            unsigned partial: 1;  // 输入缓冲中有不完整的消息
+            unsigned held_reject: 1; // 过载拒绝的回复被扣留, 连接上之前的请求全部回复后写出
         };
 
         control          ctl;
         socket_t         fd;
         sockaddr        *address;
         int              socklen;
-        uint32_t         conn_id;
+        uint64_t         conn_id;  // 见 conn_table
         ev_handler_base *ev_handler;
         handler_base*    handler;
         bufferevent*     bev;
+        filter_chain    *filters;  // 接收该连接的监听端口的过滤器链
+        void           (*resume_connects)(ev_context*); // 非空时连接的建立被挂起(见 ev_handler_base::suspend_connect), 为余下的连接过滤器
+        stream_context   recv;     // 正在接收的文件流, 接收完成前不解析新的消息
+        timer_node       timer;         // 超时定时器, 挂在所属 ev_handler 的时间轮上
+        uint64_t         last_active;   // 最近一次读取或回复的 tick
+        uint64_t         header_since;  // 开始接收当前不完整消息的 tick
+        uint64_t         request_since; // 有请求在处理中时, 最近一次取得进展(入队或回复)的 tick
+        uint64_t         trace_id;      // 最近写入输出缓冲的被采样的回复, 输出缓冲写空时记录其 FLUSH 阶段
+        uint64_t         trace_mark;
+
+        // C++20 起声明了构造函数的类不再是聚合类型, 因此通过成员禁止拷贝与移动, 使 ev_context 仍可以聚合初始化
+        struct pinned {
+            pinned() = default;
+            pinned(const pinned &) = delete;
+            pinned& operator=(const pinned &) = delete;
+        };
 
-        ev_context(const ev_context &) = delete;
-        ev_context(ev_context &&) = delete;
-        ev_context& operator=(const ev_context &) = delete;
-        ev_context& operator=(ev_context &&) = delete;
+        pinned           _pinned;
 
     };
 
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <sys/types.h>
+
+namespace tcp_kit {
+
+    // 文件流式传输
+    // api 处理器可以直接返回 file_region 或 file_sink, 文件内容不再以 base64 字符串的形式编入消息体, 而是跟随在一个
+    // 带有 stream_len 字段的回复(帧头)之后以原始字节传输, 由 ev_handler 线程直接在文件描述符与 socket 之间搬运数据:
+    //
+    // 下载: svr.api("download", [](std::string name) { return file_region::of(dir + name); });
+    //   客户端收到 stream_len = N 的回复后, 紧随其后的 N 个字节即为文件内容. ev_handler 使用 evbuffer_add_file 发送,
+    //   在支持的平台上由 sendfile 完成, 数据不经过 handler 线程, 也不拷贝到用户态
+    //
+    // 上传: svr.api("upload", [](std::string name, uint64_t size) { return file_sink::of(dir + name, size); });
+    //   客户端收到 stream_len = N 的回复后, 在同一连接上发送 N 个原始字节, ev_handler 将它们直接写入文件描述符,
+    //   写满 N 个字节之前该连接不会再解析新的消息. 发出上传请求后、收到回复之前客户端不能在该连接上发送任何数据:
+    //   ev_handler 在回复之前无法知道请求是上传, 提前发送的文件内容会被当作消息分帧
+    //
+    // 文件描述符的所有权在返回后转移给 tcp_kit, 传输结束或连接出错时由 ev_handler 关闭
+
+    struct file_region {
+        int       fd;
+        int64_t   offset;
+        int64_t   length;
+
+        // 以只读方式打开文件, length 为负数时表示从 offset 读到文件末尾
+        static file_region of(const std::string& path, int64_t offset = 0, int64_t length = -1);
+    };
+
+    struct file_sink {
+        int       fd;
+        int64_t   offset;
+        int64_t   length;
+
+        // 以写方式打开(不存在时创建)文件, 从 offset 处写入 length 个字节, 文件的长度截为 offset + length
+        static file_sink of(const std::string& path, int64_t length, int64_t offset = 0);
+    };
+
+    // 随 msg_context 在 handler 与 ev_handler 之间传递的流描述
+    struct stream_context {
+        static const uint8_t NONE = 0; // 普通回复
+        static const uint8_t SEND = 1; // 回复之后发送文件内容
+        static const uint8_t RECV = 2; // 回复之后接收文件内容
+
+        uint8_t   mode;
+        int       fd;
+        int64_t   offset;
+        int64_t   length;
+    };
+
+}
@@ -8,6 +8,8 @@
 #include <array>
 #include <type_traits>
 #include <network/ev_context.h>
+#include <network/msg_context.h>
+#include <metrics/trace.h>
 #include <logger/logger.h>
 
 // 通过 filter 介入 tcp 连接的整个生命周期.
@@ -46,8 +48,19 @@ namespace tcp_kit {
 
     using process_chain  = std::unique_ptr<msg_buffer>(*)(msg_context* ctx, std::unique_ptr<msg_buffer>);
 
+    // 类型完整的 Process Filters 调用链的入口(见 process_pipeline), 以消息所在的缓冲区调用, 返回编码后的回复
+    using process_entry  = msg_buffer(*)(msg_context* ctx, msg_buffer);
+
     using close_filter = void (*)(ev_context *);
 
+    // 不经过处理直接以状态码 code 回复, 回复由提供 reply 钩子的过滤器构造, 再经过其后的 Process Filters 编码,
+    // 过滤器链中没有 reply 钩子时返回 nullptr
+    using reply_chain = std::unique_ptr<msg_buffer>(*)(msg_context* ctx, uint32_t code);
+
+    // 将一个回复对象(reply 钩子所在过滤器的回复类型, 以 unique_ptr::release 的结果传入, 所有权随之转移)经过其后的
+    // Process Filters 编码, 用于不由请求触发的消息(如发布), 过滤器链中没有 reply 钩子时返回 nullptr
+    using encode_chain = std::unique_ptr<msg_buffer>(*)(msg_context* ctx, void* reply);
+
     class filter_chain {
 
     public:
@@ -55,6 +68,9 @@ namespace tcp_kit {
         std::vector<bufferevent_filter_cb> reads;
         std::vector<bufferevent_filter_cb> writes;
         process_chain                      process;
+        process_entry                      pipeline;
+        reply_chain                        reply;
+        encode_chain                       encode;
         close_filter                       closes;
 
         // template<typename... F>
@@ -79,35 +95,35 @@ namespace tcp_kit {
 
     // 检查 T 是否有静态函数 void connect(ev_context*);
     template<typename T>
-    struct check_connect<T, void_t<decltype(T::connect)>> : std::is_same<decltype(T::connect), void(ev_context*)> {};
+    struct check_connect<T, ::void_t<decltype(T::connect)>> : std::is_same<decltype(T::connect), void(ev_context*)> {};
 
     // 检查 T 是否有静态函数 void read(evbuffer*, evbuffer*, ev_ssize_t, bufferevent_flush_mode, ev_context*);
     template<typename T, typename = void>
     struct check_read_filter : std::false_type {};
 
     template<typename T>
-    struct check_read_filter<T, void_t<decltype(T::read)>> : std::is_same<decltype(T::read), bufferevent_filter_result(evbuffer*, evbuffer*, ev_ssize_t, bufferevent_flush_mode, ev_context*)> {};
+    struct check_read_filter<T, ::void_t<decltype(T::read)>> : std::is_same<decltype(T::read), bufferevent_filter_result(evbuffer*, evbuffer*, ev_ssize_t, bufferevent_flush_mode, ev_context*)> {};
 
     // 检查 T 是否有静态函数 void write(evbuffer*, evbuffer*, ev_ssize_t, bufferevent_flush_mode, ev_context*);
     template<typename T, typename = void>
     struct check_write_filter : std::false_type {};
 
     template<typename T>
-    struct check_write_filter<T, void_t<decltype(T::write)>> : std::is_same<decltype(T::write), bufferevent_filter_result(evbuffer*, evbuffer*, ev_ssize_t, bufferevent_flush_mode, ev_context*)> {};
+    struct check_write_filter<T, ::void_t<decltype(T::write)>> : std::is_same<decltype(T::write), bufferevent_filter_result(evbuffer*, evbuffer*, ev_ssize_t, bufferevent_flush_mode, ev_context*)> {};
 
     template<typename T, typename = void>
     struct check_close : std::false_type {};
 
     // 检查 T 是否有静态函数 void close(ev_context *);
     template<typename T>
-    struct check_close<T, void_t<decltype(T::close)>> : std::is_same<decltype(T::close), void(ev_context *)> {};
+    struct check_close<T, ::void_t<decltype(T::close)>> : std::is_same<decltype(T::close), void(ev_context *)> {};
 
     // 检查某类型为 std::unique_ptr
     template<typename, typename = void>
     struct check_unique : std::false_type {};
 
     template<typename T>
-    struct check_unique<T, void_t<typename T::element_type, typename T::deleter_type>> : std::is_same<T, std::unique_ptr<typename T::element_type, typename T::deleter_type>> {};
+    struct check_unique<T, ::void_t<typename T::element_type, typename T::deleter_type>> : std::is_same<T, std::unique_ptr<typename T::element_type, typename T::deleter_type>> {};
 
     template<typename T>
     struct process_traits;
@@ -124,19 +140,30 @@ namespace tcp_kit {
     template <typename T>
     struct process_traits : process_traits<decltype(&T::operator())> {};
 
-    // 检查 T 是否有静态函数 unique_ptr<?,?> process(ev_context*, unique_ptr<?,?>);
+    // 检查 T 是否有静态函数 R process(msg_context*, A);
+    // R 与 A 可以是 unique_ptr, 也可以是值或引用(如指向 arena 中对象的引用), 相邻的过滤器之间不必在堆上分配中间结果
     template<typename, typename = void>
     struct check_process_filter : std::false_type { };
 
     template<typename T>
-    struct check_process_filter<T, void_t<decltype(T::process)>> {
+    struct check_process_filter<T, ::void_t<decltype(T::process)>> {
         using result_t = typename process_traits<decltype(T::process)>::result_type;
         using arg_t = typename std::tuple_element<1, typename process_traits<decltype(T::process)>::args_type>::type;
-        static constexpr bool value = check_unique<result_t>::value &&
-                                      check_unique<arg_t>::value &&
+        static constexpr bool value = !std::is_void<result_t>::value &&
                                       std::is_same<decltype(T::process), result_t(msg_context*, arg_t)>::value;
     };
 
+    // 检查 T 是否有静态函数 unique_ptr<?,?> reply(msg_context*, uint32_t);
+    template<typename, typename = void>
+    struct check_reply : std::false_type { };
+
+    template<typename T>
+    struct check_reply<T, ::void_t<decltype(T::reply)>> {
+        using result_t = typename process_traits<decltype(T::reply)>::result_type;
+        static constexpr bool value = check_unique<result_t>::value &&
+                                      std::is_same<decltype(T::reply), result_t(msg_context*, uint32_t)>::value;
+    };
+
     // 仅保留有 Connect Filter 的过滤器类型
     template <typename First, typename... Others>
     struct valid_connect_filters {
@@ -205,6 +232,47 @@ namespace tcp_kit {
                 type_list<>>;
     };
 
+    // 从第一个有 reply 钩子的过滤器开始截取过滤器类型
+    template <typename... F>
+    struct from_reply_filter {
+        using types = type_list<>;
+    };
+
+    template <typename First, typename... Others>
+    struct from_reply_filter<First, Others...> {
+        using types = typename std::conditional<
+                check_reply<First>::value,
+                type_list<First, Others...>,
+                typename from_reply_filter<Others...>::types>::type;
+    };
+
+    // 过滤器集(type_list)中 reply 钩子的回复类型(unique_ptr), 即该链的 encode 所接受的回复类型, 没有 reply 钩子时为 void
+    template <typename List>
+    struct reply_type_of {
+        using type = void;
+    };
+
+    template <typename... F>
+    struct reply_type_of<type_list<F...>> {
+    private:
+        template <typename L>
+        struct first { using type = void; };
+        template <typename R, typename... Others>
+        struct first<type_list<R, Others...>> { using type = typename check_reply<R>::result_t; };
+    public:
+        using type = typename first<typename from_reply_filter<F...>::types>::type;
+    };
+
+    template <typename List>
+    struct process_filters_of {
+        using types = type_list<>;
+    };
+
+    template <typename First, typename... Others>
+    struct process_filters_of<type_list<First, Others...>> {
+        using types = typename valid_process_filters<First, Others...>::types;
+    };
+
     // 仅保留有 Connect Filter 的过滤器类型
     template <typename First, typename... Others>
     struct valid_close_filters {
@@ -224,12 +292,17 @@ namespace tcp_kit {
 
     void empty_connect_chain(ev_context* ctx);
 
+    // 过滤器挂起了连接的建立时记下余下的过滤器 rest 并返回 true, 连接恢复建立时再调用它们.
+    // 在 filter_chain.cpp 中定义, 此处 ev_context 尚不完整
+    bool suspend_connects(ev_context* ctx, void (*rest)(ev_context*));
+
     template<typename First, typename... Others>
     struct connect_chain_caller {
 
         static void call(ev_context* ctx) {
             First::connect(ctx);
-            connect_chain_caller<Others...>::call(ctx);
+            if(!suspend_connects(ctx, &connect_chain_caller<Others...>::call))
+                connect_chain_caller<Others...>::call(ctx);
         }
 
     };
@@ -264,14 +337,18 @@ namespace tcp_kit {
 
     };
 
+    // 过滤器抛出异常时以 BEV_ERROR 结束, 连接随之以错误断开
     template<typename F>
     bufferevent_filter_result catchable_read(struct evbuffer *src, struct evbuffer *dst, ev_ssize_t dst_limit,
                                              enum bufferevent_flush_mode mode, void *ctx) {
         try {
             return F::read(src, dst, dst_limit, mode, static_cast<ev_context*>(ctx));
+        } catch (const std::exception &err) {
+            log_error("%s", err.what());
         } catch (...) {
-
+            log_error("Unknown exception in the read filter");
         }
+        return BEV_ERROR;
     }
 
     template<typename F>
@@ -279,11 +356,55 @@ namespace tcp_kit {
                                              enum bufferevent_flush_mode mode, void *ctx) {
         try {
             return F::write(src, dst, dst_limit, mode, static_cast<ev_context*>(ctx));
+        } catch (const std::exception &err) {
+            log_error("%s", err.what());
         } catch (...) {
-
+            log_error("Unknown exception in the write filter");
         }
+        return BEV_ERROR;
     }
 
+    // 单层的读写过滤器管道. 所有 Read/Write Filters 共用一个 bufferevent_filter, 在同一次回调中依次执行,
+    // 而不是每个过滤器嵌套一层 bufferevent(每层都有自己的输入输出缓冲、回调与水位).
+    // 第一个与最后一个过滤器直接读写 bufferevent 的缓冲, 相邻过滤器之间各有一个只在连接上保留未消费数据的 evbuffer,
+    // 过滤器可以用 evbuffer_add_buffer 等函数在其间移动 chain 而不拷贝数据.
+    // 过滤器按注册顺序从靠近 socket 的一侧排列: 读取时按注册顺序执行, 写出时按相反的顺序执行
+    class rw_pipeline {
+
+    public:
+        // 以 underlying 构造管道, 没有过滤器时返回 underlying 本身, 失败时返回 nullptr(underlying 不被释放)
+        static bufferevent* attach(bufferevent *underlying, const std::vector<bufferevent_filter_cb> &reads,
+                                   const std::vector<bufferevent_filter_cb> &writes, ev_context *ctx);
+
+        rw_pipeline(const rw_pipeline&) = delete;
+        rw_pipeline& operator=(const rw_pipeline&) = delete;
+
+    private:
+        struct direction {
+            const std::vector<bufferevent_filter_cb> *stages;
+            std::vector<evbuffer*>                    between;  // between[i] 为第 i 与 i + 1 个执行的过滤器之间的缓冲
+            bool                                      reverse;
+
+            bufferevent_filter_result run(evbuffer *src, evbuffer *dst, ev_ssize_t dst_limit,
+                                          bufferevent_flush_mode mode, ev_context *ctx);
+        };
+
+        ev_context *_ctx;
+        direction   _reads;
+        direction   _writes;
+
+        rw_pipeline(const std::vector<bufferevent_filter_cb> &reads, const std::vector<bufferevent_filter_cb> &writes,
+                    ev_context *ctx);
+        ~rw_pipeline();
+
+        static bufferevent_filter_result read(evbuffer *src, evbuffer *dst, ev_ssize_t dst_limit,
+                                              bufferevent_flush_mode mode, void *arg);
+        static bufferevent_filter_result write(evbuffer *src, evbuffer *dst, ev_ssize_t dst_limit,
+                                               bufferevent_flush_mode mode, void *arg);
+        static void free(void *arg);
+
+    };
+
     template<typename... F>
     connect_filter make_connect_chain(type_list<F...>, typename std::enable_if<(sizeof...(F) > 0), void>::type* = nullptr) {
         return &connect_chain_caller<F...>::call;
@@ -296,7 +417,7 @@ namespace tcp_kit {
 
     template<typename... F>
     std::vector<bufferevent_filter_cb> make_reads(type_list<F...>, typename std::enable_if<(sizeof...(F) > 0), void>::type* = nullptr) {
-        return {&catchable_read<F>()...};
+        return {&catchable_read<F>...};
     }
 
     template<typename... F>
@@ -306,7 +427,7 @@ namespace tcp_kit {
 
     template<typename... F>
     std::vector<bufferevent_filter_cb> make_writes(type_list<F...>, typename std::enable_if<(sizeof...(F) > 0), void>::type* = nullptr) {
-        return {&catchable_write<F>()...};
+        return {&catchable_write<F>...};
     }
 
     template<typename... F>
@@ -325,17 +446,79 @@ namespace tcp_kit {
     }
 
     // 将 Process Filters 调用链展开, A, B, C  -> return C::process(ctx, B::process(ctx, A::process(ctx, move(input))));
+    // 被采样追踪的请求在每个过滤器返回时记录一个 FILTER 阶段
     template<typename First, typename... Others>
     struct process_chain_caller {
-        static decltype(auto) call(msg_context* ctx, typename get_arg2_type<decltype(First::process)>::type input) {
-            return process_chain_caller<Others...>::call(ctx, First::process(ctx, move(input)));
+        using input_type = typename get_arg2_type<decltype(First::process)>::type;
+
+        static decltype(auto) call(msg_context* ctx, input_type input) {
+            decltype(auto) output = First::process(ctx, std::forward<input_type>(input));
+            trace::mark(ctx->trace_id, ctx->trace_mark, trace::FILTER, trace::type_name<First>());
+            return process_chain_caller<Others...>::call(ctx, std::forward<decltype(output)>(output));
         }
     };
 
     template<typename Last>
     struct process_chain_caller<Last> {
-        static decltype(auto) call(msg_context* ctx, typename get_arg2_type<decltype(Last::process)>::type input) {
-            return Last::process(ctx, move(input));
+        using input_type = typename get_arg2_type<decltype(Last::process)>::type;
+
+        static decltype(auto) call(msg_context* ctx, input_type input) {
+            decltype(auto) output = Last::process(ctx, std::forward<input_type>(input));
+            trace::mark(ctx->trace_id, ctx->trace_mark, trace::FILTER, trace::type_name<Last>());
+            return output;
+        }
+    };
+
+    // 链的首尾以 msg_buffer 或 unique_ptr<msg_buffer> 传递缓冲区, 以下函数在两者之间转换
+    template<typename T>
+    struct buffer_arg;
+
+    template<>
+    struct buffer_arg<msg_buffer> {
+        static msg_buffer from(msg_buffer buffer) { return buffer; }
+        static msg_buffer from(std::unique_ptr<msg_buffer> buffer) { return *buffer; }
+    };
+
+    template<>
+    struct buffer_arg<std::unique_ptr<msg_buffer>> {
+        static std::unique_ptr<msg_buffer> from(msg_buffer buffer) { return std::unique_ptr<msg_buffer>(new msg_buffer(buffer)); }
+        static std::unique_ptr<msg_buffer> from(std::unique_ptr<msg_buffer> buffer) { return buffer; }
+    };
+
+    inline msg_buffer unboxed(msg_buffer buffer) { return buffer; }
+    inline msg_buffer unboxed(std::unique_ptr<msg_buffer> buffer) { return *buffer; }
+
+    inline std::unique_ptr<msg_buffer> boxed(msg_buffer buffer) { return buffer_arg<std::unique_ptr<msg_buffer>>::from(buffer); }
+    inline std::unique_ptr<msg_buffer> boxed(std::unique_ptr<msg_buffer> buffer) { return buffer; }
+
+    // 类型完整的 Process Filters 调用链. server 将其作为 handler 的模版参数, handler 直接调用而不经过函数指针,
+    // 各个过滤器可以被内联
+    template<typename List>
+    struct process_pipeline;
+
+    template<typename... F>
+    struct process_pipeline<type_list<F...>> {
+        using input_type = typename process_chain_caller<F...>::input_type;
+
+        // 以消息所在的缓冲区(不转移所有权)调用链, 返回编码后的回复
+        static msg_buffer call(msg_context* ctx, msg_buffer input) {
+            return unboxed(process_chain_caller<F...>::call(ctx, buffer_arg<input_type>::from(input)));
+        }
+    };
+
+    template<>
+    struct process_pipeline<type_list<>> {
+        static msg_buffer call(msg_context* ctx, msg_buffer input) {
+            return input;
+        }
+    };
+
+    // 擦除类型后存入 filter_chain 的调用链, 供动态注册的场景使用
+    template<typename... F>
+    struct erased_process_chain {
+        static std::unique_ptr<msg_buffer> call(msg_context* ctx, std::unique_ptr<msg_buffer> input) {
+            using input_type = typename process_chain_caller<F...>::input_type;
+            return boxed(process_chain_caller<F...>::call(ctx, buffer_arg<input_type>::from(std::move(input))));
         }
     };
 
@@ -352,7 +535,7 @@ namespace tcp_kit {
 
     template<typename... F>
     process_chain make_process_chain(type_list<F...>, typename std::enable_if<(sizeof...(F) > 0), void>::type* = nullptr) {
-        return &process_chain_caller<F...>::call;
+        return &erased_process_chain<F...>::call;
     }
 
     template<typename... F>
@@ -360,6 +543,50 @@ namespace tcp_kit {
         return &empty_process_chain;
     }
 
+    std::unique_ptr<msg_buffer> empty_reply_chain(msg_context* ctx, uint32_t code);
+
+    // 将 reply 钩子与其后的 Process Filters 展开, R, B, C -> return C::process(ctx, B::process(ctx, R::reply(ctx, code)));
+    template<typename R, typename List>
+    struct reply_chain_caller;
+
+    template<typename R, typename... P>
+    struct reply_chain_caller<R, type_list<P...>> {
+        static std::unique_ptr<msg_buffer> call(msg_context* ctx, uint32_t code) {
+            return boxed(process_chain_caller<P...>::call(ctx, R::reply(ctx, code)));
+        }
+    };
+
+    template<typename R, typename... Others>
+    reply_chain make_reply_chain(type_list<R, Others...>) {
+        return &reply_chain_caller<R, typename process_filters_of<type_list<Others...>>::types>::call;
+    }
+
+    inline reply_chain make_reply_chain(type_list<>) {
+        return &empty_reply_chain;
+    }
+
+    std::unique_ptr<msg_buffer> empty_encode_chain(msg_context* ctx, void* reply);
+
+    template<typename R, typename List>
+    struct encode_chain_caller;
+
+    template<typename R, typename... P>
+    struct encode_chain_caller<R, type_list<P...>> {
+        static std::unique_ptr<msg_buffer> call(msg_context* ctx, void* reply) {
+            using result_t = typename check_reply<R>::result_t;
+            return boxed(process_chain_caller<P...>::call(ctx, result_t(static_cast<typename result_t::element_type*>(reply))));
+        }
+    };
+
+    template<typename R, typename... Others>
+    encode_chain make_encode_chain(type_list<R, Others...>) {
+        return &encode_chain_caller<R, typename process_filters_of<type_list<Others...>>::types>::call;
+    }
+
+    inline encode_chain make_encode_chain(type_list<>) {
+        return &empty_encode_chain;
+    }
+
 //    template<typename... F>
 //    std::shared_ptr<filter_chain> filter_chain::make(type_list<F...>) {
 //        auto chain = std::make_shared<filter_chain>();
@@ -375,8 +602,11 @@ namespace tcp_kit {
         auto chain = std::make_shared<filter_chain>();
         chain->connects = make_connect_chain(typename valid_connect_filters<F...>::types{});
         chain->reads = make_reads(typename valid_read_filters<F...>::types{});
-        chain->writes = make_reads(typename valid_write_filters<F...>::types{});
+        chain->writes = make_writes(typename valid_write_filters<F...>::types{});
         chain->process = make_process_chain(typename valid_process_filters<F...>::types{});
+        chain->pipeline = &process_pipeline<typename valid_process_filters<F...>::types>::call;
+        chain->reply = make_reply_chain(typename from_reply_filter<F...>::types{});
+        chain->encode = make_encode_chain(typename from_reply_filter<F...>::types{});
         chain->closes = make_close_chain(typename valid_close_filters<F...>::types{});
         return chain;
     }
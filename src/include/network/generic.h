@@ -8,15 +8,203 @@
 #include <event2/buffer.h>
 #include <include/error/errors.h>
 #include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <new>
+#include <chrono>
 #include <network/generic_msg.pb.h>
 #include <network/generic_reply.pb.h>
 #include <network/msg_context.h>
+#include <network/file_region.h>
+#include <util/timing_wheel.h>
+#include <metrics/metrics.h>
+#include <logger/access_log.h>
+#include <metrics/trace.h>
+#include <coroutine/task.h>
+#include <coroutine/awaitable.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #define SUCCESSFUL 0 // libevent API 表示成功的值
+#define NO_DEADLINE UINT64_MAX
+
+// 单个连接上已入队但尚未回复的请求数上限, 达到上限后暂停读取该连接, 直到有请求完成
+#ifndef MAX_IN_FLIGHT_PER_CONN
+#define MAX_IN_FLIGHT_PER_CONN   64
+#endif
+
+// 所有连接排队中的消息占用内存(字节)的高水位, 超过后暂停读取所有继续收到消息的连接, 回落到低水位以下时恢复
+#ifndef MSG_MEMORY_HIGH_WATER
+#define MSG_MEMORY_HIGH_WATER    (256 * 1024 * 1024)
+#endif
+
+#ifndef MSG_MEMORY_LOW_WATER
+#define MSG_MEMORY_LOW_WATER     (MSG_MEMORY_HIGH_WATER / 4 * 3)
+#endif
+
+// 连接输出缓冲的高/低水位(字节). 超过高水位的连接被限流: 暂停读取该连接, 并按慢消费者策略处理向它推送的数据,
+// 输出缓冲回落到低水位时解除限流
+#ifndef OUTPUT_HIGH_WATER
+#define OUTPUT_HIGH_WATER        (4 * 1024 * 1024)
+#endif
+
+#ifndef OUTPUT_LOW_WATER
+#define OUTPUT_LOW_WATER         (1024 * 1024)
+#endif
+
+// 慢消费者策略, 作用于向被限流的连接推送的数据(回复不受影响, 它们已受到读暂停的约束)
+// SLOW_CONSUMER_DROP       | 丢弃推送的数据
+// SLOW_CONSUMER_DISCONNECT | 断开该连接
+// SLOW_CONSUMER_BLOCK      | 照常写入, server::send/broadcast/publish 在投递前阻塞, 等待目标 ev_handler 上的限流解除
+#define SLOW_CONSUMER_DROP       0
+#define SLOW_CONSUMER_DISCONNECT 1
+#define SLOW_CONSUMER_BLOCK      2
+
+#ifndef SLOW_CONSUMER_POLICY
+#define SLOW_CONSUMER_POLICY     SLOW_CONSUMER_DROP
+#endif
+
+// SLOW_CONSUMER_BLOCK 策略下推送方等待限流解除的最长时间(毫秒), 超时后照常投递
+#ifndef SLOW_CONSUMER_BLOCK_MS
+#define SLOW_CONSUMER_BLOCK_MS   1000
+#endif
+
+// 连接超时(毫秒), 为 0 时不启用. 超时的连接以错误关闭
+// IDLE_TIMEOUT_MS        | 没有请求在处理中时, 连接上既没有读取也没有回复或推送的时长
+// READ_HEADER_TIMEOUT_MS | 一条消息从收到第一个字节到接收完整的时长
+// REQUEST_TIMEOUT_MS     | 有请求在处理中时, 连接上没有任何请求得到回复的时长
+// 异步与协程 api 的请求可以合法地处理很久, 启用 REQUEST_TIMEOUT_MS 时它应大于这些 api 最长的处理时间,
+// 因此 IDLE_TIMEOUT_MS 与 REQUEST_TIMEOUT_MS 默认不启用. 可以为某个 server 的端口特化 conn_timeouts 单独设置
+#ifndef IDLE_TIMEOUT_MS
+#define IDLE_TIMEOUT_MS          0
+#endif
+
+#ifndef READ_HEADER_TIMEOUT_MS
+#define READ_HEADER_TIMEOUT_MS   10000
+#endif
+
+#ifndef REQUEST_TIMEOUT_MS
+#define REQUEST_TIMEOUT_MS       0
+#endif
+
+// 时间轮的精度(毫秒)
+#ifndef TIMING_WHEEL_TICK_MS
+#define TIMING_WHEEL_TICK_MS     10
+#endif
+
+// 请求在队列中等待处理的最长时间(毫秒), 为 0 时不限制. 客户端可以通过 GenericMsg.timeout_ms 为单个请求设置更短的时限,
+// 超时的请求不再交给 api 处理器, 直接以 TIMEOUT 回复
+#ifndef MAX_QUEUE_WAIT_MS
+#define MAX_QUEUE_WAIT_MS        0
+#endif
+
+// 因内存高水位而暂停的连接, 每隔该时间(毫秒)检查一次是否可以恢复
+#ifndef MSG_MEMORY_RECHECK_MS
+#define MSG_MEMORY_RECHECK_MS    10
+#endif
 
 namespace tcp_kit {
 
+    // server<Protocols, PORT> 的连接超时(毫秒), 特化它可以为某个 server 单独设置:
+    //
+    // template<> struct conn_timeouts<3000> { static constexpr uint32_t idle_ms = 60000, read_header_ms = 10000, request_ms = 0; };
+    template<uint16_t PORT>
+    struct conn_timeouts {
+        static constexpr uint32_t idle_ms        = IDLE_TIMEOUT_MS;
+        static constexpr uint32_t read_header_ms = READ_HEADER_TIMEOUT_MS;
+        static constexpr uint32_t request_ms     = REQUEST_TIMEOUT_MS;
+    };
+
+    // server<Protocols, PORT> 的背压上限与慢消费者策略, 特化它可以为某个 server 单独设置(须给出所有成员). 内存水位按 server 计,
+    // 不跨端口累加:
+    //
+    // template<> struct conn_limits<3000> {
+    //     static constexpr uint32_t max_in_flight = 16;
+    //     static constexpr size_t memory_high_water = 1 << 20, memory_low_water = 1 << 19;
+    //     static constexpr size_t output_high_water = 1 << 16, output_low_water = 1 << 14;
+    //     static constexpr int slow_consumer_policy = SLOW_CONSUMER_DISCONNECT;
+    // };
+    template<uint16_t PORT>
+    struct conn_limits {
+        static constexpr uint32_t max_in_flight        = MAX_IN_FLIGHT_PER_CONN;
+        static constexpr size_t   memory_high_water    = MSG_MEMORY_HIGH_WATER;
+        static constexpr size_t   memory_low_water     = MSG_MEMORY_LOW_WATER;
+        static constexpr size_t   output_high_water    = OUTPUT_HIGH_WATER;
+        static constexpr size_t   output_low_water     = OUTPUT_LOW_WATER;
+        static constexpr int      slow_consumer_policy = SLOW_CONSUMER_POLICY;
+    };
+
+    // 异步 api 的完成令牌
+    // 第一个参数为 completion<T> 且返回 void 的处理器是异步的, handler 线程调用它之后立即处理下一条消息, 回复在令牌被完成时
+    // 给出, 令牌可以被拷贝并在任意线程中完成:
+    //
+    // svr.api("query", [](completion<std::string> done, std::string key) {
+    //     db.async_get(key, [done](std::string value) mutable { done(value); });
+    // });
+    //
+    // 只有第一次完成有效, 所有拷贝都被析构而未完成时以 ERROR 回复. 同一连接上的异步回复按完成的先后写出, 可能与请求的顺序不同
+    template<typename T>
+    class completion {
+
+    public:
+        using value_type   = T;
+        using serializer_t = std::unique_ptr<GenericReply>(*)(msg_context *ctx, T &data);
+
+        completion() = default;
+        completion(msg_context *ctx, serializer_t serialize, std::shared_ptr<std::atomic<uint32_t>> in_flight);
+
+        // 以 value 回复, 返回是否是第一次完成
+        bool operator()(T value);
+
+        // 以 ERROR 回复
+        bool fail(const std::string &msg);
+
+        // 请求的上下文, 令牌完成后不再可用
+        msg_context *context() const;
+
+    private:
+        struct state {
+            msg_context                            *ctx;
+            serializer_t                            serialize;
+            std::shared_ptr<std::atomic<uint32_t>>  in_flight;
+            std::atomic<bool>                       fired;
+
+            bool claim();
+            void finish(std::unique_ptr<GenericReply> reply);
+            ~state();
+        };
+
+        std::shared_ptr<state> _state;
+
+        static std::unique_ptr<GenericReply> error_reply(const std::string &msg);
+
+    };
+
+    template<typename T>
+    struct is_completion : std::false_type {};
+
+    template<typename T>
+    struct is_completion<completion<T>> : std::true_type {};
+
+    // 处理器的参数列表以 completion<T> 开头时为异步处理器
+    template<typename Tuple>
+    struct is_async_args : std::false_type {};
+
+    template<typename First, typename... Others>
+    struct is_async_args<std::tuple<First, Others...>> : is_completion<First> {};
+
+    // 处理器的种类: 同步返回回复 / 通过完成令牌回复 / 返回 task<T> 的协程
+    struct sync_api {};
+    struct async_api {};
+    struct coroutine_api {};
+
+    template<typename Processor>
+    struct api_kind {
+        using type = typename std::conditional<is_async_args<typename func_traits<Processor>::args_type>::value, async_api,
+                     typename std::conditional<is_task<typename func_traits<Processor>::result_type>::value, coroutine_api,
+                     sync_api>::type>::type;
+    };
+
     // 作为 server 的通用协议实现
     class generic {
     public:
@@ -27,6 +215,12 @@ namespace tcp_kit {
 
         template<uint16_t PORT>
         class ev_handler: public ev_handler_base {
+            static_assert(conn_limits<PORT>::max_in_flight > 0 && conn_limits<PORT>::max_in_flight <= 0xfff,
+                          "conn_limits::max_in_flight must fit in ev_context::control::n_async");
+            static_assert(conn_limits<PORT>::memory_low_water <= conn_limits<PORT>::memory_high_water,
+                          "conn_limits::memory_low_water must not exceed memory_high_water");
+            static_assert(conn_limits<PORT>::output_low_water <= conn_limits<PORT>::output_high_water,
+                          "conn_limits::output_low_water must not exceed output_high_water");
         public:
             ev_handler();
             ~ev_handler();
@@ -39,8 +233,35 @@ namespace tcp_kit {
             static void event_callback(bufferevent *bev, short what, void *arg);
             static void process_callback(evutil_socket_t, short, void *arg);
             static void process_error_callback(evutil_socket_t, short, void *arg);
+            static void memory_recheck_callback(evutil_socket_t, short, void *arg);
+            static void tick_callback(evutil_socket_t, short, void *arg);
+            static void timeout_callback(void *arg);
+            static void mailbox_callback(evutil_socket_t, short, void *arg);
+            static void resume_callback(void *arg);
+            static void establish(ev_context *ctx);
+            static void connected(ev_context *ctx, mail *m);
 
             static msg_context* msg_context_new(ev_context *ctx, char *msg_line, const size_t in_len);
+            static bool reply_now(ev_context *ctx, uint32_t code);
+            static bool attach_stream(ev_context *ctx, msg_context *msg_ctx);
+            static bool drain_stream(ev_context *ctx);
+
+            static void pause_read(ev_context *ctx, uint8_t reason);
+            static void check_output(ev_context *ctx);
+            static void resume_read(ev_context *ctx, uint8_t reason);
+            static void release(ev_context *ctx, msg_context *msg_ctx);
+            static bool memory_overloaded();
+
+            static timing_wheel& wheel_of(ev_context *ctx);
+            static uint64_t next_deadline(ev_context *ctx);
+            static void refresh_timer(ev_context *ctx);
+
+            static bool writable(ev_context *ctx);
+            static void deliver(ev_context *ctx, shared_payload *payload);
+            void deliver_to_group(uint32_t group, filter_chain *chain, shared_payload *payload);
+            void join(uint64_t conn_id, uint32_t group);
+            void leave(ev_context *ctx, uint32_t group);
+            void leave_all(ev_context *ctx);
 
             static void when_error(ev_context *ctx);
             static bool try_close(ev_context *ctx);
@@ -53,26 +274,41 @@ namespace tcp_kit {
             event_base                   *_ev_base;
             std::mutex                    _mutex;
             size_t                        _next;
-            static std::atomic<uint32_t>  _id_alloc;
+            static std::atomic<size_t>    _msg_memory;  // 所有连接排队中的消息占用的内存
+            event                        *_memory_ev;   // 检查内存水位的定时器
+            std::unordered_set<ev_context*> _memory_paused;
+            timing_wheel                  _wheel;       // 所有连接的超时定时器
+            event                        *_tick_ev;     // 驱动时间轮的定时器
+            std::chrono::steady_clock::time_point _wheel_epoch;
+            std::unordered_map<uint32_t, std::unordered_set<ev_context*>> _groups;      // 组 -> 该 ev_handler 上的成员
+            std::unordered_map<ev_context*, std::vector<uint32_t>>         _memberships; // 连接 -> 加入的组
+            std::vector<ev_context*>                                       _recipients;  // 广播时成员的快照
 #ifdef __APPLE__
             event *_accept_ev;
             event *init(server_base *server_ptr) override;
 #elif __linux__
-            evconnlistener        *_evc;
+            std::vector<acceptor>  _acceptors;  // 每个监听端口一个, 各自以 SO_REUSEPORT 绑定
             void init(server_base *server_ptr) override;
 #endif
             void run() override;
+            bool push(ev_context *ctx, evbuffer *buf) override;
             inline handler_base* next();
         };
 
+        // Filters 为 server 展开后的完整过滤器类型列表, server 的 PORT 上的消息经类型完整的 Process Filters 调用链处理,
+        // 不经过函数指针. 其他监听端口(见 server::listen)的消息经由其过滤器链的 pipeline 入口处理
+        template<typename Filters>
         class handler: public handler_base {
         public:
             handler() = default;
 
         protected:
+            using pipeline = process_pipeline<typename process_filters_of<Filters>::types>;
+
             void init(server_base *server_ptr) override;
             void run() override;
             inline msg_context* pop();
+            static void release_limiter(msg_context *ctx);
 
         };
 
@@ -81,16 +317,37 @@ namespace tcp_kit {
         public:
             static std::unique_ptr<GenericReply> process(msg_context *ctx, std::unique_ptr<GenericMsg> msg);
 
+            static std::unique_ptr<GenericReply> reply(msg_context *ctx, uint32_t code);
+
+            template<typename T>
+            static std::unique_ptr<GenericReply> publication(const std::string &topic, T &data);
+
             template<typename Processor>
-            static void api(const std::string &id, Processor prcs);
+            static void api(const std::string &id, Processor prcs, api_options opts = {});
 
             template<typename T>
-            static std::unique_ptr<GenericReply> serialize(T &data);
+            static std::unique_ptr<GenericReply> serialize(msg_context *ctx, T &data);
+
+            static std::unique_ptr<GenericReply> serialize(msg_context *ctx, file_region &region);
+
+            static std::unique_ptr<GenericReply> serialize(msg_context *ctx, file_sink &sink);
 
             template<typename Tuple>
             static Tuple deserialize(msg_context *ctx, std::unique_ptr<GenericMsg> &);
 
         private:
+            template<typename Processor>
+            static std::unique_ptr<GenericReply> invoke(Processor &prcs, msg_context *ctx, std::unique_ptr<GenericMsg> &msg,
+                                                        const std::shared_ptr<std::atomic<uint32_t>> &in_flight, sync_api);
+
+            template<typename Processor>
+            static std::unique_ptr<GenericReply> invoke(Processor &prcs, msg_context *ctx, std::unique_ptr<GenericMsg> &msg,
+                                                        const std::shared_ptr<std::atomic<uint32_t>> &in_flight, async_api);
+
+            template<typename Processor>
+            static std::unique_ptr<GenericReply> invoke(Processor &prcs, msg_context *ctx, std::unique_ptr<GenericMsg> &msg,
+                                                        const std::shared_ptr<std::atomic<uint32_t>> &in_flight, coroutine_api);
+
             using map_t = std::unordered_map<std::string , std::function<std::unique_ptr<GenericReply>(msg_context *ctx, std::unique_ptr<GenericMsg>)>>;
             static map_t _api_map;
 
@@ -98,52 +355,106 @@ namespace tcp_kit {
 
         class protobuf_deserializer {
         public:
-            static std::unique_ptr<GenericMsg> process(msg_context *ctx, std::unique_ptr<msg_buffer> input);
+            static std::unique_ptr<GenericMsg> process(msg_context *ctx, msg_buffer input);
         };
 
         class protobuf_serializer {
         public:
-            static std::unique_ptr<msg_buffer> process(msg_context *ctx, std::unique_ptr<GenericReply> input);
+            static msg_buffer process(msg_context *ctx, std::unique_ptr<GenericReply> input);
+        };
+
+        // 客户端的编解码, 与上面的过滤器方向相反: 请求编码为帧(含 CRLF), 帧(不含 CRLF)解码为回复
+        class protobuf_codec {
+        public:
+            static std::string encode(const GenericMsg &msg);
+            static bool decode(const char *frame, size_t len, GenericReply &reply);
         };
 
+        using client_codec = protobuf_codec;
+
     };
 
     template<uint16_t PORT>
-    std::atomic<uint32_t> generic::ev_handler<PORT>::_id_alloc{0};
+    std::atomic<size_t> generic::ev_handler<PORT>::_msg_memory{0};
 
 #ifdef __APPLE__
     template<uint16_t PORT>
     void generic::ev_handler<PORT>::accept_callback0(int, short, void *arg) {
         auto *ev_handler_ = static_cast<generic::ev_handler<PORT> *>(arg);
         conn_info *c_info_ = &ev_handler_->c_info;
+        acceptor acceptor_{ev_handler_, c_info_->filters, nullptr};
         // TODO: 传 nullptr 可能有问题
-        accept_callback(nullptr, c_info_->fd, c_info_->address, c_info_->socklen, arg);
+        accept_callback(nullptr, c_info_->fd, c_info_->address, c_info_->socklen, &acceptor_);
     }
 #endif
 
     template<uint16_t PORT>
     void generic::ev_handler<PORT>::accept_callback(evconnlistener *listener, socket_t fd, sockaddr *address, int socklen, void *arg) {
-        auto *ev_handler_ = static_cast<generic::ev_handler<PORT> *>(arg);
+        auto *acceptor_ = static_cast<acceptor *>(arg);
+        auto *ev_handler_ = static_cast<generic::ev_handler<PORT> *>(acceptor_->owner);
         bufferevent *bev = bufferevent_socket_new(ev_handler_->_ev_base, fd, BEV_OPT_CLOSE_ON_FREE);
         if(!bev) {
             log_error("Failed to allocate the bufferevent");
             bufferevent_free(bev);
             return;
         }
-        ev_context *ctx = new ev_context{{0, ev_context::CONNECTED, 0}, fd, address, socklen,
-                                          ev_handler_->_id_alloc++, ev_handler_, ev_handler_->next(), bev};
+        uint64_t conn_id;
+        void *slot = ev_handler_->conns.acquire(conn_id);
+        if(!slot) {
+            log_warn("The connection table is full, the connection will be closed");
+            bufferevent_free(bev);
+            return;
+        }
+        ev_context *ctx = new (slot) ev_context{{0, ev_context::CONNECTED, 0}, fd, address, socklen,
+                                                conn_id, ev_handler_, ev_handler_->next(), bev, acceptor_->filters};
+        metrics::count(metrics::CONN_ACCEPTED);
         try {
             ev_handler_->call_conn_filters(ctx);
-            ev_handler_->register_read_write_filters(ctx);
-            ctx->ctl.state = ev_context::READY;
-            if(bufferevent_enable(ctx->bev, EV_READ | EV_WRITE) == SUCCESSFUL) {
-                bufferevent_setcb(ctx->bev, read_callback, write_callback, event_callback, ctx);
-                ctx->ctl.state = ev_context::ACTIVE;
-            } else {
-                throw generic_error<CONS_BEV_FAILED>("Failed to enable the read/write events of bufferevent");
-            }
+            // 连接过滤器挂起了建立, 由 CONNECT 邮件继续
+            if(!ctx->resume_connects)
+                establish(ctx);
+        } catch (const std::exception &err) {
+            log_error("%s", err.what());
+            when_error(ctx);
+            try_free_ctx(ctx);
+        }
+    }
+
+    // 连接过滤器调用完毕后注册读写过滤器并开始读写, 失败时抛出异常
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::establish(ev_context *ctx) {
+        static_cast<ev_handler<PORT> *>(ctx->ev_handler)->register_read_write_filters(ctx);
+        ctx->ctl.state = ev_context::READY;
+        ctx->timer.callback = timeout_callback;
+        ctx->timer.arg = ctx;
+        if(bufferevent_enable(ctx->bev, EV_READ | EV_WRITE) == SUCCESSFUL) {
+            bufferevent_setcb(ctx->bev, read_callback, write_callback, event_callback, ctx);
+            // 输出缓冲回落到低水位时触发写回调, 解除限流
+            bufferevent_setwatermark(ctx->bev, EV_WRITE, conn_limits<PORT>::output_low_water, 0);
+            ctx->ctl.state = ev_context::ACTIVE;
+            ctx->last_active = wheel_of(ctx).now();
+            refresh_timer(ctx);
+        } else {
+            throw generic_error<CONS_BEV_FAILED>("Failed to enable the read/write events of bufferevent");
+        }
+    }
+
+    // 被挂起的连接恢复建立, 余下的连接过滤器可能再次挂起
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::connected(ev_context *ctx, mail *m) {
+        void (*rest)(ev_context*) = ctx->resume_connects;
+        ctx->resume_connects = nullptr;
+        try {
+            if(m->group)
+                throw generic_error<CONNECT_FAILED>("Connection [%llu] failed to be established",
+                                                     (unsigned long long) ctx->conn_id);
+            if(m->then)
+                m->then(ctx, m->arg);
+            rest(ctx);
+            if(!ctx->resume_connects)
+                establish(ctx);
         } catch (const std::exception &err) {
-            log_error(err.what());
+            log_error("%s", err.what());
             when_error(ctx);
             try_free_ctx(ctx);
         }
@@ -152,22 +463,77 @@ namespace tcp_kit {
     template<uint16_t PORT>
     void generic::ev_handler<PORT>::read_callback(bufferevent *bev, void *arg) {
         auto *ctx = static_cast<ev_context *>(arg);
-        msg_context *msg_ctx;
+        msg_context *msg_ctx = nullptr;
         try {
             if(ctx->ctl.state == ev_context::ACTIVE) {
+                uint64_t now = wheel_of(ctx).now();
+                ctx->last_active = now;
+                if(ctx->recv.mode == stream_context::RECV && !drain_stream(ctx)) {
+                    refresh_timer(ctx);
+                    return;
+                }
                 evbuffer *input = bufferevent_get_input(ctx->bev);
                 size_t len = 0;
-                char *msg_line = evbuffer_readln(input, &len, EVBUFFER_EOL_CRLF);
-                if(msg_line) {
+                char *msg_line;
+                while(!ctx->ctl.paused) {
+                    if(memory_overloaded()) {
+                        pause_read(ctx, ev_context::PAUSED_BY_MEMORY);
+                        break;
+                    }
+                    uint64_t read_at = trace::active() ? trace::ticks() : 0;
+                    if(!(msg_line = evbuffer_readln(input, &len, EVBUFFER_EOL_CRLF)))
+                        break;
+                    metrics::count(metrics::FRAMES_IN);
+                    metrics::count(metrics::BYTES_IN, len);
+                    metrics::record(metrics::FRAME_BYTES, len);
+                    bool admitted = ctx->ev_handler->limiter.try_acquire();
+                    if(!admitted)
+                        metrics::count(metrics::MSG_REJECTED);
+                    // 过载时不再入队与解析, 连接上没有处理中的请求时立即回复. 否则回复(不带关联 id, 客户端将它对应到最早的
+                    // 待回复请求)要排在之前的回复之后: 扣留它并暂停读取, 之前的请求全部回复后再写出
+                    if(!admitted && ctx->ctl.n_async == 0 && reply_now(ctx, GenericReply::OVERLOADED)) {
+                        free(msg_line);
+                        continue;
+                    }
+                    if(!admitted && ctx->filters->reply != &empty_reply_chain) {
+                        free(msg_line);
+                        ctx->ctl.held_reject = true;
+                        pause_read(ctx, ev_context::PAUSED_BY_IN_FLIGHT);
+                        break;
+                    }
                     msg_ctx = msg_context_new(ctx, msg_line, len);
+                    if(admitted)
+                        msg_ctx->limiter = &ctx->ev_handler->limiter;
+                    else
+                        msg_ctx->reject_code = GenericReply::OVERLOADED;
+                    if(read_at) {
+                        msg_ctx->trace_id = trace::sample();
+                        msg_ctx->trace_mark = read_at;
+                        trace::mark(msg_ctx->trace_id, msg_ctx->trace_mark, trace::READ);
+                    }
+                    // 入队后 msg_context 可能随即被 handler 释放, 入队的阶段以局部变量记录
+                    uint64_t trace_id = msg_ctx->trace_id, push_at = msg_ctx->trace_mark;
                     ctx->handler->msg_queue->push(msg_ctx);
-                    ++ctx->ctl.n_async;
+                    msg_ctx = nullptr;
+                    trace::mark(trace_id, push_at, trace::ENQUEUE);
+                    metrics::count(metrics::MSG_ENQUEUED);
+                    _msg_memory.fetch_add(len, std::memory_order_relaxed);
+                    if(ctx->ctl.n_async == 0)
+                        ctx->request_since = now;
+                    if(++ctx->ctl.n_async >= conn_limits<PORT>::max_in_flight)
+                        pause_read(ctx, ev_context::PAUSED_BY_IN_FLIGHT);
                 }
+                // 暂停期间留在输入缓冲中的是尚未处理的消息, 不计入接收超时
+                bool partial = !ctx->ctl.paused && evbuffer_get_length(input) > 0;
+                if(partial && !ctx->ctl.partial)
+                    ctx->header_since = now;
+                ctx->ctl.partial = partial;
+                refresh_timer(ctx);
             } else {
                 try_free_ctx(ctx);
             }
         } catch (const std::exception &err) {
-            log_error(err.what());
+            log_error("%s", err.what());
             if(msg_ctx)
                 msg_ctx_free(msg_ctx);
             when_error(ctx);
@@ -177,7 +543,15 @@ namespace tcp_kit {
 
     template<uint16_t PORT>
     void generic::ev_handler<PORT>::write_callback(bufferevent *bev, void *arg) {
-
+        auto *ctx = static_cast<ev_context *>(arg);
+        trace::mark(ctx->trace_id, ctx->trace_mark, trace::FLUSH);
+        ctx->trace_id = 0;
+        if(ctx->ctl.paused & ev_context::PAUSED_BY_OUTPUT) {
+            --ctx->ev_handler->n_throttled;
+            metrics::count(metrics::CONN_UNTHROTTLED);
+            ctx->ev_handler->notify_writable();
+            resume_read(ctx, ev_context::PAUSED_BY_OUTPUT);
+        }
     }
 
     template<uint16_t PORT>
@@ -198,13 +572,47 @@ namespace tcp_kit {
         ev_context *ctx = pair->first;
         msg_context *msg_ctx = pair->second;
         delete pair;
-        --ctx->ctl.n_async;
+        trace::mark(msg_ctx->trace_id, msg_ctx->trace_mark, trace::DISPATCH);
+        release(ctx, msg_ctx);
         if(ctx->ctl.state == ev_context::ACTIVE) {
             evbuffer_add_reference(bufferevent_get_output(ctx->bev), msg_ctx->out, msg_ctx->out_len,
                                    [](const void *data, size_t len, void *arg) { free(static_cast<char *>(arg)); },
                                    msg_ctx->out);
+            metrics::count(metrics::REPLIES_OUT);
+            metrics::count(metrics::BYTES_OUT, msg_ctx->out_len);
+            auto now = std::chrono::steady_clock::now();
+            uint64_t latency = metrics::record_since(metrics::REQUEST_NS, msg_ctx->enqueued_at, now);
+            access_log::log_request(now, msg_ctx->conn_id, msg_ctx->api, msg_ctx->seq, latency,
+                                    uint32_t(msg_ctx->in_len), uint32_t(msg_ctx->out_len), msg_ctx->reply_code);
+            trace::mark(msg_ctx->trace_id, msg_ctx->trace_mark, trace::REPLY);
+            if(msg_ctx->trace_id) {
+                ctx->trace_id = msg_ctx->trace_id;
+                ctx->trace_mark = msg_ctx->trace_mark;
+            }
             msg_ctx->out = nullptr;
-            msg_ctx_free(msg_ctx);
+            bool reread;
+            try {
+                reread = attach_stream(ctx, msg_ctx);
+                msg_ctx_free(msg_ctx);
+            } catch (const std::exception &err) {
+                log_error("%s", err.what());
+                msg_ctx_free(msg_ctx);
+                when_error(ctx);
+                try_free_ctx(ctx);
+                return;
+            }
+            if(ctx->ctl.held_reject && !ctx->ctl.n_async) {
+                ctx->ctl.held_reject = false;
+                reply_now(ctx, GenericReply::OVERLOADED);
+            }
+            check_output(ctx);
+            ctx->last_active = wheel_of(ctx).now();
+            refresh_timer(ctx);
+            // 可能在读回调中释放 ctx, 所以放在最后, 且读回调只调用一次. 连接仍暂停时由 resume_read 决定是否读取
+            if(reread && !ctx->ctl.paused)
+                read_callback(ctx->bev, ctx);
+            else
+                resume_read(ctx, ev_context::PAUSED_BY_IN_FLIGHT);
         } else {
             msg_ctx_free(msg_ctx);
             try_free_ctx(ctx);
@@ -217,7 +625,7 @@ namespace tcp_kit {
         ev_context *ctx = pair->first;
         msg_context *msg_ctx = pair->second;
         delete pair;
-        --ctx->ctl.n_async;
+        release(ctx, msg_ctx);
         msg_ctx_free(msg_ctx);
         when_error(ctx);
         try_free_ctx(ctx);
@@ -227,6 +635,12 @@ namespace tcp_kit {
     msg_context* generic::ev_handler<PORT>::msg_context_new(ev_context *ctx, char *msg_line, const size_t in_len) {
         auto *base = static_cast<ev_handler<PORT> *>(ctx->ev_handler)->_ev_base;
         msg_context *msg_ctx = new msg_context{ctx->conn_id, msg_line, in_len, nullptr, 0, false, nullptr, nullptr, false};
+        msg_ctx->ev_handler = ctx->ev_handler;
+        msg_ctx->handler = ctx->handler;
+        msg_ctx->filters = ctx->filters;
+        msg_ctx->enqueued_at = std::chrono::steady_clock::now();
+        if(MAX_QUEUE_WAIT_MS)
+            msg_ctx->set_timeout(std::chrono::milliseconds(MAX_QUEUE_WAIT_MS));
         auto ctx_pair = new std::pair<ev_context *, msg_context *>(ctx, msg_ctx);
         msg_ctx->done_ev = event_new(base, -1, 0, process_callback, ctx_pair);
         msg_ctx->error_ev = event_new(base, -1, 0, process_error_callback, ctx_pair);
@@ -239,6 +653,205 @@ namespace tcp_kit {
         }
     }
 
+    // 在 ev_handler 线程中直接以状态码回复, 过滤器链不支持时返回 false
+    template <uint16_t PORT>
+    bool generic::ev_handler<PORT>::reply_now(ev_context *ctx, uint32_t code) {
+        msg_context msg_ctx{ctx->conn_id};
+        std::unique_ptr<msg_buffer> res = ctx->filters->reply(&msg_ctx, code);
+        if(!res)
+            return false;
+        evbuffer_add_reference(bufferevent_get_output(ctx->bev), res->ptr, res->size,
+                               [](const void *data, size_t len, void *arg) { free(static_cast<char *>(arg)); },
+                               res->ptr);
+        check_output(ctx);
+        return true;
+    }
+
+    // 回复(帧头)写入输出缓冲后, 将文件流接在其后发送, 或将连接切换为接收文件流的状态.
+    // 返回是否需要继续读取输入缓冲中已有的消息(文件流已在其中接收完毕), 由调用者在不再访问 ctx 时调用读回调
+    template<uint16_t PORT>
+    bool generic::ev_handler<PORT>::attach_stream(ev_context *ctx, msg_context *msg_ctx) {
+        stream_context &stream = msg_ctx->stream;
+        if(stream.mode == stream_context::SEND) {
+            int fd = stream.fd;
+            stream.mode = stream_context::NONE;
+            if(stream.length > 0) {
+                // 文件段持有 fd, 数据由 sendfile(或 mmap) 直接从文件写入 socket
+                evbuffer_file_segment *seg = evbuffer_file_segment_new(fd, stream.offset, stream.length,
+                                                                       EVBUF_FS_CLOSE_ON_FREE);
+                if(!seg) {
+                    close(fd);
+                    throw generic_error<CONS_EVENT_FAILED>("Failed to construct the file segment");
+                }
+                int res = evbuffer_add_file_segment(bufferevent_get_output(ctx->bev), seg, 0, stream.length);
+                evbuffer_file_segment_free(seg);
+                if(res != SUCCESSFUL)
+                    throw generic_error<CONS_EVENT_FAILED>("Failed to add the file segment to the output");
+            } else {
+                close(fd);
+            }
+        } else if(stream.mode == stream_context::RECV) {
+            if(ctx->recv.mode == stream_context::RECV)
+                close(ctx->recv.fd);
+            ctx->recv = stream;
+            stream.mode = stream_context::NONE;
+            // 按约定客户端收到回复后才发送文件流, 此时输入缓冲一般为空. 不遵守约定而提前发送的字节已被当作消息分帧,
+            // 余下的不完整部分在这里写入文件, 它们不会再次触发读回调
+            return drain_stream(ctx);
+        }
+        return false;
+    }
+
+    // 将输入缓冲中的数据直接写入正在接收的文件, 返回文件流是否已接收完毕
+    template<uint16_t PORT>
+    bool generic::ev_handler<PORT>::drain_stream(ev_context *ctx) {
+        evbuffer *input = bufferevent_get_input(ctx->bev);
+        stream_context &recv = ctx->recv;
+        while(recv.length > 0 && evbuffer_get_length(input) > 0) {
+            int n = evbuffer_write_atmost(input, recv.fd, recv.length);
+            if(n <= 0)
+                throw generic_error<ILLEGALITY_ARGS>("Failed to write the stream to the file");
+            recv.length -= n;
+        }
+        if(recv.length == 0) {
+            close(recv.fd);
+            recv.mode = stream_context::NONE;
+            return true;
+        }
+        return false;
+    }
+
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::tick_callback(int, short, void *arg) {
+        auto *ev_handler_ = static_cast<ev_handler<PORT> *>(arg);
+        auto elapsed = std::chrono::steady_clock::now() - ev_handler_->_wheel_epoch;
+        ev_handler_->_wheel.advance(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                                    / TIMING_WHEEL_TICK_MS);
+        access_log::flush();
+    }
+
+    // 定时器可能提前触发(延后的截止时间不会重新挂载定时器), 此时按照最新的截止时间重新挂载
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::timeout_callback(void *arg) {
+        auto *ctx = static_cast<ev_context *>(arg);
+        if(ctx->ctl.state != ev_context::ACTIVE)
+            return;
+        uint64_t deadline = next_deadline(ctx);
+        if(deadline == NO_DEADLINE || deadline > wheel_of(ctx).now()) {
+            refresh_timer(ctx);
+            return;
+        }
+        log_debug("Connection [%llu] timed out", (unsigned long long) ctx->conn_id);
+        when_error(ctx);
+        try_free_ctx(ctx);
+    }
+
+    template<uint16_t PORT>
+    inline timing_wheel& generic::ev_handler<PORT>::wheel_of(ev_context *ctx) {
+        return static_cast<ev_handler<PORT> *>(ctx->ev_handler)->_wheel;
+    }
+
+    template<uint16_t PORT>
+    uint64_t generic::ev_handler<PORT>::next_deadline(ev_context *ctx) {
+        using timeouts = conn_timeouts<PORT>;
+        constexpr uint64_t idle = (timeouts::idle_ms + TIMING_WHEEL_TICK_MS - 1) / TIMING_WHEEL_TICK_MS;
+        constexpr uint64_t header = (timeouts::read_header_ms + TIMING_WHEEL_TICK_MS - 1) / TIMING_WHEEL_TICK_MS;
+        constexpr uint64_t request = (timeouts::request_ms + TIMING_WHEEL_TICK_MS - 1) / TIMING_WHEEL_TICK_MS;
+        uint64_t deadline = NO_DEADLINE;
+        if(idle && !ctx->ctl.n_async)
+            deadline = ctx->last_active + idle;
+        if(header && ctx->ctl.partial)
+            deadline = std::min(deadline, ctx->header_since + header);
+        if(request && ctx->ctl.n_async)
+            deadline = std::min(deadline, ctx->request_since + request);
+        return deadline;
+    }
+
+    // 截止时间提前时重新挂载定时器, 推后时保持不变, 由定时器触发后再重新计算, 避免每次读写都操作时间轮
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::refresh_timer(ev_context *ctx) {
+        timing_wheel &wheel = wheel_of(ctx);
+        uint64_t deadline = next_deadline(ctx);
+        if(deadline == NO_DEADLINE) {
+            wheel.cancel(&ctx->timer);
+        } else if(!timing_wheel::armed(&ctx->timer) || ctx->timer.expire > deadline) {
+            uint64_t now = wheel.now();
+            wheel.arm(&ctx->timer, deadline > now ? deadline - now : 0);
+        }
+    }
+
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::memory_recheck_callback(int, short, void *arg) {
+        auto *ev_handler_ = static_cast<ev_handler<PORT> *>(arg);
+        if(_msg_memory.load(std::memory_order_relaxed) > conn_limits<PORT>::memory_low_water) {
+            timeval tv{0, MSG_MEMORY_RECHECK_MS * 1000};
+            evtimer_add(ev_handler_->_memory_ev, &tv);
+            return;
+        }
+        std::vector<ev_context*> paused(ev_handler_->_memory_paused.begin(), ev_handler_->_memory_paused.end());
+        ev_handler_->_memory_paused.clear();
+        for(ev_context *ctx : paused)
+            resume_read(ctx, ev_context::PAUSED_BY_MEMORY);
+    }
+
+    // 停止从连接读取数据, 已读入输入缓冲的数据保留到恢复之后处理
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::pause_read(ev_context *ctx, uint8_t reason) {
+        if(ctx->ctl.paused & reason)
+            return;
+        if(!ctx->ctl.paused)
+            bufferevent_disable(ctx->bev, EV_READ);
+        ctx->ctl.paused |= reason;
+        if(reason == ev_context::PAUSED_BY_MEMORY) {
+            auto *ev_handler_ = static_cast<ev_handler<PORT> *>(ctx->ev_handler);
+            if(ev_handler_->_memory_paused.empty()) {
+                timeval tv{0, MSG_MEMORY_RECHECK_MS * 1000};
+                evtimer_add(ev_handler_->_memory_ev, &tv);
+            }
+            ev_handler_->_memory_paused.insert(ctx);
+        }
+    }
+
+    // 输出缓冲超过高水位时限流该连接
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::check_output(ev_context *ctx) {
+        if(!(ctx->ctl.paused & ev_context::PAUSED_BY_OUTPUT)
+           && evbuffer_get_length(bufferevent_get_output(ctx->bev)) > conn_limits<PORT>::output_high_water) {
+            pause_read(ctx, ev_context::PAUSED_BY_OUTPUT);
+            ++ctx->ev_handler->n_throttled;
+            metrics::count(metrics::CONN_THROTTLED);
+        }
+    }
+
+    // 所有暂停原因解除后恢复读取. 读回调中可能释放 ctx, 调用之后不应再访问 ctx
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::resume_read(ev_context *ctx, uint8_t reason) {
+        if(!(ctx->ctl.paused & reason))
+            return;
+        if(reason == ev_context::PAUSED_BY_IN_FLIGHT && (ctx->ctl.n_async >= conn_limits<PORT>::max_in_flight || ctx->ctl.held_reject))
+            return;
+        ctx->ctl.paused &= ~reason;
+        if(!ctx->ctl.paused && ctx->ctl.state == ev_context::ACTIVE) {
+            bufferevent_enable(ctx->bev, EV_READ);
+            // 暂停期间留在输入缓冲中的数据不会再次触发读回调
+            if(evbuffer_get_length(bufferevent_get_input(ctx->bev)))
+                read_callback(ctx->bev, ctx);
+        }
+    }
+
+    // 请求完成(无论成功与否), 归还它占用的配额
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::release(ev_context *ctx, msg_context *msg_ctx) {
+        if(--ctx->ctl.n_async)
+            ctx->request_since = wheel_of(ctx).now();
+        _msg_memory.fetch_sub(msg_ctx->in_len, std::memory_order_relaxed);
+    }
+
+    template<uint16_t PORT>
+    inline bool generic::ev_handler<PORT>::memory_overloaded() {
+        return _msg_memory.load(std::memory_order_relaxed) >= conn_limits<PORT>::memory_high_water;
+    }
+
     template<uint16_t PORT>
     void generic::ev_handler<PORT>::when_error(ev_context *ctx) {
         ctx->ctl.error = true;
@@ -254,9 +867,24 @@ namespace tcp_kit {
         if(ctx->ctl.n_async == 0) {
             auto *ev_handler_ = static_cast<generic::ev_handler<PORT>*>(ctx->ev_handler);
             ev_handler_->call_close_filters(ctx);
+            ev_handler_->_wheel.cancel(&ctx->timer);
+            ev_handler_->leave_all(ctx);
+            if(ctx->ctl.paused & ev_context::PAUSED_BY_MEMORY)
+                ev_handler_->_memory_paused.erase(ctx);
+            if(ctx->ctl.paused & ev_context::PAUSED_BY_OUTPUT) {
+                --ev_handler_->n_throttled;
+                metrics::count(metrics::CONN_UNTHROTTLED);
+                ev_handler_->notify_writable();
+            }
+            ctx->ctl.paused = 0;
+            if(ctx->recv.mode == stream_context::RECV) {
+                close(ctx->recv.fd);
+                ctx->recv.mode = stream_context::NONE;
+            }
             bufferevent_free(ctx->bev);
             ctx->bev = nullptr;
             ctx->ctl.state = ev_context::CLOSED;
+            metrics::count(metrics::CONN_CLOSED);
             return true;
         }
         return false;
@@ -271,7 +899,7 @@ namespace tcp_kit {
     bool generic::ev_handler<PORT>::try_free_ctx(ev_context* ctx) {
         if(try_close(ctx)) {
             terminate(ctx);
-            delete ctx;
+            ctx->ev_handler->conns.release(ctx);
             return true;
         }
         return false;
@@ -283,11 +911,21 @@ namespace tcp_kit {
         if(ctx->out) free(ctx->out);
         if(ctx->done_ev) event_free(ctx->done_ev);
         if(ctx->error_ev) event_free(ctx->error_ev);
+        if(ctx->stream.mode != stream_context::NONE) close(ctx->stream.fd);
         delete ctx;
     }
 
     template<uint16_t PORT>
-    generic::ev_handler<PORT>::ev_handler(): _ev_base(event_base_new()), _next(0) { }
+    generic::ev_handler<PORT>::ev_handler(): _ev_base(event_base_new()), _next(0),
+                                             _wheel_epoch(std::chrono::steady_clock::now()) {
+        _memory_ev = evtimer_new(_ev_base, memory_recheck_callback, this);
+        _tick_ev = event_new(_ev_base, -1, EV_PERSIST, tick_callback, this);
+        _mailbox_ev = event_new(_ev_base, -1, 0, mailbox_callback, this);
+        if(conn_limits<PORT>::slow_consumer_policy == SLOW_CONSUMER_BLOCK)
+            writer_block = std::chrono::milliseconds(SLOW_CONSUMER_BLOCK_MS);
+        timeval tv{TIMING_WHEEL_TICK_MS / 1000, (TIMING_WHEEL_TICK_MS % 1000) * 1000};
+        event_add(_tick_ev, &tv);
+    }
 
 #ifdef __APPLE__
     template<uint16_t PORT>
@@ -300,11 +938,19 @@ namespace tcp_kit {
     template<uint16_t PORT>
     void generic::ev_handler<PORT>::init(server_base* server_ptr) {
         _server = static_cast<server<generic, PORT>*>(server_ptr);
-        sockaddr_in sin = socket_address(PORT);
-        _evc = evconnlistener_new_bind(
-                _ev_base, &generic::ev_handler<PORT>::accept_callback, this,
-                LEV_OPT_REUSEABLE | LEV_OPT_CLOSE_ON_FREE | LEV_OPT_REUSEABLE_PORT,
-                -1, (sockaddr*) &sin, sizeof(sin));
+        const std::vector<endpoint> &endpoints = server_ptr->endpoints();
+        // 回调持有 acceptor 的地址, 创建监听之前一次性分配
+        _acceptors.reserve(endpoints.size());
+        for(const endpoint &e : endpoints) {
+            _acceptors.push_back({this, e.filters.get(), nullptr});
+            sockaddr_in sin = socket_address(e.port);
+            _acceptors.back().evc = evconnlistener_new_bind(
+                    _ev_base, &generic::ev_handler<PORT>::accept_callback, &_acceptors.back(),
+                    LEV_OPT_REUSEABLE | LEV_OPT_CLOSE_ON_FREE | LEV_OPT_REUSEABLE_PORT,
+                    -1, (sockaddr*) &sin, sizeof(sin));
+            if(!_acceptors.back().evc)
+                log_error("Cannot open the socket of port: %d", e.port);
+        }
     }
 #endif
 
@@ -318,6 +964,151 @@ namespace tcp_kit {
 #endif
     }
 
+    template<uint16_t PORT>
+    bool generic::ev_handler<PORT>::push(ev_context *ctx, evbuffer *buf) {
+        if(!writable(ctx)) {
+            evbuffer_drain(buf, evbuffer_get_length(buf));
+            return false;
+        }
+        if(bufferevent_write_buffer(ctx->bev, buf) != SUCCESSFUL)
+            return false;
+        check_output(ctx);
+        return true;
+    }
+
+    // 连接是否可以写入推送的数据, 被限流时按照 conn_limits<PORT>::slow_consumer_policy 处理
+    template<uint16_t PORT>
+    bool generic::ev_handler<PORT>::writable(ev_context *ctx) {
+        if(ctx->ctl.state != ev_context::ACTIVE)
+            return false;
+        constexpr int policy = conn_limits<PORT>::slow_consumer_policy;
+        if(policy != SLOW_CONSUMER_BLOCK && (ctx->ctl.paused & ev_context::PAUSED_BY_OUTPUT)) {
+            if(policy == SLOW_CONSUMER_DISCONNECT) {
+                log_warn("Connection [%llu] is consuming too slowly and will be closed", (unsigned long long) ctx->conn_id);
+                when_error(ctx);
+                try_free_ctx(ctx);
+            }
+            return false;
+        }
+        return true;
+    }
+
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::deliver(ev_context *ctx, shared_payload *payload) {
+        if(writable(ctx) && payload->add_to(bufferevent_get_output(ctx->bev))) {
+            check_output(ctx);
+            // 只接收推送的连接(如订阅者)并不空闲
+            ctx->last_active = wheel_of(ctx).now();
+            refresh_timer(ctx);
+        }
+    }
+
+    // 先对成员做快照, 投递过程中连接可能因慢消费者策略断开并离开组. chain 不为空时只投递给该过滤器链的连接
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::deliver_to_group(uint32_t group, filter_chain *chain, shared_payload *payload) {
+        _recipients.clear();
+        if(group == ALL_CONNS) {
+            conns.for_each([this](ev_context *ctx) { _recipients.push_back(ctx); });
+        } else {
+            auto it = _groups.find(group);
+            if(it == _groups.end())
+                return;
+            _recipients.assign(it->second.begin(), it->second.end());
+        }
+        // 断开的连接在本轮事件循环中不会被复用, 由 writable 检查其状态
+        for(ev_context *ctx : _recipients) {
+            if(!chain || ctx->filters == chain)
+                deliver(ctx, payload);
+        }
+    }
+
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::join(uint64_t conn_id, uint32_t group) {
+        ev_context *ctx = conns.find(conn_id);
+        if(!ctx || ctx->ctl.state != ev_context::ACTIVE)
+            return;
+        if(_groups[group].insert(ctx).second)
+            _memberships[ctx].push_back(group);
+    }
+
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::leave(ev_context *ctx, uint32_t group) {
+        auto it = _groups.find(group);
+        if(it == _groups.end() || !it->second.erase(ctx))
+            return;
+        if(it->second.empty())
+            _groups.erase(it);
+        auto &groups = _memberships[ctx];
+        groups.erase(std::find(groups.begin(), groups.end(), group));
+        if(groups.empty())
+            _memberships.erase(ctx);
+    }
+
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::leave_all(ev_context *ctx) {
+        auto it = _memberships.find(ctx);
+        if(it == _memberships.end())
+            return;
+        for(uint32_t group : it->second) {
+            auto git = _groups.find(group);
+            git->second.erase(ctx);
+            if(git->second.empty())
+                _groups.erase(git);
+        }
+        _memberships.erase(it);
+    }
+
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::mailbox_callback(evutil_socket_t, short, void *arg) {
+        auto *ev_handler_ = static_cast<generic::ev_handler<PORT> *>(arg);
+        mail *m = ev_handler_->_mailbox.pop_all();
+        while(m) {
+            mail *next = m->next;
+            ev_context *ctx;
+            switch(m->kind) {
+                case mail::SEND:
+                    if((ctx = ev_handler_->conns.find(m->target)))
+                        deliver(ctx, m->payload);
+                    break;
+                case mail::BROADCAST:
+                    ev_handler_->deliver_to_group(m->group, reinterpret_cast<filter_chain *>(m->target), m->payload);
+                    break;
+                case mail::JOIN:
+                    ev_handler_->join(m->target, m->group);
+                    break;
+                case mail::LEAVE:
+                    if((ctx = ev_handler_->conns.find(m->target)))
+                        ev_handler_->leave(ctx, m->group);
+                    break;
+                case mail::RESUME: {
+                    auto *msg_ctx = reinterpret_cast<msg_context *>(m->target);
+                    if(m->group) {
+                        msg_ctx->resume_timer.callback = resume_callback;
+                        msg_ctx->resume_timer.arg = msg_ctx;
+                        ev_handler_->_wheel.arm(&msg_ctx->resume_timer,
+                                                (m->group + TIMING_WHEEL_TICK_MS - 1) / TIMING_WHEEL_TICK_MS);
+                    } else {
+                        resume_callback(msg_ctx);
+                    }
+                    break;
+                }
+                case mail::CONNECT:
+                    connected(reinterpret_cast<ev_context *>(m->target), m);
+                    break;
+            }
+            if(m->payload)
+                m->payload->release();
+            delete m;
+            m = next;
+        }
+    }
+
+    template<uint16_t PORT>
+    void generic::ev_handler<PORT>::resume_callback(void *arg) {
+        auto *msg_ctx = static_cast<msg_context *>(arg);
+        msg_ctx->handler->msg_queue->push(msg_ctx);
+    }
+
     template<uint16_t PORT>
     handler_base* generic::ev_handler<PORT>::next() {
         handler_base* handler_ = handlers[_next];
@@ -332,50 +1123,243 @@ namespace tcp_kit {
         if(_accept_ev)
             event_free(_accept_ev);
 #elif __linux
-        if(_evc)
-            evconnlistener_free(_evc);
+        for(acceptor &a : _acceptors)
+            if(a.evc)
+                evconnlistener_free(a.evc);
 #endif
+        if(_memory_ev)
+            event_free(_memory_ev);
+        if(_tick_ev)
+            event_free(_tick_ev);
+        if(_mailbox_ev)
+            event_free(_mailbox_ev);
+        for(mail *m = _mailbox.pop_all(), *next; m; m = next) {
+            next = m->next;
+            if(m->payload)
+                m->payload->release();
+            delete m;
+        }
         if(_ev_base)
             event_base_free(_ev_base);
     }
 
     // -----------------------------------------------------------------------------------------------------------------
 
+    template<typename Filters>
+    void generic::handler<Filters>::init(server_base* server_ptr) {
+
+    }
+
+    template<typename Filters>
+    void generic::handler<Filters>::run() {
+         while(_server_base->is_running()) {
+             msg_context* ctx = pop();
+#if TCP_KIT_COROUTINES
+             // 挂起的协程被交还回来, 在此恢复, 它运行到下一次挂起或结束时返回
+             if(ctx->resume) {
+                 resume_request(ctx);
+                 continue;
+             }
+#endif
+             trace::mark(ctx->trace_id, ctx->trace_mark, trace::QUEUE);
+             auto start = metrics::now();
+             metrics::count(metrics::MSG_DEQUEUED);
+             metrics::record_since(metrics::QUEUE_WAIT_NS, ctx->enqueued_at, start);
+             filter_chain *chain = ctx->filters;
+             ctx->encode = chain->encode;
+             try {
+                 // 已被拒绝(过滤器链不支持直接回复时)或在队列中等待超时的请求仍需解析出关联 id, 由 api_dispatcher 直接以
+                 // 状态码回复而不再处理. server 的 PORT 直接调用内联的链, 其他监听端口经由各自链的入口
+                 msg_buffer input = make_msg_buffer(ctx->in, ctx->in_len);
+                 msg_buffer res = chain == _filters.get() ? pipeline::call(ctx, input) : chain->pipeline(ctx, input);
+                 metrics::count(metrics::HANDLER_BUSY_NS, metrics::record_since(metrics::PROCESS_NS, start, metrics::now()));
+                 release_limiter(ctx);
+                 // 延迟回复时丢弃占位的回复, 立即处理下一条消息
+                 if(ctx->deferred) {
+                     free(res.ptr);
+                     ctx->complete();
+                     continue;
+                 }
+                 std::swap(ctx->out, res.ptr);
+                 std::swap(ctx->out_len, res.size);
+                 ctx->done();
+             } catch (const std::exception& err) {
+                 log_error("%s", err.what());
+                 release_limiter(ctx);
+                 if(ctx->deferred) {
+                     ctx->error_flag = true;
+                     ctx->complete();
+                 } else {
+                     ctx->error();
+                 }
+             }
+         }
+    }
+
+    // 请求处理返回(或交由完成令牌、协程挂起)时归还限制器的额度. 时延只计入排队与 handler 处理的时间,
+    // 异步 api 合法地等待很久不会使并发上限减小, 也不会在等待期间占用额度
+    template<typename Filters>
+    void generic::handler<Filters>::release_limiter(msg_context *ctx) {
+        if(ctx->limiter) {
+            ctx->limiter->release(metrics::now() - ctx->enqueued_at, ctx->reject_code == 0);
+            ctx->limiter = nullptr;
+        }
+    }
+
+    template<typename Filters>
+    msg_context* generic::handler<Filters>::pop() {
+        std::unique_ptr<msg_context*> ptr_ptr = msg_queue->pop();
+        return *(ptr_ptr.get());
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+
     template<uint16_t PORT>
     typename generic::api_dispatcher<PORT>::map_t generic::api_dispatcher<PORT>::_api_map;
 
     template<uint16_t PORT>
     std::unique_ptr<GenericReply> generic::api_dispatcher<PORT>::process(msg_context* ctx, std::unique_ptr<GenericMsg> msg) {
+        ctx->seq = msg->seq();
+        if(ctx->reject_code)
+            return reply(ctx, ctx->reject_code);
+        if(msg->has_timeout_ms())
+            ctx->set_timeout(std::chrono::milliseconds(msg->timeout_ms()));
+        if(ctx->expired())
+            return reply(ctx, GenericReply::TIMEOUT);
         auto it = api_dispatcher<PORT>::_api_map.find(msg->api());
         if(it != api_dispatcher<PORT>::_api_map.end()) {
+            ctx->api = &it->first;
             return it->second(ctx, std::move(msg));
         } else {
-            std::unique_ptr<GenericReply> reply = std::make_unique<GenericReply>();
-            reply->set_code(GenericReply::RES_NOT_FOUND);
-            return reply;
+            return reply(ctx, GenericReply::RES_NOT_FOUND);
         }
     }
 
+    template<uint16_t PORT>
+    std::unique_ptr<GenericReply> generic::api_dispatcher<PORT>::reply(msg_context *ctx, uint32_t code) {
+        std::unique_ptr<GenericReply> reply = std::make_unique<GenericReply>();
+        reply->set_code(static_cast<GenericReply::Code>(code));
+        return reply;
+    }
+
+    template<uint16_t PORT>
+    template<typename T>
+    std::unique_ptr<GenericReply> generic::api_dispatcher<PORT>::publication(const std::string &topic, T &data) {
+        msg_context ctx{};
+        std::unique_ptr<GenericReply> reply = serialize(&ctx, data);
+        reply->set_topic(topic);
+        return reply;
+    }
+
     template<uint16_t PORT>
     template<typename Processor>
-    void generic::api_dispatcher<PORT>::api(const std::string& id, Processor prcs) {
+    void generic::api_dispatcher<PORT>::api(const std::string& id, Processor prcs, api_options opts) {
         using result_t = typename func_traits<Processor>::result_type;
         using args_t = typename func_traits<Processor>::args_type;
-        api_dispatcher<PORT>::_api_map[id] = [prcs](msg_context *ctx, std::unique_ptr<GenericMsg> msg) -> std::unique_ptr<GenericReply> {
-            try {
-                args_t args = deserialize<args_t>(ctx, msg);
-                result_t res = call(prcs, move(args));
-                return serialize(res);
-            } catch (const std::exception &err) {
-                log_error(err.what());
-                std::unique_ptr<GenericReply> reply = std::make_unique<GenericReply>();
-                reply->set_code(GenericReply::ERROR);
-                reply->set_msg(err.what());
-                return reply;
+        auto in_flight = std::make_shared<std::atomic<uint32_t>>(0);
+        api_dispatcher<PORT>::_api_map[id] = [prcs, opts, in_flight](msg_context *ctx, std::unique_ptr<GenericMsg> msg) -> std::unique_ptr<GenericReply> {
+            // 按优先级与该 api 的并发上限做准入检查, 被拒绝的请求不计入限制器的时延采样.
+            // 该 api 的并发数先占用再检查, 多个 handler 同时处理该 api 时不会一起通过检查而超过上限
+            bool admitted = !ctx->limiter || ctx->limiter->admit(opts.priority);
+            if(admitted && in_flight->fetch_add(1, std::memory_order_relaxed) >= opts.max_in_flight && opts.max_in_flight) {
+                in_flight->fetch_sub(1, std::memory_order_relaxed);
+                admitted = false;
             }
+            if(!admitted) {
+                ctx->reject_code = GenericReply::OVERLOADED;
+                metrics::count(metrics::MSG_REJECTED);
+                return reply(ctx, GenericReply::OVERLOADED);
+            }
+            auto start = metrics::now();
+            std::unique_ptr<GenericReply> res = invoke(prcs, ctx, msg, in_flight, typename api_kind<Processor>::type{});
+            // 异步与协程处理器只计到它们返回(或首次挂起)为止, 错误回复由令牌给出, 不在此计数
+            metrics::record_since(metrics::API_NS, start, metrics::now());
+            metrics::count(metrics::API_CALLS);
+            if(!ctx->deferred && res->code() != GenericReply::SUCCESS)
+                metrics::count(metrics::API_ERRORS);
+            return res;
         };
     }
 
+    template<uint16_t PORT>
+    template<typename Processor>
+    std::unique_ptr<GenericReply> generic::api_dispatcher<PORT>::invoke(Processor &prcs, msg_context *ctx, std::unique_ptr<GenericMsg> &msg,
+                                                                        const std::shared_ptr<std::atomic<uint32_t>> &in_flight, sync_api) {
+        using result_t = typename func_traits<Processor>::result_type;
+        using args_t = typename func_traits<Processor>::args_type;
+        try {
+            args_t args = deserialize<args_t>(ctx, msg);
+            result_t res = call(prcs, move(args));
+            in_flight->fetch_sub(1, std::memory_order_relaxed);
+            return serialize(ctx, res);
+        } catch (const std::exception &err) {
+            in_flight->fetch_sub(1, std::memory_order_relaxed);
+            log_error("%s", err.what());
+            std::unique_ptr<GenericReply> reply = std::make_unique<GenericReply>();
+            reply->set_code(GenericReply::ERROR);
+            reply->set_msg(err.what());
+            return reply;
+        }
+    }
+
+    // 异步处理器: 回复由令牌给出, 返回的空回复只是占位, 由 handler 丢弃. 该 api 的并发数在令牌完成时才减少
+    template<uint16_t PORT>
+    template<typename Processor>
+    std::unique_ptr<GenericReply> generic::api_dispatcher<PORT>::invoke(Processor &prcs, msg_context *ctx, std::unique_ptr<GenericMsg> &msg,
+                                                                        const std::shared_ptr<std::atomic<uint32_t>> &in_flight, async_api) {
+        using args_t = typename func_traits<Processor>::args_type;
+        using token_t = typename std::tuple_element<0, args_t>::type;
+        using value_t = typename token_t::value_type;
+        static_assert(std::is_void<typename func_traits<Processor>::result_type>::value,
+                      "An asynchronous API handler must return void and reply through its completion");
+        ctx->defer();
+        token_t token(ctx, static_cast<typename token_t::serializer_t>(&api_dispatcher<PORT>::serialize), in_flight);
+        try {
+            args_t args = deserialize<args_t>(ctx, msg);
+            std::get<0>(args) = token;
+            call(prcs, move(args));
+        } catch (const std::exception &err) {
+            log_error("%s", err.what());
+            token.fail(err.what());
+        }
+        return std::make_unique<GenericReply>();
+    }
+
+#if TCP_KIT_COROUTINES
+    // 驱动处理器返回的 task, 以其结果完成令牌
+    template<typename T>
+    detached drive(msg_context *ctx, task<T> t, completion<T> done) {
+        try {
+            done(co_await std::move(t));
+        } catch (const std::exception &err) {
+            log_error("%s", err.what());
+            done.fail(err.what());
+        } catch (...) {
+            done.fail("Unknown exception thrown by the API handler");
+        }
+    }
+
+    // 协程处理器: 与异步处理器相同地延迟回复, 协程运行到第一次挂起时 handler 即可处理下一条消息
+    template<uint16_t PORT>
+    template<typename Processor>
+    std::unique_ptr<GenericReply> generic::api_dispatcher<PORT>::invoke(Processor &prcs, msg_context *ctx, std::unique_ptr<GenericMsg> &msg,
+                                                                        const std::shared_ptr<std::atomic<uint32_t>> &in_flight, coroutine_api) {
+        using args_t = typename func_traits<Processor>::args_type;
+        using value_t = typename func_traits<Processor>::result_type::value_type;
+        static_assert(!std::is_void<value_t>::value, "A coroutine API handler must co_return a value to reply with");
+        ctx->defer();
+        completion<value_t> token(ctx, static_cast<typename completion<value_t>::serializer_t>(&api_dispatcher<PORT>::serialize), in_flight);
+        try {
+            args_t args = deserialize<args_t>(ctx, msg);
+            drive(ctx, call(prcs, move(args)), token);
+        } catch (const std::exception &err) {
+            log_error("%s", err.what());
+            token.fail(err.what());
+        }
+        return std::make_unique<GenericReply>();
+    }
+#endif
+
     // -----------------------------------------------------------------------------------------------------------------
 
     // 推断类型 T 是否与 Any... 中任意类型匹配
@@ -416,7 +1400,7 @@ namespace tcp_kit {
     };
 
     template<typename T, uint32_t Offset>
-    T unpack_to(msg_context *, std::unique_ptr<GenericMsg>& msg, typename std::enable_if<!std::is_base_of<google::protobuf::Message, T>::value && !match_basic_type<T>::value && !std::is_same<T, msg_context *>::value>::type* = nullptr) {
+    T unpack_to(msg_context *, std::unique_ptr<GenericMsg>& msg, typename std::enable_if<!std::is_base_of<google::protobuf::Message, T>::value && !match_basic_type<T>::value && !std::is_same<T, msg_context *>::value && !is_completion<T>::value>::type* = nullptr) {
         throw generic_error<UNSUPPORTED_TYPE>("Only the following types are supported as parameters for the API handler: [unsigned int 32, signed int 32, unsigned int 64, signed int 64, float, double, boolean, string, msg_context *, any type that conforms to the Protobuf 3 specification].", typeid(T).name());
     }
 
@@ -435,6 +1419,12 @@ namespace tcp_kit {
         return ctx;
     }
 
+    // 完成令牌由 api_dispatcher 构造后填入
+    template<typename T, int32_t Offset>
+    T unpack_to(msg_context *, std::unique_ptr<GenericMsg>& msg, typename std::enable_if<is_completion<T>::value>::type* = nullptr) {
+        return T();
+    }
+
     template<typename T, int32_t Offset>
     T unpack_to(msg_context *, std::unique_ptr<GenericMsg>& msg, typename std::enable_if<std::is_same<T, uint32_t>::value>::type* = nullptr) {
         BasicType p = msg->params(Offset);
@@ -593,11 +1583,102 @@ namespace tcp_kit {
 
     template<uint16_t PORT>
     template<typename T>
-    std::unique_ptr<GenericReply> generic::api_dispatcher<PORT>::serialize(T& data) {
+    std::unique_ptr<GenericReply> generic::api_dispatcher<PORT>::serialize(msg_context *ctx, T& data) {
         std::unique_ptr<GenericReply> reply = std::make_unique<GenericReply>();
         reply->set_code(GenericReply::SUCCESS);
         pack_from(reply, data);
         return reply;
     }
 
-}
\ No newline at end of file
+    // 文件内容不进入回复, 回复仅作为帧头携带流的长度, 文件描述符交由 ev_handler 发送
+    template<uint16_t PORT>
+    std::unique_ptr<GenericReply> generic::api_dispatcher<PORT>::serialize(msg_context *ctx, file_region &region) {
+        std::unique_ptr<GenericReply> reply = std::make_unique<GenericReply>();
+        reply->set_code(GenericReply::SUCCESS);
+        reply->set_stream_len(region.length);
+        ctx->stream = {stream_context::SEND, region.fd, region.offset, region.length};
+        return reply;
+    }
+
+    // 回复作为帧头告知客户端可以开始发送 stream_len 个字节, 文件描述符交由 ev_handler 接收
+    template<uint16_t PORT>
+    std::unique_ptr<GenericReply> generic::api_dispatcher<PORT>::serialize(msg_context *ctx, file_sink &sink) {
+        std::unique_ptr<GenericReply> reply = std::make_unique<GenericReply>();
+        reply->set_code(GenericReply::SUCCESS);
+        reply->set_stream_len(sink.length);
+        ctx->stream = {stream_context::RECV, sink.fd, sink.offset, sink.length};
+        return reply;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    template<typename T>
+    completion<T>::completion(msg_context *ctx, serializer_t serialize, std::shared_ptr<std::atomic<uint32_t>> in_flight):
+            _state(new state{ctx, serialize, std::move(in_flight), {false}}) { }
+
+    template<typename T>
+    bool completion<T>::operator()(T value) {
+        if(!_state || !_state->claim())
+            return false;
+        std::unique_ptr<GenericReply> reply;
+        try {
+            reply = _state->serialize(_state->ctx, value);
+        } catch (const std::exception &err) {
+            log_error("%s", err.what());
+            reply = error_reply(err.what());
+        }
+        _state->finish(std::move(reply));
+        return true;
+    }
+
+    template<typename T>
+    bool completion<T>::fail(const std::string &msg) {
+        if(!_state || !_state->claim())
+            return false;
+        _state->finish(error_reply(msg));
+        return true;
+    }
+
+    template<typename T>
+    msg_context *completion<T>::context() const {
+        return _state ? _state->ctx : nullptr;
+    }
+
+    template<typename T>
+    std::unique_ptr<GenericReply> completion<T>::error_reply(const std::string &msg) {
+        std::unique_ptr<GenericReply> reply = std::make_unique<GenericReply>();
+        reply->set_code(GenericReply::ERROR);
+        reply->set_msg(msg);
+        return reply;
+    }
+
+    template<typename T>
+    bool completion<T>::state::claim() {
+        return !fired.exchange(true, std::memory_order_acq_rel);
+    }
+
+    // 编码回复并释放令牌对 msg_context 的持有, 之后不能再访问 ctx
+    template<typename T>
+    void completion<T>::state::finish(std::unique_ptr<GenericReply> reply) {
+        if(in_flight)
+            in_flight->fetch_sub(1, std::memory_order_relaxed);
+        try {
+            std::unique_ptr<msg_buffer> res = ctx->encode(ctx, reply.release());
+            if(!res)
+                throw generic_error<SERIALIZE_MSG_ERROR>("The filter chain cannot encode the reply");
+            std::swap(ctx->out, res->ptr);
+            std::swap(ctx->out_len, res->size);
+        } catch (const std::exception &err) {
+            log_error("%s", err.what());
+            ctx->error_flag = true;
+        }
+        ctx->complete();
+    }
+
+    template<typename T>
+    completion<T>::state::~state() {
+        if(claim())
+            finish(error_reply("The request was dropped without a reply"));
+    }
+
+}
@@ -8,15 +8,15 @@
 #include <string>
 
 #include <google/protobuf/port_def.inc>
-#if PROTOBUF_VERSION < 3020000
-#error_flag This file was generated by a newer version of protoc which is
-#error_flag incompatible with your Protocol Buffer headers. Please update
-#error_flag your headers.
+#if PROTOBUF_VERSION < 3021000
+#error This file was generated by a newer version of protoc which is
+#error incompatible with your Protocol Buffer headers. Please update
+#error your headers.
 #endif
-#if 3020003 < PROTOBUF_MIN_PROTOC_VERSION
-#error_flag This file was generated by an older version of protoc which is
-#error_flag incompatible with your Protocol Buffer headers. Please
-#error_flag regenerate this file with a newer version of protoc.
+#if 3021012 < PROTOBUF_MIN_PROTOC_VERSION
+#error This file was generated by an older version of protoc which is
+#error incompatible with your Protocol Buffer headers. Please
+#error regenerate this file with a newer version of protoc.
 #endif
 
 #include <google/protobuf/port_undef.inc>
@@ -153,9 +153,11 @@ class BasicType final :
   using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
   void CopyFrom(const BasicType& from);
   using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
-  void MergeFrom(const BasicType& from);
+  void MergeFrom( const BasicType& from) {
+    BasicType::MergeImpl(*this, from);
+  }
   private:
-  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message* to, const ::PROTOBUF_NAMESPACE_ID::Message& from);
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
   public:
   PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
   bool IsInitialized() const final;
@@ -164,10 +166,10 @@ class BasicType final :
   const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
   uint8_t* _InternalSerialize(
       uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
-  int GetCachedSize() const final { return _cached_size_.Get(); }
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
 
   private:
-  void SharedCtor();
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
   void SharedDtor();
   void SetCachedSize(int size) const final;
   void InternalSwap(BasicType* other);
@@ -330,21 +332,24 @@ class BasicType final :
   template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
   typedef void InternalArenaConstructable_;
   typedef void DestructorSkippable_;
-  union ValueUnion {
-    constexpr ValueUnion() : _constinit_{} {}
-      ::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized _constinit_;
-    uint32_t u32_;
-    int32_t s32_;
-    uint64_t u64_;
-    int64_t s64_;
-    float f_;
-    double d_;
-    bool b_;
-    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr str_;
-  } value_;
-  mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
-  uint32_t _oneof_case_[1];
+  struct Impl_ {
+    union ValueUnion {
+      constexpr ValueUnion() : _constinit_{} {}
+        ::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized _constinit_;
+      uint32_t u32_;
+      int32_t s32_;
+      uint64_t u64_;
+      int64_t s64_;
+      float f_;
+      double d_;
+      bool b_;
+      ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr str_;
+    } value_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+    uint32_t _oneof_case_[1];
 
+  };
+  union { Impl_ _impl_; };
   friend struct ::TableStruct_generic_5fmsg_2eproto;
 };
 // -------------------------------------------------------------------
@@ -429,9 +434,11 @@ class GenericMsg final :
   using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
   void CopyFrom(const GenericMsg& from);
   using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
-  void MergeFrom(const GenericMsg& from);
+  void MergeFrom( const GenericMsg& from) {
+    GenericMsg::MergeImpl(*this, from);
+  }
   private:
-  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message* to, const ::PROTOBUF_NAMESPACE_ID::Message& from);
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
   public:
   PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
   bool IsInitialized() const final;
@@ -440,10 +447,10 @@ class GenericMsg final :
   const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
   uint8_t* _InternalSerialize(
       uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
-  int GetCachedSize() const final { return _cached_size_.Get(); }
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
 
   private:
-  void SharedCtor();
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
   void SharedDtor();
   void SetCachedSize(int size) const final;
   void InternalSwap(GenericMsg* other);
@@ -471,6 +478,8 @@ class GenericMsg final :
     kParamsFieldNumber = 2,
     kApiFieldNumber = 1,
     kBodyFieldNumber = 3,
+    kSeqFieldNumber = 5,
+    kTimeoutMsFieldNumber = 4,
   };
   // repeated .tcp_kit.BasicType params = 2;
   int params_size() const;
@@ -522,6 +531,32 @@ class GenericMsg final :
       ::PROTOBUF_NAMESPACE_ID::Any* body);
   ::PROTOBUF_NAMESPACE_ID::Any* unsafe_arena_release_body();
 
+  // optional uint64 seq = 5;
+  bool has_seq() const;
+  private:
+  bool _internal_has_seq() const;
+  public:
+  void clear_seq();
+  uint64_t seq() const;
+  void set_seq(uint64_t value);
+  private:
+  uint64_t _internal_seq() const;
+  void _internal_set_seq(uint64_t value);
+  public:
+
+  // optional uint32 timeout_ms = 4;
+  bool has_timeout_ms() const;
+  private:
+  bool _internal_has_timeout_ms() const;
+  public:
+  void clear_timeout_ms();
+  uint32_t timeout_ms() const;
+  void set_timeout_ms(uint32_t value);
+  private:
+  uint32_t _internal_timeout_ms() const;
+  void _internal_set_timeout_ms(uint32_t value);
+  public:
+
   // @@protoc_insertion_point(class_scope:tcp_kit.GenericMsg)
  private:
   class _Internal;
@@ -529,11 +564,16 @@ class GenericMsg final :
   template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
   typedef void InternalArenaConstructable_;
   typedef void DestructorSkippable_;
-  ::PROTOBUF_NAMESPACE_ID::internal::HasBits<1> _has_bits_;
-  mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
-  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tcp_kit::BasicType > params_;
-  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr api_;
-  ::PROTOBUF_NAMESPACE_ID::Any* body_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::HasBits<1> _has_bits_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+    ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tcp_kit::BasicType > params_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr api_;
+    ::PROTOBUF_NAMESPACE_ID::Any* body_;
+    uint64_t seq_;
+    uint32_t timeout_ms_;
+  };
+  union { Impl_ _impl_; };
   friend struct ::TableStruct_generic_5fmsg_2eproto;
 };
 // ===================================================================
@@ -555,17 +595,17 @@ inline bool BasicType::has_u32() const {
   return _internal_has_u32();
 }
 inline void BasicType::set_has_u32() {
-  _oneof_case_[0] = kU32;
+  _impl_._oneof_case_[0] = kU32;
 }
 inline void BasicType::clear_u32() {
   if (_internal_has_u32()) {
-    value_.u32_ = 0u;
+    _impl_.value_.u32_ = 0u;
     clear_has_value();
   }
 }
 inline uint32_t BasicType::_internal_u32() const {
   if (_internal_has_u32()) {
-    return value_.u32_;
+    return _impl_.value_.u32_;
   }
   return 0u;
 }
@@ -574,7 +614,7 @@ inline void BasicType::_internal_set_u32(uint32_t value) {
     clear_value();
     set_has_u32();
   }
-  value_.u32_ = value;
+  _impl_.value_.u32_ = value;
 }
 inline uint32_t BasicType::u32() const {
   // @@protoc_insertion_point(field_get:tcp_kit.BasicType.u32)
@@ -593,17 +633,17 @@ inline bool BasicType::has_s32() const {
   return _internal_has_s32();
 }
 inline void BasicType::set_has_s32() {
-  _oneof_case_[0] = kS32;
+  _impl_._oneof_case_[0] = kS32;
 }
 inline void BasicType::clear_s32() {
   if (_internal_has_s32()) {
-    value_.s32_ = 0;
+    _impl_.value_.s32_ = 0;
     clear_has_value();
   }
 }
 inline int32_t BasicType::_internal_s32() const {
   if (_internal_has_s32()) {
-    return value_.s32_;
+    return _impl_.value_.s32_;
   }
   return 0;
 }
@@ -612,7 +652,7 @@ inline void BasicType::_internal_set_s32(int32_t value) {
     clear_value();
     set_has_s32();
   }
-  value_.s32_ = value;
+  _impl_.value_.s32_ = value;
 }
 inline int32_t BasicType::s32() const {
   // @@protoc_insertion_point(field_get:tcp_kit.BasicType.s32)
@@ -631,17 +671,17 @@ inline bool BasicType::has_u64() const {
   return _internal_has_u64();
 }
 inline void BasicType::set_has_u64() {
-  _oneof_case_[0] = kU64;
+  _impl_._oneof_case_[0] = kU64;
 }
 inline void BasicType::clear_u64() {
   if (_internal_has_u64()) {
-    value_.u64_ = uint64_t{0u};
+    _impl_.value_.u64_ = uint64_t{0u};
     clear_has_value();
   }
 }
 inline uint64_t BasicType::_internal_u64() const {
   if (_internal_has_u64()) {
-    return value_.u64_;
+    return _impl_.value_.u64_;
   }
   return uint64_t{0u};
 }
@@ -650,7 +690,7 @@ inline void BasicType::_internal_set_u64(uint64_t value) {
     clear_value();
     set_has_u64();
   }
-  value_.u64_ = value;
+  _impl_.value_.u64_ = value;
 }
 inline uint64_t BasicType::u64() const {
   // @@protoc_insertion_point(field_get:tcp_kit.BasicType.u64)
@@ -669,17 +709,17 @@ inline bool BasicType::has_s64() const {
   return _internal_has_s64();
 }
 inline void BasicType::set_has_s64() {
-  _oneof_case_[0] = kS64;
+  _impl_._oneof_case_[0] = kS64;
 }
 inline void BasicType::clear_s64() {
   if (_internal_has_s64()) {
-    value_.s64_ = int64_t{0};
+    _impl_.value_.s64_ = int64_t{0};
     clear_has_value();
   }
 }
 inline int64_t BasicType::_internal_s64() const {
   if (_internal_has_s64()) {
-    return value_.s64_;
+    return _impl_.value_.s64_;
   }
   return int64_t{0};
 }
@@ -688,7 +728,7 @@ inline void BasicType::_internal_set_s64(int64_t value) {
     clear_value();
     set_has_s64();
   }
-  value_.s64_ = value;
+  _impl_.value_.s64_ = value;
 }
 inline int64_t BasicType::s64() const {
   // @@protoc_insertion_point(field_get:tcp_kit.BasicType.s64)
@@ -707,17 +747,17 @@ inline bool BasicType::has_f() const {
   return _internal_has_f();
 }
 inline void BasicType::set_has_f() {
-  _oneof_case_[0] = kF;
+  _impl_._oneof_case_[0] = kF;
 }
 inline void BasicType::clear_f() {
   if (_internal_has_f()) {
-    value_.f_ = 0;
+    _impl_.value_.f_ = 0;
     clear_has_value();
   }
 }
 inline float BasicType::_internal_f() const {
   if (_internal_has_f()) {
-    return value_.f_;
+    return _impl_.value_.f_;
   }
   return 0;
 }
@@ -726,7 +766,7 @@ inline void BasicType::_internal_set_f(float value) {
     clear_value();
     set_has_f();
   }
-  value_.f_ = value;
+  _impl_.value_.f_ = value;
 }
 inline float BasicType::f() const {
   // @@protoc_insertion_point(field_get:tcp_kit.BasicType.f)
@@ -745,17 +785,17 @@ inline bool BasicType::has_d() const {
   return _internal_has_d();
 }
 inline void BasicType::set_has_d() {
-  _oneof_case_[0] = kD;
+  _impl_._oneof_case_[0] = kD;
 }
 inline void BasicType::clear_d() {
   if (_internal_has_d()) {
-    value_.d_ = 0;
+    _impl_.value_.d_ = 0;
     clear_has_value();
   }
 }
 inline double BasicType::_internal_d() const {
   if (_internal_has_d()) {
-    return value_.d_;
+    return _impl_.value_.d_;
   }
   return 0;
 }
@@ -764,7 +804,7 @@ inline void BasicType::_internal_set_d(double value) {
     clear_value();
     set_has_d();
   }
-  value_.d_ = value;
+  _impl_.value_.d_ = value;
 }
 inline double BasicType::d() const {
   // @@protoc_insertion_point(field_get:tcp_kit.BasicType.d)
@@ -783,17 +823,17 @@ inline bool BasicType::has_b() const {
   return _internal_has_b();
 }
 inline void BasicType::set_has_b() {
-  _oneof_case_[0] = kB;
+  _impl_._oneof_case_[0] = kB;
 }
 inline void BasicType::clear_b() {
   if (_internal_has_b()) {
-    value_.b_ = false;
+    _impl_.value_.b_ = false;
     clear_has_value();
   }
 }
 inline bool BasicType::_internal_b() const {
   if (_internal_has_b()) {
-    return value_.b_;
+    return _impl_.value_.b_;
   }
   return false;
 }
@@ -802,7 +842,7 @@ inline void BasicType::_internal_set_b(bool value) {
     clear_value();
     set_has_b();
   }
-  value_.b_ = value;
+  _impl_.value_.b_ = value;
 }
 inline bool BasicType::b() const {
   // @@protoc_insertion_point(field_get:tcp_kit.BasicType.b)
@@ -821,11 +861,11 @@ inline bool BasicType::has_str() const {
   return _internal_has_str();
 }
 inline void BasicType::set_has_str() {
-  _oneof_case_[0] = kStr;
+  _impl_._oneof_case_[0] = kStr;
 }
 inline void BasicType::clear_str() {
   if (_internal_has_str()) {
-    value_.str_.Destroy();
+    _impl_.value_.str_.Destroy();
     clear_has_value();
   }
 }
@@ -838,9 +878,9 @@ inline void BasicType::set_str(ArgT0&& arg0, ArgT... args) {
   if (!_internal_has_str()) {
     clear_value();
     set_has_str();
-    value_.str_.InitDefault();
+    _impl_.value_.str_.InitDefault();
   }
-  value_.str_.Set( static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  _impl_.value_.str_.Set( static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
   // @@protoc_insertion_point(field_set:tcp_kit.BasicType.str)
 }
 inline std::string* BasicType::mutable_str() {
@@ -850,7 +890,7 @@ inline std::string* BasicType::mutable_str() {
 }
 inline const std::string& BasicType::_internal_str() const {
   if (_internal_has_str()) {
-    return value_.str_.Get();
+    return _impl_.value_.str_.Get();
   }
   return ::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited();
 }
@@ -858,23 +898,23 @@ inline void BasicType::_internal_set_str(const std::string& value) {
   if (!_internal_has_str()) {
     clear_value();
     set_has_str();
-    value_.str_.InitDefault();
+    _impl_.value_.str_.InitDefault();
   }
-  value_.str_.Set(value, GetArenaForAllocation());
+  _impl_.value_.str_.Set(value, GetArenaForAllocation());
 }
 inline std::string* BasicType::_internal_mutable_str() {
   if (!_internal_has_str()) {
     clear_value();
     set_has_str();
-    value_.str_.InitDefault();
+    _impl_.value_.str_.InitDefault();
   }
-  return value_.str_.Mutable(      GetArenaForAllocation());
+  return _impl_.value_.str_.Mutable(      GetArenaForAllocation());
 }
 inline std::string* BasicType::release_str() {
   // @@protoc_insertion_point(field_release:tcp_kit.BasicType.str)
   if (_internal_has_str()) {
     clear_has_value();
-    return value_.str_.Release();
+    return _impl_.value_.str_.Release();
   } else {
     return nullptr;
   }
@@ -885,7 +925,7 @@ inline void BasicType::set_allocated_str(std::string* str) {
   }
   if (str != nullptr) {
     set_has_str();
-    value_.str_.InitAllocated(str, GetArenaForAllocation());
+    _impl_.value_.str_.InitAllocated(str, GetArenaForAllocation());
   }
   // @@protoc_insertion_point(field_set_allocated:tcp_kit.BasicType.str)
 }
@@ -894,10 +934,10 @@ inline bool BasicType::has_value() const {
   return value_case() != VALUE_NOT_SET;
 }
 inline void BasicType::clear_has_value() {
-  _oneof_case_[0] = VALUE_NOT_SET;
+  _impl_._oneof_case_[0] = VALUE_NOT_SET;
 }
 inline BasicType::ValueCase BasicType::value_case() const {
-  return BasicType::ValueCase(_oneof_case_[0]);
+  return BasicType::ValueCase(_impl_._oneof_case_[0]);
 }
 // -------------------------------------------------------------------
 
@@ -905,7 +945,7 @@ inline BasicType::ValueCase BasicType::value_case() const {
 
 // string api = 1;
 inline void GenericMsg::clear_api() {
-  api_.ClearToEmpty();
+  _impl_.api_.ClearToEmpty();
 }
 inline const std::string& GenericMsg::api() const {
   // @@protoc_insertion_point(field_get:tcp_kit.GenericMsg.api)
@@ -915,7 +955,7 @@ template <typename ArgT0, typename... ArgT>
 inline PROTOBUF_ALWAYS_INLINE
 void GenericMsg::set_api(ArgT0&& arg0, ArgT... args) {
  
- api_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+ _impl_.api_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
   // @@protoc_insertion_point(field_set:tcp_kit.GenericMsg.api)
 }
 inline std::string* GenericMsg::mutable_api() {
@@ -924,19 +964,19 @@ inline std::string* GenericMsg::mutable_api() {
   return _s;
 }
 inline const std::string& GenericMsg::_internal_api() const {
-  return api_.Get();
+  return _impl_.api_.Get();
 }
 inline void GenericMsg::_internal_set_api(const std::string& value) {
   
-  api_.Set(value, GetArenaForAllocation());
+  _impl_.api_.Set(value, GetArenaForAllocation());
 }
 inline std::string* GenericMsg::_internal_mutable_api() {
   
-  return api_.Mutable(GetArenaForAllocation());
+  return _impl_.api_.Mutable(GetArenaForAllocation());
 }
 inline std::string* GenericMsg::release_api() {
   // @@protoc_insertion_point(field_release:tcp_kit.GenericMsg.api)
-  return api_.Release();
+  return _impl_.api_.Release();
 }
 inline void GenericMsg::set_allocated_api(std::string* api) {
   if (api != nullptr) {
@@ -944,10 +984,10 @@ inline void GenericMsg::set_allocated_api(std::string* api) {
   } else {
     
   }
-  api_.SetAllocated(api, GetArenaForAllocation());
+  _impl_.api_.SetAllocated(api, GetArenaForAllocation());
 #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
-  if (api_.IsDefault()) {
-    api_.Set("", GetArenaForAllocation());
+  if (_impl_.api_.IsDefault()) {
+    _impl_.api_.Set("", GetArenaForAllocation());
   }
 #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
   // @@protoc_insertion_point(field_set_allocated:tcp_kit.GenericMsg.api)
@@ -955,32 +995,32 @@ inline void GenericMsg::set_allocated_api(std::string* api) {
 
 // repeated .tcp_kit.BasicType params = 2;
 inline int GenericMsg::_internal_params_size() const {
-  return params_.size();
+  return _impl_.params_.size();
 }
 inline int GenericMsg::params_size() const {
   return _internal_params_size();
 }
 inline void GenericMsg::clear_params() {
-  params_.Clear();
+  _impl_.params_.Clear();
 }
 inline ::tcp_kit::BasicType* GenericMsg::mutable_params(int index) {
   // @@protoc_insertion_point(field_mutable:tcp_kit.GenericMsg.params)
-  return params_.Mutable(index);
+  return _impl_.params_.Mutable(index);
 }
 inline ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tcp_kit::BasicType >*
 GenericMsg::mutable_params() {
   // @@protoc_insertion_point(field_mutable_list:tcp_kit.GenericMsg.params)
-  return &params_;
+  return &_impl_.params_;
 }
 inline const ::tcp_kit::BasicType& GenericMsg::_internal_params(int index) const {
-  return params_.Get(index);
+  return _impl_.params_.Get(index);
 }
 inline const ::tcp_kit::BasicType& GenericMsg::params(int index) const {
   // @@protoc_insertion_point(field_get:tcp_kit.GenericMsg.params)
   return _internal_params(index);
 }
 inline ::tcp_kit::BasicType* GenericMsg::_internal_add_params() {
-  return params_.Add();
+  return _impl_.params_.Add();
 }
 inline ::tcp_kit::BasicType* GenericMsg::add_params() {
   ::tcp_kit::BasicType* _add = _internal_add_params();
@@ -990,20 +1030,20 @@ inline ::tcp_kit::BasicType* GenericMsg::add_params() {
 inline const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::tcp_kit::BasicType >&
 GenericMsg::params() const {
   // @@protoc_insertion_point(field_list:tcp_kit.GenericMsg.params)
-  return params_;
+  return _impl_.params_;
 }
 
 // optional .google.protobuf.Any body = 3;
 inline bool GenericMsg::_internal_has_body() const {
-  bool value = (_has_bits_[0] & 0x00000001u) != 0;
-  PROTOBUF_ASSUME(!value || body_ != nullptr);
+  bool value = (_impl_._has_bits_[0] & 0x00000001u) != 0;
+  PROTOBUF_ASSUME(!value || _impl_.body_ != nullptr);
   return value;
 }
 inline bool GenericMsg::has_body() const {
   return _internal_has_body();
 }
 inline const ::PROTOBUF_NAMESPACE_ID::Any& GenericMsg::_internal_body() const {
-  const ::PROTOBUF_NAMESPACE_ID::Any* p = body_;
+  const ::PROTOBUF_NAMESPACE_ID::Any* p = _impl_.body_;
   return p != nullptr ? *p : reinterpret_cast<const ::PROTOBUF_NAMESPACE_ID::Any&>(
       ::PROTOBUF_NAMESPACE_ID::_Any_default_instance_);
 }
@@ -1014,20 +1054,20 @@ inline const ::PROTOBUF_NAMESPACE_ID::Any& GenericMsg::body() const {
 inline void GenericMsg::unsafe_arena_set_allocated_body(
     ::PROTOBUF_NAMESPACE_ID::Any* body) {
   if (GetArenaForAllocation() == nullptr) {
-    delete reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(body_);
+    delete reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(_impl_.body_);
   }
-  body_ = body;
+  _impl_.body_ = body;
   if (body) {
-    _has_bits_[0] |= 0x00000001u;
+    _impl_._has_bits_[0] |= 0x00000001u;
   } else {
-    _has_bits_[0] &= ~0x00000001u;
+    _impl_._has_bits_[0] &= ~0x00000001u;
   }
   // @@protoc_insertion_point(field_unsafe_arena_set_allocated:tcp_kit.GenericMsg.body)
 }
 inline ::PROTOBUF_NAMESPACE_ID::Any* GenericMsg::release_body() {
-  _has_bits_[0] &= ~0x00000001u;
-  ::PROTOBUF_NAMESPACE_ID::Any* temp = body_;
-  body_ = nullptr;
+  _impl_._has_bits_[0] &= ~0x00000001u;
+  ::PROTOBUF_NAMESPACE_ID::Any* temp = _impl_.body_;
+  _impl_.body_ = nullptr;
 #ifdef PROTOBUF_FORCE_COPY_IN_RELEASE
   auto* old =  reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(temp);
   temp = ::PROTOBUF_NAMESPACE_ID::internal::DuplicateIfNonNull(temp);
@@ -1041,18 +1081,18 @@ inline ::PROTOBUF_NAMESPACE_ID::Any* GenericMsg::release_body() {
 }
 inline ::PROTOBUF_NAMESPACE_ID::Any* GenericMsg::unsafe_arena_release_body() {
   // @@protoc_insertion_point(field_release:tcp_kit.GenericMsg.body)
-  _has_bits_[0] &= ~0x00000001u;
-  ::PROTOBUF_NAMESPACE_ID::Any* temp = body_;
-  body_ = nullptr;
+  _impl_._has_bits_[0] &= ~0x00000001u;
+  ::PROTOBUF_NAMESPACE_ID::Any* temp = _impl_.body_;
+  _impl_.body_ = nullptr;
   return temp;
 }
 inline ::PROTOBUF_NAMESPACE_ID::Any* GenericMsg::_internal_mutable_body() {
-  _has_bits_[0] |= 0x00000001u;
-  if (body_ == nullptr) {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  if (_impl_.body_ == nullptr) {
     auto* p = CreateMaybeMessage<::PROTOBUF_NAMESPACE_ID::Any>(GetArenaForAllocation());
-    body_ = p;
+    _impl_.body_ = p;
   }
-  return body_;
+  return _impl_.body_;
 }
 inline ::PROTOBUF_NAMESPACE_ID::Any* GenericMsg::mutable_body() {
   ::PROTOBUF_NAMESPACE_ID::Any* _msg = _internal_mutable_body();
@@ -1062,7 +1102,7 @@ inline ::PROTOBUF_NAMESPACE_ID::Any* GenericMsg::mutable_body() {
 inline void GenericMsg::set_allocated_body(::PROTOBUF_NAMESPACE_ID::Any* body) {
   ::PROTOBUF_NAMESPACE_ID::Arena* message_arena = GetArenaForAllocation();
   if (message_arena == nullptr) {
-    delete reinterpret_cast< ::PROTOBUF_NAMESPACE_ID::MessageLite*>(body_);
+    delete reinterpret_cast< ::PROTOBUF_NAMESPACE_ID::MessageLite*>(_impl_.body_);
   }
   if (body) {
     ::PROTOBUF_NAMESPACE_ID::Arena* submessage_arena =
@@ -1072,14 +1112,70 @@ inline void GenericMsg::set_allocated_body(::PROTOBUF_NAMESPACE_ID::Any* body) {
       body = ::PROTOBUF_NAMESPACE_ID::internal::GetOwnedMessage(
           message_arena, body, submessage_arena);
     }
-    _has_bits_[0] |= 0x00000001u;
+    _impl_._has_bits_[0] |= 0x00000001u;
   } else {
-    _has_bits_[0] &= ~0x00000001u;
+    _impl_._has_bits_[0] &= ~0x00000001u;
   }
-  body_ = body;
+  _impl_.body_ = body;
   // @@protoc_insertion_point(field_set_allocated:tcp_kit.GenericMsg.body)
 }
 
+// optional uint32 timeout_ms = 4;
+inline bool GenericMsg::_internal_has_timeout_ms() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000004u) != 0;
+  return value;
+}
+inline bool GenericMsg::has_timeout_ms() const {
+  return _internal_has_timeout_ms();
+}
+inline void GenericMsg::clear_timeout_ms() {
+  _impl_.timeout_ms_ = 0u;
+  _impl_._has_bits_[0] &= ~0x00000004u;
+}
+inline uint32_t GenericMsg::_internal_timeout_ms() const {
+  return _impl_.timeout_ms_;
+}
+inline uint32_t GenericMsg::timeout_ms() const {
+  // @@protoc_insertion_point(field_get:tcp_kit.GenericMsg.timeout_ms)
+  return _internal_timeout_ms();
+}
+inline void GenericMsg::_internal_set_timeout_ms(uint32_t value) {
+  _impl_._has_bits_[0] |= 0x00000004u;
+  _impl_.timeout_ms_ = value;
+}
+inline void GenericMsg::set_timeout_ms(uint32_t value) {
+  _internal_set_timeout_ms(value);
+  // @@protoc_insertion_point(field_set:tcp_kit.GenericMsg.timeout_ms)
+}
+
+// optional uint64 seq = 5;
+inline bool GenericMsg::_internal_has_seq() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000002u) != 0;
+  return value;
+}
+inline bool GenericMsg::has_seq() const {
+  return _internal_has_seq();
+}
+inline void GenericMsg::clear_seq() {
+  _impl_.seq_ = uint64_t{0u};
+  _impl_._has_bits_[0] &= ~0x00000002u;
+}
+inline uint64_t GenericMsg::_internal_seq() const {
+  return _impl_.seq_;
+}
+inline uint64_t GenericMsg::seq() const {
+  // @@protoc_insertion_point(field_get:tcp_kit.GenericMsg.seq)
+  return _internal_seq();
+}
+inline void GenericMsg::_internal_set_seq(uint64_t value) {
+  _impl_._has_bits_[0] |= 0x00000002u;
+  _impl_.seq_ = value;
+}
+inline void GenericMsg::set_seq(uint64_t value) {
+  _internal_set_seq(value);
+  // @@protoc_insertion_point(field_set:tcp_kit.GenericMsg.seq)
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
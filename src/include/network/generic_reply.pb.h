@@ -8,12 +8,12 @@
 #include <string>
 
 #include <google/protobuf/port_def.inc>
-#if PROTOBUF_VERSION < 3020000
+#if PROTOBUF_VERSION < 3021000
 #error This file was generated by a newer version of protoc which is
 #error incompatible with your Protocol Buffer headers. Please update
 #error your headers.
 #endif
-#if 3020003 < PROTOBUF_MIN_PROTOC_VERSION
+#if 3021012 < PROTOBUF_MIN_PROTOC_VERSION
 #error This file was generated by an older version of protoc which is
 #error incompatible with your Protocol Buffer headers. Please
 #error regenerate this file with a newer version of protoc.
@@ -64,7 +64,9 @@ enum GenericReply_Code : int {
   GenericReply_Code_UNKNOWN_ERR = 0,
   GenericReply_Code_SUCCESS = 200,
   GenericReply_Code_RES_NOT_FOUND = 404,
+  GenericReply_Code_TIMEOUT = 408,
   GenericReply_Code_INTERNAL_SERVER_ERR = 500,
+  GenericReply_Code_OVERLOADED = 503,
   GenericReply_Code_ERROR = 505,
   GenericReply_Code_GenericReply_Code_INT_MIN_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::min(),
   GenericReply_Code_GenericReply_Code_INT_MAX_SENTINEL_DO_NOT_USE_ = std::numeric_limits<int32_t>::max()
@@ -182,9 +184,11 @@ class GenericReply_BasicType final :
   using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
   void CopyFrom(const GenericReply_BasicType& from);
   using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
-  void MergeFrom(const GenericReply_BasicType& from);
+  void MergeFrom( const GenericReply_BasicType& from) {
+    GenericReply_BasicType::MergeImpl(*this, from);
+  }
   private:
-  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message* to, const ::PROTOBUF_NAMESPACE_ID::Message& from);
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
   public:
   PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
   bool IsInitialized() const final;
@@ -193,10 +197,10 @@ class GenericReply_BasicType final :
   const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
   uint8_t* _InternalSerialize(
       uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
-  int GetCachedSize() const final { return _cached_size_.Get(); }
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
 
   private:
-  void SharedCtor();
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
   void SharedDtor();
   void SetCachedSize(int size) const final;
   void InternalSwap(GenericReply_BasicType* other);
@@ -359,21 +363,24 @@ class GenericReply_BasicType final :
   template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
   typedef void InternalArenaConstructable_;
   typedef void DestructorSkippable_;
-  union ValueUnion {
-    constexpr ValueUnion() : _constinit_{} {}
-      ::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized _constinit_;
-    uint32_t u32_;
-    int32_t s32_;
-    uint64_t u64_;
-    int64_t s64_;
-    float f_;
-    double d_;
-    bool b_;
-    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr str_;
-  } value_;
-  mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
-  uint32_t _oneof_case_[1];
+  struct Impl_ {
+    union ValueUnion {
+      constexpr ValueUnion() : _constinit_{} {}
+        ::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized _constinit_;
+      uint32_t u32_;
+      int32_t s32_;
+      uint64_t u64_;
+      int64_t s64_;
+      float f_;
+      double d_;
+      bool b_;
+      ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr str_;
+    } value_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+    uint32_t _oneof_case_[1];
 
+  };
+  union { Impl_ _impl_; };
   friend struct ::TableStruct_generic_5freply_2eproto;
 };
 // -------------------------------------------------------------------
@@ -458,9 +465,11 @@ class GenericReply final :
   using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
   void CopyFrom(const GenericReply& from);
   using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
-  void MergeFrom(const GenericReply& from);
+  void MergeFrom( const GenericReply& from) {
+    GenericReply::MergeImpl(*this, from);
+  }
   private:
-  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message* to, const ::PROTOBUF_NAMESPACE_ID::Message& from);
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
   public:
   PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
   bool IsInitialized() const final;
@@ -469,10 +478,10 @@ class GenericReply final :
   const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
   uint8_t* _InternalSerialize(
       uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
-  int GetCachedSize() const final { return _cached_size_.Get(); }
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
 
   private:
-  void SharedCtor();
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
   void SharedDtor();
   void SetCachedSize(int size) const final;
   void InternalSwap(GenericReply* other);
@@ -503,8 +512,12 @@ class GenericReply final :
     GenericReply_Code_SUCCESS;
   static constexpr Code RES_NOT_FOUND =
     GenericReply_Code_RES_NOT_FOUND;
+  static constexpr Code TIMEOUT =
+    GenericReply_Code_TIMEOUT;
   static constexpr Code INTERNAL_SERVER_ERR =
     GenericReply_Code_INTERNAL_SERVER_ERR;
+  static constexpr Code OVERLOADED =
+    GenericReply_Code_OVERLOADED;
   static constexpr Code ERROR =
     GenericReply_Code_ERROR;
   static inline bool Code_IsValid(int value) {
@@ -536,8 +549,11 @@ class GenericReply final :
 
   enum : int {
     kMsgFieldNumber = 2,
+    kTopicFieldNumber = 6,
     kResultFieldNumber = 3,
     kBodyFieldNumber = 4,
+    kStreamLenFieldNumber = 5,
+    kSeqFieldNumber = 7,
     kCodeFieldNumber = 1,
   };
   // optional string msg = 2;
@@ -558,6 +574,24 @@ class GenericReply final :
   std::string* _internal_mutable_msg();
   public:
 
+  // optional string topic = 6;
+  bool has_topic() const;
+  private:
+  bool _internal_has_topic() const;
+  public:
+  void clear_topic();
+  const std::string& topic() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_topic(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_topic();
+  PROTOBUF_NODISCARD std::string* release_topic();
+  void set_allocated_topic(std::string* topic);
+  private:
+  const std::string& _internal_topic() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_topic(const std::string& value);
+  std::string* _internal_mutable_topic();
+  public:
+
   // optional .tcp_kit.GenericReply.BasicType result = 3;
   bool has_result() const;
   private:
@@ -594,6 +628,32 @@ class GenericReply final :
       ::PROTOBUF_NAMESPACE_ID::Any* body);
   ::PROTOBUF_NAMESPACE_ID::Any* unsafe_arena_release_body();
 
+  // optional uint64 stream_len = 5;
+  bool has_stream_len() const;
+  private:
+  bool _internal_has_stream_len() const;
+  public:
+  void clear_stream_len();
+  uint64_t stream_len() const;
+  void set_stream_len(uint64_t value);
+  private:
+  uint64_t _internal_stream_len() const;
+  void _internal_set_stream_len(uint64_t value);
+  public:
+
+  // optional uint64 seq = 7;
+  bool has_seq() const;
+  private:
+  bool _internal_has_seq() const;
+  public:
+  void clear_seq();
+  uint64_t seq() const;
+  void set_seq(uint64_t value);
+  private:
+  uint64_t _internal_seq() const;
+  void _internal_set_seq(uint64_t value);
+  public:
+
   // .tcp_kit.GenericReply.Code code = 1;
   void clear_code();
   ::tcp_kit::GenericReply_Code code() const;
@@ -610,12 +670,18 @@ class GenericReply final :
   template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
   typedef void InternalArenaConstructable_;
   typedef void DestructorSkippable_;
-  ::PROTOBUF_NAMESPACE_ID::internal::HasBits<1> _has_bits_;
-  mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
-  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr msg_;
-  ::tcp_kit::GenericReply_BasicType* result_;
-  ::PROTOBUF_NAMESPACE_ID::Any* body_;
-  int code_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::HasBits<1> _has_bits_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr msg_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr topic_;
+    ::tcp_kit::GenericReply_BasicType* result_;
+    ::PROTOBUF_NAMESPACE_ID::Any* body_;
+    uint64_t stream_len_;
+    uint64_t seq_;
+    int code_;
+  };
+  union { Impl_ _impl_; };
   friend struct ::TableStruct_generic_5freply_2eproto;
 };
 // ===================================================================
@@ -637,17 +703,17 @@ inline bool GenericReply_BasicType::has_u32() const {
   return _internal_has_u32();
 }
 inline void GenericReply_BasicType::set_has_u32() {
-  _oneof_case_[0] = kU32;
+  _impl_._oneof_case_[0] = kU32;
 }
 inline void GenericReply_BasicType::clear_u32() {
   if (_internal_has_u32()) {
-    value_.u32_ = 0u;
+    _impl_.value_.u32_ = 0u;
     clear_has_value();
   }
 }
 inline uint32_t GenericReply_BasicType::_internal_u32() const {
   if (_internal_has_u32()) {
-    return value_.u32_;
+    return _impl_.value_.u32_;
   }
   return 0u;
 }
@@ -656,7 +722,7 @@ inline void GenericReply_BasicType::_internal_set_u32(uint32_t value) {
     clear_value();
     set_has_u32();
   }
-  value_.u32_ = value;
+  _impl_.value_.u32_ = value;
 }
 inline uint32_t GenericReply_BasicType::u32() const {
   // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.BasicType.u32)
@@ -675,17 +741,17 @@ inline bool GenericReply_BasicType::has_s32() const {
   return _internal_has_s32();
 }
 inline void GenericReply_BasicType::set_has_s32() {
-  _oneof_case_[0] = kS32;
+  _impl_._oneof_case_[0] = kS32;
 }
 inline void GenericReply_BasicType::clear_s32() {
   if (_internal_has_s32()) {
-    value_.s32_ = 0;
+    _impl_.value_.s32_ = 0;
     clear_has_value();
   }
 }
 inline int32_t GenericReply_BasicType::_internal_s32() const {
   if (_internal_has_s32()) {
-    return value_.s32_;
+    return _impl_.value_.s32_;
   }
   return 0;
 }
@@ -694,7 +760,7 @@ inline void GenericReply_BasicType::_internal_set_s32(int32_t value) {
     clear_value();
     set_has_s32();
   }
-  value_.s32_ = value;
+  _impl_.value_.s32_ = value;
 }
 inline int32_t GenericReply_BasicType::s32() const {
   // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.BasicType.s32)
@@ -713,17 +779,17 @@ inline bool GenericReply_BasicType::has_u64() const {
   return _internal_has_u64();
 }
 inline void GenericReply_BasicType::set_has_u64() {
-  _oneof_case_[0] = kU64;
+  _impl_._oneof_case_[0] = kU64;
 }
 inline void GenericReply_BasicType::clear_u64() {
   if (_internal_has_u64()) {
-    value_.u64_ = uint64_t{0u};
+    _impl_.value_.u64_ = uint64_t{0u};
     clear_has_value();
   }
 }
 inline uint64_t GenericReply_BasicType::_internal_u64() const {
   if (_internal_has_u64()) {
-    return value_.u64_;
+    return _impl_.value_.u64_;
   }
   return uint64_t{0u};
 }
@@ -732,7 +798,7 @@ inline void GenericReply_BasicType::_internal_set_u64(uint64_t value) {
     clear_value();
     set_has_u64();
   }
-  value_.u64_ = value;
+  _impl_.value_.u64_ = value;
 }
 inline uint64_t GenericReply_BasicType::u64() const {
   // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.BasicType.u64)
@@ -751,17 +817,17 @@ inline bool GenericReply_BasicType::has_s64() const {
   return _internal_has_s64();
 }
 inline void GenericReply_BasicType::set_has_s64() {
-  _oneof_case_[0] = kS64;
+  _impl_._oneof_case_[0] = kS64;
 }
 inline void GenericReply_BasicType::clear_s64() {
   if (_internal_has_s64()) {
-    value_.s64_ = int64_t{0};
+    _impl_.value_.s64_ = int64_t{0};
     clear_has_value();
   }
 }
 inline int64_t GenericReply_BasicType::_internal_s64() const {
   if (_internal_has_s64()) {
-    return value_.s64_;
+    return _impl_.value_.s64_;
   }
   return int64_t{0};
 }
@@ -770,7 +836,7 @@ inline void GenericReply_BasicType::_internal_set_s64(int64_t value) {
     clear_value();
     set_has_s64();
   }
-  value_.s64_ = value;
+  _impl_.value_.s64_ = value;
 }
 inline int64_t GenericReply_BasicType::s64() const {
   // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.BasicType.s64)
@@ -789,17 +855,17 @@ inline bool GenericReply_BasicType::has_f() const {
   return _internal_has_f();
 }
 inline void GenericReply_BasicType::set_has_f() {
-  _oneof_case_[0] = kF;
+  _impl_._oneof_case_[0] = kF;
 }
 inline void GenericReply_BasicType::clear_f() {
   if (_internal_has_f()) {
-    value_.f_ = 0;
+    _impl_.value_.f_ = 0;
     clear_has_value();
   }
 }
 inline float GenericReply_BasicType::_internal_f() const {
   if (_internal_has_f()) {
-    return value_.f_;
+    return _impl_.value_.f_;
   }
   return 0;
 }
@@ -808,7 +874,7 @@ inline void GenericReply_BasicType::_internal_set_f(float value) {
     clear_value();
     set_has_f();
   }
-  value_.f_ = value;
+  _impl_.value_.f_ = value;
 }
 inline float GenericReply_BasicType::f() const {
   // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.BasicType.f)
@@ -827,17 +893,17 @@ inline bool GenericReply_BasicType::has_d() const {
   return _internal_has_d();
 }
 inline void GenericReply_BasicType::set_has_d() {
-  _oneof_case_[0] = kD;
+  _impl_._oneof_case_[0] = kD;
 }
 inline void GenericReply_BasicType::clear_d() {
   if (_internal_has_d()) {
-    value_.d_ = 0;
+    _impl_.value_.d_ = 0;
     clear_has_value();
   }
 }
 inline double GenericReply_BasicType::_internal_d() const {
   if (_internal_has_d()) {
-    return value_.d_;
+    return _impl_.value_.d_;
   }
   return 0;
 }
@@ -846,7 +912,7 @@ inline void GenericReply_BasicType::_internal_set_d(double value) {
     clear_value();
     set_has_d();
   }
-  value_.d_ = value;
+  _impl_.value_.d_ = value;
 }
 inline double GenericReply_BasicType::d() const {
   // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.BasicType.d)
@@ -865,17 +931,17 @@ inline bool GenericReply_BasicType::has_b() const {
   return _internal_has_b();
 }
 inline void GenericReply_BasicType::set_has_b() {
-  _oneof_case_[0] = kB;
+  _impl_._oneof_case_[0] = kB;
 }
 inline void GenericReply_BasicType::clear_b() {
   if (_internal_has_b()) {
-    value_.b_ = false;
+    _impl_.value_.b_ = false;
     clear_has_value();
   }
 }
 inline bool GenericReply_BasicType::_internal_b() const {
   if (_internal_has_b()) {
-    return value_.b_;
+    return _impl_.value_.b_;
   }
   return false;
 }
@@ -884,7 +950,7 @@ inline void GenericReply_BasicType::_internal_set_b(bool value) {
     clear_value();
     set_has_b();
   }
-  value_.b_ = value;
+  _impl_.value_.b_ = value;
 }
 inline bool GenericReply_BasicType::b() const {
   // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.BasicType.b)
@@ -903,11 +969,11 @@ inline bool GenericReply_BasicType::has_str() const {
   return _internal_has_str();
 }
 inline void GenericReply_BasicType::set_has_str() {
-  _oneof_case_[0] = kStr;
+  _impl_._oneof_case_[0] = kStr;
 }
 inline void GenericReply_BasicType::clear_str() {
   if (_internal_has_str()) {
-    value_.str_.Destroy();
+    _impl_.value_.str_.Destroy();
     clear_has_value();
   }
 }
@@ -920,9 +986,9 @@ inline void GenericReply_BasicType::set_str(ArgT0&& arg0, ArgT... args) {
   if (!_internal_has_str()) {
     clear_value();
     set_has_str();
-    value_.str_.InitDefault();
+    _impl_.value_.str_.InitDefault();
   }
-  value_.str_.Set( static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  _impl_.value_.str_.Set( static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
   // @@protoc_insertion_point(field_set:tcp_kit.GenericReply.BasicType.str)
 }
 inline std::string* GenericReply_BasicType::mutable_str() {
@@ -932,7 +998,7 @@ inline std::string* GenericReply_BasicType::mutable_str() {
 }
 inline const std::string& GenericReply_BasicType::_internal_str() const {
   if (_internal_has_str()) {
-    return value_.str_.Get();
+    return _impl_.value_.str_.Get();
   }
   return ::PROTOBUF_NAMESPACE_ID::internal::GetEmptyStringAlreadyInited();
 }
@@ -940,23 +1006,23 @@ inline void GenericReply_BasicType::_internal_set_str(const std::string& value)
   if (!_internal_has_str()) {
     clear_value();
     set_has_str();
-    value_.str_.InitDefault();
+    _impl_.value_.str_.InitDefault();
   }
-  value_.str_.Set(value, GetArenaForAllocation());
+  _impl_.value_.str_.Set(value, GetArenaForAllocation());
 }
 inline std::string* GenericReply_BasicType::_internal_mutable_str() {
   if (!_internal_has_str()) {
     clear_value();
     set_has_str();
-    value_.str_.InitDefault();
+    _impl_.value_.str_.InitDefault();
   }
-  return value_.str_.Mutable(      GetArenaForAllocation());
+  return _impl_.value_.str_.Mutable(      GetArenaForAllocation());
 }
 inline std::string* GenericReply_BasicType::release_str() {
   // @@protoc_insertion_point(field_release:tcp_kit.GenericReply.BasicType.str)
   if (_internal_has_str()) {
     clear_has_value();
-    return value_.str_.Release();
+    return _impl_.value_.str_.Release();
   } else {
     return nullptr;
   }
@@ -967,7 +1033,7 @@ inline void GenericReply_BasicType::set_allocated_str(std::string* str) {
   }
   if (str != nullptr) {
     set_has_str();
-    value_.str_.InitAllocated(str, GetArenaForAllocation());
+    _impl_.value_.str_.InitAllocated(str, GetArenaForAllocation());
   }
   // @@protoc_insertion_point(field_set_allocated:tcp_kit.GenericReply.BasicType.str)
 }
@@ -976,10 +1042,10 @@ inline bool GenericReply_BasicType::has_value() const {
   return value_case() != VALUE_NOT_SET;
 }
 inline void GenericReply_BasicType::clear_has_value() {
-  _oneof_case_[0] = VALUE_NOT_SET;
+  _impl_._oneof_case_[0] = VALUE_NOT_SET;
 }
 inline GenericReply_BasicType::ValueCase GenericReply_BasicType::value_case() const {
-  return GenericReply_BasicType::ValueCase(_oneof_case_[0]);
+  return GenericReply_BasicType::ValueCase(_impl_._oneof_case_[0]);
 }
 // -------------------------------------------------------------------
 
@@ -987,10 +1053,10 @@ inline GenericReply_BasicType::ValueCase GenericReply_BasicType::value_case() co
 
 // .tcp_kit.GenericReply.Code code = 1;
 inline void GenericReply::clear_code() {
-  code_ = 0;
+  _impl_.code_ = 0;
 }
 inline ::tcp_kit::GenericReply_Code GenericReply::_internal_code() const {
-  return static_cast< ::tcp_kit::GenericReply_Code >(code_);
+  return static_cast< ::tcp_kit::GenericReply_Code >(_impl_.code_);
 }
 inline ::tcp_kit::GenericReply_Code GenericReply::code() const {
   // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.code)
@@ -998,7 +1064,7 @@ inline ::tcp_kit::GenericReply_Code GenericReply::code() const {
 }
 inline void GenericReply::_internal_set_code(::tcp_kit::GenericReply_Code value) {
   
-  code_ = value;
+  _impl_.code_ = value;
 }
 inline void GenericReply::set_code(::tcp_kit::GenericReply_Code value) {
   _internal_set_code(value);
@@ -1007,15 +1073,15 @@ inline void GenericReply::set_code(::tcp_kit::GenericReply_Code value) {
 
 // optional string msg = 2;
 inline bool GenericReply::_internal_has_msg() const {
-  bool value = (_has_bits_[0] & 0x00000001u) != 0;
+  bool value = (_impl_._has_bits_[0] & 0x00000001u) != 0;
   return value;
 }
 inline bool GenericReply::has_msg() const {
   return _internal_has_msg();
 }
 inline void GenericReply::clear_msg() {
-  msg_.ClearToEmpty();
-  _has_bits_[0] &= ~0x00000001u;
+  _impl_.msg_.ClearToEmpty();
+  _impl_._has_bits_[0] &= ~0x00000001u;
 }
 inline const std::string& GenericReply::msg() const {
   // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.msg)
@@ -1024,8 +1090,8 @@ inline const std::string& GenericReply::msg() const {
 template <typename ArgT0, typename... ArgT>
 inline PROTOBUF_ALWAYS_INLINE
 void GenericReply::set_msg(ArgT0&& arg0, ArgT... args) {
- _has_bits_[0] |= 0x00000001u;
- msg_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+ _impl_._has_bits_[0] |= 0x00000001u;
+ _impl_.msg_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
   // @@protoc_insertion_point(field_set:tcp_kit.GenericReply.msg)
 }
 inline std::string* GenericReply::mutable_msg() {
@@ -1034,40 +1100,40 @@ inline std::string* GenericReply::mutable_msg() {
   return _s;
 }
 inline const std::string& GenericReply::_internal_msg() const {
-  return msg_.Get();
+  return _impl_.msg_.Get();
 }
 inline void GenericReply::_internal_set_msg(const std::string& value) {
-  _has_bits_[0] |= 0x00000001u;
-  msg_.Set(value, GetArenaForAllocation());
+  _impl_._has_bits_[0] |= 0x00000001u;
+  _impl_.msg_.Set(value, GetArenaForAllocation());
 }
 inline std::string* GenericReply::_internal_mutable_msg() {
-  _has_bits_[0] |= 0x00000001u;
-  return msg_.Mutable(GetArenaForAllocation());
+  _impl_._has_bits_[0] |= 0x00000001u;
+  return _impl_.msg_.Mutable(GetArenaForAllocation());
 }
 inline std::string* GenericReply::release_msg() {
   // @@protoc_insertion_point(field_release:tcp_kit.GenericReply.msg)
   if (!_internal_has_msg()) {
     return nullptr;
   }
-  _has_bits_[0] &= ~0x00000001u;
-  auto* p = msg_.Release();
+  _impl_._has_bits_[0] &= ~0x00000001u;
+  auto* p = _impl_.msg_.Release();
 #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
-  if (msg_.IsDefault()) {
-    msg_.Set("", GetArenaForAllocation());
+  if (_impl_.msg_.IsDefault()) {
+    _impl_.msg_.Set("", GetArenaForAllocation());
   }
 #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
   return p;
 }
 inline void GenericReply::set_allocated_msg(std::string* msg) {
   if (msg != nullptr) {
-    _has_bits_[0] |= 0x00000001u;
+    _impl_._has_bits_[0] |= 0x00000001u;
   } else {
-    _has_bits_[0] &= ~0x00000001u;
+    _impl_._has_bits_[0] &= ~0x00000001u;
   }
-  msg_.SetAllocated(msg, GetArenaForAllocation());
+  _impl_.msg_.SetAllocated(msg, GetArenaForAllocation());
 #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
-  if (msg_.IsDefault()) {
-    msg_.Set("", GetArenaForAllocation());
+  if (_impl_.msg_.IsDefault()) {
+    _impl_.msg_.Set("", GetArenaForAllocation());
   }
 #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
   // @@protoc_insertion_point(field_set_allocated:tcp_kit.GenericReply.msg)
@@ -1075,19 +1141,19 @@ inline void GenericReply::set_allocated_msg(std::string* msg) {
 
 // optional .tcp_kit.GenericReply.BasicType result = 3;
 inline bool GenericReply::_internal_has_result() const {
-  bool value = (_has_bits_[0] & 0x00000002u) != 0;
-  PROTOBUF_ASSUME(!value || result_ != nullptr);
+  bool value = (_impl_._has_bits_[0] & 0x00000004u) != 0;
+  PROTOBUF_ASSUME(!value || _impl_.result_ != nullptr);
   return value;
 }
 inline bool GenericReply::has_result() const {
   return _internal_has_result();
 }
 inline void GenericReply::clear_result() {
-  if (result_ != nullptr) result_->Clear();
-  _has_bits_[0] &= ~0x00000002u;
+  if (_impl_.result_ != nullptr) _impl_.result_->Clear();
+  _impl_._has_bits_[0] &= ~0x00000004u;
 }
 inline const ::tcp_kit::GenericReply_BasicType& GenericReply::_internal_result() const {
-  const ::tcp_kit::GenericReply_BasicType* p = result_;
+  const ::tcp_kit::GenericReply_BasicType* p = _impl_.result_;
   return p != nullptr ? *p : reinterpret_cast<const ::tcp_kit::GenericReply_BasicType&>(
       ::tcp_kit::_GenericReply_BasicType_default_instance_);
 }
@@ -1098,20 +1164,20 @@ inline const ::tcp_kit::GenericReply_BasicType& GenericReply::result() const {
 inline void GenericReply::unsafe_arena_set_allocated_result(
     ::tcp_kit::GenericReply_BasicType* result) {
   if (GetArenaForAllocation() == nullptr) {
-    delete reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(result_);
+    delete reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(_impl_.result_);
   }
-  result_ = result;
+  _impl_.result_ = result;
   if (result) {
-    _has_bits_[0] |= 0x00000002u;
+    _impl_._has_bits_[0] |= 0x00000004u;
   } else {
-    _has_bits_[0] &= ~0x00000002u;
+    _impl_._has_bits_[0] &= ~0x00000004u;
   }
   // @@protoc_insertion_point(field_unsafe_arena_set_allocated:tcp_kit.GenericReply.result)
 }
 inline ::tcp_kit::GenericReply_BasicType* GenericReply::release_result() {
-  _has_bits_[0] &= ~0x00000002u;
-  ::tcp_kit::GenericReply_BasicType* temp = result_;
-  result_ = nullptr;
+  _impl_._has_bits_[0] &= ~0x00000004u;
+  ::tcp_kit::GenericReply_BasicType* temp = _impl_.result_;
+  _impl_.result_ = nullptr;
 #ifdef PROTOBUF_FORCE_COPY_IN_RELEASE
   auto* old =  reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(temp);
   temp = ::PROTOBUF_NAMESPACE_ID::internal::DuplicateIfNonNull(temp);
@@ -1125,18 +1191,18 @@ inline ::tcp_kit::GenericReply_BasicType* GenericReply::release_result() {
 }
 inline ::tcp_kit::GenericReply_BasicType* GenericReply::unsafe_arena_release_result() {
   // @@protoc_insertion_point(field_release:tcp_kit.GenericReply.result)
-  _has_bits_[0] &= ~0x00000002u;
-  ::tcp_kit::GenericReply_BasicType* temp = result_;
-  result_ = nullptr;
+  _impl_._has_bits_[0] &= ~0x00000004u;
+  ::tcp_kit::GenericReply_BasicType* temp = _impl_.result_;
+  _impl_.result_ = nullptr;
   return temp;
 }
 inline ::tcp_kit::GenericReply_BasicType* GenericReply::_internal_mutable_result() {
-  _has_bits_[0] |= 0x00000002u;
-  if (result_ == nullptr) {
+  _impl_._has_bits_[0] |= 0x00000004u;
+  if (_impl_.result_ == nullptr) {
     auto* p = CreateMaybeMessage<::tcp_kit::GenericReply_BasicType>(GetArenaForAllocation());
-    result_ = p;
+    _impl_.result_ = p;
   }
-  return result_;
+  return _impl_.result_;
 }
 inline ::tcp_kit::GenericReply_BasicType* GenericReply::mutable_result() {
   ::tcp_kit::GenericReply_BasicType* _msg = _internal_mutable_result();
@@ -1146,7 +1212,7 @@ inline ::tcp_kit::GenericReply_BasicType* GenericReply::mutable_result() {
 inline void GenericReply::set_allocated_result(::tcp_kit::GenericReply_BasicType* result) {
   ::PROTOBUF_NAMESPACE_ID::Arena* message_arena = GetArenaForAllocation();
   if (message_arena == nullptr) {
-    delete result_;
+    delete _impl_.result_;
   }
   if (result) {
     ::PROTOBUF_NAMESPACE_ID::Arena* submessage_arena =
@@ -1155,25 +1221,25 @@ inline void GenericReply::set_allocated_result(::tcp_kit::GenericReply_BasicType
       result = ::PROTOBUF_NAMESPACE_ID::internal::GetOwnedMessage(
           message_arena, result, submessage_arena);
     }
-    _has_bits_[0] |= 0x00000002u;
+    _impl_._has_bits_[0] |= 0x00000004u;
   } else {
-    _has_bits_[0] &= ~0x00000002u;
+    _impl_._has_bits_[0] &= ~0x00000004u;
   }
-  result_ = result;
+  _impl_.result_ = result;
   // @@protoc_insertion_point(field_set_allocated:tcp_kit.GenericReply.result)
 }
 
 // optional .google.protobuf.Any body = 4;
 inline bool GenericReply::_internal_has_body() const {
-  bool value = (_has_bits_[0] & 0x00000004u) != 0;
-  PROTOBUF_ASSUME(!value || body_ != nullptr);
+  bool value = (_impl_._has_bits_[0] & 0x00000008u) != 0;
+  PROTOBUF_ASSUME(!value || _impl_.body_ != nullptr);
   return value;
 }
 inline bool GenericReply::has_body() const {
   return _internal_has_body();
 }
 inline const ::PROTOBUF_NAMESPACE_ID::Any& GenericReply::_internal_body() const {
-  const ::PROTOBUF_NAMESPACE_ID::Any* p = body_;
+  const ::PROTOBUF_NAMESPACE_ID::Any* p = _impl_.body_;
   return p != nullptr ? *p : reinterpret_cast<const ::PROTOBUF_NAMESPACE_ID::Any&>(
       ::PROTOBUF_NAMESPACE_ID::_Any_default_instance_);
 }
@@ -1184,20 +1250,20 @@ inline const ::PROTOBUF_NAMESPACE_ID::Any& GenericReply::body() const {
 inline void GenericReply::unsafe_arena_set_allocated_body(
     ::PROTOBUF_NAMESPACE_ID::Any* body) {
   if (GetArenaForAllocation() == nullptr) {
-    delete reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(body_);
+    delete reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(_impl_.body_);
   }
-  body_ = body;
+  _impl_.body_ = body;
   if (body) {
-    _has_bits_[0] |= 0x00000004u;
+    _impl_._has_bits_[0] |= 0x00000008u;
   } else {
-    _has_bits_[0] &= ~0x00000004u;
+    _impl_._has_bits_[0] &= ~0x00000008u;
   }
   // @@protoc_insertion_point(field_unsafe_arena_set_allocated:tcp_kit.GenericReply.body)
 }
 inline ::PROTOBUF_NAMESPACE_ID::Any* GenericReply::release_body() {
-  _has_bits_[0] &= ~0x00000004u;
-  ::PROTOBUF_NAMESPACE_ID::Any* temp = body_;
-  body_ = nullptr;
+  _impl_._has_bits_[0] &= ~0x00000008u;
+  ::PROTOBUF_NAMESPACE_ID::Any* temp = _impl_.body_;
+  _impl_.body_ = nullptr;
 #ifdef PROTOBUF_FORCE_COPY_IN_RELEASE
   auto* old =  reinterpret_cast<::PROTOBUF_NAMESPACE_ID::MessageLite*>(temp);
   temp = ::PROTOBUF_NAMESPACE_ID::internal::DuplicateIfNonNull(temp);
@@ -1211,18 +1277,18 @@ inline ::PROTOBUF_NAMESPACE_ID::Any* GenericReply::release_body() {
 }
 inline ::PROTOBUF_NAMESPACE_ID::Any* GenericReply::unsafe_arena_release_body() {
   // @@protoc_insertion_point(field_release:tcp_kit.GenericReply.body)
-  _has_bits_[0] &= ~0x00000004u;
-  ::PROTOBUF_NAMESPACE_ID::Any* temp = body_;
-  body_ = nullptr;
+  _impl_._has_bits_[0] &= ~0x00000008u;
+  ::PROTOBUF_NAMESPACE_ID::Any* temp = _impl_.body_;
+  _impl_.body_ = nullptr;
   return temp;
 }
 inline ::PROTOBUF_NAMESPACE_ID::Any* GenericReply::_internal_mutable_body() {
-  _has_bits_[0] |= 0x00000004u;
-  if (body_ == nullptr) {
+  _impl_._has_bits_[0] |= 0x00000008u;
+  if (_impl_.body_ == nullptr) {
     auto* p = CreateMaybeMessage<::PROTOBUF_NAMESPACE_ID::Any>(GetArenaForAllocation());
-    body_ = p;
+    _impl_.body_ = p;
   }
-  return body_;
+  return _impl_.body_;
 }
 inline ::PROTOBUF_NAMESPACE_ID::Any* GenericReply::mutable_body() {
   ::PROTOBUF_NAMESPACE_ID::Any* _msg = _internal_mutable_body();
@@ -1232,7 +1298,7 @@ inline ::PROTOBUF_NAMESPACE_ID::Any* GenericReply::mutable_body() {
 inline void GenericReply::set_allocated_body(::PROTOBUF_NAMESPACE_ID::Any* body) {
   ::PROTOBUF_NAMESPACE_ID::Arena* message_arena = GetArenaForAllocation();
   if (message_arena == nullptr) {
-    delete reinterpret_cast< ::PROTOBUF_NAMESPACE_ID::MessageLite*>(body_);
+    delete reinterpret_cast< ::PROTOBUF_NAMESPACE_ID::MessageLite*>(_impl_.body_);
   }
   if (body) {
     ::PROTOBUF_NAMESPACE_ID::Arena* submessage_arena =
@@ -1242,14 +1308,138 @@ inline void GenericReply::set_allocated_body(::PROTOBUF_NAMESPACE_ID::Any* body)
       body = ::PROTOBUF_NAMESPACE_ID::internal::GetOwnedMessage(
           message_arena, body, submessage_arena);
     }
-    _has_bits_[0] |= 0x00000004u;
+    _impl_._has_bits_[0] |= 0x00000008u;
   } else {
-    _has_bits_[0] &= ~0x00000004u;
+    _impl_._has_bits_[0] &= ~0x00000008u;
   }
-  body_ = body;
+  _impl_.body_ = body;
   // @@protoc_insertion_point(field_set_allocated:tcp_kit.GenericReply.body)
 }
 
+// optional uint64 stream_len = 5;
+inline bool GenericReply::_internal_has_stream_len() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000010u) != 0;
+  return value;
+}
+inline bool GenericReply::has_stream_len() const {
+  return _internal_has_stream_len();
+}
+inline void GenericReply::clear_stream_len() {
+  _impl_.stream_len_ = uint64_t{0u};
+  _impl_._has_bits_[0] &= ~0x00000010u;
+}
+inline uint64_t GenericReply::_internal_stream_len() const {
+  return _impl_.stream_len_;
+}
+inline uint64_t GenericReply::stream_len() const {
+  // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.stream_len)
+  return _internal_stream_len();
+}
+inline void GenericReply::_internal_set_stream_len(uint64_t value) {
+  _impl_._has_bits_[0] |= 0x00000010u;
+  _impl_.stream_len_ = value;
+}
+inline void GenericReply::set_stream_len(uint64_t value) {
+  _internal_set_stream_len(value);
+  // @@protoc_insertion_point(field_set:tcp_kit.GenericReply.stream_len)
+}
+
+// optional string topic = 6;
+inline bool GenericReply::_internal_has_topic() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000002u) != 0;
+  return value;
+}
+inline bool GenericReply::has_topic() const {
+  return _internal_has_topic();
+}
+inline void GenericReply::clear_topic() {
+  _impl_.topic_.ClearToEmpty();
+  _impl_._has_bits_[0] &= ~0x00000002u;
+}
+inline const std::string& GenericReply::topic() const {
+  // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.topic)
+  return _internal_topic();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void GenericReply::set_topic(ArgT0&& arg0, ArgT... args) {
+ _impl_._has_bits_[0] |= 0x00000002u;
+ _impl_.topic_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:tcp_kit.GenericReply.topic)
+}
+inline std::string* GenericReply::mutable_topic() {
+  std::string* _s = _internal_mutable_topic();
+  // @@protoc_insertion_point(field_mutable:tcp_kit.GenericReply.topic)
+  return _s;
+}
+inline const std::string& GenericReply::_internal_topic() const {
+  return _impl_.topic_.Get();
+}
+inline void GenericReply::_internal_set_topic(const std::string& value) {
+  _impl_._has_bits_[0] |= 0x00000002u;
+  _impl_.topic_.Set(value, GetArenaForAllocation());
+}
+inline std::string* GenericReply::_internal_mutable_topic() {
+  _impl_._has_bits_[0] |= 0x00000002u;
+  return _impl_.topic_.Mutable(GetArenaForAllocation());
+}
+inline std::string* GenericReply::release_topic() {
+  // @@protoc_insertion_point(field_release:tcp_kit.GenericReply.topic)
+  if (!_internal_has_topic()) {
+    return nullptr;
+  }
+  _impl_._has_bits_[0] &= ~0x00000002u;
+  auto* p = _impl_.topic_.Release();
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.topic_.IsDefault()) {
+    _impl_.topic_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  return p;
+}
+inline void GenericReply::set_allocated_topic(std::string* topic) {
+  if (topic != nullptr) {
+    _impl_._has_bits_[0] |= 0x00000002u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000002u;
+  }
+  _impl_.topic_.SetAllocated(topic, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.topic_.IsDefault()) {
+    _impl_.topic_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:tcp_kit.GenericReply.topic)
+}
+
+// optional uint64 seq = 7;
+inline bool GenericReply::_internal_has_seq() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000020u) != 0;
+  return value;
+}
+inline bool GenericReply::has_seq() const {
+  return _internal_has_seq();
+}
+inline void GenericReply::clear_seq() {
+  _impl_.seq_ = uint64_t{0u};
+  _impl_._has_bits_[0] &= ~0x00000020u;
+}
+inline uint64_t GenericReply::_internal_seq() const {
+  return _impl_.seq_;
+}
+inline uint64_t GenericReply::seq() const {
+  // @@protoc_insertion_point(field_get:tcp_kit.GenericReply.seq)
+  return _internal_seq();
+}
+inline void GenericReply::_internal_set_seq(uint64_t value) {
+  _impl_._has_bits_[0] |= 0x00000020u;
+  _impl_.seq_ = value;
+}
+inline void GenericReply::set_seq(uint64_t value) {
+  _internal_set_seq(value);
+  // @@protoc_insertion_point(field_set:tcp_kit.GenericReply.seq)
+}
+
 #ifdef __GNUC__
   #pragma GCC diagnostic pop
 #endif  // __GNUC__
@@ -13,16 +13,25 @@ namespace tcp_kit {
 
         class json_deserializer {
         public:
-            static std::unique_ptr<GenericMsg> process(msg_context* ctx, std::unique_ptr<msg_buffer> input);
+            static std::unique_ptr<GenericMsg> process(msg_context* ctx, msg_buffer input);
 
         };
 
         class json_serializer {
         public:
-            static std::unique_ptr<msg_buffer> process(msg_context* ctx, std::unique_ptr<GenericReply> input);
+            static msg_buffer process(msg_context* ctx, std::unique_ptr<GenericReply> input);
 
         };
 
+        class json_codec {
+        public:
+            static std::string encode(const GenericMsg &msg);
+            static bool decode(const char *frame, size_t len, GenericReply &reply);
+
+        };
+
+        using client_codec = json_codec;
+
     };
 
 
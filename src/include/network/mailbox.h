@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <event2/buffer.h>
+
+// 广播给 ev_handler 的所有连接的组
+#define ALL_CONNS 0
+
+namespace tcp_kit {
+
+    struct ev_context;
+
+    // 引用计数的只读数据, 以 evbuffer_add_reference 的方式加入连接的输出缓冲, 广播给多个连接时数据只有一份,
+    // 最后一个引用(发送方、投递中的邮件、输出缓冲)释放时回收
+    class shared_payload {
+
+    public:
+        size_t len;
+
+        // 拷贝 data 构造, 引用数为 1
+        static shared_payload *make(const void *data, size_t len);
+
+        const char *data() const;
+        void retain(uint32_t n = 1);
+        void release();
+
+        // 以引用的方式追加到 buf, 追加成功时持有一个引用
+        bool add_to(evbuffer *buf);
+
+        shared_payload(const shared_payload&) = delete;
+        shared_payload& operator=(const shared_payload&) = delete;
+
+    private:
+        std::atomic<uint32_t> _refs;
+
+        shared_payload(size_t len_);
+
+    };
+
+    // 投递给 ev_handler 的邮件, 由其事件循环线程取出并执行
+    struct mail {
+        static const uint8_t SEND      = 0; // 向 target 连接发送 payload
+        static const uint8_t BROADCAST = 1; // 向 group 组中的连接发送 payload, target 不为 0 时为 filter_chain 指针, 只发送给该链的连接
+        static const uint8_t JOIN      = 2; // target 连接加入 group
+        static const uint8_t LEAVE     = 3; // target 连接离开 group
+        static const uint8_t RESUME    = 4; // target 为 msg_context 指针, group 毫秒后将其重新放入 handler 的消息队列
+        static const uint8_t CONNECT   = 5; // target 为挂起建立的 ev_context 指针, group 非 0 表示失败. 成功时以 arg 调用 then 后继续建立连接
+
+        mail           *next;
+        uint8_t         kind;
+        uint64_t        target;
+        uint32_t        group;
+        shared_payload *payload; // 邮件持有一个引用
+        void          (*then)(ev_context *ctx, void *arg);
+        void           *arg;
+    };
+
+}
@@ -1,13 +1,25 @@
 #pragma once
 #include <event2/event.h>
 #include <event2/buffer.h>
+#include <network/file_region.h>
+#include <network/concurrency_limiter.h>
+#include <util/timing_wheel.h>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <string>
 
 namespace tcp_kit {
 
+    class msg_buffer;
+    class filter_chain;
+    class handler_base;
+    class ev_handler_base;
+
     // handler 线程不允许直接对 bufferevent 访问, 这将引发线程安全问题, 将输入输出的缓冲数据作为线程独享, 并通过事件回调
     // 通知 event handler 线程可以避免处理线程安全问题(要求事件本身设置为线程安全的)
     struct msg_context {
-        uint32_t    conn_id;        // tcp 连接唯一id
+        uint64_t    conn_id;        // tcp 连接唯一id, 可通过 server::find 查找对应的连接
         char       *in;             // 输入缓冲区, 一般是一个完整的消息
         size_t      in_len;
         char       *out;            // 输出缓冲区, 缓存回写给客户端的数据
@@ -16,6 +28,35 @@ namespace tcp_kit {
         event      *done_ev;        // 处理结束回调
         event      *error_ev;       // 处理结束回调
         bool        error_flag;     // 错误标志
+        stream_context stream;      // 跟随回复发送或接收的文件流
+        std::chrono::steady_clock::time_point enqueued_at; // ev_handler 收到完整消息并入队的时间
+        std::chrono::steady_clock::time_point deadline;    // 处理截止时间, 默认值表示没有截止时间
+        concurrency_limiter *limiter;   // 入队时占用了额度的限制器, handler 处理返回(包括交由完成令牌)时归还
+        uint32_t    reject_code;    // 非 0 时表示请求已被拒绝, handler 不再处理而直接以该状态码回复
+        bool        deferred;       // 回复由异步 api 的完成令牌稍后给出
+        std::atomic<uint8_t> holds; // 延迟回复时 handler 与完成令牌各持有一份, 都释放后才触发回调
+        std::unique_ptr<msg_buffer>(*encode)(msg_context *ctx, void *reply); // 编码回复, 由 handler 在处理前设置
+        ev_handler_base *ev_handler;    // 收到该消息的 ev_handler
+        handler_base    *handler;       // 处理该消息的 handler
+        filter_chain    *filters;       // 收到该消息的监听端口的过滤器链
+        void        *resume;        // 挂起中的协程, 非空时 handler 取出该消息后恢复它而不是重新处理
+        timer_node   resume_timer;  // 协程延时恢复的定时器, 挂在 ev_handler 的时间轮上
+        uint64_t     seq;           // 请求的关联 id, 解析请求后设置, 由序列化过滤器写入回复
+        const std::string *api;     // 请求的 api(api_dispatcher 中的键), 未找到 api 时为空
+        uint16_t     reply_code;    // 回复的状态码, 由序列化过滤器设置
+        uint64_t     trace_id;      // 被采样追踪时非 0, 见 trace
+        uint64_t     trace_mark;    // 被采样追踪时, 上一个阶段结束的 trace::ticks()
+
+        // 将回复交由完成令牌给出, 在 handler 线程中处理请求时调用
+        void defer();
+        // 释放一份持有, 最后一份释放时按 error_flag 触发 done 或 error, 之后不能再访问 msg_context
+        void complete();
+
+        // 设置处理时限(从入队时开始计算), 已有更早的截止时间时保持不变
+        void set_timeout(std::chrono::milliseconds timeout);
+        // 剩余的处理时间, 没有截止时间时返回 milliseconds::max(), 已超时返回 0
+        std::chrono::milliseconds remaining() const;
+        bool expired() const;
 
         // -------------以下事件只能有一个被触发--------------------
         void done();
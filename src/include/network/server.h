@@ -1,20 +1,31 @@
 #pragma once
 
 #include <cstdlib>
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
 #include <network/filter_chain.h>
 #include <network/ev_context.h>
 #include <network/msg_context.h>
+#include <network/concurrency_limiter.h>
+#include <network/conn_table.h>
+#include <network/mailbox.h>
 #include <util/int_types.h>
 #include <logger/logger.h>
 #include <thread/thread_pool.h>
 #include <util/tcp_util.h>
 #include <util/system_util.h>
+#include <metrics/metrics.h>
+#include <metrics/trace.h>
 #include <event2/event.h>
 #include <event2/listener.h>
 #include <event2/bufferevent.h>
 #include <event2/thread.h>
 #include <concurrent/lock_free_queue.h>
 #include <concurrent/lock_free_spsc_queue.h>
+#include <concurrent/mpsc_queue.h>
 
 #define EV_HANDLER_CAPACITY      0x3fff
 #define HANDLER_CAPACITY         0x3fff
@@ -29,6 +40,9 @@
 #define TASK_FIFO_SIZE      3
 #endif
 
+// topic 对应的组号从此开始分配
+#define TOPIC_GROUP_BASE         0x80000000u
+
 namespace tcp_kit {
 
     class ev_handler_base;
@@ -37,6 +51,21 @@ namespace tcp_kit {
     class ev_context;
     class evbuffer_holder;
     class msg_buffer;
+    template<typename List> struct reply_type_of;
+
+    // server 监听的一个端口, 每个端口有自己的过滤器链与 api 表, 共享 server 的 ev_handler 与 handler 线程
+    struct endpoint {
+        uint16_t                      port;
+        std::shared_ptr<filter_chain> filters;
+        bool                          publishable; // 回复类型与 server 的 PORT 相同, publish 以该端口的过滤器链编码发布
+    };
+
+    // 一个监听端口的接收者, 作为 evconnlistener 接收回调的参数
+    struct acceptor {
+        void           *owner;    // 接收连接的 ev_handler(__APPLE__ 下为 server)
+        filter_chain   *filters;
+        evconnlistener *evc;
+    };
 
     // 该类制定了 server 的状态控制行为
     //
@@ -49,10 +78,13 @@ namespace tcp_kit {
     class server_base {
 
     public:
-        server_base(std::shared_ptr<filter_chain> filters_);
+        server_base(uint16_t port, std::shared_ptr<filter_chain> filters_);
 
         bool is_running();
 
+        // 所有监听端口, 第一个为 server 的 PORT. 只在 start() 之前增加
+        const std::vector<endpoint>& endpoints() const { return _endpoints; }
+
         virtual ~server_base() = default;
 
     protected:
@@ -70,8 +102,12 @@ namespace tcp_kit {
         std::atomic<uint32_t>         _ctl;
         std::mutex                    _mutex;
         std::condition_variable_any   _state;
-        std::shared_ptr<filter_chain> _filters;
+        std::shared_ptr<filter_chain> _filters;    // server 的 PORT 的过滤器链
+        std::vector<endpoint>         _endpoints;
 
+        void add_endpoint(uint16_t port, std::shared_ptr<filter_chain> filters_, bool publishable);
+        // 以 chain 编码 publication(由过滤器链接管并释放), 编码结果 data 由调用者 free
+        static void encode_publication(filter_chain *chain, void *publication, char *&data, size_t &len);
         virtual void try_ready() = 0;
         void trans_to(uint32_t rs);
         void wait_at_least(uint32_t rs);
@@ -87,6 +123,7 @@ namespace tcp_kit {
         socket_t          fd;
         sockaddr         *address;
         int               socklen;
+        filter_chain     *filters;
     };
 #endif
 
@@ -113,6 +150,44 @@ namespace tcp_kit {
         // 在 server 进入 RUNNING 状态后被调度, 派生类在此处做任务处理
         virtual void run() = 0;
 
+        // 向连接推送一段非回复的数据(如广播), 只能在该连接所属的 ev_handler 线程中调用, 连接被限流时按照
+        // conn_limits::slow_consumer_policy 处理. 返回数据是否被写入
+        virtual bool push(ev_context *ctx, evbuffer *buf) = 0;
+
+        // 当前因输出缓冲超过高水位而被限流的连接数
+        std::atomic<uint32_t> n_throttled;
+
+        // 该 ev_handler 上的请求在进入 handler 之前的并发限制
+        concurrency_limiter limiter;
+
+        // 该 ev_handler 持有的连接
+        conn_table conns;
+
+        // 投递邮件, 可以在任意线程中调用. 邮件在 ev_handler 的下一轮事件循环中被批量取出执行, 执行后释放
+        void post(mail *m);
+
+        // 在 delay_ms 毫秒后(精度为时间轮的 tick)将挂起的请求交还给处理它的 handler, 可以在任意线程中调用.
+        // 经由 ev_handler 转交, 因此 handler 的消息队列仍只有 ev_handler 一个生产者
+        void resume(msg_context *ctx, uint32_t delay_ms = 0);
+
+        // 由连接过滤器调用, 挂起连接的建立: 过滤器返回后不再调用其后的连接过滤器, 也不注册读写过滤器, 连接在
+        // resume_connect 之前不读不写. 用于耗时的建立过程(如在 crypto 线程池中进行的 TLS 握手)不阻塞事件循环
+        static void suspend_connect(ev_context *ctx);
+
+        // 恢复被挂起的连接的建立, 可以在任意线程中调用. 在该 ev_handler 线程中, ok 时先调用 then(ctx, arg), 再调用余下的
+        // 连接过滤器并注册读写过滤器; 否则(或 then 抛出异常时)以错误关闭连接, 此时不调用 then
+        void resume_connect(ev_context *ctx, bool ok, void (*then)(ev_context *ctx, void *arg) = nullptr, void *arg = nullptr);
+
+        // 阻塞直到该 ev_handler 上没有被限流的连接或超时, 返回是否可写
+        template<typename Duration>
+        bool wait_writable(Duration timeout);
+
+        // 不为 0 时(SLOW_CONSUMER_BLOCK 策略), server::send/broadcast/publish 投递前以它为时限调用 wait_writable
+        std::chrono::milliseconds writer_block;
+
+        // 限流解除后由 ev_handler 线程调用, 唤醒等待的推送方
+        void notify_writable();
+
         virtual ~ev_handler_base() = default;
 
     protected:
@@ -124,6 +199,13 @@ namespace tcp_kit {
         void call_close_filters(struct ev_context *ctx);
         // std::unique_ptr<evbuffer_holder> call_process_filters(ev_context* ctx);
 
+        std::mutex                   _writable_mutex;
+        std::condition_variable_any  _writable;
+        std::atomic<uint32_t>        _n_writable_waiters;
+
+        mpsc_queue<mail>             _mailbox;
+        event                       *_mailbox_ev; // 由派生类创建, 邮箱由空变为非空时被激活
+
     };
 
     class handler_base {
@@ -141,18 +223,32 @@ namespace tcp_kit {
     protected:
         server_base* _server_base;
         std::shared_ptr<filter_chain> _filters;
-        std::unique_ptr<msg_buffer> make_msg_buffer(char* line_msg, size_t len);
+        // 以消息所在的缓冲区构造 msg_buffer, 不转移所有权
+        msg_buffer make_msg_buffer(char* line_msg, size_t len);
 //        std::unique_ptr<evbuffer_holder> call_process_filters(struct msg_context* ctx);
 
     };
 
     struct api_dispatcher_p {};
 
+    // server::listen 增加的监听端口, 用于在该端口的 api 表(api_dispatcher<PORT>)中注册 api
+    template<typename Protocols, uint16_t PORT>
+    class listener {
+
+    public:
+        template<typename Identity, typename Processor, typename... Options>
+        void api(const Identity& id, Processor prcs, Options&&... opts) {
+            Protocols::template api_dispatcher<PORT>::api(id, prcs, std::forward<Options>(opts)...);
+        }
+
+    };
+
     // 模版参数 Protocols:
     // Protocols 代表协议(Protocol), 将 server 指定为任意协议实现, 如: server<generic> svr; 或: server<http> svr;
     // Protocols 必须满足以下条件:
     //   1: 有公共成员类 ev_handler 且派生于 ev_handler_base 类, 无参构造函数
-    //   2: 有公共成员类 handler 且派生于 handler 类, 无参构造函数
+    //   2: 有公共成员类模版 handler<Filters> 且派生于 handler_base 类, 无参构造函数. Filters 为替换 api_dispatcher_p 后的
+    //      过滤器集, handler 以此直接调用类型完整的 Process Filters(见 process_pipeline), 而不经过 filter_chain 中的函数指针
     //   3: 如若有默认的过滤器集, 声明 filter_types 类型, 如: using filter_types = type_list<filter1, filter2, filter3...>;
     //   4: 有公共成员类 api_dispatcher<uint16_t PORT>, 无参构造函数, 且具备以下条件:
     //      ----------------------------------------------------------------------------------------------------------
@@ -166,6 +262,11 @@ namespace tcp_kit {
     //      ----------------------------------------------------------------------------------------------------------
     //      2. 过滤器
     //      使用 api_dispatcher_p 代替实际类型, 如: using filter_types = type_list<filter1, api_dispatcher_p>
+    //      ----------------------------------------------------------------------------------------------------------
+    //      3. publication 函数(static 修饰, 使用 publish 时需要)
+    //      将发布到 topic 的数据构造为回复对象, 随后经 api_dispatcher 之后的过滤器编码一次, 由所有订阅者共享
+    //      template<typename T>
+    //      std::unique_ptr<Reply> publication(const std::string &topic, T &data);
     //
     // 线程的分配:
     //   ev_handler -> 处理连接事件线程(一般是读、写)
@@ -183,6 +284,19 @@ namespace tcp_kit {
     //   ev_handler 和 handler 使用队列传递消息. 根据它们线程数的不同, 自动选择使用是否支持在多线程同步的队列, 在分配线程时尽量不要使
     //   ev_handler 的线程数多于 handler 的线程数, 这将产生竞争
     //
+    // 多个监听端口:
+    //   listen<P, LPORT, Extra...>() 在 LPORT 上以协议 P 的过滤器集(前面加上 Extra...)增加一个监听, 例如在同一个 server 上
+    //   以 protobuf 监听 3000, 以 JSON 监听 3001, 以 TLS + protobuf 监听 3443:
+    //     server<generic, 3000> svr;
+    //     auto js = svr.listen<json, 3001>();
+    //     auto tls = svr.listen<generic, 3443, filters::tls_filter>();
+    //   每个端口有自己的过滤器链与 api 表(api_dispatcher<LPORT>), 所有端口的连接由同一组 ev_handler 接收, 消息由同一组
+    //   handler 处理, 不会因为多个协议而成倍地增加线程. P 必须与 Protocols 使用相同的 ev_handler(消息的分帧方式相同).
+    //   PORT 的消息直接调用内联的 Process Filters, 其他端口的消息经过一次函数指针调用各自的链.
+    //   publish 以每个端口自己的过滤器链各编码一次, 订阅者收到其所在端口协议的编码. 回复类型与 PORT 不同的端口不参与
+    //   publish, 其上的订阅者只收到 publish 原始数据. pubsub_api 只注册在 PORT 上, 其他端口以 listener::api 注册调用
+    //   subscribe/unsubscribe 的 api
+    //
     // 生命周期函数:
     //   when_ready(): 进入 READY 状态后回调, 随后进入 RUNNING 状态
     template <typename Protocols, uint16_t PORT = 3000>
@@ -190,9 +304,9 @@ namespace tcp_kit {
 
     protected:
         using ev_handler_t     = typename Protocols::template ev_handler<PORT>;
-        using handler_t        = typename Protocols::handler;
         using api_dispatcher_t = typename Protocols::template api_dispatcher<PORT>;
         using filter_types     = typename replace_type<typename Protocols::filters,api_dispatcher_p,api_dispatcher_t>::type;
+        using handler_t        = typename Protocols::template handler<filter_types>;
 
         static_assert(std::is_base_of<ev_handler_base, ev_handler_t>::value , "Protocols::ev_handler must be derived from ev_handler_base.");
         static_assert(std::is_base_of<handler_base, handler_t>::value , "Protocols::handler must be derived from handler_base.");
@@ -203,8 +317,57 @@ namespace tcp_kit {
 
         void start();
 
-        template<typename Identity, typename Processor>
-        void api(const Identity& id, Processor prcs);
+        template<typename Identity, typename Processor, typename... Options>
+        void api(const Identity& id, Processor prcs, Options&&... opts);
+
+        // 在 LPORT 上增加一个监听, 见上文. 只能在 start() 之前调用, 端口已被该 server 监听时抛出 invalid_argument
+        template<typename P, uint16_t LPORT, typename... Extra>
+        listener<P, LPORT> listen();
+
+        // 当前被限流(慢消费者)的连接数
+        uint32_t n_throttled();
+
+        // 查找 conn_id 对应的存活连接, 连接已断开时返回 nullptr. 返回的连接只能在其所属的 ev_handler 线程中访问
+        ev_context *find(uint64_t conn_id);
+
+        // 以下函数可以在任意线程中调用, 数据由连接所属的 ev_handler 写出, 并受 conn_limits::slow_consumer_policy 约束.
+        // 连接在投递到达前断开时数据被丢弃. SLOW_CONSUMER_BLOCK 策略下, 目标 ev_handler 上有被限流的连接时先阻塞
+        // (最长 SLOW_CONSUMER_BLOCK_MS)再投递, 不要在 ev_handler 线程(如连接过滤器)中调用
+
+        // 向连接发送数据, conn_id 不属于该 server 时返回 false
+        bool send(uint64_t conn_id, const void *data, size_t len);
+        bool send(uint64_t conn_id, const std::string &data);
+
+        // 向组中的所有连接发送数据, 数据只拷贝一次, 由所有连接的输出缓冲共享. group 为 ALL_CONNS 时发送给所有连接
+        void broadcast(uint32_t group, const void *data, size_t len);
+        void broadcast(uint32_t group, const std::string &data);
+
+        // 连接加入/离开组, 连接断开时自动离开所有组
+        bool join(uint64_t conn_id, uint32_t group);
+        bool leave(uint64_t conn_id, uint32_t group);
+
+        // 发布/订阅, 每个 topic 对应一个组(组号从 TOPIC_GROUP_BASE 开始分配, 不要将其用于 join). 每个 ev_handler 只持有
+        // 自己连接的订阅, 发布时向每个 ev_handler 投递一封邮件, 而不是向每个订阅者投递
+        bool subscribe(uint64_t conn_id, const std::string &topic);
+        bool unsubscribe(uint64_t conn_id, const std::string &topic);
+
+        // 以协议的回复格式编码 data 并发布给 topic 的所有订阅者, 每个监听端口的过滤器链编码一次, 只投递给该端口的订阅者.
+        // 没有连接订阅过该 topic 时直接返回
+        template<typename T>
+        void publish(const std::string &topic, T data);
+
+        // 发布已编码的原始数据
+        void publish(const std::string &topic, const void *data, size_t len);
+
+        // 将 subscribe / unsubscribe 注册为 api, 参数为 topic, 返回是否成功
+        void pubsub_api(const std::string &subscribe_id = "subscribe", const std::string &unsubscribe_id = "unsubscribe");
+
+        // 所有 ev_handler 当前的并发上限之和
+        uint32_t concurrency_limit();
+
+        // 累计被接受/因过载被拒绝的请求数, 拒绝率 = n_rejected / (n_admitted + n_rejected)
+        uint64_t n_admitted();
+        uint64_t n_rejected();
 
 #ifdef __APPLE__
         virtual ~server();
@@ -220,17 +383,30 @@ namespace tcp_kit {
 
 #ifdef __APPLE__
         event_base                     *_ev_base;
-        evconnlistener                 *_evc;
+        std::vector<acceptor>           _acceptors;
         size_t                          _index;
 #endif
         std::atomic<uint32_t>          _ready_threads;
         std::unique_ptr<thread_pool>   _threads;
         std::vector<ev_handler_t>      _ev_handlers;
         std::vector<handler_t>         _handlers;
+        std::mutex                     _topic_mutex;
+        std::unordered_map<std::string, uint32_t> _topics; // topic -> 组
 
         void try_ready() override;
         virtual void when_ready();
 
+        // 在 api 表中注册 METRICS_API, 每个监听端口都注册
+        template<typename Dispatcher>
+        void builtin_apis();
+
+        bool topic_group(const std::string &topic, bool create, uint32_t &group);
+
+        // 等待所有 ev_handler 可写(仅 SLOW_CONSUMER_BLOCK 策略), 共用一个 writer_block 时限
+        void wait_writers();
+        // 向每个 ev_handler 投递一次广播, chain 不为空时只投递给该过滤器链(监听端口)的连接
+        void post_broadcast(uint32_t group, filter_chain *chain, const void *data, size_t len);
+
 #ifdef __APPLE__
         static void accept_callback(evconnlistener *listener, socket_t fd, sockaddr *address, int socklen, void *arg);
         ev_handler_t *next();
@@ -244,11 +420,10 @@ namespace tcp_kit {
     };
 
     template <typename Protocols, uint16_t PORT>
-    server<Protocols,PORT>::server(uint16_t n_ev_handler, uint16_t n_handler): _ready_threads(0), server_base(make_filter_chain(filter_types{})) {
+    server<Protocols,PORT>::server(uint16_t n_ev_handler, uint16_t n_handler): _ready_threads(0), server_base(PORT, make_filter_chain(filter_types{})) {
         evthread_use_pthreads();
 #ifdef __APPLE__
         _ev_base = event_base_new();
-        _evc = nullptr;
         _index = 0;
 #endif
         if(n_ev_handler > EV_HANDLER_CAPACITY || n_handler > HANDLER_CAPACITY)
@@ -266,6 +441,22 @@ namespace tcp_kit {
         adjust_to_multiple(n_ev_handler, n_handler);
         _ctl |= (n_ev_handler << EV_HANDLER_OFFSET);
         _ctl |= n_handler;
+        builtin_apis<api_dispatcher_t>();
+#if TRACE_API_ENABLED
+        api_dispatcher_t::api(TRACE_API, [](double rate) {
+            double previous = trace::sample_rate();
+            trace::set_sample_rate(rate);
+            return previous;
+        });
+#endif
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    template <typename Dispatcher>
+    void server<Protocols, PORT>::builtin_apis() {
+        Dispatcher::api(METRICS_API, [] {
+            return metrics::to_json();
+        });
     }
 
     // 4 - 2 ev_h: [1][2][1,2][1,2]
@@ -287,6 +478,7 @@ namespace tcp_kit {
                     uint16_t ev_handler_i = handler_i * n_share + j;
                     _ev_handlers[ev_handler_i].handlers.push_back(&_handlers[handler_i]);
                     _ev_handlers[ev_handler_i].n_handler = 1;
+                    _ev_handlers[ev_handler_i].conns.init(ev_handler_i);
                     _threads->execute(&ev_handler_t::bind_and_run, &_ev_handlers[ev_handler_i], this);
                 }
                 _handlers[handler_i].race = true;
@@ -302,32 +494,238 @@ namespace tcp_kit {
                     _threads->execute(&handler_t::bind_and_run, &_handlers[handler_i], this);
                 }
                 _ev_handlers[ev_handler_i].n_handler = n_own;
+                _ev_handlers[ev_handler_i].conns.init(ev_handler_i);
                 _threads->execute(&ev_handler_t::bind_and_run, &_ev_handlers[ev_handler_i], this);
             }
         }
         wait_at_least(READY);
 #ifdef __APPLE__
-        sockaddr_in sin = socket_address(PORT);
-        _evc = evconnlistener_new_bind(
-                _ev_base, accept_callback, this, LEV_OPT_CLOSE_ON_FREE,
-                -1, (sockaddr*) &sin, sizeof(sin));
-        if(!_evc) {
-            log_error("Cannot open the socket of port: %d", PORT);
-            throw std::runtime_error("Server start failed");
+        _acceptors.reserve(_endpoints.size());
+        for(const endpoint &e : _endpoints) {
+            _acceptors.push_back({this, e.filters.get(), nullptr});
+            sockaddr_in sin = socket_address(e.port);
+            _acceptors.back().evc = evconnlistener_new_bind(
+                    _ev_base, accept_callback, &_acceptors.back(), LEV_OPT_CLOSE_ON_FREE,
+                    -1, (sockaddr*) &sin, sizeof(sin));
+            if(!_acceptors.back().evc) {
+                log_error("Cannot open the socket of port: %d", e.port);
+                throw std::runtime_error("Server start failed");
+            }
         }
 #endif
+        if(METRICS_PROMETHEUS_PORT)
+            metrics::serve_prometheus(METRICS_PROMETHEUS_PORT);
         when_ready();
         trans_to(RUNNING);
-        log_info("The server is started on port: %d", PORT);
+        for(const endpoint &e : _endpoints)
+            log_info("The server is started on port: %d", e.port);
         event_base_loop(_ev_base, EVLOOP_NO_EXIT_ON_EMPTY);
         log_info("loop break");
         wait_at_least(SHUTDOWN);
     }
 
     template<typename Protocols, uint16_t PORT>
-    template<typename Identity, typename Processor>
-    void server<Protocols, PORT>::api(const Identity& id, Processor prcs) {
-        api_dispatcher_t::api(id, prcs);
+    template<typename Identity, typename Processor, typename... Options>
+    void server<Protocols, PORT>::api(const Identity& id, Processor prcs, Options&&... opts) {
+        api_dispatcher_t::api(id, prcs, std::forward<Options>(opts)...);
+    }
+
+    template<typename Protocols, uint16_t PORT>
+    template<typename P, uint16_t LPORT, typename... Extra>
+    listener<P, LPORT> server<Protocols, PORT>::listen() {
+        using dispatcher_t = typename P::template api_dispatcher<LPORT>;
+        using types = typename concat_types<type_list<Extra...>,
+                      typename replace_type<typename P::filters, api_dispatcher_p, dispatcher_t>::type>::type;
+        static_assert(std::is_same<typename P::template ev_handler<PORT>, ev_handler_t>::value,
+                      "The protocol of a listener must frame messages with the ev_handler of the server.");
+        if(_threads)
+            throw std::logic_error("Listeners must be added before the server starts");
+        add_endpoint(LPORT, make_filter_chain(types{}),
+                     std::is_same<typename reply_type_of<types>::type, typename reply_type_of<filter_types>::type>::value);
+        builtin_apis<dispatcher_t>();
+        return {};
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    uint32_t server<Protocols, PORT>::n_throttled() {
+        uint32_t n = 0;
+        for(auto &ev_handler : _ev_handlers)
+            n += ev_handler.n_throttled.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    ev_context *server<Protocols, PORT>::find(uint64_t conn_id) {
+        uint16_t index = conn_table::ev_handler_of(conn_id);
+        return index < _ev_handlers.size() ? _ev_handlers[index].conns.find(conn_id) : nullptr;
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    bool server<Protocols, PORT>::send(uint64_t conn_id, const void *data, size_t len) {
+        uint16_t index = conn_table::ev_handler_of(conn_id);
+        if(index >= _ev_handlers.size())
+            return false;
+        ev_handler_t &ev_handler = _ev_handlers[index];
+        if(ev_handler.writer_block.count())
+            ev_handler.wait_writable(ev_handler.writer_block);
+        ev_handler.post(new mail{nullptr, mail::SEND, conn_id, 0, shared_payload::make(data, len)});
+        return true;
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    bool server<Protocols, PORT>::send(uint64_t conn_id, const std::string &data) {
+        return send(conn_id, data.data(), data.size());
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    void server<Protocols, PORT>::broadcast(uint32_t group, const void *data, size_t len) {
+        if(_ev_handlers.empty())
+            return;
+        wait_writers();
+        post_broadcast(group, nullptr, data, len);
+    }
+
+    // 所有 ev_handler 共用一个时限, 而不是逐个等待 writer_block
+    template <typename Protocols, uint16_t PORT>
+    void server<Protocols, PORT>::wait_writers() {
+        auto until = std::chrono::steady_clock::now() + _ev_handlers.front().writer_block;
+        for(auto &ev_handler : _ev_handlers) {
+            if(ev_handler.writer_block.count())
+                ev_handler.wait_writable(std::max(until - std::chrono::steady_clock::now(),
+                                                  std::chrono::steady_clock::duration::zero()));
+        }
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    void server<Protocols, PORT>::post_broadcast(uint32_t group, filter_chain *chain, const void *data, size_t len) {
+        shared_payload *payload = shared_payload::make(data, len);
+        payload->retain(_ev_handlers.size());
+        for(auto &ev_handler : _ev_handlers)
+            ev_handler.post(new mail{nullptr, mail::BROADCAST, reinterpret_cast<uint64_t>(chain), group, payload});
+        payload->release();
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    void server<Protocols, PORT>::broadcast(uint32_t group, const std::string &data) {
+        broadcast(group, data.data(), data.size());
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    bool server<Protocols, PORT>::join(uint64_t conn_id, uint32_t group) {
+        uint16_t index = conn_table::ev_handler_of(conn_id);
+        if(index >= _ev_handlers.size() || group == ALL_CONNS)
+            return false;
+        _ev_handlers[index].post(new mail{nullptr, mail::JOIN, conn_id, group, nullptr});
+        return true;
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    bool server<Protocols, PORT>::leave(uint64_t conn_id, uint32_t group) {
+        uint16_t index = conn_table::ev_handler_of(conn_id);
+        if(index >= _ev_handlers.size() || group == ALL_CONNS)
+            return false;
+        _ev_handlers[index].post(new mail{nullptr, mail::LEAVE, conn_id, group, nullptr});
+        return true;
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    bool server<Protocols, PORT>::topic_group(const std::string &topic, bool create, uint32_t &group) {
+        std::lock_guard<std::mutex> lock(_topic_mutex);
+        auto it = _topics.find(topic);
+        if(it != _topics.end()) {
+            group = it->second;
+            return true;
+        }
+        if(!create || _topics.size() >= 0xffffffffu - TOPIC_GROUP_BASE)
+            return false;
+        group = TOPIC_GROUP_BASE + uint32_t(_topics.size());
+        _topics.emplace(topic, group);
+        return true;
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    bool server<Protocols, PORT>::subscribe(uint64_t conn_id, const std::string &topic) {
+        uint32_t group;
+        return topic_group(topic, true, group) && join(conn_id, group);
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    bool server<Protocols, PORT>::unsubscribe(uint64_t conn_id, const std::string &topic) {
+        uint32_t group;
+        return topic_group(topic, false, group) && leave(conn_id, group);
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    template<typename T>
+    void server<Protocols, PORT>::publish(const std::string &topic, T data) {
+        uint32_t group;
+        if(!topic_group(topic, false, group) || _ev_handlers.empty())
+            return;
+        wait_writers();
+        // 只有一个监听端口时不必按过滤器链区分订阅者
+        bool single = _endpoints.size() == 1;
+        for(const endpoint &e : _endpoints) {
+            if(!e.publishable)
+                continue;
+            char *encoded;
+            size_t len;
+            encode_publication(e.filters.get(), api_dispatcher_t::publication(topic, data).release(), encoded, len);
+            post_broadcast(group, single ? nullptr : e.filters.get(), encoded, len);
+            free(encoded);
+        }
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    void server<Protocols, PORT>::publish(const std::string &topic, const void *data, size_t len) {
+        uint32_t group;
+        if(topic_group(topic, false, group))
+            broadcast(group, data, len);
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    void server<Protocols, PORT>::pubsub_api(const std::string &subscribe_id, const std::string &unsubscribe_id) {
+        api(subscribe_id, [this](msg_context *ctx, std::string topic) {
+            return subscribe(ctx->conn_id, topic);
+        });
+        api(unsubscribe_id, [this](msg_context *ctx, std::string topic) {
+            return unsubscribe(ctx->conn_id, topic);
+        });
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    uint32_t server<Protocols, PORT>::concurrency_limit() {
+        uint32_t n = 0;
+        for(auto &ev_handler : _ev_handlers)
+            n += ev_handler.limiter.limit();
+        return n;
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    uint64_t server<Protocols, PORT>::n_admitted() {
+        uint64_t n = 0;
+        for(auto &ev_handler : _ev_handlers)
+            n += ev_handler.limiter.n_admitted();
+        return n;
+    }
+
+    template <typename Protocols, uint16_t PORT>
+    uint64_t server<Protocols, PORT>::n_rejected() {
+        uint64_t n = 0;
+        for(auto &ev_handler : _ev_handlers)
+            n += ev_handler.limiter.n_rejected();
+        return n;
+    }
+
+    template<typename Duration>
+    bool ev_handler_base::wait_writable(Duration timeout) {
+        if(n_throttled.load(std::memory_order_acquire) == 0)
+            return true;
+        std::unique_lock<std::mutex> lock(_writable_mutex);
+        ++_n_writable_waiters;
+        if(n_throttled.load(std::memory_order_acquire) != 0)
+            interruptible_wait_for(_writable, lock, timeout);
+        --_n_writable_waiters;
+        return n_throttled.load(std::memory_order_acquire) == 0;
     }
 
     template <typename Protocols, uint16_t PORT>
@@ -344,12 +742,14 @@ namespace tcp_kit {
     template<typename Protocols, uint16_t PORT>
     void server<Protocols, PORT>::accept_callback(evconnlistener *listener, int fd,
                                                   sockaddr *address, int socklen, void *arg) {
-        auto *server_ = static_cast<server<Protocols, PORT>*>(arg);
+        auto *acceptor_ = static_cast<acceptor*>(arg);
+        auto *server_ = static_cast<server<Protocols, PORT>*>(acceptor_->owner);
         ev_handler_t *ev_handler = server_->next();
         conn_info *c_info_ = &ev_handler->c_info;
         c_info_->fd = fd;
         c_info_->address = address;
         c_info_->socklen = socklen;
+        c_info_->filters = acceptor_->filters;
         event_active(ev_handler->accept_ev, 0, 0);
     }
 
@@ -393,8 +793,9 @@ namespace tcp_kit {
 #ifdef __APPLE__
     template <typename Protocols, uint16_t PORT>
     server<Protocols, PORT>::~server() {
-        if(_evc)
-            evconnlistener_free(_evc);
+        for(acceptor &a : _acceptors)
+            if(a.evc)
+                evconnlistener_free(a.evc);
         if(_ev_base)
             event_base_free(_ev_base);
     }
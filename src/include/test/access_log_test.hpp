@@ -0,0 +1,118 @@
+#ifndef TCP_KIT_ACCESS_LOG_TEST_H
+#define TCP_KIT_ACCESS_LOG_TEST_H
+
+#include <gtest/gtest.h>
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <logger/access_log.h>
+#include <network/server.h>
+#include <network/json.h>
+#include <network/client.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace access_log_test {
+
+        const uint16_t PORT = 3102;
+
+        void start_server() {
+            test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                svr.api("echo", [](std::string s) {
+                    return s;
+                });
+            });
+        }
+
+        std::string make_dir() {
+            char path[] = "/tmp/tcp_kit_access_log_XXXXXX";
+            return mkdtemp(path);
+        }
+
+        // 读取目录中所有段文件的记录, 并删除目录
+        std::vector<access_log::record> read_all(const std::string &dir, uint32_t &n_segments) {
+            std::vector<access_log::record> records;
+            n_segments = 0;
+            DIR *d = opendir(dir.c_str());
+            while(dirent *e = readdir(d)) {
+                std::string name = e->d_name;
+                if(name.size() < 4 || name.compare(name.size() - 4, 4, ".seg"))
+                    continue;
+                access_log::segment_header header;
+                EXPECT_TRUE(access_log::read_segment(dir + "/" + name, header, records));
+                ++n_segments;
+                unlink((dir + "/" + name).c_str());
+            }
+            closedir(d);
+            rmdir(dir.c_str());
+            return records;
+        }
+
+    }
+
+}
+
+// 测试1：写满一个段后换用新的段, 线程退出时关闭, 所有记录按写入顺序读出
+TEST(access_log_tests, rotate_and_read) {
+    std::string dir = access_log_test::make_dir();
+    // 每段只能容纳 10 条记录
+    access_log::enable(dir, sizeof(access_log::segment_header) + 10 * sizeof(access_log::record));
+    std::thread([] {
+        std::string api = "a_very_long_api_name_that_is_truncated";
+        for(uint64_t i = 0; i < 25; ++i)
+            access_log::log_request(std::chrono::steady_clock::now(), 7, &api, i, 1000 + i, 10, 20, 200);
+    }).join();
+    access_log::disable();
+    uint32_t n_segments;
+    std::vector<access_log::record> records = access_log_test::read_all(dir, n_segments);
+    EXPECT_EQ(n_segments, 3);
+    ASSERT_EQ(records.size(), 25);
+    std::sort(records.begin(), records.end(), [](const access_log::record &a, const access_log::record &b) {
+        return a.seq < b.seq;
+    });
+    for(uint64_t i = 0; i < 25; ++i) {
+        EXPECT_EQ(records[i].seq, i);
+        EXPECT_EQ(records[i].latency_ns, 1000 + i);
+        EXPECT_EQ(records[i].conn_id, 7);
+        EXPECT_EQ(records[i].code, 200);
+        EXPECT_EQ(std::string(records[i].api, strnlen(records[i].api, sizeof(records[i].api))),
+                  std::string("a_very_long_api_name_that_is_truncated").substr(0, sizeof(records[i].api)));
+    }
+}
+
+// 测试2：服务端每个回复写一条记录
+TEST(access_log_tests, server_requests) {
+    access_log_test::start_server();
+    client<json> cli("127.0.0.1:" + std::to_string(access_log_test::PORT), 1);
+    EXPECT_EQ(cli.call<std::string>("echo", "warm up").get(), "warm up");
+    std::string dir = access_log_test::make_dir();
+    access_log::enable(dir);
+    for(uint32_t i = 0; i < 5; ++i)
+        EXPECT_EQ(cli.call<std::string>("echo", "logged").get(), "logged");
+    EXPECT_THROW(cli.call<std::string>("no_such_api").get(), generic_error<CALL_FAILED>);
+    access_log::disable();
+    // ev_handler 在下一个时间轮刻度写出缓冲的记录并关闭段
+    std::this_thread::sleep_for(std::chrono::milliseconds(5 * TIMING_WHEEL_TICK_MS));
+    uint32_t n_segments;
+    std::vector<access_log::record> records = access_log_test::read_all(dir, n_segments);
+    uint32_t echoed = 0, not_found = 0;
+    for(const access_log::record &r: records) {
+        std::string api(r.api, strnlen(r.api, sizeof(r.api)));
+        if(api == "echo" && r.code == 200 && r.bytes_in > 0 && r.bytes_out > 0 && r.latency_ns > 0)
+            ++echoed;
+        if(api.empty() && r.code == 404)
+            ++not_found;
+    }
+    EXPECT_EQ(echoed, 5);
+    EXPECT_EQ(not_found, 1);
+}
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef TCP_KIT_BACKPRESSURE_TEST_H
+#define TCP_KIT_BACKPRESSURE_TEST_H
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <network/server.h>
+#include <network/json.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace backpressure_test {
+        const uint16_t PORT = 3115;
+        const size_t PAYLOAD = 16 * 1024;
+    }
+
+    // 只为本测试的 server 设置较小的上限: 每个连接 4 个处理中的请求, 3 条 PAYLOAD 大小的消息超过内存高水位, 回落到 1 条以下恢复
+    template<>
+    struct conn_limits<backpressure_test::PORT> {
+        static constexpr uint32_t max_in_flight        = 4;
+        static constexpr size_t   memory_high_water    = backpressure_test::PAYLOAD * 5 / 2;
+        static constexpr size_t   memory_low_water     = backpressure_test::PAYLOAD * 3 / 2;
+        static constexpr size_t   output_high_water    = OUTPUT_HIGH_WATER;
+        static constexpr size_t   output_low_water     = OUTPUT_LOW_WATER;
+        static constexpr int      slow_consumer_policy = SLOW_CONSUMER_POLICY;
+    };
+
+    namespace backpressure_test {
+
+        std::mutex mut;
+        std::deque<std::pair<uint32_t, completion<uint32_t>>> held;
+
+        server<json, PORT> *start_server() {
+            return test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                // 异步处理器不占用并发限制器, 令牌留在 held 中直到测试完成它, 请求在此期间一直处于处理中
+                svr.api("hold", [](completion<uint32_t> done, uint32_t i, std::string) {
+                    std::lock_guard<std::mutex> lock(mut);
+                    held.emplace_back(i, done);
+                });
+            });
+        }
+
+        size_t n_held() {
+            std::lock_guard<std::mutex> lock(mut);
+            return held.size();
+        }
+
+        // 等待处理中的请求数不再变化, 返回稳定后的值
+        size_t settle() {
+            size_t n = n_held();
+            for(int stable = 0; stable < 10; ) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                size_t m = n_held();
+                stable = m == n ? stable + 1 : 0;
+                n = m;
+            }
+            return n;
+        }
+
+        // 完成最早收到的请求, 以请求的序号回复, 返回该序号
+        uint32_t release_oldest() {
+            std::lock_guard<std::mutex> lock(mut);
+            uint32_t i = held.front().first;
+            held.front().second(i);
+            held.pop_front();
+            return i;
+        }
+
+        // 完成最早的请求, 检查它是第 expected 个请求且回复按顺序到达
+        void release_and_check(int fd, uint32_t expected) {
+            EXPECT_EQ(release_oldest(), expected);
+            std::string reply = test_util::read_line(fd);
+            EXPECT_NE(reply.find(std::to_string(expected)), std::string::npos) << reply;
+        }
+
+        std::string request(uint32_t i, size_t payload) {
+            return "{\"api\":\"hold\",\"params\":[{\"u32\":" + std::to_string(i) + "},{\"str\":\""
+                   + std::string(payload, 'x') + "\"}]}\r\n";
+        }
+
+    }
+
+}
+
+// 测试1：流水线发出超过上限的请求, 读取在处理中的请求达到 max_in_flight 时暂停, 每完成一个才读入一个, 所有回复按顺序到达
+TEST(backpressure_tests, in_flight_pauses_read) {
+    backpressure_test::start_server();
+    constexpr uint32_t limit = conn_limits<backpressure_test::PORT>::max_in_flight;
+    constexpr uint32_t total = limit * 3;
+    int fd = test_util::connect_to(backpressure_test::PORT);
+    ASSERT_GE(fd, 0);
+    std::string pipeline;
+    for(uint32_t i = 0; i < total; ++i)
+        pipeline += backpressure_test::request(1000 + i, 8);
+    ASSERT_TRUE(test_util::send_all(fd, pipeline));
+    EXPECT_EQ(backpressure_test::settle(), limit);
+    for(uint32_t i = 0; i < total; ++i) {
+        backpressure_test::release_and_check(fd, 1000 + i);
+        EXPECT_EQ(backpressure_test::settle(), std::min(limit, total - i - 1));
+    }
+    EXPECT_EQ(backpressure_test::n_held(), 0);
+    close(fd);
+}
+
+// 测试2：排队消息的内存超过高水位时在 max_in_flight 之前暂停读取, 回落到低水位以下才恢复, 所有回复按顺序到达
+TEST(backpressure_tests, memory_pauses_read) {
+    backpressure_test::start_server();
+    using limits = conn_limits<backpressure_test::PORT>;
+    constexpr uint32_t total = limits::max_in_flight * 2;
+    int fd = test_util::connect_to(backpressure_test::PORT);
+    ASSERT_GE(fd, 0);
+    std::string pipeline;
+    for(uint32_t i = 0; i < total; ++i)
+        pipeline += backpressure_test::request(2000 + i, backpressure_test::PAYLOAD);
+    ASSERT_TRUE(test_util::send_all(fd, pipeline));
+    // 第 3 条入队后超过高水位
+    ASSERT_EQ(backpressure_test::settle(), 3);
+    // 剩余 2 条仍在低水位之上, 不恢复
+    backpressure_test::release_and_check(fd, 2000);
+    EXPECT_EQ(backpressure_test::settle(), 2);
+    // 剩余 1 条时恢复, 再读入 2 条后又超过高水位
+    backpressure_test::release_and_check(fd, 2001);
+    EXPECT_EQ(backpressure_test::settle(), 3);
+    for(uint32_t i = 2; i < total; ++i) {
+        backpressure_test::release_and_check(fd, 2000 + i);
+        EXPECT_LE(backpressure_test::settle(), 3);
+    }
+    EXPECT_EQ(backpressure_test::n_held(), 0);
+    close(fd);
+}
+
+#endif
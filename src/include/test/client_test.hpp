@@ -0,0 +1,98 @@
+#ifndef TCP_KIT_CLIENT_TEST_H
+#define TCP_KIT_CLIENT_TEST_H
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <network/server.h>
+#include <network/generic.h>
+#include <network/json.h>
+#include <network/client.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace client_test {
+
+        const uint16_t PORT = 3100;
+
+        // 在后台线程中启动一个本地服务端, 进程退出前不停止. 使用 json 协议: 二进制的 protobuf 帧中可能出现换行符,
+        // 不适用于按行分帧
+        void start_server() {
+            test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                svr.api("add", [](int32_t a, int32_t b) {
+                    return a + b;
+                });
+                svr.api("echo", [](std::string s) {
+                    return s;
+                });
+                // 延迟 delay_ms 后回复, 用于制造乱序完成的回复
+                svr.api("delayed_echo", [](completion<std::string> done, std::string s, uint32_t delay_ms) {
+                    std::thread([done, s, delay_ms]() mutable {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+                        done(s);
+                    }).detach();
+                });
+            });
+        }
+
+        std::string address() {
+            return "127.0.0.1:" + std::to_string(PORT);
+        }
+
+    }
+
+}
+
+// 测试1：按类型打包参数与解包结果
+TEST(client_tests, typed_call) {
+    client_test::start_server();
+    client<json> cli(client_test::address());
+    EXPECT_EQ(cli.call<int32_t>("add", int32_t(20), int32_t(22)).get(), 42);
+    EXPECT_EQ(cli.call<std::string>("echo", "tcp_kit").get(), "tcp_kit");
+}
+
+// 测试2：同一连接上流水线的请求乱序完成时, 回复仍与请求对应
+TEST(client_tests, pipelined_out_of_order) {
+    client_test::start_server();
+    client<json> cli(client_test::address(), 1);
+    std::vector<std::future<std::string>> replies;
+    for(uint32_t i = 0; i < 20; ++i)
+        replies.push_back(cli.call<std::string>("delayed_echo", std::to_string(i), uint32_t((20 - i) * 5)));
+    for(uint32_t i = 0; i < 20; ++i)
+        EXPECT_EQ(replies[i].get(), std::to_string(i));
+    EXPECT_EQ(cli.n_pending(), 0);
+}
+
+// 测试3：批量调用与回调形式的调用
+TEST(client_tests, batch_and_callback) {
+    client_test::start_server();
+    client<json> cli(client_test::address());
+    auto b = cli.make_batch();
+    std::vector<std::future<int32_t>> sums;
+    for(int32_t i = 0; i < 20; ++i)
+        sums.push_back(b.call<int32_t>("add", i, i));
+    b.submit();
+    for(int32_t i = 0; i < 20; ++i)
+        EXPECT_EQ(sums[i].get(), i * 2);
+
+    std::promise<std::string> echoed;
+    cli.call_async<std::string>("echo", [&](std::exception_ptr err, std::string s) {
+        echoed.set_value(err ? "error" : s);
+    }, "callback");
+    EXPECT_EQ(echoed.get_future().get(), "callback");
+}
+
+// 测试4：服务端的错误回复与连接失败都以 CALL_FAILED 抛出
+TEST(client_tests, failures) {
+    client_test::start_server();
+    client<json> cli(client_test::address());
+    EXPECT_THROW(cli.call<int32_t>("no_such_api").get(), generic_error<CALL_FAILED>);
+    client<json> unreachable("127.0.0.1:1");
+    EXPECT_THROW(unreachable.call<int32_t>("add", int32_t(1), int32_t(2)).get(), generic_error<CALL_FAILED>);
+}
+
+#endif
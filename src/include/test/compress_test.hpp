@@ -0,0 +1,169 @@
+#ifndef TCP_KIT_COMPRESS_TEST_H
+#define TCP_KIT_COMPRESS_TEST_H
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <event2/buffer.h>
+#include <filter/compress.h>
+#include <error/errors.h>
+#include <network/server.h>
+#include <network/json.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace compress_test {
+
+        const uint16_t PORT = 3109;
+        const uint16_t COMPRESS_PORT = 3110;
+
+        void start_server() {
+            test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                auto compressed = svr.listen<json, COMPRESS_PORT, filters::compress_filter>();
+                compressed.api("echo", [](std::string s) {
+                    return s;
+                });
+            });
+        }
+
+        // 字段相同、值略有不同的 JSON 消息, 与 RPC 的请求/回复相似
+        std::string message(int i) {
+            std::string s = "[";
+            for(int j = 0; j < 16; ++j)
+                s += "{\"id\":" + std::to_string(i * 16 + j) + ",\"name\":\"user\",\"status\":\"active\"},";
+            s.back() = ']';
+            return s;
+        }
+
+        std::string drain(evbuffer *buf) {
+            std::string s(evbuffer_get_length(buf), '\0');
+            evbuffer_remove(buf, &s[0], s.size());
+            return s;
+        }
+
+        std::vector<uint8_t> codecs() {
+            std::vector<uint8_t> all{filters::CODEC_RAW};
+            if(filters::supported_codecs() & filters::CODEC_LZ4)
+                all.push_back(filters::CODEC_LZ4);
+            if(filters::supported_codecs() & filters::CODEC_ZSTD)
+                all.push_back(filters::CODEC_ZSTD);
+            return all;
+        }
+
+        // 以 session 编码并发送一次 echo 请求, 解码出回复. wire 累加从 socket 读到的字节数
+        std::string echo(int fd, filters::compress_session &session, const std::string &s, size_t &wire) {
+            evbuffer *plain = evbuffer_new();
+            evbuffer *encoded = evbuffer_new();
+            std::string frame = "{\"api\":\"echo\",\"params\":[{\"str\":\"" + s + "\"}]}\r\n";
+            evbuffer_add(plain, frame.data(), frame.size());
+            session.encode(plain, encoded);
+            std::string out = drain(encoded);
+            std::string reply;
+            if(write(fd, out.data(), out.size()) == ssize_t(out.size())) {
+                char buf[4096];
+                ssize_t n;
+                while(reply.find("\r\n") == std::string::npos && (n = read(fd, buf, sizeof(buf))) > 0) {
+                    wire += size_t(n);
+                    evbuffer_add(encoded, buf, size_t(n));
+                    session.decode(encoded, plain);
+                    reply += drain(plain);
+                }
+            }
+            evbuffer_free(plain);
+            evbuffer_free(encoded);
+            return reply;
+        }
+
+    }
+
+}
+
+// 测试1：每种编码的块逐字节送达时都能还原, 后面的块引用之前的数据而更小
+TEST(compress_tests, round_trip) {
+    for(uint8_t codec : compress_test::codecs()) {
+        filters::block_encoder encoder(codec);
+        filters::block_decoder decoder;
+        evbuffer *plain = evbuffer_new();
+        evbuffer *encoded = evbuffer_new();
+        evbuffer *decoded = evbuffer_new();
+        std::string sent, received;
+        std::vector<size_t> sizes;
+        for(int i = 0; i < 8; ++i) {
+            std::string msg = compress_test::message(i);
+            sent += msg;
+            evbuffer_add(plain, msg.data(), msg.size());
+            size_t before = evbuffer_get_length(encoded);
+            encoder.encode(plain, encoded);
+            sizes.push_back(evbuffer_get_length(encoded) - before);
+        }
+        // 小于 COMPRESS_MIN_SIZE 的数据以原始块发送
+        evbuffer_add(plain, "tail", 4);
+        encoder.encode(plain, encoded);
+        sent += "tail";
+        EXPECT_EQ(evbuffer_get_length(plain), 0);
+        std::string wire = compress_test::drain(encoded);
+        for(char c : wire) {
+            evbuffer_add(encoded, &c, 1);
+            decoder.decode(encoded, decoded);
+            received += compress_test::drain(decoded);
+        }
+        EXPECT_EQ(received, sent) << "codec " << int(codec);
+        if(codec != filters::CODEC_RAW) {
+            EXPECT_LT(sizes.back(), sizes.front()) << "codec " << int(codec);
+            EXPECT_LT(sizes.back() * 4, compress_test::message(7).size()) << "codec " << int(codec);
+        }
+        evbuffer_free(plain);
+        evbuffer_free(encoded);
+        evbuffer_free(decoded);
+    }
+}
+
+// 测试2：非法的块抛出 COMPRESS_FAILED, 不完整的块留在缓冲中等待
+TEST(compress_tests, invalid_block) {
+    filters::block_decoder decoder;
+    evbuffer *src = evbuffer_new();
+    evbuffer *dst = evbuffer_new();
+    const unsigned char partial[] = {filters::CODEC_RAW, 8, 0, 0, 'a', 'b'};
+    evbuffer_add(src, partial, sizeof(partial));
+    EXPECT_FALSE(decoder.decode(src, dst));
+    EXPECT_EQ(evbuffer_get_length(src), sizeof(partial));
+    evbuffer_drain(src, sizeof(partial));
+    const unsigned char garbage[] = {filters::CODEC_ZSTD, 4, 0, 0, 1, 2, 3, 4};
+    evbuffer_add(src, garbage, sizeof(garbage));
+    EXPECT_THROW(decoder.decode(src, dst), generic_error<COMPRESS_FAILED>);
+    evbuffer_drain(src, evbuffer_get_length(src));
+    const unsigned char huge[] = {filters::CODEC_RAW, 0xff, 0xff, 0xff};
+    evbuffer_add(src, huge, sizeof(huge));
+    EXPECT_THROW(decoder.decode(src, dst), generic_error<COMPRESS_FAILED>);
+    evbuffer_free(src);
+    evbuffer_free(dst);
+}
+
+// 测试3：第一个请求以原始块发出, 服务端收到握手字节后回复即被压缩, 之后双方都以协商的编码通信
+TEST(compress_tests, compressed_echo) {
+    compress_test::start_server();
+    int fd = test_util::connect_to(compress_test::COMPRESS_PORT);
+    ASSERT_GE(fd, 0);
+    filters::compress_session session;
+    std::string payload;
+    for(int i = 0; i < 20; ++i)
+        payload += "repeated-field-" + std::to_string(i % 4) + ";";
+    size_t wire = 0;
+    std::string reply = compress_test::echo(fd, session, payload, wire);
+    EXPECT_NE(reply.find(payload), std::string::npos);
+    EXPECT_EQ(session.codec(), filters::choose_codec(filters::supported_codecs()));
+    if(filters::supported_codecs())
+        EXPECT_LT(wire, reply.size());
+    wire = 0;
+    reply = compress_test::echo(fd, session, payload + "again", wire);
+    EXPECT_NE(reply.find(payload + "again"), std::string::npos);
+    if(filters::supported_codecs())
+        EXPECT_LT(wire, reply.size());
+    close(fd);
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef TCP_KIT_CONN_TABLE_TEST_H
+#define TCP_KIT_CONN_TABLE_TEST_H
+
+#include <gtest/gtest.h>
+#include <new>
+#include <network/conn_table.h>
+#include <network/ev_context.h>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace conn_table_test {
+
+        ev_context *make_ctx(conn_table &table) {
+            uint64_t conn_id;
+            void *slot = table.acquire(conn_id);
+            return new (slot) ev_context{{0, ev_context::ACTIVE, 0}, -1, nullptr, 0, conn_id};
+        }
+
+    }
+
+}
+
+// 测试1：conn_id 可以查找到对应的连接, 且记录了所属 ev_handler
+TEST(conn_table_tests, find_live) {
+    conn_table table;
+    table.init(3);
+    ev_context *a = conn_table_test::make_ctx(table);
+    ev_context *b = conn_table_test::make_ctx(table);
+    EXPECT_NE(a->conn_id, b->conn_id);
+    EXPECT_EQ(table.find(a->conn_id), a);
+    EXPECT_EQ(table.find(b->conn_id), b);
+    EXPECT_EQ(conn_table::ev_handler_of(a->conn_id), 3);
+    EXPECT_EQ(table.size(), 2);
+}
+
+// 测试2：槽位被复用后, 旧的 conn_id 查找不到新的连接
+TEST(conn_table_tests, stale_id) {
+    conn_table table;
+    ev_context *a = conn_table_test::make_ctx(table);
+    uint64_t stale = a->conn_id;
+    table.release(a);
+    EXPECT_EQ(table.find(stale), nullptr);
+    ev_context *b = conn_table_test::make_ctx(table);
+    EXPECT_EQ(static_cast<void *>(b), static_cast<void *>(a));
+    EXPECT_NE(b->conn_id, stale);
+    EXPECT_EQ(table.find(stale), nullptr);
+    EXPECT_EQ(table.find(b->conn_id), b);
+}
+
+#endif
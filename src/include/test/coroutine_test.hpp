@@ -0,0 +1,115 @@
+#ifndef TCP_KIT_COROUTINE_TEST_H
+#define TCP_KIT_COROUTINE_TEST_H
+
+#include <coroutine/task.h>
+
+#if TCP_KIT_COROUTINES
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <coroutine/awaitable.h>
+#include <thread/thread_pool.h>
+#include <network/server.h>
+#include <network/json.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace coroutine_test {
+
+        const uint16_t PORT = 3121;
+
+        // 与 server 一样存活到测试进程结束
+        thread_pool &workers() {
+            static thread_pool *pool = new thread_pool(2, 2, 0, std::make_unique<blocking_fifo<runnable>>(64));
+            return *pool;
+        }
+
+        task<uint32_t> step(uint32_t n) {
+            co_await sleep_for(std::chrono::milliseconds(10));
+            if(n == 0)
+                throw std::runtime_error("step from zero");
+            co_return n + 1;
+        }
+
+        server<json, PORT> *start_server() {
+            return test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                svr.api("nap", [](uint32_t delay_ms) -> task<uint32_t> {
+                    co_await sleep_for(std::chrono::milliseconds(delay_ms));
+                    co_return delay_ms;
+                });
+                // n 为 13 时在线程池中抛出异常
+                svr.api("square", [](uint32_t n) -> task<uint64_t> {
+                    co_return co_await offload(workers(), [n] {
+                        if(n == 13)
+                            throw std::runtime_error("unlucky square");
+                        return uint64_t(n) * n;
+                    });
+                });
+                // 依次 await 两个子协程, 子协程抛出的异常在 co_await 处被捕获
+                svr.api("twice", [](uint32_t n) -> task<uint32_t> {
+                    try {
+                        uint32_t once = co_await step(n);
+                        co_return co_await step(once);
+                    } catch (const std::runtime_error &) {
+                        co_return 404;
+                    }
+                });
+            });
+        }
+
+        std::string call(int fd, const std::string &api, uint32_t n) {
+            std::string req = "{\"api\":\"" + api + "\",\"params\":[{\"u32\":" + std::to_string(n) + "}]}\r\n";
+            return test_util::send_all(fd, req) ? test_util::read_line(fd) : "";
+        }
+
+    }
+
+}
+
+// 测试1：sleep_for 挂起请求而不占用 handler 线程, 同一连接上后发出的短请求先得到回复
+TEST(coroutine_tests, sleep_for) {
+    coroutine_test::start_server();
+    int fd = test_util::connect_to(coroutine_test::PORT);
+    ASSERT_GE(fd, 0);
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(test_util::send_all(fd, "{\"api\":\"nap\",\"params\":[{\"u32\":300}]}\r\n"
+                                        "{\"api\":\"nap\",\"params\":[{\"u32\":1}]}\r\n"));
+    EXPECT_NE(test_util::read_line(fd).find("\"u32\":1}"), std::string::npos);
+    EXPECT_NE(test_util::read_line(fd).find("\"u32\":300"), std::string::npos);
+    // 精度为时间轮的 tick
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(300 - TIMING_WHEEL_TICK_MS));
+    close(fd);
+}
+
+// 测试2：offload 以线程池中的返回值恢复, 线程池中抛出的异常在 co_await 处重新抛出, 以 ERROR 回复
+TEST(coroutine_tests, offload) {
+    coroutine_test::start_server();
+    int fd = test_util::connect_to(coroutine_test::PORT);
+    ASSERT_GE(fd, 0);
+    EXPECT_NE(coroutine_test::call(fd, "square", 12).find("144"), std::string::npos);
+    std::string failed = coroutine_test::call(fd, "square", 13);
+    EXPECT_NE(failed.find("\"ERROR\""), std::string::npos) << failed;
+    EXPECT_NE(failed.find("unlucky square"), std::string::npos) << failed;
+    EXPECT_NE(coroutine_test::call(fd, "square", 3).find("\"9\""), std::string::npos);
+    close(fd);
+}
+
+// 测试3：await 嵌套的 task, 子协程的返回值与异常都传递给 await 它的协程
+TEST(coroutine_tests, nested_task) {
+    coroutine_test::start_server();
+    int fd = test_util::connect_to(coroutine_test::PORT);
+    ASSERT_GE(fd, 0);
+    EXPECT_NE(coroutine_test::call(fd, "twice", 5).find("\"u32\":7"), std::string::npos);
+    EXPECT_NE(coroutine_test::call(fd, "twice", 0).find("\"u32\":404"), std::string::npos);
+    close(fd);
+}
+
+#endif
+
+#endif
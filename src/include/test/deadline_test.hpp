@@ -0,0 +1,95 @@
+#ifndef TCP_KIT_DEADLINE_TEST_H
+#define TCP_KIT_DEADLINE_TEST_H
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <network/server.h>
+#include <network/json.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace deadline_test {
+
+        const uint16_t PORT = 3118;
+
+        std::atomic<uint32_t> n_probed{0};
+
+        server<json, PORT> *start_server() {
+            return test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                // 同一连接的请求由同一个 handler 依次处理, block 之后的请求在队列中等待
+                svr.api("block", [](uint32_t delay_ms) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+                    return delay_ms;
+                });
+                svr.api("probe", [](std::string s) {
+                    ++n_probed;
+                    return s;
+                });
+                // 空的参数列表不会被解析, 多带一个字符串参数才能拿到 msg_context
+                svr.api("remaining", [](msg_context *ctx, std::string) {
+                    return int64_t(ctx->remaining().count());
+                });
+            });
+        }
+
+        std::string request(const std::string &api, const std::string &param, int64_t timeout_ms = -1) {
+            std::string req = "{\"api\":\"" + api + "\",\"params\":[" + param + "]";
+            if(timeout_ms >= 0)
+                req += ",\"timeout_ms\":" + std::to_string(timeout_ms);
+            return req + "}\r\n";
+        }
+
+        // 回复中 int64 编码为字符串: "s64":"<value>", 没有该字段时返回 -1
+        int64_t s64_of(const std::string &reply) {
+            size_t begin = reply.find("\"s64\":\"");
+            return begin == std::string::npos ? -1 : std::stoll(reply.substr(begin + 7));
+        }
+
+    }
+
+}
+
+// 测试1：在队列中等待超过 timeout_ms 的请求以 TIMEOUT 回复而不调用 api, 之前与之后的请求照常处理
+TEST(deadline_tests, expired_in_queue) {
+    deadline_test::start_server();
+    int fd = test_util::connect_to(deadline_test::PORT);
+    ASSERT_GE(fd, 0);
+    uint32_t probed = deadline_test::n_probed;
+    std::string pipeline = deadline_test::request("block", "{\"u32\":200}")
+                         + deadline_test::request("probe", "{\"str\":\"late\"}", 20)
+                         + deadline_test::request("probe", "{\"str\":\"patient\"}", 5000);
+    ASSERT_TRUE(test_util::send_all(fd, pipeline));
+    EXPECT_NE(test_util::read_line(fd).find("200"), std::string::npos);
+    std::string late = test_util::read_line(fd);
+    EXPECT_NE(late.find("\"TIMEOUT\""), std::string::npos) << late;
+    EXPECT_EQ(late.find("late"), std::string::npos);
+    EXPECT_NE(test_util::read_line(fd).find("patient"), std::string::npos);
+    EXPECT_EQ(deadline_test::n_probed, probed + 1);
+    close(fd);
+}
+
+// 测试2：api 中 remaining() 返回扣除排队时间后的剩余时限, 没有时限时返回 milliseconds::max()
+TEST(deadline_tests, remaining_in_handler) {
+    deadline_test::start_server();
+    int fd = test_util::connect_to(deadline_test::PORT);
+    ASSERT_GE(fd, 0);
+    std::string pipeline = deadline_test::request("block", "{\"u32\":100}")
+                         + deadline_test::request("remaining", "{\"str\":\"\"}", 1000)
+                         + deadline_test::request("remaining", "{\"str\":\"\"}");
+    ASSERT_TRUE(test_util::send_all(fd, pipeline));
+    EXPECT_NE(test_util::read_line(fd).find("100"), std::string::npos);
+    int64_t remaining = deadline_test::s64_of(test_util::read_line(fd));
+    EXPECT_GT(remaining, 0);
+    EXPECT_LE(remaining, 900);
+    EXPECT_EQ(deadline_test::s64_of(test_util::read_line(fd)), std::chrono::milliseconds::max().count());
+    close(fd);
+}
+
+#endif
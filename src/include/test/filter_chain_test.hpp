@@ -0,0 +1,109 @@
+#ifndef TCP_KIT_FILTER_CHAIN_TEST_H
+#define TCP_KIT_FILTER_CHAIN_TEST_H
+
+#include <gtest/gtest.h>
+#include <event2/event.h>
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <string>
+#include <vector>
+#include <network/filter_chain.h>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace filter_chain_test {
+
+        // 将 src 中的全部字节经 f 变换后写入 dst
+        template<typename F>
+        bufferevent_filter_result transform(evbuffer *src, evbuffer *dst, F f) {
+            std::vector<unsigned char> bytes(evbuffer_get_length(src));
+            evbuffer_remove(src, bytes.data(), bytes.size());
+            for(unsigned char &c: bytes)
+                c = f(c);
+            evbuffer_add(dst, bytes.data(), bytes.size());
+            return BEV_OK;
+        }
+
+        struct plus_one {
+            static bufferevent_filter_result read(evbuffer *src, evbuffer *dst, ev_ssize_t, bufferevent_flush_mode, ev_context*) {
+                return transform(src, dst, [](unsigned char c) { return (unsigned char) (c + 1); });
+            }
+            static bufferevent_filter_result write(evbuffer *src, evbuffer *dst, ev_ssize_t, bufferevent_flush_mode, ev_context*) {
+                return transform(src, dst, [](unsigned char c) { return (unsigned char) (c + 1); });
+            }
+        };
+
+        struct times_two {
+            static bufferevent_filter_result read(evbuffer *src, evbuffer *dst, ev_ssize_t, bufferevent_flush_mode, ev_context*) {
+                return transform(src, dst, [](unsigned char c) { return (unsigned char) (c * 2); });
+            }
+            static bufferevent_filter_result write(evbuffer *src, evbuffer *dst, ev_ssize_t, bufferevent_flush_mode, ev_context*) {
+                return transform(src, dst, [](unsigned char c) { return (unsigned char) (c * 2); });
+            }
+        };
+
+        // 只有 Write Filter, 将数据原样移动
+        struct write_only {
+            static bufferevent_filter_result write(evbuffer *src, evbuffer *dst, ev_ssize_t, bufferevent_flush_mode, ev_context*) {
+                evbuffer_add_buffer(dst, src);
+                return BEV_OK;
+            }
+        };
+
+        std::string drain(evbuffer *buf) {
+            std::string s(evbuffer_get_length(buf), '\0');
+            evbuffer_remove(buf, &s[0], s.size());
+            return s;
+        }
+
+    }
+
+}
+
+// 测试1：Write Filter 被放入 writes, 而不是 reads
+TEST(filter_chain_tests, write_filters) {
+    std::shared_ptr<filter_chain> chain = make_filter_chain(type_list<filter_chain_test::write_only, filter_chain_test::plus_one>{});
+    EXPECT_EQ(chain->reads.size(), 1);
+    EXPECT_EQ(chain->writes.size(), 2);
+}
+
+// 测试2：单层管道中, 读取时按注册顺序执行过滤器, 写出时按相反的顺序执行
+TEST(filter_chain_tests, pipeline_order) {
+    event_base *base = event_base_new();
+    bufferevent *pair[2];
+    ASSERT_EQ(bufferevent_pair_new(base, BEV_OPT_CLOSE_ON_FREE, pair), 0);
+    std::shared_ptr<filter_chain> chain = make_filter_chain(type_list<filter_chain_test::plus_one, filter_chain_test::times_two>{});
+    bufferevent *bev = rw_pipeline::attach(pair[0], chain->reads, chain->writes, nullptr);
+    ASSERT_NE(bev, nullptr);
+    ASSERT_NE(bev, pair[0]);
+    bufferevent_enable(bev, EV_READ | EV_WRITE);
+    bufferevent_enable(pair[1], EV_READ | EV_WRITE);
+
+    bufferevent_write(pair[1], "\x01\x02", 2);
+    bufferevent_write(bev, "\x01\x02", 2);
+    for(int i = 0; i < 10; ++i)
+        event_base_loop(base, EVLOOP_NONBLOCK);
+    // 读取: (x + 1) * 2, 写出: x * 2 + 1
+    EXPECT_EQ(filter_chain_test::drain(bufferevent_get_input(bev)), std::string("\x04\x06", 2));
+    EXPECT_EQ(filter_chain_test::drain(bufferevent_get_input(pair[1])), std::string("\x03\x05", 2));
+
+    bufferevent_free(bev);
+    bufferevent_free(pair[1]);
+    event_base_free(base);
+}
+
+// 测试3：没有读写过滤器时不增加 bufferevent 层
+TEST(filter_chain_tests, no_filters) {
+    event_base *base = event_base_new();
+    bufferevent *pair[2];
+    ASSERT_EQ(bufferevent_pair_new(base, BEV_OPT_CLOSE_ON_FREE, pair), 0);
+    std::vector<bufferevent_filter_cb> none;
+    EXPECT_EQ(rw_pipeline::attach(pair[0], none, none, nullptr), pair[0]);
+    bufferevent_free(pair[0]);
+    bufferevent_free(pair[1]);
+    event_base_free(base);
+}
+
+#endif
@@ -11,7 +11,7 @@ namespace tcp_kit {
             auto seq = make_index_seq<std::tuple<int, double, bool, std::string>>();
             using t = decltype(seq);
             static_assert(std::is_same<index_seq<0, 1, 2, 3>, t>::value);
-            log_info(typeid(t).name());
+            log_info("%s", typeid(t).name());
         }
 
     }
@@ -0,0 +1,164 @@
+#ifndef TCP_KIT_LIMITER_TEST_H
+#define TCP_KIT_LIMITER_TEST_H
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+#include <network/concurrency_limiter.h>
+#include <network/server.h>
+#include <network/json.h>
+#include <network/client.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace limiter_test {
+
+        const uint16_t PORT = 3113;
+
+        std::atomic<uint32_t> n_single{0};
+        std::atomic<uint32_t> peak_single{0};
+
+        server<json, PORT> *start_server() {
+            return test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                // 处理器立即把令牌交给其他线程, 回复在 delay_ms 之后给出
+                svr.api("slow_echo", [](completion<std::string> done, std::string msg, uint32_t delay_ms) {
+                    std::thread([done, msg, delay_ms]() mutable {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+                        done(msg);
+                    }).detach();
+                });
+                // 同时只允许一个请求, 记录观察到的最大并发数
+                svr.api("single", [](uint32_t delay_ms) {
+                    uint32_t n = ++n_single;
+                    uint32_t peak = peak_single;
+                    while(n > peak && !peak_single.compare_exchange_weak(peak, n));
+                    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+                    --n_single;
+                    return delay_ms;
+                }, api_options{concurrency_limiter::CRITICAL, 1});
+            }, uint16_t(1), uint16_t(4));
+        }
+
+        const std::chrono::milliseconds FAST(1);
+        const std::chrono::milliseconds SLOW(LIMITER_LATENCY_TARGET_MS * 2);
+
+    }
+
+}
+
+#if LIMITER_INITIAL_LIMIT
+// 测试1：占用达到并发上限时拒绝, 归还后可以再次获得
+TEST(limiter_tests, rejection) {
+    concurrency_limiter limiter;
+    for(uint32_t i = 0; i < LIMITER_INITIAL_LIMIT; ++i)
+        ASSERT_TRUE(limiter.try_acquire());
+    EXPECT_FALSE(limiter.try_acquire());
+    EXPECT_EQ(limiter.n_rejected(), 1);
+    EXPECT_EQ(limiter.in_flight(), LIMITER_INITIAL_LIMIT);
+    limiter.release(limiter_test::FAST, false);
+    EXPECT_TRUE(limiter.try_acquire());
+    EXPECT_EQ(limiter.n_admitted(), LIMITER_INITIAL_LIMIT + 1);
+}
+
+// 测试2：占用超过一半且时延未超过目标时并发上限加性增大, 不超过 LIMITER_MAX_LIMIT
+TEST(limiter_tests, increase) {
+    concurrency_limiter limiter;
+    for(uint32_t i = 0; i < LIMITER_INITIAL_LIMIT; ++i)
+        limiter.try_acquire();
+    for(int i = 0; i < LIMITER_INITIAL_LIMIT * 4; ++i) {
+        limiter.release(limiter_test::FAST, true);
+        limiter.try_acquire();
+    }
+    EXPECT_GT(limiter.limit(), LIMITER_INITIAL_LIMIT);
+    EXPECT_LE(limiter.limit(), LIMITER_MAX_LIMIT);
+    // 占用不足一半时不增大
+    uint32_t limit = limiter.limit();
+    while(limiter.in_flight() > 1)
+        limiter.release(limiter_test::FAST, false);
+    limiter.release(limiter_test::FAST, true);
+    EXPECT_EQ(limiter.limit(), limit);
+}
+
+// 测试3：时延超过目标时并发上限乘性减小, 不低于 LIMITER_MIN_LIMIT; 不采样的归还不影响上限
+TEST(limiter_tests, backoff) {
+    concurrency_limiter limiter;
+    limiter.try_acquire();
+    limiter.release(limiter_test::SLOW, false);
+    EXPECT_EQ(limiter.limit(), LIMITER_INITIAL_LIMIT);
+    limiter.try_acquire();
+    limiter.release(limiter_test::SLOW, true);
+    EXPECT_EQ(limiter.limit(), uint32_t(LIMITER_INITIAL_LIMIT * LIMITER_BACKOFF));
+    for(int i = 0; i < 100; ++i) {
+        limiter.try_acquire();
+        limiter.release(limiter_test::SLOW, true);
+    }
+    EXPECT_EQ(limiter.limit(), LIMITER_MIN_LIMIT);
+}
+
+// 测试4：因优先级被拒绝的请求从接受数改记为拒绝数, 拒绝率不因此偏低
+TEST(limiter_tests, priority_rejection_counted_once) {
+    concurrency_limiter limiter;
+    for(uint32_t i = 0; i < LIMITER_INITIAL_LIMIT; ++i)
+        ASSERT_TRUE(limiter.try_acquire());
+    EXPECT_FALSE(limiter.admit(concurrency_limiter::SHEDDABLE));
+    EXPECT_TRUE(limiter.admit(concurrency_limiter::CRITICAL));
+    EXPECT_EQ(limiter.n_admitted(), LIMITER_INITIAL_LIMIT - 1);
+    EXPECT_EQ(limiter.n_rejected(), 1);
+}
+
+// 测试5：异步 api 等待完成的时间不计入时延, 也不占用额度, 并发的慢请求多于并发上限时不被拒绝
+TEST(limiter_tests, async_requests_not_limited) {
+    server<json, limiter_test::PORT> *svr = limiter_test::start_server();
+    uint32_t limit = svr->concurrency_limit();
+    uint64_t rejected = svr->n_rejected();
+    client<json> cli("127.0.0.1:" + std::to_string(limiter_test::PORT), 1);
+    // 每批少于并发上限的一半, 同一时刻等待回复的请求是并发上限的数倍
+    std::vector<std::future<std::string>> replies;
+    for(int wave = 0; wave < 6; ++wave) {
+        for(int i = 0; i < LIMITER_INITIAL_LIMIT / 2; ++i)
+            replies.push_back(cli.call<std::string>("slow_echo", std::to_string(replies.size()),
+                                                    uint32_t(limiter_test::SLOW.count())));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    for(size_t i = 0; i < replies.size(); ++i)
+        EXPECT_EQ(replies[i].get(), std::to_string(i));
+    EXPECT_EQ(svr->n_rejected(), rejected);
+    EXPECT_GE(svr->concurrency_limit(), limit);
+}
+#endif
+
+// 测试6：多个 handler 同时收到 max_in_flight 为 1 的 api 的请求时, 同时处理的不超过 1 个, 其余以 OVERLOADED 回复
+TEST(limiter_tests, api_max_in_flight) {
+    limiter_test::start_server();
+    const int n = 8;
+    std::atomic<int> n_ok{0}, n_overloaded{0};
+    std::vector<std::thread> callers;
+    for(int i = 0; i < n; ++i) {
+        callers.emplace_back([&n_ok, &n_overloaded] {
+            int fd = test_util::connect_to(limiter_test::PORT);
+            test_util::send_all(fd, "{\"api\":\"single\",\"params\":[{\"u32\":100}]}\r\n");
+            std::string reply = test_util::read_line(fd);
+            if(reply.find("OVERLOADED") != std::string::npos)
+                ++n_overloaded;
+            else if(reply.find("100") != std::string::npos)
+                ++n_ok;
+            close(fd);
+        });
+    }
+    for(std::thread &t : callers)
+        t.join();
+    EXPECT_EQ(limiter_test::peak_single, 1);
+    EXPECT_GE(n_ok, 1);
+    EXPECT_GE(n_overloaded, 1);
+    EXPECT_EQ(n_ok + n_overloaded, n);
+}
+
+#endif
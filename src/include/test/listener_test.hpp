@@ -0,0 +1,80 @@
+#ifndef TCP_KIT_LISTENER_TEST_H
+#define TCP_KIT_LISTENER_TEST_H
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <stdexcept>
+#include <network/server.h>
+#include <network/json.h>
+#include <network/client.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace listener_test {
+
+        const uint16_t PORT = 3105;
+        const uint16_t SECOND_PORT = 3106;
+
+        std::atomic<uint32_t> n_connected{0};
+        std::atomic<bool>     duplicate_rejected{false};
+
+        // 只加在第二个监听端口上的过滤器, 统计该端口接收的连接
+        struct count_connect {
+            static void connect(ev_context *ctx) {
+                ++n_connected;
+            }
+        };
+
+        void start_server() {
+            test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                svr.api("echo", [](std::string s) {
+                    return "first:" + s;
+                });
+                auto second = svr.listen<json, SECOND_PORT, count_connect>();
+                second.api("echo", [](std::string s) {
+                    return "second:" + s;
+                });
+                try {
+                    svr.listen<json, SECOND_PORT>();
+                } catch (const std::invalid_argument &) {
+                    duplicate_rejected = true;
+                }
+            });
+        }
+
+        std::string address(uint16_t port) {
+            return "127.0.0.1:" + std::to_string(port);
+        }
+
+    }
+
+}
+
+// 测试1：一个 server 上的两个监听端口各自使用自己的 api 表与过滤器链
+TEST(listener_tests, separate_chains) {
+    listener_test::start_server();
+    EXPECT_TRUE(listener_test::duplicate_rejected);
+    uint32_t connected = listener_test::n_connected;
+    {
+        client<json> first(listener_test::address(listener_test::PORT), 1);
+        EXPECT_EQ(first.call<std::string>("echo", "x").get(), "first:x");
+    }
+    EXPECT_EQ(listener_test::n_connected, connected);
+    client<json> second(listener_test::address(listener_test::SECOND_PORT), 1);
+    EXPECT_EQ(second.call<std::string>("echo", "y").get(), "second:y");
+    EXPECT_EQ(listener_test::n_connected, connected + 1);
+}
+
+// 测试2：每个监听端口都注册了内置的 api
+TEST(listener_tests, builtin_apis) {
+    listener_test::start_server();
+    client<json> second(listener_test::address(listener_test::SECOND_PORT), 1);
+    EXPECT_EQ(second.call<std::string>(METRICS_API).get().front(), '{');
+}
+
+#endif
@@ -2,8 +2,45 @@
 #define TCP_KIT_LOGGER_TEST_H
 
 #include <gtest/gtest.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <vector>
 #include "include/logger/logger.h"
 
+namespace tcp_kit {
+
+    namespace logger_test {
+
+        // 将 stdout 重定向到临时文件, 执行 f 并写出日志后恢复, 返回 f 期间输出的行中包含 marker 的行数
+        template<typename F>
+        uint32_t count_output(const std::string &marker, F f) {
+            log_flush();
+            char path[] = "/tmp/tcp_kit_logger_XXXXXX";
+            int fd = mkstemp(path);
+            int saved = dup(STDOUT_FILENO);
+            dup2(fd, STDOUT_FILENO);
+            f();
+            log_flush();
+            dup2(saved, STDOUT_FILENO);
+            close(saved);
+            close(fd);
+            std::ifstream in(path);
+            uint32_t n = 0;
+            for(std::string line; std::getline(in, line); )
+                n += line.find(marker) != std::string::npos;
+            unlink(path);
+            return n;
+        }
+
+    }
+
+}
+
 TEST(logger_tests, level_print) {
     log_debug("Hello %s", "world");
     log_info("Hello %s", "world");
@@ -12,4 +49,69 @@ TEST(logger_tests, level_print) {
     log_fatal("Hello %s", "world");
 }
 
-#endif
\ No newline at end of file
+// 多个线程写入的日志在 log_flush 之后全部写出. 直接调用 log 以绕过调用点的限流
+TEST(logger_tests, async_flush) {
+    uint32_t n = tcp_kit::logger_test::count_output("async_flush_marker", [] {
+        std::vector<std::thread> threads;
+        for(int t = 0; t < 4; ++t) {
+            threads.emplace_back([t] {
+                for(int i = 0; i < 100; ++i)
+                    log(LOG_INFO, __FILE__, __LINE__, "async_flush_marker %d %d", t, i);
+            });
+        }
+        for(std::thread &t: threads)
+            t.join();
+    });
+    EXPECT_EQ(n, 400);
+}
+
+// 缓冲区写满时丢弃而不阻塞, 写出的与丢弃的之和等于写入的
+TEST(logger_tests, drop_when_full) {
+    uint64_t dropped = log_dropped();
+    std::string padding(LOG_LINE_MAX / 2, 'x');
+    uint32_t n = tcp_kit::logger_test::count_output("drop_marker", [&padding] {
+        std::thread([&padding] {
+            for(int i = 0; i < 2000; ++i)
+                log(LOG_INFO, __FILE__, __LINE__, "drop_marker %s", padding.c_str());
+        }).join();
+    });
+    EXPECT_EQ(n + (log_dropped() - dropped), 2000);
+}
+
+// 参数被拷贝后在后台线程中格式化, 调用后修改参数不影响输出
+TEST(logger_tests, deferred_format) {
+    uint32_t n = tcp_kit::logger_test::count_output("deferred_marker str 42 1.5 x (null)", [] {
+        std::string s("str");
+        char buf[8] = "marker";
+        log_info("deferred_%s %s %d %.1f %c %s", buf, s, 42, 1.5, 'x', (const char*) nullptr);
+        s = "changed";
+        buf[0] = 'X';
+    });
+    EXPECT_EQ(n, 1);
+}
+
+// 低于 LOG_LEVEL 的日志不求值参数
+TEST(logger_tests, compiled_out) {
+    int evaluated = 0;
+    TCP_KIT_LOG(LOG_DEBUG - 1, "%d", ++evaluated);
+    EXPECT_EQ(evaluated, 0);
+}
+
+// 同一调用点在一个窗口内至多写出 LOG_RATE_LIMIT 条, 之后写出的一条注明被抑制的条数
+TEST(logger_tests, rate_limit) {
+    auto storm = [] {
+        log_warn("rate_limit_marker");
+    };
+    uint32_t n = tcp_kit::logger_test::count_output("rate_limit_marker", [&storm] {
+        for(int i = 0; i < 10 * LOG_RATE_LIMIT; ++i)
+            storm();
+    });
+    // 可能跨过一个窗口的边界
+    EXPECT_GE(n, 1);
+    EXPECT_LE(n, 2 * LOG_RATE_LIMIT);
+    std::this_thread::sleep_for(std::chrono::milliseconds(LOG_RATE_WINDOW_MS + 20));
+    uint32_t suppressed = tcp_kit::logger_test::count_output("similar record(s) suppressed", storm);
+    EXPECT_EQ(suppressed, 1);
+}
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef TCP_KIT_MAILBOX_TEST_H
+#define TCP_KIT_MAILBOX_TEST_H
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <network/server.h>
+#include <network/json.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace mailbox_test {
+
+        const uint16_t PORT = 3120;
+
+        // 两个 ev_handler, 广播需要经由两个邮箱投递
+        server<json, PORT> *start_server() {
+            return test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                server<json, PORT> *s = &svr;
+                // 加入/离开组并返回连接的 conn_id
+                svr.api("join", [s](msg_context *ctx, uint32_t group) {
+                    s->join(ctx->conn_id, group);
+                    return ctx->conn_id;
+                });
+                svr.api("leave", [s](msg_context *ctx, uint32_t group) {
+                    s->leave(ctx->conn_id, group);
+                    return ctx->conn_id;
+                });
+            }, uint16_t(2), uint16_t(1));
+        }
+
+        // 调用 join/leave 并返回 conn_id, 失败时返回 0. 与之后的投递经由同一个邮箱按顺序处理, 读到回复后投递的数据一定能看到组的变化
+        uint64_t call(int fd, const std::string &api, uint32_t group) {
+            std::string req = "{\"api\":\"" + api + "\",\"params\":[{\"u32\":" + std::to_string(group) + "}]}\r\n";
+            if(!test_util::send_all(fd, req))
+                return 0;
+            std::string reply = test_util::read_line(fd);
+            // uint64 在 json 中编码为字符串: "u64":"<id>"
+            size_t begin = reply.find("\"u64\":\"");
+            return begin == std::string::npos ? 0 : std::stoull(reply.substr(begin + 7));
+        }
+
+    }
+
+}
+
+// 测试1：向存活的连接发送数据, conn_id 不属于该 server 时返回 false
+TEST(mailbox_tests, send_to_live) {
+    server<json, mailbox_test::PORT> *svr = mailbox_test::start_server();
+    int fd = test_util::connect_to(mailbox_test::PORT);
+    ASSERT_GE(fd, 0);
+    uint64_t id = mailbox_test::call(fd, "join", 1);
+    ASSERT_NE(id, 0);
+    EXPECT_NE(svr->find(id), nullptr);
+    EXPECT_TRUE(svr->send(id, std::string("direct\r\n")));
+    EXPECT_EQ(test_util::read_line(fd), "direct\r\n");
+    EXPECT_FALSE(svr->send(uint64_t(1000) << CONN_SLOT_BITS, std::string("nowhere\r\n")));
+    close(fd);
+}
+
+// 测试2：连接断开后它的 conn_id 失效, 发往它的数据被丢弃, 即使槽位已被新的连接复用
+TEST(mailbox_tests, send_to_stale) {
+    server<json, mailbox_test::PORT> *svr = mailbox_test::start_server();
+    int gone = test_util::connect_to(mailbox_test::PORT);
+    ASSERT_GE(gone, 0);
+    uint64_t stale = mailbox_test::call(gone, "join", 1);
+    ASSERT_NE(stale, 0);
+    close(gone);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while(svr->find(stale) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ASSERT_EQ(svr->find(stale), nullptr);
+    // 新的连接可能复用同一个槽位, 不应收到发往旧 conn_id 的数据
+    int fresh = test_util::connect_to(mailbox_test::PORT);
+    ASSERT_GE(fresh, 0);
+    uint64_t id = mailbox_test::call(fresh, "join", 1);
+    ASSERT_NE(id, 0);
+    EXPECT_NE(id, stale);
+    EXPECT_TRUE(svr->send(stale, std::string("stale\r\n")));
+    EXPECT_TRUE(svr->send(id, std::string("fresh\r\n")));
+    EXPECT_EQ(test_util::read_line(fresh), "fresh\r\n");
+    close(fresh);
+}
+
+// 测试3：广播只投递给组中的连接, 离开后不再收到; ALL_CONNS 投递给所有连接
+TEST(mailbox_tests, broadcast_to_group) {
+    server<json, mailbox_test::PORT> *svr = mailbox_test::start_server();
+    const uint32_t group = 7;
+    int a = test_util::connect_to(mailbox_test::PORT);
+    int b = test_util::connect_to(mailbox_test::PORT);
+    int outsider = test_util::connect_to(mailbox_test::PORT);
+    ASSERT_GE(a, 0);
+    ASSERT_GE(b, 0);
+    ASSERT_GE(outsider, 0);
+    ASSERT_NE(mailbox_test::call(a, "join", group), 0);
+    ASSERT_NE(mailbox_test::call(b, "join", group), 0);
+    ASSERT_NE(mailbox_test::call(outsider, "join", group + 1), 0);
+    svr->broadcast(group, std::string("first\r\n"));
+    EXPECT_EQ(test_util::read_line(a), "first\r\n");
+    EXPECT_EQ(test_util::read_line(b), "first\r\n");
+    ASSERT_NE(mailbox_test::call(b, "leave", group), 0);
+    svr->broadcast(group, std::string("second\r\n"));
+    svr->broadcast(ALL_CONNS, std::string("everyone\r\n"));
+    EXPECT_EQ(test_util::read_line(a), "second\r\n");
+    EXPECT_EQ(test_util::read_line(a), "everyone\r\n");
+    EXPECT_EQ(test_util::read_line(b), "everyone\r\n");
+    EXPECT_EQ(test_util::read_line(outsider), "everyone\r\n");
+    EXPECT_FALSE(svr->join(0, ALL_CONNS));
+    close(a);
+    close(b);
+    close(outsider);
+}
+
+#endif
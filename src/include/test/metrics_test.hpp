@@ -0,0 +1,85 @@
+#ifndef TCP_KIT_METRICS_TEST_H
+#define TCP_KIT_METRICS_TEST_H
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <string>
+#include <metrics/metrics.h>
+#include <network/server.h>
+#include <network/json.h>
+#include <network/client.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace metrics_test {
+
+        const uint16_t PORT = 3101;
+
+        void start_server() {
+            test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                svr.api("echo", [](std::string s) {
+                    return s;
+                });
+            });
+        }
+
+        // 从 __metrics 的结果中取出 "name":<数字>
+        uint64_t field(const std::string &json, const std::string &name) {
+            size_t pos = json.find("\"" + name + "\":");
+            if(pos == std::string::npos)
+                return UINT64_MAX;
+            return std::stoull(json.substr(pos + name.size() + 3));
+        }
+
+    }
+
+}
+
+// 测试1：多个线程各自的分片在汇总时合并
+TEST(metrics_tests, shards_aggregate) {
+    std::unique_ptr<metrics::snapshot> before(new metrics::snapshot), after(new metrics::snapshot);
+    metrics::collect(*before);
+    std::vector<std::thread> threads;
+    for(uint64_t t = 1; t <= 4; ++t) {
+        threads.emplace_back([t] {
+            for(uint32_t i = 0; i < 1000; ++i) {
+                metrics::count(metrics::BYTES_OUT, t);
+                metrics::record(metrics::SERIALIZE_NS, t * 1000);
+            }
+        });
+    }
+    for(std::thread &t: threads)
+        t.join();
+    metrics::collect(*after);
+    EXPECT_EQ(after->counters[metrics::BYTES_OUT] - before->counters[metrics::BYTES_OUT], 10000);
+    // 其他测试的服务端也会记录, 只比较增量
+    const metrics::shard_histogram_t &h0 = before->histograms[metrics::SERIALIZE_NS];
+    const metrics::shard_histogram_t &h1 = after->histograms[metrics::SERIALIZE_NS];
+    EXPECT_EQ(h1.count() - h0.count(), 4000);
+    EXPECT_EQ(h1.sum() - h0.sum(), 10000000);
+    EXPECT_GE(h1.max(), 4000);
+}
+
+// 测试2：通过内置的 __metrics api 读取请求通路上的计数
+TEST(metrics_tests, metrics_api) {
+    metrics_test::start_server();
+    client<json> cli("127.0.0.1:" + std::to_string(metrics_test::PORT), 1);
+    std::string before = cli.call<std::string>(METRICS_API).get();
+    for(uint32_t i = 0; i < 10; ++i)
+        EXPECT_EQ(cli.call<std::string>("echo", "metrics").get(), "metrics");
+    std::string after = cli.call<std::string>(METRICS_API).get();
+    // 读取 before 的那次调用在 before 生成之后才完成
+    EXPECT_GE(metrics_test::field(after, "api_calls") - metrics_test::field(before, "api_calls"), 11);
+    EXPECT_GE(metrics_test::field(after, "frames_in") - metrics_test::field(before, "frames_in"), 11);
+    EXPECT_GE(metrics_test::field(after, "connections"), 1);
+    EXPECT_EQ(metrics_test::field(after, "throttled"), 0);
+    EXPECT_NE(after.find("\"request_ns\":{\"count\":"), std::string::npos);
+}
+
+#endif
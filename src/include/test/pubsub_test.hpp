@@ -0,0 +1,150 @@
+#ifndef TCP_KIT_PUBSUB_TEST_H
+#define TCP_KIT_PUBSUB_TEST_H
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <network/server.h>
+#include <network/json.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace pubsub_test {
+
+        const uint16_t PORT = 3114;
+        const uint16_t MIXED_PORT = 3122;
+        const uint16_t TAGGED_PORT = 3123;
+
+        server<json, PORT> *start_server() {
+            return test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                svr.pubsub_api();
+            });
+        }
+
+        // 在回复中带上标记的 JSON 协议, 编码结果与 json 不同
+        struct tagged_json: public json {
+            struct tag {
+                static std::unique_ptr<GenericReply> process(msg_context *ctx, std::unique_ptr<GenericReply> reply) {
+                    reply->set_msg("tagged");
+                    return reply;
+                }
+            };
+            using filters = type_list<json_deserializer, api_dispatcher_p, tag, json_serializer>;
+        };
+
+        // MIXED_PORT 上以 json, TAGGED_PORT 上以 tagged_json 订阅同一个 server
+        server<json, MIXED_PORT> *start_mixed_server() {
+            return test_util::start_once<server<json, MIXED_PORT>>([](server<json, MIXED_PORT> &svr) {
+                svr.pubsub_api();
+                server<json, MIXED_PORT> *s = &svr;
+                svr.listen<tagged_json, TAGGED_PORT>().api("subscribe", [s](msg_context *ctx, std::string topic) {
+                    return s->subscribe(ctx->conn_id, topic);
+                });
+            });
+        }
+
+        // 发出订阅/取消订阅请求并返回回复
+        std::string call(int fd, const std::string &api, const std::string &topic) {
+            std::string req = "{\"api\":\"" + api + "\",\"params\":[{\"str\":\"" + topic + "\"}]}\r\n";
+            return test_util::send_all(fd, req) ? test_util::read_line(fd) : "";
+        }
+
+        // 订阅/取消订阅与发布经由连接所属 ev_handler 的邮箱按顺序处理, 读到订阅的回复后发布的消息一定会投递
+        void publish(const std::string &topic, const std::string &data) {
+            start_server()->publish(topic, data);
+        }
+
+    }
+
+}
+
+// 测试1：只有订阅者收到发布, 推送以协议格式编码并带有主题, 没有订阅者的主题直接忽略.
+// 未订阅的连接读到的第一条推送应当是之后发布的标记
+TEST(pubsub_tests, subscribe_and_publish) {
+    pubsub_test::start_server();
+    int sub = test_util::connect_to(pubsub_test::PORT);
+    int other = test_util::connect_to(pubsub_test::PORT);
+    ASSERT_GE(sub, 0);
+    ASSERT_GE(other, 0);
+    EXPECT_NE(pubsub_test::call(sub, "subscribe", "news").find("true"), std::string::npos);
+    EXPECT_NE(pubsub_test::call(other, "subscribe", "marker").find("true"), std::string::npos);
+    pubsub_test::publish("nobody", "lost");
+    pubsub_test::publish("news", "hello");
+    pubsub_test::publish("marker", "end");
+    std::string pushed = test_util::read_line(sub);
+    EXPECT_NE(pushed.find("hello"), std::string::npos);
+    EXPECT_NE(pushed.find("news"), std::string::npos);
+    EXPECT_NE(test_util::read_line(other).find("end"), std::string::npos);
+    close(sub);
+    close(other);
+}
+
+// 测试2：取消订阅后不再收到发布(下一条推送是另一主题的), 重复订阅只收到一次, 取消未知的主题返回 false
+TEST(pubsub_tests, unsubscribe_and_duplicate) {
+    pubsub_test::start_server();
+    int fd = test_util::connect_to(pubsub_test::PORT);
+    ASSERT_GE(fd, 0);
+    EXPECT_NE(pubsub_test::call(fd, "unsubscribe", "unknown_topic").find("false"), std::string::npos);
+    EXPECT_NE(pubsub_test::call(fd, "subscribe", "sports").find("true"), std::string::npos);
+    EXPECT_NE(pubsub_test::call(fd, "subscribe", "sports").find("true"), std::string::npos);
+    EXPECT_NE(pubsub_test::call(fd, "subscribe", "weather").find("true"), std::string::npos);
+    pubsub_test::publish("sports", "goal");
+    pubsub_test::publish("weather", "rain");
+    EXPECT_NE(test_util::read_line(fd).find("goal"), std::string::npos);
+    EXPECT_NE(test_util::read_line(fd).find("rain"), std::string::npos);
+    EXPECT_NE(pubsub_test::call(fd, "unsubscribe", "sports").find("true"), std::string::npos);
+    pubsub_test::publish("sports", "miss");
+    pubsub_test::publish("weather", "sun");
+    EXPECT_NE(test_util::read_line(fd).find("sun"), std::string::npos);
+    close(fd);
+}
+
+// 测试3：订阅者断开后自动离开主题, 其他订阅者照常收到发布
+TEST(pubsub_tests, disconnect_leaves) {
+    pubsub_test::start_server();
+    int gone = test_util::connect_to(pubsub_test::PORT);
+    int stay = test_util::connect_to(pubsub_test::PORT);
+    ASSERT_GE(gone, 0);
+    ASSERT_GE(stay, 0);
+    EXPECT_NE(pubsub_test::call(gone, "subscribe", "chat").find("true"), std::string::npos);
+    EXPECT_NE(pubsub_test::call(stay, "subscribe", "chat").find("true"), std::string::npos);
+    close(gone);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for(int i = 0; i < 3; ++i) {
+        std::string msg = "line" + std::to_string(i);
+        pubsub_test::publish("chat", msg);
+        EXPECT_NE(test_util::read_line(stay).find(msg), std::string::npos);
+    }
+    close(stay);
+}
+
+// 测试4：不同过滤器链的监听端口上的订阅者各自收到以其链编码的发布, 每个订阅者只收到一份
+TEST(pubsub_tests, per_endpoint_encoding) {
+    auto *svr = pubsub_test::start_mixed_server();
+    int plain = test_util::connect_to(pubsub_test::MIXED_PORT);
+    int tagged = test_util::connect_to(pubsub_test::TAGGED_PORT);
+    ASSERT_GE(plain, 0);
+    ASSERT_GE(tagged, 0);
+    EXPECT_NE(pubsub_test::call(plain, "subscribe", "mixed").find("true"), std::string::npos);
+    EXPECT_NE(pubsub_test::call(tagged, "subscribe", "mixed").find("true"), std::string::npos);
+    svr->publish("mixed", std::string("first"));
+    svr->publish("mixed", std::string("second"));
+    for(const char *data : {"first", "second"}) {
+        std::string line = test_util::read_line(plain);
+        EXPECT_NE(line.find(data), std::string::npos) << line;
+        EXPECT_EQ(line.find("tagged"), std::string::npos) << line;
+        line = test_util::read_line(tagged);
+        EXPECT_NE(line.find(data), std::string::npos) << line;
+        EXPECT_NE(line.find("tagged"), std::string::npos) << line;
+    }
+    close(plain);
+    close(tagged);
+}
+
+#endif
@@ -12,6 +12,12 @@
 #include <google/protobuf/util/json_util.h>
 #include <thread>
 #include <random>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string.h>
 
 namespace tcp_kit {
 
@@ -385,60 +391,22 @@ namespace tcp_kit {
             }
         }
 
-        class conn_manager {
-        public:
-            struct conn_context {
-                ev_context *ev_ctx;
-                event      *msg_event;
-                evbuffer   *msg_buffer;
-            };
-            static std::unordered_map<uint32_t, conn_context> cli_map;
-            static void msg_callback(evutil_socket_t, short, void *arg) {
-                auto *ev_ctx = static_cast<ev_context *>(arg);
-                bufferevent_write_buffer(ev_ctx->bev, cli_map[ev_ctx->conn_id].msg_buffer);
-            }
-            static void connect(ev_context *ctx) {
-                cli_map[ctx->conn_id] = {ctx, nullptr, evbuffer_new()};
-                event *ev = event_new(bufferevent_get_base(ctx->bev), -1, EV_PERSIST, msg_callback, ctx);
-                cli_map[ctx->conn_id].msg_event = ev;
-            }
-            static void send_global_msg(std::string &msg) {
-                for(auto &cli_pair : cli_map) {
-                    std::string json = "{\"msg\":\"" + msg + "\"}\r\n";
-                    evbuffer_add(cli_pair.second.msg_buffer, json.c_str(), json.length());
-                    event_active(cli_pair.second.msg_event, 0, 0);
-                }
-            }
-            static void close(ev_context *ctx) {
-                log_info("CLOSE");
-                auto it = cli_map.find(ctx->conn_id);
-                if (it != cli_map.end()) {
-                    evbuffer_free(it->second.msg_buffer);
-                    event_free(it->second.msg_event);
-                    cli_map.erase(it);
-                }
-            }
-        };
-
-        std::unordered_map<uint32_t, conn_manager::conn_context> conn_manager::cli_map;
-
-        class chat: public tcp_kit::json {
-        public:
-            using filters = type_list<conn_manager, json_deserializer, api_dispatcher_p, json_serializer>;
-        };
-
+        // 聊天室: 客户端通过 subscribe api 订阅 "chat", 消息以协议格式编码一次后发布给所有订阅者
         void chat_room() {
-            server<chat> chat_server;
-            std::unordered_map<uint32_t, std::string> user_map;
+            server<json> chat_server;
+            std::mutex user_mutex;
+            std::unordered_map<uint64_t, std::string> user_map;
+            chat_server.pubsub_api();
             chat_server.api("join", [&](msg_context *ctx, std::string name) {
+                std::lock_guard<std::mutex> lock(user_mutex);
                 user_map[ctx->conn_id] = name;
-                return ctx->conn_id;
+                return chat_server.subscribe(ctx->conn_id, "chat");
             });
-            chat_server.api("send", [&](uint32_t id, std::string msg) {
-                auto it = user_map.find(id);
+            chat_server.api("send", [&](msg_context *ctx, std::string msg) {
+                std::lock_guard<std::mutex> lock(user_mutex);
+                auto it = user_map.find(ctx->conn_id);
                 if(it != user_map.end()) {
-                    auto name_with_msg = it->second + ":" + msg;
-                    conn_manager::send_global_msg(name_with_msg);
+                    chat_server.publish("chat", it->second + ":" + msg);
                     return true;
                 }
                 return false;
@@ -446,134 +414,120 @@ namespace tcp_kit {
             chat_server.start();
         }
 
-        static const std::string base64_chars =
-                "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-                "abcdefghijklmnopqrstuvwxyz"
-                "0123456789+/";
-
-
-        static inline bool is_base64(unsigned char c) {
-            return (isalnum(c) || (c == '+') || (c == '/'));
-        }
-
-        std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
-            std::string ret;
-            int i = 0;
-            int j = 0;
-            unsigned char char_array_3[3];
-            unsigned char char_array_4[4];
-
-            while (in_len--) {
-                char_array_3[i++] = *(bytes_to_encode++);
-                if (i == 3) {
-                    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-                    char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-                    char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-                    char_array_4[3] = char_array_3[2] & 0x3f;
-
-                    for(i = 0; (i <4) ; i++)
-                        ret += base64_chars[char_array_4[i]];
-                    i = 0;
+        // 发布扇出的端到端耗时: n 个连接订阅同一主题后 server::publish 一条消息, 计时到最后一个订阅者读到完整的消息为止
+        // (按连接顺序阻塞读取, 包含客户端读取的耗时). 10 万个连接需要足够的文件描述符, 源地址分散在 127.0.0.x 上以免
+        // 耗尽临时端口
+        void fan_out_bench() {
+            const uint16_t port = 3000;
+            std::atomic<server<json> *> svr_ptr{nullptr};
+            std::thread([&svr_ptr] {
+                server<json> svr;
+                svr.pubsub_api();
+                svr_ptr = &svr;
+                svr.start();
+            }).detach();
+            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+            rlimit rl;
+            getrlimit(RLIMIT_NOFILE, &rl);
+            rl.rlim_cur = rl.rlim_max;
+            setrlimit(RLIMIT_NOFILE, &rl);
+
+            char buf[8192];
+            for(size_t n : {1000, 10000, 100000}) {
+                std::vector<int> fds;
+                for(size_t i = 0; i < n; ++i) {
+                    int fd = socket(AF_INET, SOCK_STREAM, 0);
+                    sockaddr_in src{}, dst{};
+                    src.sin_family = dst.sin_family = AF_INET;
+                    src.sin_addr.s_addr = htonl(INADDR_LOOPBACK + uint32_t(i / 20000));
+                    dst.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                    dst.sin_port = htons(port);
+                    if(fd < 0 || bind(fd, (sockaddr*) &src, sizeof(src)) != 0 || connect(fd, (sockaddr*) &dst, sizeof(dst)) != 0) {
+                        log_error("Only %zu of %zu subscribers connected", fds.size(), n);
+                        if(fd >= 0)
+                            close(fd);
+                        break;
+                    }
+                    fds.push_back(fd);
                 }
-            }
-
-            if (i)
-            {
-                for(j = i; j < 3; j++)
-                    char_array_3[j] = '\0';
-
-                char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-                char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-                char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-                char_array_4[3] = char_array_3[2] & 0x3f;
-
-                for (j = 0; (j < i + 1); j++)
-                    ret += base64_chars[char_array_4[j]];
-
-                while((i++ < 3))
-                    ret += '=';
-
-            }
-
-            return ret;
-
-        }
-
-        std::string base64_decode(std::string const& encoded_string) {
-            int in_len = encoded_string.size();
-            int i = 0;
-            int j = 0;
-            int in_ = 0;
-            unsigned char char_array_4[4], char_array_3[3];
-            std::string ret;
-
-            while (in_len-- && ( encoded_string[in_] != '=') && is_base64(encoded_string[in_])) {
-                char_array_4[i++] = encoded_string[in_]; in_++;
-                if (i ==4) {
-                    for (i = 0; i <4; i++)
-                        char_array_4[i] = base64_chars.find(char_array_4[i]);
-
-                    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-                    char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-                    char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-                    for (i = 0; (i < 3); i++)
-                        ret += char_array_3[i];
-                    i = 0;
+                const std::string subscribe = "{\"api\":\"subscribe\",\"params\":[{\"str\":\"bench\"}]}\r\n";
+                // 逐个订阅并读到成功的回复, 同时发出的订阅请求可能被并发限制器拒绝. 服务端的文件描述符不足时连接虽然建立
+                // 但不会被接受, 读取超时后只以已订阅的连接计时
+                for(size_t i = 0; i < fds.size(); ++i) {
+                    timeval tv{5, 0};
+                    setsockopt(fds[i], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+                    ssize_t len;
+                    do {
+                        write(fds[i], subscribe.data(), subscribe.size());
+                        while((len = read(fds[i], buf, sizeof(buf))) > 0 && buf[len - 1] != '\n');
+                    } while(len > 0 && !memmem(buf, size_t(len), "true", 4));
+                    if(len <= 0) {
+                        log_error("Only %zu of %zu subscribers subscribed", i, n);
+                        for(size_t j = i; j < fds.size(); ++j)
+                            close(fds[j]);
+                        fds.resize(i);
+                    }
                 }
+                for(size_t payload_len : {256, 4096}) {
+                    std::string payload(payload_len, 'x');
+                    auto begin = chrono::steady_clock::now();
+                    svr_ptr.load()->publish("bench", payload);
+                    size_t delivered = 0;
+                    for(int fd : fds) {
+                        ssize_t len;
+                        while((len = read(fd, buf, sizeof(buf))) > 0 && buf[len - 1] != '\n');
+                        delivered += len > 0;
+                    }
+                    auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count();
+                    log_info("publish %zu bytes to %zu subscribers: %zu delivered, last after %.3f ms (%lld ns/sub)",
+                             payload_len, fds.size(), delivered, ns / 1e6, (long long) (fds.empty() ? 0 : ns / fds.size()));
+                }
+                for(int fd : fds)
+                    close(fd);
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
             }
+        }
 
-            if (i) {
-                for (j = i; j <4; j++)
-                    char_array_4[j] = 0;
-
-                for (j = 0; j <4; j++)
-                    char_array_4[j] = base64_chars.find(char_array_4[j]);
-
-                char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-                char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-                char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-                for (j = 0; (j < i - 1); j++) ret += char_array_3[j];
-            }
+        // 异步 api: 处理器把完成令牌交给其他线程后立即返回, handler 线程继续处理下一条消息
+        void async_api() {
+            server<json> svr;
+            thread_pool workers(4, 4, 0l, std::make_unique<blocking_fifo<runnable>>(1024));
+            svr.api("slow_echo", [&](completion<std::string> done, std::string msg, uint32_t delay_ms) {
+                workers.execute([done, msg, delay_ms]() mutable {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+                    done(msg);
+                });
+            });
+            svr.start();
+        }
 
-            return ret;
+#if TCP_KIT_COROUTINES
+        // 协程 api: 慢请求挂起时不占用 handler 线程, 每个 handler 线程上可以同时有数千个处理中的请求
+        void coroutine_api() {
+            server<json> svr;
+            thread_pool workers(4, 4, 0l, std::make_unique<blocking_fifo<runnable>>(1024));
+            svr.api("slow_echo", [](std::string msg, uint32_t delay_ms) -> task<std::string> {
+                co_await sleep_for(std::chrono::milliseconds(delay_ms));
+                co_return msg;
+            });
+            svr.api("checksum", [&](std::string msg) -> task<uint64_t> {
+                co_return co_await offload(workers, [msg] {
+                    return static_cast<uint64_t>(std::hash<std::string>()(msg));
+                });
+            });
+            svr.start();
         }
+#endif
 
+        // 文件以原始字节流跟随在回复帧头之后传输, 由 ev_handler 直接在文件与 socket 之间搬运
         void file_system() {
             server<json> file_svr;
             const std::string directory_path_of_file = "/Users/linruixin/tcp_kit/upload/";
-            std::atomic<uint32_t> uid{0};
-            std::unordered_map<uint32_t, std::string> file_map;
-            file_svr.api("upload", [&](std::string filename) {
-                auto id = uid++;
-                file_map[id] = filename;
-                return id;
+            file_svr.api("upload", [&](std::string filename, uint64_t size) {
+                return file_sink::of(directory_path_of_file + filename, size);
             });
-            file_svr.api("uploading", [&](uint32_t uid, bool err, bool end, int32_t offset, std::string base64) {
-                if (file_map.find(uid) == file_map.end())
-                    return false;
-                std::string filename = directory_path_of_file + file_map[uid];
-                if (err) {
-                    std::remove(filename.c_str());
-                    file_map.erase(uid);
-                    return false;
-                }
-                std::string decoded_data = base64_decode(base64);
-                if(offset == 0) {
-                    std::ofstream file(filename, std::ios::binary | std::ios::app);
-                    file.close();
-                }
-                std::ofstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
-                if (!file.is_open()) {
-                    return false;
-                }
-                file.seekp(offset, std::ios::beg);
-                file.write(decoded_data.data(), decoded_data.size());
-                file.close();
-                if (end)
-                    file_map.erase(uid);
-                return true;
+            file_svr.api("download", [&](std::string filename) {
+                return file_region::of(directory_path_of_file + filename);
             });
             file_svr.start();
         }
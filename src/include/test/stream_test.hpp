@@ -0,0 +1,100 @@
+#ifndef TCP_KIT_STREAM_TEST_H
+#define TCP_KIT_STREAM_TEST_H
+
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <network/server.h>
+#include <network/json.h>
+#include <network/file_region.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace stream_test {
+
+        const uint16_t PORT = 3111;
+        const std::string DIR = "/tmp/tcp_kit_stream_test/";
+
+        void start_server() {
+            test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                mkdir(DIR.c_str(), 0755);
+                svr.api("upload", [](std::string name, uint64_t size) {
+                    return file_sink::of(DIR + name, size);
+                });
+                svr.api("download", [](std::string name) {
+                    return file_region::of(DIR + name);
+                });
+                svr.api("echo", [](std::string s) {
+                    return s;
+                });
+            });
+        }
+
+        // 读取一行回复, 下载时(stream 非空)再读取回复之后 streamLen 个字节的数据流
+        std::string read_reply(int fd, std::string *stream = nullptr) {
+            std::string received;
+            char buf[512];
+            ssize_t n;
+            size_t eol;
+            while((eol = received.find("\r\n")) == std::string::npos && (n = read(fd, buf, sizeof(buf))) > 0)
+                received.append(buf, size_t(n));
+            if(eol == std::string::npos)
+                return "";
+            std::string reply = received.substr(0, eol);
+            if(stream) {
+                *stream = received.substr(eol + 2);
+                size_t pos = reply.find("\"streamLen\":\"");
+                size_t len = pos == std::string::npos ? 0 : strtoull(reply.c_str() + pos + 13, nullptr, 10);
+                while(stream->size() < len && (n = read(fd, buf, sizeof(buf))) > 0)
+                    stream->append(buf, size_t(n));
+            }
+            return reply;
+        }
+
+        std::string file_content(const std::string &path) {
+            std::string content;
+            FILE *f = fopen(path.c_str(), "rb");
+            if(!f)
+                return content;
+            char buf[512];
+            size_t n;
+            while((n = fread(buf, 1, sizeof(buf), f)) > 0)
+                content.append(buf, n);
+            fclose(f);
+            return content;
+        }
+
+    }
+
+}
+
+// 测试1：上传覆盖较大的旧文件后不残留旧文件的尾部, 下载得到上传的内容(含 CRLF 也不被分帧), 数据流之后的请求照常处理
+TEST(stream_tests, upload_download_round_trip) {
+    stream_test::start_server();
+    const std::string path = stream_test::DIR + "round_trip.txt";
+    FILE *old = fopen(path.c_str(), "wb");
+    ASSERT_NE(old, nullptr);
+    fputs(std::string(100, 'z').c_str(), old);
+    fclose(old);
+    int fd = test_util::connect_to(stream_test::PORT);
+    ASSERT_GE(fd, 0);
+    const std::string content = "hello\r\nworld";
+    std::string stream;
+    ASSERT_TRUE(test_util::send_all(fd, "{\"api\":\"upload\",\"params\":[{\"str\":\"round_trip.txt\"},{\"u64\":\"12\"}]}\r\n"));
+    EXPECT_NE(stream_test::read_reply(fd).find("\"streamLen\":\"12\""), std::string::npos);
+    ASSERT_TRUE(test_util::send_all(fd, content + "{\"api\":\"echo\",\"params\":[{\"str\":\"after\"}]}\r\n"));
+    EXPECT_NE(stream_test::read_reply(fd).find("\"after\""), std::string::npos);
+    EXPECT_EQ(stream_test::file_content(path), content);
+    ASSERT_TRUE(test_util::send_all(fd, "{\"api\":\"download\",\"params\":[{\"str\":\"round_trip.txt\"}]}\r\n"));
+    EXPECT_NE(stream_test::read_reply(fd, &stream).find("\"streamLen\":\"12\""), std::string::npos);
+    EXPECT_EQ(stream, content);
+    close(fd);
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef TCP_KIT_TEST_UTIL_H
+#define TCP_KIT_TEST_UTIL_H
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 网络测试共用的 server 启动与 socket 读写工具
+namespace tcp_kit {
+
+    namespace test_util {
+
+        // 在分离的线程中以 args 构造并启动 Server, 同一个调用处只启动一次, server 一直运行到测试进程结束.
+        // setup(svr) 在启动前于 server 线程中调用, 用于注册 api 与增加监听端口.
+        // 返回时 server 已进入 RUNNING 状态, 即所有端口都已开始监听
+        template<typename Server, typename Setup, typename... Args>
+        Server *start_once(Setup setup, Args... args) {
+            static std::once_flag once;
+            static std::atomic<Server *> svr_ptr{nullptr};
+            std::call_once(once, [&setup, &args...] {
+                std::thread([setup, args...]() mutable {
+                    Server svr(args...);
+                    setup(svr);
+                    svr_ptr = &svr;
+                    svr.start();
+                }).detach();
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+                while(!(svr_ptr.load() && svr_ptr.load()->is_running()) && std::chrono::steady_clock::now() < deadline)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            });
+            return svr_ptr;
+        }
+
+        // 连接本机的 port, 读取超时为 recv_timeout_s 秒(0 表示不超时), 失败时返回 -1
+        inline int connect_to(uint16_t port, long recv_timeout_s = 2) {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in sin{};
+            sin.sin_family = AF_INET;
+            sin.sin_port = htons(port);
+            inet_pton(AF_INET, "127.0.0.1", &sin.sin_addr);
+            timeval tv{recv_timeout_s, 0};
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+            if(connect(fd, (sockaddr*) &sin, sizeof(sin)) != 0) {
+                close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        inline bool send_all(int fd, const std::string &data) {
+            return write(fd, data.data(), data.size()) == ssize_t(data.size());
+        }
+
+        // 读取到包含 expected 的数据为止, 连接关闭或超时时返回已读到的数据
+        inline std::string read_until(int fd, const std::string &expected) {
+            std::string received;
+            char buf[512];
+            ssize_t n;
+            while(received.find(expected) == std::string::npos && (n = read(fd, buf, sizeof(buf))) > 0)
+                received.append(buf, size_t(n));
+            return received;
+        }
+
+        // 逐字节读取一行(包括 \r\n), 不会读走其后的回复或推送. 超时或连接关闭时返回已读到的数据
+        inline std::string read_line(int fd) {
+            std::string line;
+            char c;
+            while(line.size() < 2 || line.compare(line.size() - 2, 2, "\r\n") != 0) {
+                if(read(fd, &c, 1) != 1)
+                    break;
+                line.push_back(c);
+            }
+            return line;
+        }
+
+        // 读空输入直到连接被服务端关闭(关闭前可能先收到一条错误提示), 超时返回 false
+        inline bool closed_by_peer(int fd) {
+            char buf[512];
+            ssize_t n;
+            while((n = read(fd, buf, sizeof(buf))) > 0);
+            return n == 0;
+        }
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef TCP_KIT_THROTTLE_TEST_H
+#define TCP_KIT_THROTTLE_TEST_H
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <metrics/metrics.h>
+#include <network/server.h>
+#include <network/json.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace throttle_test {
+        const uint16_t DROP_PORT = 3116;
+        const uint16_t DISCONNECT_PORT = 3117;
+        const uint16_t BLOCK_PORT = 3119;
+        const size_t CHUNK = 16 * 1024;
+    }
+
+    // 只为本测试的 server 设置较小的输出水位, 三个 server 分别使用 DROP、DISCONNECT 与 BLOCK 策略
+    template<>
+    struct conn_limits<throttle_test::DROP_PORT> {
+        static constexpr uint32_t max_in_flight        = MAX_IN_FLIGHT_PER_CONN;
+        static constexpr size_t   memory_high_water    = MSG_MEMORY_HIGH_WATER;
+        static constexpr size_t   memory_low_water     = MSG_MEMORY_LOW_WATER;
+        static constexpr size_t   output_high_water    = throttle_test::CHUNK * 4;
+        static constexpr size_t   output_low_water     = throttle_test::CHUNK;
+        static constexpr int      slow_consumer_policy = SLOW_CONSUMER_DROP;
+    };
+
+    template<>
+    struct conn_limits<throttle_test::DISCONNECT_PORT> {
+        static constexpr uint32_t max_in_flight        = MAX_IN_FLIGHT_PER_CONN;
+        static constexpr size_t   memory_high_water    = MSG_MEMORY_HIGH_WATER;
+        static constexpr size_t   memory_low_water     = MSG_MEMORY_LOW_WATER;
+        static constexpr size_t   output_high_water    = throttle_test::CHUNK * 4;
+        static constexpr size_t   output_low_water     = throttle_test::CHUNK;
+        static constexpr int      slow_consumer_policy = SLOW_CONSUMER_DISCONNECT;
+    };
+
+    template<>
+    struct conn_limits<throttle_test::BLOCK_PORT> {
+        static constexpr uint32_t max_in_flight        = MAX_IN_FLIGHT_PER_CONN;
+        static constexpr size_t   memory_high_water    = MSG_MEMORY_HIGH_WATER;
+        static constexpr size_t   memory_low_water     = MSG_MEMORY_LOW_WATER;
+        static constexpr size_t   output_high_water    = throttle_test::CHUNK * 4;
+        static constexpr size_t   output_low_water     = throttle_test::CHUNK;
+        static constexpr int      slow_consumer_policy = SLOW_CONSUMER_BLOCK;
+    };
+
+    namespace throttle_test {
+
+        template<uint16_t PORT>
+        server<json, PORT> *start_server() {
+            return test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                svr.pubsub_api();
+                // 请求没有参数时不解析任何参数(msg_context * 也为空), 因此带一个不使用的参数
+                svr.api("conn_id", [](msg_context *ctx, std::string) {
+                    return ctx->conn_id;
+                });
+            });
+        }
+
+        uint64_t throttled_gauge() {
+            metrics::snapshot snap;
+            metrics::collect(snap);
+            return snap.throttled();
+        }
+
+        uint64_t counter(metrics::counter_id id) {
+            metrics::snapshot snap;
+            metrics::collect(snap);
+            return snap.counters[id];
+        }
+
+        // 连接并订阅 flood, 此后不再读取
+        int subscriber(uint16_t port) {
+            int fd = test_util::connect_to(port);
+            if(fd < 0)
+                return -1;
+            test_util::send_all(fd, "{\"api\":\"subscribe\",\"params\":[{\"str\":\"flood\"}]}\r\n");
+            if(test_util::read_line(fd).find("true") == std::string::npos) {
+                close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        // 查询连接在服务端的 conn_id, 失败时返回 0
+        uint64_t conn_id(int fd) {
+            if(!test_util::send_all(fd, "{\"api\":\"conn_id\",\"params\":[{\"str\":\"\"}]}\r\n"))
+                return 0;
+            std::string reply = test_util::read_line(fd);
+            // uint64 在 json 中编码为字符串: "u64":"<id>"
+            size_t begin = reply.find("\"u64\":\"");
+            return begin == std::string::npos ? 0 : std::stoull(reply.substr(begin + 7));
+        }
+
+        // 向不读取的订阅者持续推送, 直到 done() 为真. 套接字缓冲填满之前推送仍能写出, 因此推送量不确定
+        template<uint16_t PORT, typename Done>
+        bool flood_until(server<json, PORT> *svr, Done done) {
+            std::string chunk(CHUNK, 'x');
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while(std::chrono::steady_clock::now() < deadline) {
+                for(int i = 0; i < 16; ++i)
+                    svr->publish("flood", chunk.data(), chunk.size());
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                if(done())
+                    return true;
+            }
+            return false;
+        }
+
+        // 套接字缓冲未满时输出缓冲很快回落, 限流随即解除, 限流持续一段时间才说明订阅者确实不再读取
+        template<uint16_t PORT>
+        bool stays_throttled(server<json, PORT> *svr) {
+            if(svr->n_throttled() != 1)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return svr->n_throttled() == 1;
+        }
+
+        template<uint16_t PORT>
+        bool wait_unthrottled(server<json, PORT> *svr) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while(svr->n_throttled() != 0 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return svr->n_throttled() == 0;
+        }
+
+    }
+
+}
+
+// 测试1：不读取的订阅者被限流, 限流期间向它的推送被丢弃而连接保持; 读空之后解除限流, 其后的推送照常到达
+TEST(throttle_tests, drop_and_recover) {
+    auto *svr = throttle_test::start_server<throttle_test::DROP_PORT>();
+    uint64_t gauge = throttle_test::throttled_gauge();
+    int fd = throttle_test::subscriber(throttle_test::DROP_PORT);
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(throttle_test::flood_until(svr, [svr] { return throttle_test::stays_throttled(svr); }));
+    EXPECT_EQ(throttle_test::throttled_gauge(), gauge + 1);
+    svr->publish("flood", "DROPPED\r\n", 9);
+    // 等待邮箱处理完之前的推送, 之后才开始读取
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(svr->n_throttled(), 1);
+    std::string received;
+    std::thread reader([fd, &received] {
+        received = test_util::read_until(fd, "AFTER");
+    });
+    EXPECT_TRUE(throttle_test::wait_unthrottled(svr));
+    EXPECT_EQ(throttle_test::throttled_gauge(), gauge);
+    svr->publish("flood", "AFTER\r\n", 7);
+    reader.join();
+    EXPECT_NE(received.find("AFTER"), std::string::npos);
+    EXPECT_EQ(received.find("DROPPED"), std::string::npos);
+    close(fd);
+}
+
+// 测试2：DISCONNECT 策略下向被限流的连接推送时断开它, 限流计数随之归零. 限流之后的下一次推送即断开连接,
+// 因此以累计计数确认限流发生过
+TEST(throttle_tests, disconnect) {
+    auto *svr = throttle_test::start_server<throttle_test::DISCONNECT_PORT>();
+    uint64_t gauge = throttle_test::throttled_gauge();
+    uint64_t throttled = throttle_test::counter(metrics::CONN_THROTTLED);
+    int fd = throttle_test::subscriber(throttle_test::DISCONNECT_PORT);
+    ASSERT_GE(fd, 0);
+    uint64_t id = throttle_test::conn_id(fd);
+    ASSERT_NE(svr->find(id), nullptr);
+    ASSERT_TRUE(throttle_test::flood_until(svr, [svr, id] { return svr->find(id) == nullptr; }));
+    EXPECT_GT(throttle_test::counter(metrics::CONN_THROTTLED), throttled);
+    EXPECT_EQ(svr->n_throttled(), 0);
+    EXPECT_EQ(throttle_test::throttled_gauge(), gauge);
+    EXPECT_TRUE(test_util::closed_by_peer(fd));
+    close(fd);
+}
+
+// 测试3：BLOCK 策略下向被限流的连接推送时, publish 阻塞到订阅者读空、限流解除, 推送的数据不被丢弃
+TEST(throttle_tests, block_publisher) {
+    auto *svr = throttle_test::start_server<throttle_test::BLOCK_PORT>();
+    int fd = throttle_test::subscriber(throttle_test::BLOCK_PORT);
+    ASSERT_GE(fd, 0);
+    // 被限流后 publish 会阻塞, 只在没有限流时推送
+    std::string chunk(throttle_test::CHUNK, 'x');
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while(!throttle_test::stays_throttled(svr) && std::chrono::steady_clock::now() < deadline) {
+        for(int i = 0; i < 16 && svr->n_throttled() == 0; ++i)
+            svr->publish("flood", chunk.data(), chunk.size());
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(svr->n_throttled(), 1);
+    std::atomic<bool> published{false};
+    std::thread publisher([svr, &published] {
+        svr->publish("flood", "BLOCKED\r\n", 9);
+        published = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(published);
+    auto drain_at = std::chrono::steady_clock::now();
+    std::string received = test_util::read_until(fd, "BLOCKED");
+    publisher.join();
+    // 因限流解除而返回, 而不是等到 SLOW_CONSUMER_BLOCK_MS 超时
+    EXPECT_LT(std::chrono::steady_clock::now() - drain_at, std::chrono::milliseconds(SLOW_CONSUMER_BLOCK_MS));
+    EXPECT_NE(received.find("BLOCKED"), std::string::npos);
+    EXPECT_EQ(svr->n_throttled(), 0);
+    close(fd);
+}
+
+#endif
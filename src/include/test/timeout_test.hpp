@@ -0,0 +1,101 @@
+#ifndef TCP_KIT_TIMEOUT_TEST_H
+#define TCP_KIT_TIMEOUT_TEST_H
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <network/server.h>
+#include <network/json.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace timeout_test {
+        const uint16_t PORT = 3112;
+    }
+
+    // 只为本测试的 server 启用较短的超时
+    template<>
+    struct conn_timeouts<timeout_test::PORT> {
+        static constexpr uint32_t idle_ms        = 200;
+        static constexpr uint32_t read_header_ms = 200;
+        static constexpr uint32_t request_ms     = 200;
+    };
+
+    namespace timeout_test {
+
+        server<json, PORT> *start_server() {
+            return test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                svr.api("echo", [](std::string s) {
+                    return s;
+                });
+                svr.api("slow", [](uint32_t delay_ms) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+                    return delay_ms;
+                });
+                svr.pubsub_api();
+            });
+        }
+
+    }
+
+}
+
+// 测试1：空闲的连接超时后被关闭, 有读写的连接不受影响
+TEST(timeout_tests, idle_closed) {
+    timeout_test::start_server();
+    int idle = test_util::connect_to(timeout_test::PORT);
+    int busy = test_util::connect_to(timeout_test::PORT);
+    ASSERT_GE(idle, 0);
+    ASSERT_GE(busy, 0);
+    for(int i = 0; i < 6; ++i) {
+        ASSERT_TRUE(test_util::send_all(busy, "{\"api\":\"echo\",\"params\":[{\"str\":\"ping\"}]}\r\n"));
+        EXPECT_NE(test_util::read_until(busy, "\r\n").find("ping"), std::string::npos);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    EXPECT_TRUE(test_util::closed_by_peer(idle));
+    close(idle);
+    close(busy);
+}
+
+// 测试2：只接收推送的订阅者不被视为空闲
+TEST(timeout_tests, pushes_keep_alive) {
+    server<json, timeout_test::PORT> *svr = timeout_test::start_server();
+    int fd = test_util::connect_to(timeout_test::PORT);
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(test_util::send_all(fd, "{\"api\":\"subscribe\",\"params\":[{\"str\":\"tick\"}]}\r\n"));
+    EXPECT_NE(test_util::read_until(fd, "\r\n").find("true"), std::string::npos);
+    for(int i = 0; i < 6; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::string tick = "tick" + std::to_string(i) + "\r\n";
+        svr->publish("tick", tick.data(), tick.size());
+        EXPECT_NE(test_util::read_until(fd, tick).find(tick), std::string::npos);
+    }
+    ASSERT_TRUE(test_util::send_all(fd, "{\"api\":\"echo\",\"params\":[{\"str\":\"alive\"}]}\r\n"));
+    EXPECT_NE(test_util::read_until(fd, "alive").find("alive"), std::string::npos);
+    close(fd);
+}
+
+// 测试3：请求迟迟得不到回复时连接以错误关闭(处理中的请求完成后才释放), 消息接收不完整时也被关闭
+TEST(timeout_tests, request_and_header) {
+    timeout_test::start_server();
+    int slow = test_util::connect_to(timeout_test::PORT);
+    int partial = test_util::connect_to(timeout_test::PORT);
+    ASSERT_GE(slow, 0);
+    ASSERT_GE(partial, 0);
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(test_util::send_all(slow, "{\"api\":\"slow\",\"params\":[{\"u32\":600}]}\r\n"));
+    ASSERT_TRUE(test_util::send_all(partial, "{\"api\":\"echo\""));
+    EXPECT_NE(test_util::read_until(slow, "closed").find("closed"), std::string::npos);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(600));
+    EXPECT_TRUE(test_util::closed_by_peer(slow));
+    EXPECT_TRUE(test_util::closed_by_peer(partial));
+    close(slow);
+    close(partial);
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef TCP_KIT_TIMING_WHEEL_TEST_H
+#define TCP_KIT_TIMING_WHEEL_TEST_H
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <util/timing_wheel.h>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace timing_wheel_test {
+
+        struct fired_timer {
+            timing_wheel      *wheel;
+            timer_node         node;
+            std::vector<uint64_t> fired_at;
+        };
+
+        void on_fired(void *arg) {
+            auto *t = static_cast<fired_timer *>(arg);
+            t->fired_at.push_back(t->wheel->now() - 1);
+        }
+
+        void init(fired_timer &t, timing_wheel &wheel) {
+            t.wheel = &wheel;
+            t.node = {nullptr, nullptr, 0, on_fired, &t};
+        }
+
+    }
+
+}
+
+// 测试1：节点在到期的 tick 被回调, 且只回调一次
+TEST(timing_wheel_tests, fire_at_expire) {
+    using namespace timing_wheel_test;
+    timing_wheel wheel;
+    fired_timer t;
+    init(t, wheel);
+    wheel.arm(&t.node, 10);
+    wheel.advance(9);
+    EXPECT_TRUE(t.fired_at.empty());
+    wheel.advance(20);
+    ASSERT_EQ(t.fired_at.size(), 1);
+    EXPECT_EQ(t.fired_at[0], 10);
+    EXPECT_FALSE(timing_wheel::armed(&t.node));
+}
+
+// 测试2：取消与重新设置到期时间
+TEST(timing_wheel_tests, cancel_and_rearm) {
+    using namespace timing_wheel_test;
+    timing_wheel wheel;
+    fired_timer a, b;
+    init(a, wheel);
+    init(b, wheel);
+    wheel.arm(&a.node, 5);
+    wheel.arm(&b.node, 5);
+    wheel.cancel(&a.node);
+    wheel.arm(&b.node, 50);
+    wheel.advance(100);
+    EXPECT_TRUE(a.fired_at.empty());
+    ASSERT_EQ(b.fired_at.size(), 1);
+    EXPECT_EQ(b.fired_at[0], 50);
+}
+
+// 测试3：跨越多层的延时经过 cascade 后仍在准确的 tick 被回调
+TEST(timing_wheel_tests, cascade_levels) {
+    using namespace timing_wheel_test;
+    timing_wheel wheel;
+    std::vector<uint64_t> delays = {255, 256, 300, 16383, 16384, 20000, 1 << 20, (1 << 20) + 7};
+    std::vector<fired_timer> timers(delays.size());
+    wheel.advance(123);
+    uint64_t base = wheel.now();
+    for(size_t i = 0; i < delays.size(); ++i) {
+        init(timers[i], wheel);
+        wheel.arm(&timers[i].node, delays[i]);
+    }
+    wheel.advance(base + (1 << 20) + 10);
+    for(size_t i = 0; i < delays.size(); ++i) {
+        ASSERT_EQ(timers[i].fired_at.size(), 1);
+        EXPECT_EQ(timers[i].fired_at[0], base + delays[i]);
+    }
+}
+
+#endif
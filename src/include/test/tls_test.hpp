@@ -0,0 +1,146 @@
+#ifndef TCP_KIT_TLS_TEST_H
+#define TCP_KIT_TLS_TEST_H
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <openssl/ssl.h>
+#include <filter/ssl.h>
+#include <metrics/metrics.h>
+#include <network/server.h>
+#include <network/json.h>
+#include <network/client.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace tls_test {
+
+        const uint16_t PORT = 3107;
+        const uint16_t TLS_PORT = 3108;
+
+        std::atomic<uint32_t> n_established{0};
+        std::atomic<uint32_t> n_unfinished{0};
+
+        // 注册在 tls_filter 之后的连接过滤器, 检查它被调用时握手是否已经完成
+        struct check_established {
+            static void connect(ev_context *ctx) {
+                SSL *ssl = bufferevent_openssl_get_ssl(ctx->bev);
+                if(ssl && SSL_is_init_finished(ssl))
+                    ++n_established;
+                else
+                    ++n_unfinished;
+            }
+        };
+
+        void start_server() {
+            test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                filters::tls_options opts;
+                opts.cert_file = "/tmp/tcp_kit_tls_test_cert.pem";
+                opts.key_file = "/tmp/tcp_kit_tls_test_key.pem";
+                filters::write_self_signed(opts.cert_file, opts.key_file);
+                filters::tls_context::configure(opts);
+                auto tls = svr.listen<json, TLS_PORT, filters::tls_filter, check_established>();
+                tls.api("echo", [](std::string s) {
+                    return s;
+                });
+            });
+        }
+
+        // 以 TLS 连接到 TLS_PORT 并调用一次 echo. session 非空时尝试恢复该会话, 返回后 session 为本次连接的会话
+        std::string echo(SSL_CTX *client_ctx, const std::string &s, SSL_SESSION *&session, bool &reused, int &version) {
+            int fd = test_util::connect_to(TLS_PORT);
+            std::string reply;
+            SSL *ssl = SSL_new(client_ctx);
+            SSL_set_fd(ssl, fd);
+            if(session)
+                SSL_set_session(ssl, session);
+            if(fd >= 0 && SSL_connect(ssl) == 1) {
+                std::string frame = "{\"api\":\"echo\",\"params\":[{\"str\":\"" + s + "\"}]}\r\n";
+                SSL_write(ssl, frame.data(), int(frame.size()));
+                char buf[512];
+                int n;
+                while(reply.find("\r\n") == std::string::npos && (n = SSL_read(ssl, buf, sizeof(buf))) > 0)
+                    reply.append(buf, size_t(n));
+                reused = SSL_session_reused(ssl);
+                version = SSL_version(ssl);
+                if(session)
+                    SSL_SESSION_free(session);
+                // TLS 1.3 的票据在握手之后发送, 读到回复时已经收到
+                session = SSL_get1_session(ssl);
+                SSL_shutdown(ssl);
+            }
+            SSL_free(ssl);
+            close(fd);
+            return reply;
+        }
+
+        uint64_t counter(metrics::counter_id id) {
+            metrics::snapshot snap;
+            metrics::collect(snap);
+            return snap.counters[id];
+        }
+
+    }
+
+}
+
+// 测试1：以 TLS 1.3 握手并处理请求, 重连时以会话票据恢复而不进行完整握手
+TEST(tls_tests, handshake_and_resume) {
+    tls_test::start_server();
+    SSL_CTX *client_ctx = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_session_cache_mode(client_ctx, SSL_SESS_CACHE_CLIENT);
+    uint64_t handshakes = tls_test::counter(metrics::TLS_HANDSHAKES);
+    uint64_t resumed = tls_test::counter(metrics::TLS_RESUMED);
+    SSL_SESSION *session = nullptr;
+    bool reused = true;
+    int version = 0;
+    EXPECT_NE(tls_test::echo(client_ctx, "first", session, reused, version).find("\"first\""), std::string::npos);
+    EXPECT_FALSE(reused);
+    EXPECT_EQ(version, TLS1_3_VERSION);
+    ASSERT_NE(session, nullptr);
+    EXPECT_NE(tls_test::echo(client_ctx, "second", session, reused, version).find("\"second\""), std::string::npos);
+    EXPECT_TRUE(reused);
+    // 服务端在握手完成时计数, 可能晚于客户端读到回复之前的最后一步
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(tls_test::counter(metrics::TLS_HANDSHAKES), handshakes + 2);
+    EXPECT_EQ(tls_test::counter(metrics::TLS_RESUMED), resumed + 1);
+    SSL_SESSION_free(session);
+    SSL_CTX_free(client_ctx);
+}
+
+// 测试2：TLS 端口不接受明文请求, 同一个 server 的明文端口不受影响
+TEST(tls_tests, plaintext_rejected) {
+    tls_test::start_server();
+    client<json> plain(std::string("127.0.0.1:") + std::to_string(tls_test::PORT), 1);
+    EXPECT_EQ(plain.call<std::string>(METRICS_API).get().front(), '{');
+    int fd = test_util::connect_to(tls_test::TLS_PORT);
+    ASSERT_GE(fd, 0);
+    ASSERT_TRUE(test_util::send_all(fd, "{\"api\":\"echo\",\"params\":[{\"str\":\"plain\"}]}\r\n"));
+    EXPECT_EQ(test_util::read_until(fd, "plain").find("plain"), std::string::npos);
+    close(fd);
+}
+
+#if TLS_HANDSHAKE_THREADS > 0
+// 测试3：握手在 crypto 线程中完成后, 其后的连接过滤器才在 ev_handler 中被调用
+TEST(tls_tests, filters_after_handshake) {
+    tls_test::start_server();
+    SSL_CTX *client_ctx = SSL_CTX_new(TLS_client_method());
+    uint32_t established = tls_test::n_established;
+    SSL_SESSION *session = nullptr;
+    bool reused;
+    int version;
+    EXPECT_NE(tls_test::echo(client_ctx, "after", session, reused, version).find("\"after\""), std::string::npos);
+    EXPECT_EQ(tls_test::n_established, established + 1);
+    EXPECT_EQ(tls_test::n_unfinished, 0);
+    SSL_SESSION_free(session);
+    SSL_CTX_free(client_ctx);
+}
+#endif
+
+#endif
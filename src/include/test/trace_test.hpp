@@ -0,0 +1,112 @@
+#ifndef TCP_KIT_TRACE_TEST_H
+#define TCP_KIT_TRACE_TEST_H
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <thread>
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <metrics/trace.h>
+#include <network/server.h>
+#include <network/json.h>
+#include <network/client.h>
+#include <test/test_util.hpp>
+
+using namespace tcp_kit;
+
+namespace tcp_kit {
+
+    namespace trace_test {
+
+        const uint16_t PORT = 3103;
+
+        void start_server() {
+            test_util::start_once<server<json, PORT>>([](server<json, PORT> &svr) {
+                svr.api("echo", [](std::string s) {
+                    return s;
+                });
+            });
+        }
+
+        std::vector<trace::span> spans_of(uint64_t trace_id) {
+            std::vector<trace::span> all, out;
+            trace::collect(all);
+            for(const trace::span &s: all)
+                if(s.trace_id == trace_id)
+                    out.push_back(s);
+            return out;
+        }
+
+    }
+
+}
+
+// 测试1：按采样率采样, 各阶段首尾相接地记录, 并导出为两种格式
+TEST(trace_tests, sample_and_export) {
+    trace::set_sample_rate(0);
+    EXPECT_EQ(trace::sample(), 0);
+    trace::set_sample_rate(1);
+    EXPECT_EQ(trace::sample_rate(), 1);
+    uint64_t id = trace::sample();
+    trace::set_sample_rate(0);
+    ASSERT_NE(id, 0);
+    uint64_t at = trace::ticks(), begin = at;
+    trace::mark(id, at, trace::READ);
+    trace::mark(id, at, trace::FILTER, trace::type_name<trace::span>());
+    std::thread([id, &at] {
+        trace::mark(id, at, trace::REPLY);
+    }).join();
+    std::vector<trace::span> spans = trace_test::spans_of(id);
+    ASSERT_EQ(spans.size(), 3);
+    EXPECT_EQ(spans[0].stage_, trace::READ);
+    EXPECT_EQ(spans[0].begin, begin);
+    EXPECT_EQ(spans[1].begin, spans[0].end);
+    EXPECT_EQ(spans[2].begin, spans[1].end);
+    EXPECT_EQ(spans[2].end, at);
+    EXPECT_NE(spans[2].thread, spans[1].thread);
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) id);
+    std::string chrome = trace::to_chrome_json();
+    EXPECT_NE(chrome.find(hex), std::string::npos);
+    EXPECT_NE(chrome.find("\"name\":\"filter:tcp_kit::trace::span\""), std::string::npos);
+    std::string otlp = trace::to_otlp_json();
+    EXPECT_NE(otlp.find(std::string(hex) + "\",\"spanId\""), std::string::npos);
+    EXPECT_NE(otlp.find("\"parentSpanId\":\"" + std::string(hex) + "\""), std::string::npos);
+
+    char path[] = "/tmp/tcp_kit_trace_XXXXXX";
+    close(mkstemp(path));
+    EXPECT_TRUE(trace::export_file(path, trace::OTLP));
+    unlink(path);
+}
+
+// 测试2：打开采样后, 被采样的请求记录了从读取到写出的每个阶段
+TEST(trace_tests, server_stages) {
+    trace_test::start_server();
+    client<json> cli("127.0.0.1:" + std::to_string(trace_test::PORT), 1);
+    trace::set_sample_rate(1.0);
+    EXPECT_EQ(cli.call<std::string>("echo", "traced").get(), "traced");
+    EXPECT_EQ(cli.call<std::string>("echo", "again").get(), "again");
+    trace::set_sample_rate(0);
+    // 等待最后一个回复的输出缓冲被写空
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::vector<trace::span> all;
+    trace::collect(all);
+    std::map<uint64_t, std::set<uint8_t>> stages;
+    std::map<uint64_t, uint32_t> filters;
+    for(const trace::span &s: all) {
+        stages[s.trace_id].insert(s.stage_);
+        filters[s.trace_id] += s.stage_ == trace::FILTER;
+    }
+    // 两次请求被采样, 每个都经过反序列化、api 分发与序列化三个过滤器
+    uint32_t complete = 0;
+    for(auto &p: stages)
+        complete += p.second.size() == trace::N_STAGES && filters[p.first] == 3;
+    EXPECT_GE(complete, 2);
+}
+
+#endif
@@ -120,7 +120,7 @@ namespace tcp_kit {
 
     template <typename Func, typename... Args>
     void thread_pool::execute(Func&& first_task, Args&&... args) {
-        auto bound_func = bind(std::forward<Func>(first_task), std::forward<Args>(args)...);
+        auto bound_func = std::bind(std::forward<Func>(first_task), std::forward<Args>(args)...);
         execute((runnable) bound_func);
     }
 
@@ -43,15 +43,26 @@ namespace tcp_kit {
         using seq_t = index_seq<0, I...>;
     };
 
+    // 空的 tuple 对应 index_seq<>
+    template<size_t N>
+    struct tuple_index_seq {
+        using seq_t = typename index_seq_h<N - 1>::seq_t;
+    };
+
+    template<>
+    struct tuple_index_seq<0> {
+        using seq_t = index_seq<>;
+    };
+
     template<typename Tuple>
     auto make_index_seq() {
-        using seq_t = typename index_seq_h<std::tuple_size<Tuple>::value - 1>::seq_t;
+        using seq_t = typename tuple_index_seq<std::tuple_size<Tuple>::value>::seq_t;
         return seq_t{};
     }
 
     template<typename Function,typename... Args, size_t... I>
     decltype(auto) call_helper(Function f, std::tuple<Args...>&& params, index_seq<I...>) {
-        return f(move(std::get<I>(params))...);
+        return f(std::move(std::get<I>(params))...);
     }
 
     template<typename Function, typename... Args>
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+
+// histogram 在每个 2 的幂区间内划分的子桶数为 2^(HISTOGRAM_SUB_BUCKET_BITS - 1), 记录值的相对误差不超过 1 / 2^(HISTOGRAM_SUB_BUCKET_BITS - 1)
+#ifndef HISTOGRAM_SUB_BUCKET_BITS
+#define HISTOGRAM_SUB_BUCKET_BITS 8
+#endif
+
+namespace tcp_kit {
+
+    // 对数线性分桶的直方图(与 HdrHistogram 相同的分桶方式), 可记录 [0, 2^64) 的值, 占用固定内存, 记录为 O(1).
+    // 非线程安全, 多线程记录时每个线程持有一个, 读取时 merge
+    template<uint32_t BITS>
+    class basic_histogram {
+
+    public:
+        static constexpr uint32_t SUB_BUCKETS = 1u << BITS;
+        static constexpr uint32_t HALF        = SUB_BUCKETS / 2;
+        static constexpr uint32_t N_COUNTS    = (64 - BITS + 2) * HALF;
+
+        basic_histogram() { reset(); }
+
+        void record(uint64_t value, uint64_t count = 1) {
+            _counts[index_of(value)] += count;
+            _total += count;
+            _sum += value * count;
+            _min = std::min(_min, value);
+            _max = std::max(_max, value);
+        }
+
+        // 协调遗漏(coordinated omission)修正: 一个耗时 value 的请求阻塞了本应每隔 expected_interval 发出的后续请求,
+        // 补记这些请求本应观测到的延迟 value - expected_interval, value - 2 * expected_interval, ...
+        void record_corrected(uint64_t value, uint64_t expected_interval, uint64_t count = 1) {
+            record(value, count);
+            if(!expected_interval)
+                return;
+            for(uint64_t missing = value; missing > expected_interval; ) {
+                missing -= expected_interval;
+                record(missing, count);
+            }
+        }
+
+        // 以 expected_interval 对已记录的值做协调遗漏修正, 结果写入 out
+        void corrected(uint64_t expected_interval, basic_histogram &out) const {
+            out.reset();
+            for(uint32_t i = 0; i < N_COUNTS; ++i) {
+                if(!_counts[i])
+                    continue;
+                out.record_corrected(std::min(highest_equivalent(i), _max), expected_interval, _counts[i]);
+            }
+        }
+
+        void merge(const basic_histogram &other) {
+            for(uint32_t i = 0; i < N_COUNTS; ++i)
+                _counts[i] += other._counts[i];
+            _total += other._total;
+            _sum += other._sum;
+            _min = std::min(_min, other._min);
+            _max = std::max(_max, other._max);
+        }
+
+        // 从其他形式(如原子计数)的同样分桶的数组汇总: 逐桶加入计数后以 add_summary 给出这些值的和与最值
+        void add_bucket(uint32_t index, uint64_t count) {
+            _counts[index] += count;
+            _total += count;
+        }
+
+        void add_summary(uint64_t sum, uint64_t min, uint64_t max) {
+            _sum += sum;
+            _min = std::min(_min, min);
+            _max = std::max(_max, max);
+        }
+
+        void reset() {
+            memset(_counts, 0, sizeof(_counts));
+            _total = 0;
+            _sum = 0;
+            _min = UINT64_MAX;
+            _max = 0;
+        }
+
+        // percentile 取值 [0, 100], 返回不小于该比例记录值的最小桶上界(max 以内)
+        uint64_t percentile(double percentile) const {
+            if(!_total)
+                return 0;
+            uint64_t rank = uint64_t(percentile / 100.0 * _total + 0.5);
+            rank = std::max<uint64_t>(1, std::min(rank, _total));
+            uint64_t seen = 0;
+            for(uint32_t i = 0; i < N_COUNTS; ++i) {
+                seen += _counts[i];
+                if(seen >= rank)
+                    return std::min(highest_equivalent(i), _max);
+            }
+            return _max;
+        }
+
+        uint64_t count() const { return _total; }
+        uint64_t sum()   const { return _sum; }
+        uint64_t min()   const { return _total ? _min : 0; }
+        uint64_t max()   const { return _max; }
+        double   mean()  const { return _total ? double(_sum) / _total : 0; }
+
+        // 小于 SUB_BUCKETS 的值精确记录; 其余的值按最高位所在的 2 的幂区间(shift)分组, 每组 HALF 个子桶
+        static uint32_t index_of(uint64_t value) {
+            if(value < SUB_BUCKETS)
+                return uint32_t(value);
+            uint32_t shift = 63 - __builtin_clzll(value) - (BITS - 1);
+            return shift * HALF + uint32_t(value >> shift);
+        }
+
+        static uint64_t highest_equivalent(uint32_t index) {
+            if(index < SUB_BUCKETS)
+                return index;
+            uint32_t shift = index / HALF - 1;
+            uint64_t sub = index - shift * HALF;
+            return ((sub + 1) << shift) - 1;
+        }
+
+    private:
+        uint64_t _counts[N_COUNTS];
+        uint64_t _total;
+        uint64_t _sum;
+        uint64_t _min;
+        uint64_t _max;
+
+    };
+
+    using histogram = basic_histogram<HISTOGRAM_SUB_BUCKET_BITS>;
+
+}
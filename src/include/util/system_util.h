@@ -6,4 +6,7 @@ namespace tcp_kit {
 
     int64_t numb_of_processor();
 
+    // 进程累计使用的 CPU 时间(用户态 + 内核态), 单位微秒
+    int64_t process_cpu_time_us();
+
 }
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+
+#define TW_ROOT_BITS   8
+#define TW_LEVEL_BITS  6
+#define TW_LEVELS      3
+#define TW_ROOT_SIZE   (1 << TW_ROOT_BITS)
+#define TW_LEVEL_SIZE  (1 << TW_LEVEL_BITS)
+#define TW_MAX_TICKS   ((uint64_t(1) << (TW_ROOT_BITS + TW_LEVELS * TW_LEVEL_BITS)) - 1)
+
+namespace tcp_kit {
+
+    using timer_callback = void (*)(void *arg);
+
+    // 侵入式定时器节点, 由使用者持有(如嵌入 ev_context), 时间轮只负责链接, 不负责分配与释放
+    struct timer_node {
+        timer_node     *prev;
+        timer_node     *next;
+        uint64_t        expire;   // 到期的 tick
+        timer_callback  callback;
+        void           *arg;
+    };
+
+    // 分层时间轮(参考 Linux 内核早期的 timer wheel 实现)
+    // 第 0 层有 256 个槽位, 每个槽位对应 1 个 tick; 之后的 3 层各有 64 个槽位, 每个槽位覆盖上一层的一整圈.
+    // 每当第 0 层转完一圈, 就将上一层当前槽位中的节点重新散列到下层(cascade), 节点总是在到期的那个 tick 被回调.
+    //
+    // arm / cancel 均为 O(1), advance 每推进一个 tick 的均摊代价为 O(1) 加上到期节点数. 可表示的最大延时为 2^26 - 1
+    // 个 tick, 超出时按最大延时处理.
+    //
+    // 时间轮不是线程安全的, 每个 ev_handler 持有一个, 只在其事件循环线程中使用
+    class timing_wheel {
+
+    public:
+        timing_wheel();
+
+        // 在 ticks 个 tick 之后回调节点, 节点已在时间轮中时重新设置到期时间
+        void arm(timer_node *node, uint64_t ticks);
+
+        // 取消节点, 节点不在时间轮中时什么也不做
+        void cancel(timer_node *node);
+
+        // 推进到第 to 个 tick 为止, 依次回调到期的节点. 回调中可以重新 arm 或 cancel 任意节点
+        void advance(uint64_t to);
+
+        uint64_t now() const;
+
+        static bool armed(const timer_node *node);
+
+        timing_wheel(const timing_wheel&) = delete;
+        timing_wheel& operator=(const timing_wheel&) = delete;
+
+    private:
+        timer_node  _root[TW_ROOT_SIZE];
+        timer_node  _levels[TW_LEVELS][TW_LEVEL_SIZE];
+        uint64_t    _current;
+
+        void add(timer_node *node);
+        uint32_t cascade(uint32_t level);
+        void tick();
+
+    };
+
+}
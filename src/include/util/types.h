@@ -26,3 +26,11 @@ template <typename Target, typename Replacement>
 struct replace_type<type_list<>, Target, Replacement> {
     using type = type_list<>;
 };
+
+template <typename A, typename B>
+struct concat_types;
+
+template <typename... A, typename... B>
+struct concat_types<type_list<A...>, type_list<B...>> {
+    using type = type_list<A..., B...>;
+};
@@ -3,9 +3,9 @@
 
 namespace tcp_kit {
 
-    std::unique_ptr<GenericMsg> json::json_deserializer::process(msg_context *ctx, std::unique_ptr<msg_buffer> input) {
+    std::unique_ptr<GenericMsg> json::json_deserializer::process(msg_context *ctx, msg_buffer input) {
         std::unique_ptr<GenericMsg> generic_msg(new GenericMsg);
-        std::string json_str(input->ptr);
+        std::string json_str(input.ptr, input.size);
         if(google::protobuf::util::JsonStringToMessage(json_str, generic_msg.get()).ok()) {
             return generic_msg;
         } else {
@@ -13,15 +13,30 @@ namespace tcp_kit {
         }
     }
 
-    std::unique_ptr<msg_buffer> json::json_serializer::process(msg_context *ctx, std::unique_ptr<GenericReply> reply) {
+    msg_buffer json::json_serializer::process(msg_context *ctx, std::unique_ptr<GenericReply> reply) {
+        metrics::scoped_timer timer(metrics::SERIALIZE_NS);
+        ctx->reply_code = uint16_t(reply->code());
+        if(ctx->seq)
+            reply->set_seq(ctx->seq);
         std::string json_string;
-        GenericReply reply_c(*reply);
-        google::protobuf::util::MessageToJsonString(reply_c, &json_string);
-        std::unique_ptr<msg_buffer> output(new msg_buffer(json_string.size() + 2));
-        memcpy(output->ptr, json_string.c_str(), json_string.size());
-        output->ptr[json_string.size()] = '\r';
-        output->ptr[json_string.size() + 1] = '\n';
+        google::protobuf::util::MessageToJsonString(*reply, &json_string);
+        msg_buffer output(json_string.size() + 2);
+        memcpy(output.ptr, json_string.c_str(), json_string.size());
+        output.ptr[json_string.size()] = '\r';
+        output.ptr[json_string.size() + 1] = '\n';
         return output;
     }
 
+    std::string json::json_codec::encode(const GenericMsg &msg) {
+        std::string frame;
+        if(!google::protobuf::util::MessageToJsonString(msg, &frame).ok())
+            throw generic_error<SERIALIZE_MSG_ERROR>("Failed to serialize GenericMsg to json");
+        frame.append("\r\n", 2);
+        return frame;
+    }
+
+    bool json::json_codec::decode(const char *frame, size_t len, GenericReply &reply) {
+        return google::protobuf::util::JsonStringToMessage(std::string(frame, len), &reply).ok();
+    }
+
 }
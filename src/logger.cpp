@@ -1,51 +1,343 @@
 #include <logger/logger.h>
 #include <unistd.h>
 #include <time.h>
-#include <utility>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static_assert((LOG_BUFFER_SIZE & (LOG_BUFFER_SIZE - 1)) == 0, "LOG_BUFFER_SIZE must be a power of 2");
+static_assert(LOG_BUFFER_SIZE >= 2 * LOG_LINE_MAX, "LOG_BUFFER_SIZE must hold at least two lines");
 
 static const char* LEVEL_NAMES[] = {"DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
 static const char* LEVEL_COLORS[] = {"\x1b[94m", "\x1b[36m", "\x1b[32m", "\x1b[33m", "\x1b[31m", "\x1b[35m"};
 static const char* COLOR_RESET = "\x1b[0m";
 
+namespace {
 
-inline int snprintf_base_msg(char* ptr, uint32_t size, uint8_t level, const char* file, uint32_t line, const tm* local_time);
+    using tcp_kit::logging::deferred_head;
 
-// time pid [level] file line log
-void log(uint8_t level, const char* file, uint32_t line, const char* fmt, ...) {
-    if(level >= LOG_LEVEL) {
-        va_list args;
-        va_start(args, fmt);
-        auto current_time = time(nullptr);
-        auto* local_time = localtime(&current_time);
-        auto base_msg_length = snprintf_base_msg(nullptr, 0, level, file, line, local_time);
-        auto log_length = base_msg_length + vsnprintf(nullptr, 0, fmt, args);
-        va_start(args, fmt);
-        auto log_str = std::make_unique<char[]>(log_length + 2);
-        snprintf_base_msg(log_str.get(), base_msg_length + 1, level, file, line, local_time);
-        vsprintf(log_str.get() + base_msg_length, fmt, args);
-        va_end(args);
-        log_str[log_length] = '\n';
-        log_str[log_length + 1] = '\0';
-        if(level != LOG_ERROR) {
-            printf("%s", log_str.get());
-        } else {
-            fprintf(stderr, "%s", log_str.get());
+    enum record_kind: uint8_t { TEXT, DEFERRED };
+
+    const uint32_t HEADER_SIZE = sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint8_t);
+    const size_t   BATCH_SIZE  = 64 * 1024;
+    // 延迟格式化的记录在写出时的最大长度(含前缀与抑制计数)
+    const size_t   RENDER_MAX  = LOG_LINE_MAX + 128;
+
+    pid_t cached_pid = getpid();
+
+    // 每个线程缓存格式化后的时间, 每毫秒至多刷新一次, 秒数变化时才调用 localtime_r
+    const char* timestamp(int64_t ms) {
+        struct clock_cache {
+            time_t  sec = -1;
+            int64_t ms  = -1;
+            char    text[32];
+        };
+        static thread_local clock_cache c;
+        if(ms != c.ms) {
+            time_t sec = time_t(ms / 1000);
+            if(sec != c.sec) {
+                tm local_time;
+                localtime_r(&sec, &local_time);
+                strftime(c.text, sizeof(c.text), "%m-%d %H:%M:%S", &local_time);
+                c.sec = sec;
+            }
+            snprintf(c.text + 14, sizeof(c.text) - 14, ".%03d", int(ms % 1000));
+            c.ms = ms;
+        }
+        return c.text;
+    }
+
+    // time pid [level] file line: 
+    size_t format_prefix(char *out, size_t size, int64_t ms, uint8_t level, const char *file, uint32_t line) {
+        int n = snprintf(out, size, "%s %d %s[%s]%s %s %d: ", timestamp(ms), cached_pid,
+                         LEVEL_COLORS[level], LEVEL_NAMES[level], COLOR_RESET, file, line);
+        return std::min(size_t(std::max(n, 0)), size - 1);
+    }
+
+    // 在后台线程中格式化延迟的记录, 返回写入 out 的长度(含换行)
+    size_t render(char *out, uint8_t level, const char *record) {
+        deferred_head head;
+        memcpy(&head, record, sizeof(head));
+        size_t len = format_prefix(out, LOG_LINE_MAX, head.time_ms, level, head.file, head.line);
+        int m = head.formatter(out + len, LOG_LINE_MAX - len, head.fmt, record + sizeof(head));
+        len = std::min(len + size_t(std::max(m, 0)), size_t(LOG_LINE_MAX) - 1);
+        if(head.suppressed)
+            len += snprintf(out + len, RENDER_MAX - len - 1, " (%u similar record(s) suppressed)", head.suppressed);
+        out[len++] = '\n';
+        return len;
+    }
+
+    // 后台线程写出的批, 满时或一轮结束时以一次 write 写出
+    struct batch {
+        int    fd;
+        size_t len;
+        char   buf[BATCH_SIZE];
+
+        explicit batch(int fd_): fd(fd_), len(0) { }
+
+        char* reserve(size_t n) {
+            if(len + n > BATCH_SIZE)
+                flush();
+            char *p = buf + len;
+            len += n;
+            return p;
+        }
+
+        void flush() {
+            size_t off = 0;
+            while(off < len) {
+                ssize_t n = ::write(fd, buf + off, len - off);
+                if(n < 0 && errno == EINTR)
+                    continue;
+                if(n <= 0)
+                    break;
+                off += size_t(n);
+            }
+            len = 0;
+        }
+    };
+
+    // 单生产者(所属线程)单消费者(后台线程)的字节环形缓冲区, 每条记录为 [uint32_t 长度][uint8_t 级别][文本]
+    struct log_ring {
+        std::atomic<uint64_t> head {0};         // 生产者写入的位置
+        std::atomic<uint64_t> tail {0};         // 消费者读到的位置
+        std::atomic<uint64_t> dropped {0};      // 只由生产者写入
+        std::atomic<bool>     closed {false};   // 所属线程已退出, 读完后由后台线程释放
+        uint64_t              reported = 0;     // 后台线程已报告的丢弃数
+        char                  data[LOG_BUFFER_SIZE];
+
+        void copy_in(uint64_t pos, const void *src, size_t n) {
+            size_t off = size_t(pos & (LOG_BUFFER_SIZE - 1));
+            size_t first = std::min(n, size_t(LOG_BUFFER_SIZE) - off);
+            memcpy(data + off, src, first);
+            memcpy(data, static_cast<const char*>(src) + first, n - first);
+        }
+
+        void copy_out(uint64_t pos, void *dst, size_t n) const {
+            size_t off = size_t(pos & (LOG_BUFFER_SIZE - 1));
+            size_t first = std::min(n, size_t(LOG_BUFFER_SIZE) - off);
+            memcpy(dst, data + off, first);
+            memcpy(static_cast<char*>(dst) + first, data, n - first);
+        }
+
+        bool push(uint8_t level, uint8_t kind, const char *text, uint32_t len) {
+            uint64_t h = head.load(std::memory_order_relaxed);
+            uint64_t t = tail.load(std::memory_order_acquire);
+            if(LOG_BUFFER_SIZE - (h - t) < HEADER_SIZE + len) {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+            copy_in(h, &len, sizeof(len));
+            copy_in(h + sizeof(len), &level, sizeof(level));
+            copy_in(h + sizeof(len) + sizeof(level), &kind, sizeof(kind));
+            copy_in(h + HEADER_SIZE, text, len);
+            head.store(h + HEADER_SIZE + len, std::memory_order_release);
+            return true;
+        }
+
+        // 取出所有已写入的记录, 返回是否取到. record 用于拷出延迟格式化的记录
+        bool drain(batch &out, batch &err, char *record) {
+            uint64_t h = head.load(std::memory_order_acquire);
+            uint64_t t = tail.load(std::memory_order_relaxed);
+            if(t == h)
+                return false;
+            while(t < h) {
+                uint32_t len;
+                uint8_t level, kind;
+                copy_out(t, &len, sizeof(len));
+                copy_out(t + sizeof(len), &level, sizeof(level));
+                copy_out(t + sizeof(len) + sizeof(level), &kind, sizeof(kind));
+                batch &b = level == LOG_ERROR ? err : out;
+                if(kind == TEXT) {
+                    copy_out(t + HEADER_SIZE, b.reserve(len), len);
+                } else {
+                    copy_out(t + HEADER_SIZE, record, len);
+                    char *p = b.reserve(RENDER_MAX);
+                    b.len -= RENDER_MAX - render(p, level, record);
+                }
+                t += HEADER_SIZE + len;
+            }
+            tail.store(t, std::memory_order_release);
+            return true;
+        }
+    };
+
+    struct logger_state {
+        std::mutex              mutex;      // 保护以下除 started 之外的成员
+        std::condition_variable wake;
+        std::condition_variable flushed;
+        std::vector<log_ring*>  rings;
+        uint64_t                requested = 0;
+        uint64_t                completed = 0;
+        uint64_t                retired_dropped = 0;
+        std::atomic<bool>       started {false};
+    };
+
+    // 不析构: 进程退出时其他线程仍可能在写日志
+    logger_state*& state_ptr() {
+        static logger_state *s = new logger_state;
+        return s;
+    }
+
+    logger_state& state() {
+        return *state_ptr();
+    }
+
+    struct ring_holder {
+        log_ring *ring = nullptr;
+        ~ring_holder() {
+            if(ring)
+                ring->closed.store(true, std::memory_order_release);
+            ring = nullptr;
+        }
+    };
+
+    thread_local ring_holder local;
+
+    void writer_loop(logger_state *s) {
+        std::unique_ptr<batch> out(new batch(STDOUT_FILENO)), err(new batch(STDERR_FILENO));
+        std::unique_ptr<char[]> record(new char[LOG_LINE_MAX]);
+        std::vector<log_ring*> rings;
+        std::unique_lock<std::mutex> lock(s->mutex);
+        while(true) {
+            uint64_t requested = s->requested;
+            rings = s->rings;
+            lock.unlock();
+            bool drained = false;
+            for(log_ring *r: rings) {
+                drained |= r->drain(*out, *err, record.get());
+                uint64_t dropped = r->dropped.load(std::memory_order_relaxed);
+                if(dropped != r->reported) {
+                    char *p = err->reserve(64);
+                    err->len -= 64 - snprintf(p, 64, "%llu log record(s) dropped\n",
+                                              (unsigned long long) (dropped - r->reported));
+                    r->reported = dropped;
+                }
+            }
+            out->flush();
+            err->flush();
+            lock.lock();
+            // 线程退出后关闭标志之前的记录都已可见, 再次确认读完后释放
+            for(auto it = s->rings.begin(); it != s->rings.end(); ) {
+                log_ring *r = *it;
+                if(r->closed.load(std::memory_order_acquire) &&
+                   r->head.load(std::memory_order_acquire) == r->tail.load(std::memory_order_relaxed) &&
+                   r->dropped.load(std::memory_order_relaxed) == r->reported) {
+                    s->retired_dropped += r->reported;
+                    it = s->rings.erase(it);
+                    delete r;
+                } else {
+                    ++it;
+                }
+            }
+            s->completed = requested;
+            s->flushed.notify_all();
+            if(!drained && s->requested == requested)
+                s->wake.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS));
+        }
+    }
+
+    void at_exit() {
+        log_flush();
+    }
+
+    void before_fork() {
+        state().mutex.lock();
+    }
+
+    void after_fork_parent() {
+        state().mutex.unlock();
+    }
+
+    // 子进程中只有调用 fork 的线程, 原状态(已加锁)弃用, 只保留该线程的缓冲区. 其中未写出的记录由父进程写出
+    void after_fork_child() {
+        logger_state *s = new logger_state;
+        if(local.ring) {
+            local.ring->tail.store(local.ring->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            s->rings.push_back(local.ring);
+        }
+        state_ptr() = s;
+        cached_pid = getpid();
+    }
+
+    void start_writer() {
+        static std::once_flag once;
+        std::call_once(once, [] {
+            atexit(at_exit);
+            pthread_atfork(before_fork, after_fork_parent, after_fork_child);
+        });
+        logger_state &s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if(!s.started.load(std::memory_order_relaxed)) {
+            std::thread(writer_loop, &s).detach();
+            s.started.store(true, std::memory_order_release);
+        }
+    }
+
+    log_ring* local_ring() {
+        if(!local.ring) {
+            log_ring *r = new log_ring;
+            logger_state &s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.rings.push_back(r);
+            local.ring = r;
         }
+        return local.ring;
+    }
+
+    void push(uint8_t level, uint8_t kind, const char *record, uint32_t len) {
+        if(!state().started.load(std::memory_order_acquire))
+            start_writer();
+        local_ring()->push(level, kind, record, len);
     }
+
 }
 
+void log(uint8_t level, const char* file, uint32_t line, const char* fmt, ...) {
+    if(level < LOG_LEVEL)
+        return;
+    char buf[LOG_LINE_MAX];
+    size_t len = format_prefix(buf, sizeof(buf), tcp_kit::logging::coarse_now_ms(), level, file, line);
+    va_list args;
+    va_start(args, fmt);
+    int m = vsnprintf(buf + len, sizeof(buf) - len, fmt, args);
+    va_end(args);
+    len = std::min(len + size_t(std::max(m, 0)), sizeof(buf) - 1);
+    buf[len++] = '\n';
+    push(level, TEXT, buf, uint32_t(len));
+    if(level == LOG_FATAL)
+        log_flush();
+}
+
+void tcp_kit::logging::push_deferred(uint8_t level, const char *record, uint32_t len) {
+    push(level, DEFERRED, record, len);
+}
 
-int snprintf_base_msg(char* ptr, uint32_t size, uint8_t level, const char* file, uint32_t line, const tm* time) {
-    return snprintf(ptr, size, "%02d-%02d %02d:%02d:%02d %d %s[%s]%s %s %d: ",
-                    time->tm_mon + 1,
-                    time->tm_mday,
-                    time->tm_hour,
-                    time->tm_min,
-                    time->tm_sec,
-                    getpid(),
-                    LEVEL_COLORS[level],
-                    LEVEL_NAMES[level],
-                    COLOR_RESET,
-                    file,
-                    line);
-}
\ No newline at end of file
+void log_flush() {
+    logger_state &s = state();
+    std::unique_lock<std::mutex> lock(s.mutex);
+    if(!s.started.load(std::memory_order_relaxed))
+        return;
+    uint64_t target = ++s.requested;
+    s.wake.notify_one();
+    s.flushed.wait(lock, [&s, target] { return s.completed >= target; });
+}
+
+uint64_t log_dropped() {
+    logger_state &s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    uint64_t dropped = s.retired_dropped;
+    for(log_ring *r: s.rings)
+        dropped += r->dropped.load(std::memory_order_relaxed);
+    return dropped;
+}
@@ -0,0 +1,45 @@
+#include <network/mailbox.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+namespace tcp_kit {
+
+    shared_payload::shared_payload(size_t len_): len(len_), _refs(1) { }
+
+    shared_payload *shared_payload::make(const void *data, size_t len) {
+        void *mem = malloc(sizeof(shared_payload) + len);
+        if(!mem)
+            throw std::bad_alloc();
+        auto *payload = new (mem) shared_payload(len);
+        memcpy(reinterpret_cast<char *>(payload + 1), data, len);
+        return payload;
+    }
+
+    const char *shared_payload::data() const {
+        return reinterpret_cast<const char *>(this + 1);
+    }
+
+    void shared_payload::retain(uint32_t n) {
+        _refs.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void shared_payload::release() {
+        if(_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            this->~shared_payload();
+            free(this);
+        }
+    }
+
+    bool shared_payload::add_to(evbuffer *buf) {
+        retain();
+        if(evbuffer_add_reference(buf, data(), len,
+                                  [](const void *, size_t, void *arg) { static_cast<shared_payload *>(arg)->release(); },
+                                  this) != 0) {
+            release();
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -7,6 +7,26 @@
 #include <test/tcp_util_test.hpp>
 #include <test/lock_free_queue_test.hpp>
 #include <test/lock_free_queue_nb_test.hpp>
+#include <test/timing_wheel_test.hpp>
+#include <test/conn_table_test.hpp>
+#include <test/client_test.hpp>
+#include <test/metrics_test.hpp>
+#include <test/logger_test.hpp>
+#include <test/access_log_test.hpp>
+#include <test/trace_test.hpp>
+#include <test/filter_chain_test.hpp>
+#include <test/listener_test.hpp>
+#include <test/tls_test.hpp>
+#include <test/compress_test.hpp>
+#include <test/stream_test.hpp>
+#include <test/timeout_test.hpp>
+#include <test/limiter_test.hpp>
+#include <test/pubsub_test.hpp>
+#include <test/backpressure_test.hpp>
+#include <test/throttle_test.hpp>
+#include <test/deadline_test.hpp>
+#include <test/mailbox_test.hpp>
+#include <test/coroutine_test.hpp>
 #include <util/func_traits.h>
 #include <network/filter_chain.h>
 #include <test/func_traits_test.h>
@@ -23,6 +43,8 @@ int main() {
 //    tcp_kit::server_test::log_server_by_libevent();
 //    tcp_kit::server_test::log_server();
 //    tcp_kit::server_test::chat_room();
+//    tcp_kit::server_test::fan_out_bench();
+//    tcp_kit::server_test::coroutine_api();
     tcp_kit::server_test::file_system();
     return 0;
 }
@@ -0,0 +1,215 @@
+#include <metrics/metrics.h>
+#include <logger/logger.h>
+#include <event2/event.h>
+#include <event2/http.h>
+#include <event2/buffer.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tcp_kit {
+
+    namespace metrics {
+
+        namespace {
+
+            struct descriptor {
+                const char *name;   // __metrics 中的名称
+                const char *prom;   // Prometheus 中的名称(不含前缀与 _total)
+                const char *help;
+                double      scale;  // Prometheus 输出时的单位换算
+            };
+
+            const descriptor counter_desc[N_COUNTERS] = {
+                {"conn_accepted",   "conn_accepted",       "Accepted connections",                      1},
+                {"conn_closed",     "conn_closed",         "Closed connections",                        1},
+                {"conn_throttled",  "conn_throttled",      "Connections throttled as slow consumers",   1},
+                {"conn_unthrottled","conn_unthrottled",    "Connections released from throttling",      1},
+                {"frames_in",       "frames_in",           "Complete frames read",                      1},
+                {"bytes_in",        "bytes_in",            "Bytes of the frames read",                  1},
+                {"msg_enqueued",    "msg_enqueued",        "Messages handed to the handlers",           1},
+                {"msg_rejected",    "msg_rejected",        "Messages rejected for overload",            1},
+                {"msg_dequeued",    "msg_dequeued",        "Messages taken by the handlers",            1},
+                {"api_calls",       "api_calls",           "API invocations",                           1},
+                {"api_errors",      "api_errors",          "API invocations replied with an error",     1},
+                {"replies_out",     "replies_out",         "Replies written to the output buffers",     1},
+                {"bytes_out",       "bytes_out",           "Bytes of the replies written",              1},
+                {"handler_busy_ns", "handler_busy_seconds","Time spent by the handlers on messages",    1e-9},
+                {"tls_handshakes",  "tls_handshakes",      "Completed TLS handshakes",                  1},
+                {"tls_resumed",     "tls_resumed",         "TLS handshakes resuming a session",         1},
+                {"tls_ktls",        "tls_ktls",            "TLS connections sending through kernel TLS", 1}
+            };
+
+            const descriptor histogram_desc[N_HISTOGRAMS] = {
+                {"frame_bytes",     "frame_bytes",         "Size of the frames read",                   1},
+                {"queue_wait_ns",   "queue_wait_seconds",  "Time from enqueue to dequeue",              1e-9},
+                {"process_ns",      "process_seconds",     "Time spent in the filter chain",            1e-9},
+                {"api_ns",          "api_seconds",         "Time spent in the API handlers",            1e-9},
+                {"serialize_ns",    "serialize_seconds",   "Time spent serializing the replies",        1e-9},
+                {"request_ns",      "request_seconds",     "Time from enqueue to the reply written",    1e-9}
+            };
+
+            const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+            std::mutex& shards_mutex() {
+                static std::mutex m;
+                return m;
+            }
+
+            std::vector<shard*>& shards() {
+                static std::vector<shard*> s;
+                return s;
+            }
+
+            void append(std::string &out, const char *fmt, ...) {
+                char buf[256];
+                va_list args;
+                va_start(args, fmt);
+                int len = vsnprintf(buf, sizeof(buf), fmt, args);
+                va_end(args);
+                if(len > 0)
+                    out.append(buf, std::min<size_t>(size_t(len), sizeof(buf) - 1));
+            }
+
+            // 不换算单位的值按整数输出, 避免大的计数丢失精度
+            void append_value(std::string &out, uint64_t value, double scale) {
+                if(scale == 1)
+                    append(out, "%llu\n", (unsigned long long) value);
+                else
+                    append(out, "%.9g\n", value * scale);
+            }
+
+        }
+
+        void shard_histogram::merge_into(shard_histogram_t &out) const {
+            for(uint32_t i = 0; i < shard_histogram_t::N_COUNTS; ++i) {
+                uint64_t c = _counts[i].load(std::memory_order_relaxed);
+                if(c)
+                    out.add_bucket(i, c);
+            }
+            out.add_summary(_sum.load(std::memory_order_relaxed), _min.load(std::memory_order_relaxed),
+                            _max.load(std::memory_order_relaxed));
+        }
+
+        shard* register_shard() {
+            shard *s = new shard;
+            std::lock_guard<std::mutex> lock(shards_mutex());
+            shards().push_back(s);
+            return s;
+        }
+
+        const char* name_of(counter_id id) {
+            return counter_desc[id].name;
+        }
+
+        const char* name_of(histogram_id id) {
+            return histogram_desc[id].name;
+        }
+
+        void collect(snapshot &out) {
+            memset(out.counters, 0, sizeof(out.counters));
+            for(shard_histogram_t &h: out.histograms)
+                h.reset();
+            std::lock_guard<std::mutex> lock(shards_mutex());
+            for(shard *s: shards()) {
+                for(uint32_t i = 0; i < N_COUNTERS; ++i)
+                    out.counters[i] += s->counters[i].load(std::memory_order_relaxed);
+                for(uint32_t i = 0; i < N_HISTOGRAMS; ++i)
+                    s->histograms[i].merge_into(out.histograms[i]);
+            }
+        }
+
+        std::string to_json() {
+            std::unique_ptr<snapshot> snap(new snapshot);
+            collect(*snap);
+            std::string out;
+            append(out, "{\"connections\":%llu,\"queue_depth\":%llu,\"throttled\":%llu,\"counters\":{",
+                   (unsigned long long) snap->connections(), (unsigned long long) snap->queue_depth(),
+                   (unsigned long long) snap->throttled());
+            for(uint32_t i = 0; i < N_COUNTERS; ++i)
+                append(out, "%s\"%s\":%llu", i ? "," : "", counter_desc[i].name, (unsigned long long) snap->counters[i]);
+            out += "},\"histograms\":{";
+            for(uint32_t i = 0; i < N_HISTOGRAMS; ++i) {
+                const shard_histogram_t &h = snap->histograms[i];
+                append(out, "%s\"%s\":{\"count\":%llu,\"mean\":%.1f,\"min\":%llu,\"p50\":%llu,\"p90\":%llu,"
+                            "\"p99\":%llu,\"p999\":%llu,\"max\":%llu}",
+                       i ? "," : "", histogram_desc[i].name, (unsigned long long) h.count(), h.mean(),
+                       (unsigned long long) h.min(), (unsigned long long) h.percentile(50),
+                       (unsigned long long) h.percentile(90), (unsigned long long) h.percentile(99),
+                       (unsigned long long) h.percentile(99.9), (unsigned long long) h.max());
+            }
+            out += "}}";
+            return out;
+        }
+
+        std::string to_prometheus() {
+            std::unique_ptr<snapshot> snap(new snapshot);
+            collect(*snap);
+            std::string out;
+            for(uint32_t i = 0; i < N_COUNTERS; ++i) {
+                const descriptor &d = counter_desc[i];
+                append(out, "# HELP tcp_kit_%s_total %s\n# TYPE tcp_kit_%s_total counter\n", d.prom, d.help, d.prom);
+                append(out, "tcp_kit_%s_total ", d.prom);
+                append_value(out, snap->counters[i], d.scale);
+            }
+            append(out, "# HELP tcp_kit_connections Open connections\n# TYPE tcp_kit_connections gauge\n"
+                        "tcp_kit_connections %llu\n", (unsigned long long) snap->connections());
+            append(out, "# HELP tcp_kit_queue_depth Messages waiting for the handlers\n# TYPE tcp_kit_queue_depth gauge\n"
+                        "tcp_kit_queue_depth %llu\n", (unsigned long long) snap->queue_depth());
+            append(out, "# HELP tcp_kit_throttled_connections Connections throttled as slow consumers\n"
+                        "# TYPE tcp_kit_throttled_connections gauge\n"
+                        "tcp_kit_throttled_connections %llu\n", (unsigned long long) snap->throttled());
+            for(uint32_t i = 0; i < N_HISTOGRAMS; ++i) {
+                const descriptor &d = histogram_desc[i];
+                const shard_histogram_t &h = snap->histograms[i];
+                append(out, "# HELP tcp_kit_%s %s\n# TYPE tcp_kit_%s summary\n", d.prom, d.help, d.prom);
+                for(double q: quantiles) {
+                    append(out, "tcp_kit_%s{quantile=\"%g\"} ", d.prom, q);
+                    append_value(out, h.percentile(q * 100), d.scale);
+                }
+                append(out, "tcp_kit_%s_sum ", d.prom);
+                append_value(out, h.sum(), d.scale);
+                append(out, "tcp_kit_%s_count %llu\n", d.prom, (unsigned long long) h.count());
+            }
+            return out;
+        }
+
+        bool serve_prometheus(uint16_t port, const std::string &address) {
+            static std::once_flag once;
+            static bool served = false;
+            std::call_once(once, [port, &address] {
+                event_base *base = event_base_new();
+                evhttp *http = base ? evhttp_new(base) : nullptr;
+                if(!http || evhttp_bind_socket(http, address.c_str(), port) != 0) {
+                    log_error("Cannot serve the metrics on %s:%d", address.c_str(), port);
+                    if(http) evhttp_free(http);
+                    if(base) event_base_free(base);
+                    return;
+                }
+                evhttp_set_cb(http, "/metrics", [](evhttp_request *req, void *) {
+                    std::string body = to_prometheus();
+                    evbuffer *buf = evbuffer_new();
+                    evbuffer_add(buf, body.data(), body.size());
+                    evhttp_add_header(evhttp_request_get_output_headers(req), "Content-Type",
+                                      "text/plain; version=0.0.4");
+                    evhttp_send_reply(req, HTTP_OK, "OK", buf);
+                    evbuffer_free(buf);
+                }, nullptr);
+                served = true;
+                log_info("The metrics are served on %s:%d/metrics", address.c_str(), port);
+                // 进程退出前不停止
+                std::thread([base] {
+                    event_base_dispatch(base);
+                }).detach();
+            });
+            return served;
+        }
+
+    }
+
+}
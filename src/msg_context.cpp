@@ -1,19 +1,57 @@
 #include <network/msg_context.h>
+#include <metrics/trace.h>
 #include <event2/event.h>
 #include <assert.h>
 
 namespace tcp_kit {
 
+    using std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    void msg_context::set_timeout(milliseconds timeout) {
+        steady_clock::time_point d = enqueued_at + timeout;
+        if(deadline == steady_clock::time_point() || d < deadline)
+            deadline = d;
+    }
+
+    milliseconds msg_context::remaining() const {
+        if(deadline == steady_clock::time_point())
+            return milliseconds::max();
+        steady_clock::time_point now = steady_clock::now();
+        return now < deadline ? std::chrono::duration_cast<milliseconds>(deadline - now) : milliseconds(0);
+    }
+
+    bool msg_context::expired() const {
+        return deadline != steady_clock::time_point() && steady_clock::now() >= deadline;
+    }
+
+    void msg_context::defer() {
+        deferred = true;
+        holds.store(2, std::memory_order_relaxed);
+    }
+
+    void msg_context::complete() {
+        if(holds.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            if(error_flag)
+                error();
+            else
+                done();
+        }
+    }
+
     void msg_context::done() {
-        assert(!callback_fired);
-        event_active(done_ev, 0, 0);
+        assert(!event_fired);
+        trace::mark(trace_id, trace_mark, trace::DONE);
+        // 激活事件后 msg_context 可能随即被 ev_handler 线程释放, 标志必须在此之前设置
         event_fired = true;
+        event_active(done_ev, 0, 0);
     }
 
     void msg_context::error() {
-        assert(!callback_fired);
-        event_active(error_ev, 0, 0);
+        assert(!event_fired);
+        // 激活事件后 msg_context 可能随即被 ev_handler 线程释放, 标志必须在此之前设置
         event_fired = true;
+        event_active(error_ev, 0, 0);
     }
 
 }
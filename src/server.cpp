@@ -5,7 +5,25 @@
 
 namespace tcp_kit {
 
-    server_base::server_base(std::shared_ptr<filter_chain> filters_): _ctl(NEW), _filters(filters_) { }
+    server_base::server_base(uint16_t port, std::shared_ptr<filter_chain> filters_): _ctl(NEW), _filters(filters_) {
+        _endpoints.push_back({port, filters_, true});
+    }
+
+    void server_base::add_endpoint(uint16_t port, std::shared_ptr<filter_chain> filters_, bool publishable) {
+        for(const endpoint &e : _endpoints)
+            if(e.port == port)
+                throw std::invalid_argument("The port is already listened by the server");
+        _endpoints.push_back({port, std::move(filters_), publishable});
+    }
+
+    void server_base::encode_publication(filter_chain *chain, void *publication, char *&data, size_t &len) {
+        msg_context ctx{};
+        std::unique_ptr<msg_buffer> buf = chain->encode(&ctx, publication);
+        if(!buf)
+            throw std::logic_error("The filter chain cannot encode a publication");
+        data = buf->ptr;
+        len = buf->size;
+    }
 
     void server_base::trans_to(uint32_t rs) {
         std::unique_lock<std::mutex> lock(_mutex);
@@ -42,7 +60,8 @@ namespace tcp_kit {
 
     // -----------------------------------------------------------------------------------------------------------------
 
-    ev_handler_base::ev_handler_base(): n_handler(0), accept_ev(nullptr) { }
+    ev_handler_base::ev_handler_base(): n_handler(0), accept_ev(nullptr), n_throttled(0), writer_block(0),
+                                        _n_writable_waiters(0), _mailbox_ev(nullptr) { }
 
     void ev_handler_base::bind_and_run(server_base* server_ptr) {
         assert(server_ptr);
@@ -55,42 +74,53 @@ namespace tcp_kit {
         run();
     }
 
+    // 异常交由调用方以错误断开连接, 不能忽略: 例如 TLS 过滤器失败后连接不能以明文继续
     void ev_handler_base::call_conn_filters(ev_context* ctx) {
-        try {
-            _filters->connects(ctx);
-        } catch (...) {
-            // TODO
-        }
-    }
-
-    inline size_t max(const size_t& a, const size_t& b) {
-        return a > b ? a : b;
+        ctx->filters->connects(ctx);
     }
 
     void ev_handler_base::register_read_write_filters(ev_context* ctx) {
-        auto &reads = _filters->reads;
-        auto &writes = _filters->writes;
-        for(size_t i = 0; i < max(reads.size(), writes.size()); ++i) {
-            bufferevent* nested_bev = bufferevent_filter_new(ctx->bev,
-                                                             i < reads.size() ? reads[i] : nullptr,
-                                                             i < writes.size() ? writes[i] : nullptr,
-                                                             BEV_OPT_CLOSE_ON_FREE, nullptr, ctx);
-            if(nested_bev) {
-                ctx->bev = nested_bev;
-            } else {
-                throw generic_error<CONS_BEV_FAILED>("Failed to register filter with index [%d]", i);
-            }
-        }
+        bufferevent *bev = rw_pipeline::attach(ctx->bev, ctx->filters->reads, ctx->filters->writes, ctx);
+        if(bev)
+            ctx->bev = bev;
+        else
+            throw generic_error<CONS_BEV_FAILED>("Failed to register the read/write filters");
     }
 
     void ev_handler_base::call_close_filters(ev_context* ctx) {
         try {
-            _filters->closes(ctx);
+            ctx->filters->closes(ctx);
         } catch (...) {
             // TODO
         }
     }
 
+    // 限流解除后唤醒等待的推送方
+    void ev_handler_base::notify_writable() {
+        if(_n_writable_waiters.load() && n_throttled.load() == 0) {
+            std::unique_lock<std::mutex> lock(_writable_mutex);
+            _writable.notify_all();
+        }
+    }
+
+    void ev_handler_base::post(mail *m) {
+        if(_mailbox.push(m))
+            event_active(_mailbox_ev, 0, 0);
+    }
+
+    void ev_handler_base::resume(msg_context *ctx, uint32_t delay_ms) {
+        post(new mail{nullptr, mail::RESUME, reinterpret_cast<uintptr_t>(ctx), delay_ms, nullptr});
+    }
+
+    void ev_handler_base::suspend_connect(ev_context *ctx) {
+        // 余下的连接过滤器由 connect_chain_caller 填入
+        ctx->resume_connects = &empty_connect_chain;
+    }
+
+    void ev_handler_base::resume_connect(ev_context *ctx, bool ok, void (*then)(ev_context *, void *), void *arg) {
+        post(new mail{nullptr, mail::CONNECT, reinterpret_cast<uintptr_t>(ctx), ok ? 0u : 1u, nullptr, then, arg});
+    }
+
     // std::unique_ptr<evbuffer_holder> ev_handler_base::call_process_filters(ev_context *ctx) {
     //     auto holder = std::make_unique<evbuffer_holder>(bufferevent_get_input(ctx->bev));
     //     return _filters->process(ctx, move(holder));
@@ -111,8 +141,8 @@ namespace tcp_kit {
         run();
     }
 
-    std::unique_ptr<msg_buffer> handler_base::make_msg_buffer(char *line_msg, size_t len) {
-        return std::unique_ptr<msg_buffer>(new msg_buffer(line_msg, len));
+    msg_buffer handler_base::make_msg_buffer(char *line_msg, size_t len) {
+        return msg_buffer(line_msg, len);
     }
 
 //    std::unique_ptr<evbuffer_holder> handler_base::call_process_filters(ev_context *ctx) {
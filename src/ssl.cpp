@@ -1,101 +1,291 @@
 #include <filter/ssl.h>
 #include <logger/logger.h>
-#include <openssl/crypto.h>
-#include <stdlib.h>
+#include <metrics/metrics.h>
 #include <error/errors.h>
-
-#define _SSLtid pthread_self().p
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <event2/event.h>
+#include <event2/thread.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace tcp_kit {
 
     namespace filters {
 
-        pthread_mutex_t* ssl_ctx_guard::ssl_locks = nullptr;
-        int ssl_ctx_guard::ssl_num_locks = 0;
-        ssl_ctx_guard ssl_ctx_guard::singleton;
+        namespace {
 
-#define SSL_PKEY_FILE "/Users/linruixin/Desktop/pkey" // TODO
-#define SSL_CERT_FILE "/Users/linruixin/Desktop/cert" // TODO
+            std::mutex& config_mutex() {
+                static std::mutex m;
+                return m;
+            }
 
-#if OPENSSL_VERSION_NUMBER < 0x10000000L
-        static unsigned long get_thread_id_cb() {
-            return _SSLtid;
-        }
-#else
-        static void get_thread_id_cb(CRYPTO_THREADID *id) {
-            CRYPTO_THREADID_set_numeric(id, _SSLtid);
-        }
+            tls_options& config() {
+                static tls_options opts;
+                return opts;
+            }
+
+            bool& created() {
+                static bool c = false;
+                return c;
+            }
+
+            std::string last_error() {
+                char buf[256];
+                unsigned long err = ERR_get_error();
+                if(!err)
+                    return "unknown error";
+                ERR_error_string_n(err, buf, sizeof(buf));
+                ERR_clear_error();
+                return buf;
+            }
+
+            // 握手完成时在执行握手的 crypto 线程中计数(见 handshake_pool)
+            void on_info(const SSL *ssl, int where, int ret) {
+                if(!(where & SSL_CB_HANDSHAKE_DONE))
+                    return;
+                metrics::count(metrics::TLS_HANDSHAKES);
+                if(SSL_session_reused(const_cast<SSL*>(ssl)))
+                    metrics::count(metrics::TLS_RESUMED);
+#if defined(BIO_get_ktls_send)
+                if(BIO_get_ktls_send(SSL_get_wbio(ssl)))
+                    metrics::count(metrics::TLS_KTLS);
 #endif
+            }
 
-        ssl_ctx_guard::ssl_ctx_guard() {
-            init_ssl_locking();
-            SSL_load_error_strings();
-            SSL_library_init();
-            if(!RAND_poll()) {
-                log_error("Failed to gather sufficient entropy for SSL initialization");
-                exit(EXIT_FAILURE);
+            SSL_CTX* create(const tls_options &opts, std::string &error) {
+                OPENSSL_init_ssl(0, nullptr);
+                SSL_CTX *ctx = SSL_CTX_new(TLS_server_method());
+                if(!ctx) {
+                    error = "Failed to create the SSL_CTX: " + last_error();
+                    return nullptr;
+                }
+                if(!SSL_CTX_set_min_proto_version(ctx, opts.min_version)) {
+                    error = "Unsupported minimum TLS version: " + last_error();
+                } else if(SSL_CTX_use_certificate_chain_file(ctx, opts.cert_file.c_str()) != 1) {
+                    error = "Cannot read the certificate chain " + opts.cert_file + ": " + last_error();
+                } else if(SSL_CTX_use_PrivateKey_file(ctx, opts.key_file.c_str(), SSL_FILETYPE_PEM) != 1) {
+                    error = "Cannot read the private key " + opts.key_file + ": " + last_error();
+                } else if(SSL_CTX_check_private_key(ctx) != 1) {
+                    error = "The private key does not match the certificate: " + last_error();
+                }
+                if(!error.empty()) {
+                    SSL_CTX_free(ctx);
+                    return nullptr;
+                }
+                // TLS 1.2 按会话 id 在服务端缓存中恢复, TLS 1.3 以无状态的票据恢复, 票据密钥由 SSL_CTX 生成并共享
+                static const unsigned char sid_ctx[] = "tcp_kit";
+                SSL_CTX_set_session_id_context(ctx, sid_ctx, sizeof(sid_ctx) - 1);
+                SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+                SSL_CTX_sess_set_cache_size(ctx, TLS_SESSION_CACHE_SIZE);
+                SSL_CTX_set_timeout(ctx, TLS_SESSION_TIMEOUT_S);
+                SSL_CTX_set_num_tickets(ctx, TLS_TICKETS);
+                SSL_CTX_set_options(ctx, SSL_OP_NO_COMPRESSION | SSL_OP_NO_RENEGOTIATION | SSL_OP_CIPHER_SERVER_PREFERENCE);
+#if TLS_ENABLE_KTLS && defined(SSL_OP_ENABLE_KTLS)
+                SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+#endif
+                SSL_CTX_set_info_callback(ctx, on_info);
+                return ctx;
             }
-            ctx = SSL_CTX_new(SSLv23_server_method());
-            if (! SSL_CTX_use_certificate_chain_file(ctx, SSL_CERT_FILE) ||
-                ! SSL_CTX_use_PrivateKey_file(ctx, SSL_PKEY_FILE, SSL_FILETYPE_PEM)) {
-                log_error("Couldn't read 'pkey' or 'cert' file.  To generate a key\n"
-                     "and self-signed certificate, run:\n"
-                     "  openssl genrsa -out pkey 2048\n"
-                     "  openssl req -new -key pkey -out cert.req\n"
-                     "  openssl x509 -req -days 365 -in cert.req -signkey pkey -out cert");
-                exit(EXIT_FAILURE);
+
+            // 以 ssl 构造直接读写 socket 的 bufferevent, 替换连接原来的 bufferevent
+            void replace_bev(ev_context *ctx, SSL *ssl, bufferevent_ssl_state state) {
+                bufferevent *tls_bev = bufferevent_openssl_socket_new(bufferevent_get_base(ctx->bev), ctx->fd, ssl,
+                                                                      state, BEV_OPT_CLOSE_ON_FREE);
+                if(!tls_bev) {
+                    SSL_free(ssl);
+                    throw generic_error<CONS_BEV_FAILED>("Failed to create the TLS bufferevent");
+                }
+                bufferevent_openssl_set_allow_dirty_shutdown(tls_bev, 1);
+                // 原来的 socket bufferevent 不再使用, 释放它时不关闭 socket
+                bufferevent_setfd(ctx->bev, -1);
+                bufferevent_free(ctx->bev);
+                ctx->bev = tls_bev;
             }
-            SSL_CTX_set_options(ctx, SSL_OP_NO_SSLv2);
-        }
 
-        void ssl_ctx_guard::thread_lock_cb(int mode, int which, const char * f, int l) {
-            if (which < ssl_num_locks) {
-                if (mode & CRYPTO_LOCK) {
-                    pthread_mutex_lock(&(ssl_locks[which]));
-                } else {
-                    pthread_mutex_unlock(&(ssl_locks[which]));
+            // crypto 线程中进行的一次握手
+            struct handshake {
+                SSL             *ssl;
+                ev_context      *ctx;
+                ev_handler_base *owner;
+                event           *ev;
+                std::chrono::steady_clock::time_point deadline;
+            };
+
+            // 每个 crypto 线程运行自己的事件循环, 握手按轮转分配给它们. 握手按 OpenSSL 的要求等待 socket 可读或可写,
+            // 一个线程可以同时进行多个握手. 结束后经邮件将连接交还给接收它的 ev_handler, 线程不读写 ev_context
+            class handshake_pool {
+
+            public:
+                handshake_pool(): _next(0) {
+                    evthread_use_pthreads();
+                    for(size_t i = 0; i < TLS_HANDSHAKE_THREADS; ++i) {
+                        event_base *base = event_base_new();
+                        if(!base)
+                            throw generic_error<CONS_EVENT_FAILED>("Failed to construct the event base of the crypto thread");
+                        _bases.push_back(base);
+                        std::thread([base] { event_base_loop(base, EVLOOP_NO_EXIT_ON_EMPTY); }).detach();
+                    }
+                }
+
+                void submit(handshake *h) {
+                    event_base *base = _bases[_next.fetch_add(1, std::memory_order_relaxed) % _bases.size()];
+                    h->ev = event_new(base, SSL_get_fd(h->ssl), 0, step, h);
+                    if(!h->ev) {
+                        SSL_free(h->ssl);
+                        delete h;
+                        throw generic_error<CONS_EVENT_FAILED>("Failed to construct the handshake event");
+                    }
+                    event_active(h->ev, EV_READ, 0);
+                }
+
+            private:
+                std::vector<event_base*> _bases;
+                std::atomic<size_t>      _next;
+
+                static void step(evutil_socket_t fd, short what, void *arg) {
+                    auto *h = static_cast<handshake *>(arg);
+                    if(what & EV_TIMEOUT) {
+                        log_debug("The TLS handshake timed out");
+                        finish(h, false);
+                        return;
+                    }
+                    ERR_clear_error();
+                    int res = SSL_do_handshake(h->ssl);
+                    if(res == 1) {
+                        finish(h, true);
+                        return;
+                    }
+                    short wait;
+                    switch(SSL_get_error(h->ssl, res)) {
+                        case SSL_ERROR_WANT_READ:
+                            wait = EV_READ;
+                            break;
+                        case SSL_ERROR_WANT_WRITE:
+                            wait = EV_WRITE;
+                            break;
+                        default:
+                            log_debug("The TLS handshake failed: %s", last_error().c_str());
+                            finish(h, false);
+                            return;
+                    }
+                    auto left = std::chrono::duration_cast<std::chrono::microseconds>(h->deadline - std::chrono::steady_clock::now());
+                    if(left.count() <= 0) {
+                        finish(h, false);
+                        return;
+                    }
+                    timeval tv{time_t(left.count() / 1000000), suseconds_t(left.count() % 1000000)};
+                    event_assign(h->ev, event_get_base(h->ev), fd, wait, step, h);
+                    event_add(h->ev, &tv);
+                }
+
+                static void finish(handshake *h, bool ok) {
+                    event_free(h->ev);
+                    if(ok) {
+                        h->owner->resume_connect(h->ctx, true, &tls_filter::established, h->ssl);
+                    } else {
+                        SSL_free(h->ssl);
+                        h->owner->resume_connect(h->ctx, false);
+                    }
+                    delete h;
                 }
+
+            };
+
+            handshake_pool& pool() {
+                static handshake_pool p;
+                return p;
             }
+
         }
 
-        void ssl_ctx_guard::init_ssl_locking() {
-            int i;
-            ssl_num_locks = CRYPTO_num_locks();
-            ssl_locks = static_cast<pthread_mutex_t *>(malloc(ssl_num_locks * sizeof(pthread_mutex_t)));
-            if (ssl_locks == NULL) {
-                log_error("Failed to initialize OpenSSL locking");
-                exit(EXIT_FAILURE);
-            }
-            for (i = 0; i < ssl_num_locks; i++) {
-                pthread_mutex_init(&(ssl_locks[i]), NULL);
+        bool tls_context::configure(const tls_options &opts) {
+            std::lock_guard<std::mutex> lock(config_mutex());
+            if(created())
+                return false;
+            config() = opts;
+            return true;
+        }
+
+        SSL_CTX* tls_context::get() {
+            static std::string error;
+            static SSL_CTX *ctx = [] {
+                std::lock_guard<std::mutex> lock(config_mutex());
+                created() = true;
+                SSL_CTX *c = create(config(), error);
+                if(!c)
+                    log_error("%s", error.c_str());
+                return c;
+            }();
+            if(!ctx)
+                throw generic_error<TLS_FAILED>("%s", error.c_str());
+            return ctx;
+        }
+
+        void tls_filter::connect(ev_context* ctx) {
+            SSL *ssl = SSL_new(tls_context::get());
+            if(!ssl)
+                throw generic_error<TLS_FAILED>("Failed to create the SSL: %s", last_error().c_str());
+#if TLS_HANDSHAKE_THREADS > 0
+            if(SSL_set_fd(ssl, ctx->fd) != 1) {
+                SSL_free(ssl);
+                throw generic_error<TLS_FAILED>("Failed to set the socket of the SSL: %s", last_error().c_str());
             }
-#if OPENSSL_VERSION_NUMBER < 0x10000000L
-            CRYPTO_set_id_callback(get_thread_id_cb);
+            SSL_set_accept_state(ssl);
+            ev_handler_base::suspend_connect(ctx);
+            // 握手可能在过滤器返回之前完成, 但 CONNECT 邮件要在本次回调返回后才由 ev_handler 处理
+            pool().submit(new handshake{ssl, ctx, ctx->ev_handler, nullptr,
+                                        std::chrono::steady_clock::now() + std::chrono::milliseconds(TLS_HANDSHAKE_TIMEOUT_MS)});
 #else
-            CRYPTO_THREADID_set_callback(get_thread_id_cb);
+            // OpenSSL 以 socket BIO 直接读写连接, 握手后才能在该 socket 上启用内核 TLS
+            replace_bev(ctx, ssl, BUFFEREVENT_SSL_ACCEPTING);
 #endif
-            CRYPTO_set_locking_callback(thread_lock_cb);
         }
 
-        ssl_ctx_guard::~ssl_ctx_guard() {
-            delete[] ssl_locks;
-            SSL_CTX_free(ctx);
+        void tls_filter::established(ev_context* ctx, void *ssl) {
+            replace_bev(ctx, static_cast<SSL *>(ssl), BUFFEREVENT_SSL_OPEN);
         }
 
-        void openssl_filter::connect(ev_context* ctx) {
-            bufferevent* ssl_bev = bufferevent_openssl_filter_new(bufferevent_get_base(ctx->bev),
-                                                                  ctx->bev,
-                                                                  SSL_new(ssl_ctx_guard::singleton.ctx),
-                                                                  BUFFEREVENT_SSL_ACCEPTING,
-                                                                  BEV_OPT_CLOSE_ON_FREE);
-            if(ssl_bev) {
-                ctx->bev = ssl_bev;
-            } else {
-                throw generic_error<CONS_BEV_FAILED>("Failed to create the SSL filter");
+        bool write_self_signed(const std::string &cert_file, const std::string &key_file) {
+            EVP_PKEY *pkey = nullptr;
+            EVP_PKEY_CTX *pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+            bool ok = pctx && EVP_PKEY_keygen_init(pctx) > 0 &&
+                      EVP_PKEY_CTX_set_ec_paramgen_curve_nid(pctx, NID_X9_62_prime256v1) > 0 &&
+                      EVP_PKEY_keygen(pctx, &pkey) > 0;
+            EVP_PKEY_CTX_free(pctx);
+            X509 *x509 = ok ? X509_new() : nullptr;
+            if(x509) {
+                X509_NAME *name = X509_get_subject_name(x509);
+                ok = X509_set_version(x509, 2) &&
+                     ASN1_INTEGER_set(X509_get_serialNumber(x509), 1) &&
+                     X509_gmtime_adj(X509_getm_notBefore(x509), 0) &&
+                     X509_gmtime_adj(X509_getm_notAfter(x509), 365L * 24 * 3600) &&
+                     X509_set_pubkey(x509, pkey) &&
+                     X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                                reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0) &&
+                     X509_set_issuer_name(x509, name) &&
+                     X509_sign(x509, pkey, EVP_sha256()) > 0;
             }
+            FILE *cert = ok ? fopen(cert_file.c_str(), "w") : nullptr;
+            ok = cert && PEM_write_X509(cert, x509);
+            if(cert && fclose(cert) != 0)
+                ok = false;
+            FILE *key = ok ? fopen(key_file.c_str(), "w") : nullptr;
+            ok = key && PEM_write_PrivateKey(key, pkey, nullptr, nullptr, 0, nullptr, nullptr);
+            if(key && fclose(key) != 0)
+                ok = false;
+            X509_free(x509);
+            EVP_PKEY_free(pkey);
+            if(!ok)
+                log_error("Cannot write the self-signed certificate to %s", cert_file.c_str());
+            return ok;
         }
 
-
     }
 
 }
@@ -1,4 +1,12 @@
 #include <util/system_util.h>
+#include <sys/resource.h>
+
+int64_t tcp_kit::process_cpu_time_us() {
+    rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ll + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
 
 #ifdef __APPLE__
 #include <sys/types.h>
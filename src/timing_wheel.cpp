@@ -0,0 +1,121 @@
+#include <util/timing_wheel.h>
+
+namespace tcp_kit {
+
+    static inline void list_init(timer_node *head) {
+        head->prev = head;
+        head->next = head;
+    }
+
+    static inline bool list_empty(const timer_node *head) {
+        return head->next == head;
+    }
+
+    static inline void list_append(timer_node *head, timer_node *node) {
+        node->prev = head->prev;
+        node->next = head;
+        head->prev->next = node;
+        head->prev = node;
+    }
+
+    static inline void list_unlink(timer_node *node) {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = nullptr;
+        node->next = nullptr;
+    }
+
+    // 将 from 中的所有节点转移到 to(空链表)中
+    static inline void list_move(timer_node *from, timer_node *to) {
+        if(list_empty(from)) {
+            list_init(to);
+            return;
+        }
+        to->next = from->next;
+        to->prev = from->prev;
+        to->next->prev = to;
+        to->prev->next = to;
+        list_init(from);
+    }
+
+    timing_wheel::timing_wheel(): _current(0) {
+        for(auto &slot : _root)
+            list_init(&slot);
+        for(auto &level : _levels)
+            for(auto &slot : level)
+                list_init(&slot);
+    }
+
+    void timing_wheel::arm(timer_node *node, uint64_t ticks) {
+        if(armed(node))
+            list_unlink(node);
+        node->expire = _current + (ticks > TW_MAX_TICKS ? TW_MAX_TICKS : ticks);
+        add(node);
+    }
+
+    void timing_wheel::cancel(timer_node *node) {
+        if(armed(node))
+            list_unlink(node);
+    }
+
+    void timing_wheel::advance(uint64_t to) {
+        while(_current <= to)
+            tick();
+    }
+
+    uint64_t timing_wheel::now() const {
+        return _current;
+    }
+
+    bool timing_wheel::armed(const timer_node *node) {
+        return node->next != nullptr;
+    }
+
+    void timing_wheel::add(timer_node *node) {
+        uint64_t expire = node->expire;
+        uint64_t delta = expire - _current;
+        timer_node *slot;
+        if(expire < _current) {
+            // 已过期的节点在当前 tick 处理
+            slot = &_root[_current & (TW_ROOT_SIZE - 1)];
+        } else if(delta < (uint64_t(1) << TW_ROOT_BITS)) {
+            slot = &_root[expire & (TW_ROOT_SIZE - 1)];
+        } else {
+            uint32_t level = 0;
+            while(level < TW_LEVELS - 1 && delta >= (uint64_t(1) << (TW_ROOT_BITS + (level + 1) * TW_LEVEL_BITS)))
+                ++level;
+            uint32_t index = (expire >> (TW_ROOT_BITS + level * TW_LEVEL_BITS)) & (TW_LEVEL_SIZE - 1);
+            slot = &_levels[level][index];
+        }
+        list_append(slot, node);
+    }
+
+    // 将第 level 层当前槽位中的节点重新散列到下层, 返回该槽位的下标, 为 0 时表示这一层也转完了一圈
+    uint32_t timing_wheel::cascade(uint32_t level) {
+        uint32_t index = (_current >> (TW_ROOT_BITS + level * TW_LEVEL_BITS)) & (TW_LEVEL_SIZE - 1);
+        timer_node pending;
+        list_move(&_levels[level][index], &pending);
+        while(!list_empty(&pending)) {
+            timer_node *node = pending.next;
+            list_unlink(node);
+            add(node);
+        }
+        return index;
+    }
+
+    void timing_wheel::tick() {
+        uint32_t index = _current & (TW_ROOT_SIZE - 1);
+        if(!index) {
+            for(uint32_t level = 0; level < TW_LEVELS && !cascade(level); ++level);
+        }
+        timer_node expired;
+        list_move(&_root[index], &expired);
+        ++_current;
+        while(!list_empty(&expired)) {
+            timer_node *node = expired.next;
+            list_unlink(node);
+            node->callback(node->arg);
+        }
+    }
+
+}
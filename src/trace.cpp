@@ -0,0 +1,291 @@
+#include <metrics/trace.h>
+#include <logger/logger.h>
+#include <cxxabi.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+namespace tcp_kit {
+
+    namespace trace {
+
+        std::atomic<uint64_t> _threshold {uint64_t(TRACE_SAMPLE_RATE * 4294967296.0)};
+
+        namespace {
+
+            const char* stage_names[N_STAGES] = {
+                "read", "enqueue", "queue", "filter", "done", "dispatch", "reply", "flush"
+            };
+
+            // 单写者的槽, seq 为写入完成时的序号加 1, 写入过程中为 0. 读者在读取前后各读一次 seq 以丢弃正被覆盖的槽
+            struct slot {
+                std::atomic<uint64_t>     seq {0};
+                std::atomic<uint64_t>     trace_id {0};
+                std::atomic<uint64_t>     begin {0};
+                std::atomic<uint64_t>     end {0};
+                std::atomic<const char*>  name {nullptr};
+                std::atomic<uint8_t>      stage_ {0};
+            };
+
+            // 每个记录过 span 的线程持有一个环, 环在线程退出后保留
+            struct ring {
+                uint32_t               thread;
+                std::atomic<uint64_t>  head {0};   // 已写入的 span 数
+                slot                   slots[TRACE_RING_SPANS];
+            };
+
+            std::mutex& rings_mutex() {
+                static std::mutex m;
+                return m;
+            }
+
+            std::vector<ring*>& rings() {
+                static std::vector<ring*> r;
+                return r;
+            }
+
+            ring& local() {
+                static thread_local ring *r = nullptr;
+                if(!r) {
+                    r = new ring;
+                    std::lock_guard<std::mutex> lock(rings_mutex());
+                    rings().push_back(r);
+                    r->thread = uint32_t(rings().size());
+                }
+                return *r;
+            }
+
+            uint64_t next_random() {
+                static thread_local uint64_t state = 0;
+                if(!state)
+                    state = (uint64_t(ticks()) ^ uint64_t(reinterpret_cast<uintptr_t>(&state))) | 1;
+                // xorshift64*
+                state ^= state >> 12;
+                state ^= state << 25;
+                state ^= state >> 27;
+                return state * 0x2545F4914F6CDD1Dull;
+            }
+
+            int64_t clock_ns(clockid_t id) {
+                timespec ts;
+                clock_gettime(id, &ts);
+                return int64_t(ts.tv_sec) * 1000000000ll + ts.tv_nsec;
+            }
+
+            // 同一时刻的计数器与两个时钟, 用于将 ticks 换算为纳秒
+            struct clock_pair {
+                uint64_t ticks;
+                int64_t  steady_ns;
+                int64_t  wall_ns;
+
+                static clock_pair now() {
+                    return {trace::ticks(), clock_ns(CLOCK_MONOTONIC), clock_ns(CLOCK_REALTIME)};
+                }
+            };
+
+            const clock_pair origin = clock_pair::now();
+
+            // 以进程启动到导出之间的平均频率换算, 要求计数器在各个核上同步(现代 x86 的 invariant TSC)
+            struct converter {
+                double ns_per_tick;
+
+                converter() {
+                    clock_pair cur = clock_pair::now();
+                    ns_per_tick = cur.ticks > origin.ticks ?
+                                  double(cur.steady_ns - origin.steady_ns) / double(cur.ticks - origin.ticks) : 1;
+                }
+
+                // 相对于进程启动的纳秒数
+                double since_origin(uint64_t t) const {
+                    return (double(int64_t(t - origin.ticks))) * ns_per_tick;
+                }
+
+                uint64_t wall_ns(uint64_t t) const {
+                    return uint64_t(origin.wall_ns + int64_t(since_origin(t)));
+                }
+            };
+
+            void append(std::string &out, const char *fmt, ...) {
+                char buf[256];
+                va_list args;
+                va_start(args, fmt);
+                int len = vsnprintf(buf, sizeof(buf), fmt, args);
+                va_end(args);
+                if(len > 0)
+                    out.append(buf, std::min<size_t>(size_t(len), sizeof(buf) - 1));
+            }
+
+            void append_escaped(std::string &out, const std::string &s) {
+                for(char c: s) {
+                    if(c == '"' || c == '\\')
+                        out += '\\';
+                    if(static_cast<unsigned char>(c) >= 0x20)
+                        out += c;
+                }
+            }
+
+            // span 的显示名称, 过滤器为 filter:<类型名>
+            class namer {
+
+            public:
+                const std::string& operator()(const span &s) {
+                    auto it = _names.find(std::make_pair(s.stage_, s.name));
+                    if(it != _names.end())
+                        return it->second;
+                    std::string name = name_of(s.stage_);
+                    if(s.name) {
+                        int status = 0;
+                        char *demangled = abi::__cxa_demangle(s.name, nullptr, nullptr, &status);
+                        name += ":";
+                        name += status == 0 ? demangled : s.name;
+                        free(demangled);
+                    }
+                    return _names[std::make_pair(s.stage_, s.name)] = name;
+                }
+
+            private:
+                std::map<std::pair<uint8_t, const char*>, std::string> _names;
+
+            };
+
+        }
+
+        void set_sample_rate(double rate) {
+            rate = std::max(0.0, std::min(1.0, rate));
+            _threshold.store(uint64_t(rate * 4294967296.0), std::memory_order_relaxed);
+        }
+
+        double sample_rate() {
+            return double(_threshold.load(std::memory_order_relaxed)) / 4294967296.0;
+        }
+
+        uint64_t sample() {
+#if TRACE_ENABLED
+            uint64_t r = next_random();
+            if((r >> 32) < _threshold.load(std::memory_order_relaxed))
+                return next_random() | 1;
+#endif
+            return 0;
+        }
+
+        void record(uint64_t trace_id, stage s, const char *name, uint64_t begin, uint64_t end) {
+            ring &r = local();
+            uint64_t n = r.head.load(std::memory_order_relaxed);
+            slot &sl = r.slots[n % TRACE_RING_SPANS];
+            sl.seq.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            sl.trace_id.store(trace_id, std::memory_order_relaxed);
+            sl.begin.store(begin, std::memory_order_relaxed);
+            sl.end.store(end, std::memory_order_relaxed);
+            sl.name.store(name, std::memory_order_relaxed);
+            sl.stage_.store(s, std::memory_order_relaxed);
+            sl.seq.store(n + 1, std::memory_order_release);
+            r.head.store(n + 1, std::memory_order_release);
+        }
+
+        const char* name_of(stage s) {
+            return stage_names[s];
+        }
+
+        void collect(std::vector<span> &out) {
+            std::vector<ring*> all;
+            {
+                std::lock_guard<std::mutex> lock(rings_mutex());
+                all = rings();
+            }
+            for(ring *r: all) {
+                uint64_t head = r->head.load(std::memory_order_acquire);
+                for(uint64_t n = head > TRACE_RING_SPANS ? head - TRACE_RING_SPANS : 0; n < head; ++n) {
+                    slot &sl = r->slots[n % TRACE_RING_SPANS];
+                    uint64_t seq = sl.seq.load(std::memory_order_acquire);
+                    span s{sl.trace_id.load(std::memory_order_relaxed), sl.begin.load(std::memory_order_relaxed),
+                           sl.end.load(std::memory_order_relaxed), sl.name.load(std::memory_order_relaxed),
+                           r->thread, stage(sl.stage_.load(std::memory_order_relaxed))};
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if(seq == n + 1 && sl.seq.load(std::memory_order_relaxed) == seq)
+                        out.push_back(s);
+                }
+            }
+            std::sort(out.begin(), out.end(), [](const span &a, const span &b) {
+                return a.trace_id != b.trace_id ? a.trace_id < b.trace_id : a.begin < b.begin;
+            });
+        }
+
+        std::string to_chrome_json() {
+            std::vector<span> spans;
+            collect(spans);
+            converter conv;
+            namer name;
+            int pid = getpid();
+            std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            for(size_t i = 0; i < spans.size(); ++i) {
+                const span &s = spans[i];
+                double begin = conv.since_origin(s.begin);
+                append(out, "%s{\"name\":\"", i ? "," : "");
+                append_escaped(out, name(s));
+                append(out, "\",\"cat\":\"tcp_kit\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u,"
+                            "\"args\":{\"trace_id\":\"%016llx\"}}",
+                       begin / 1000, std::max(0.0, conv.since_origin(s.end) - begin) / 1000, pid, s.thread,
+                       (unsigned long long) s.trace_id);
+            }
+            out += "]}";
+            return out;
+        }
+
+        std::string to_otlp_json() {
+            std::vector<span> spans;
+            collect(spans);
+            converter conv;
+            namer name;
+            unsigned long long salt = (unsigned long long) origin.wall_ns ^ (unsigned long long) getpid();
+            std::string out = "{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\","
+                              "\"value\":{\"stringValue\":\"tcp_kit\"}}]},\"scopeSpans\":[{\"scope\":{\"name\":\"tcp_kit\"},"
+                              "\"spans\":[";
+            bool first = true;
+            for(size_t i = 0; i < spans.size(); ) {
+                // 同一个请求的 span 相邻, 其最早的开始与最晚的结束构成根 span
+                size_t j = i;
+                uint64_t begin = spans[i].begin, end = spans[i].end;
+                for(; j < spans.size() && spans[j].trace_id == spans[i].trace_id; ++j)
+                    end = std::max(end, spans[j].end);
+                unsigned long long id = spans[i].trace_id;
+                append(out, "%s{\"traceId\":\"%016llx%016llx\",\"spanId\":\"%016llx\",\"name\":\"request\",\"kind\":2,"
+                            "\"startTimeUnixNano\":\"%llu\",\"endTimeUnixNano\":\"%llu\"}",
+                       first ? "" : ",", salt, id, id, (unsigned long long) conv.wall_ns(begin),
+                       (unsigned long long) conv.wall_ns(end));
+                first = false;
+                for(size_t k = i; k < j; ++k) {
+                    const span &s = spans[k];
+                    append(out, ",{\"traceId\":\"%016llx%016llx\",\"spanId\":\"%016llx\",\"parentSpanId\":\"%016llx\","
+                                "\"name\":\"", salt, id, (unsigned long long) (id + k - i + 1), id);
+                    append_escaped(out, name(s));
+                    append(out, "\",\"kind\":1,\"startTimeUnixNano\":\"%llu\",\"endTimeUnixNano\":\"%llu\","
+                                "\"attributes\":[{\"key\":\"thread.id\",\"value\":{\"intValue\":\"%u\"}}]}",
+                           (unsigned long long) conv.wall_ns(s.begin), (unsigned long long) conv.wall_ns(s.end),
+                           s.thread);
+                }
+                i = j;
+            }
+            out += "]}]}]}";
+            return out;
+        }
+
+        bool export_file(const std::string &path, format f) {
+            std::string body = f == OTLP ? to_otlp_json() : to_chrome_json();
+            FILE *file = fopen(path.c_str(), "w");
+            bool written = file && fwrite(body.data(), 1, body.size(), file) == body.size();
+            if(file && fclose(file) != 0)
+                written = false;
+            if(!written)
+                log_error("Cannot export the trace to %s", path.c_str());
+            return written;
+        }
+
+    }
+
+}
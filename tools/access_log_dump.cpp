@@ -0,0 +1,105 @@
+// tcp_kit_access_log: 将访问日志的段文件转换为 csv 或 json(每行一个对象), 输出到 stdout
+//
+// tcp_kit_access_log [--format=csv|json] <segment>...
+
+#include <logger/access_log.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace tcp_kit {
+
+    namespace access_log_dump {
+
+        using access_log::record;
+
+        std::string api_of(const record &r) {
+            return std::string(r.api, strnlen(r.api, sizeof(r.api)));
+        }
+
+        std::string json_escape(const std::string &s) {
+            std::string out;
+            for(char c: s) {
+                if(c == '"' || c == '\\') {
+                    out += '\\';
+                    out += c;
+                } else if(static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += c;
+                }
+            }
+            return out;
+        }
+
+        std::string csv_escape(const std::string &s) {
+            if(s.find_first_of(",\"\n") == std::string::npos)
+                return s;
+            std::string out = "\"";
+            for(char c: s) {
+                if(c == '"')
+                    out += '"';
+                out += c;
+            }
+            return out + "\"";
+        }
+
+        void print_csv(const record &r, uint32_t pid) {
+            printf("%llu,%u,%llu,%s,%llu,%u,%llu,%u,%u\n",
+                   (unsigned long long) r.time_ns, pid, (unsigned long long) r.conn_id, csv_escape(api_of(r)).c_str(),
+                   (unsigned long long) r.seq, r.code, (unsigned long long) r.latency_ns, r.bytes_in, r.bytes_out);
+        }
+
+        void print_json(const record &r, uint32_t pid) {
+            printf("{\"time_ns\":%llu,\"pid\":%u,\"conn_id\":%llu,\"api\":\"%s\",\"seq\":%llu,\"code\":%u,"
+                   "\"latency_ns\":%llu,\"bytes_in\":%u,\"bytes_out\":%u}\n",
+                   (unsigned long long) r.time_ns, pid, (unsigned long long) r.conn_id, json_escape(api_of(r)).c_str(),
+                   (unsigned long long) r.seq, r.code, (unsigned long long) r.latency_ns, r.bytes_in, r.bytes_out);
+        }
+
+        int run(int argc, char **argv) {
+            bool json = false;
+            std::vector<std::string> paths;
+            for(int i = 1; i < argc; ++i) {
+                if(strcmp(argv[i], "--format=json") == 0) {
+                    json = true;
+                } else if(strcmp(argv[i], "--format=csv") == 0) {
+                    json = false;
+                } else if(strncmp(argv[i], "--", 2) == 0) {
+                    fprintf(stderr, "Unknown option: %s\n", argv[i]);
+                    return 2;
+                } else {
+                    paths.push_back(argv[i]);
+                }
+            }
+            if(paths.empty()) {
+                fprintf(stderr, "usage: %s [--format=csv|json] <segment>...\n", argv[0]);
+                return 2;
+            }
+            if(!json)
+                printf("time_ns,pid,conn_id,api,seq,code,latency_ns,bytes_in,bytes_out\n");
+            int code = 0;
+            for(const std::string &path: paths) {
+                access_log::segment_header header;
+                std::vector<record> records;
+                if(!access_log::read_segment(path, header, records)) {
+                    fprintf(stderr, "Not an access log segment: %s\n", path.c_str());
+                    code = 1;
+                    continue;
+                }
+                for(const record &r: records)
+                    json ? print_json(r, header.pid) : print_csv(r, header.pid);
+            }
+            return code;
+        }
+
+    }
+
+}
+
+int main(int argc, char **argv) {
+    return tcp_kit::access_log_dump::run(argc, argv);
+}